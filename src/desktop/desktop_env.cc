@@ -35,8 +35,7 @@
 
 namespace crystaldock {
 
-DesktopEnv* DesktopEnv::getDesktopEnv() {
-  QString currentDesktopEnv = getDesktopEnvName();
+DesktopEnv* DesktopEnv::getDesktopEnv(const QString& currentDesktopEnv) {
   if (currentDesktopEnv == "Hyprland") {
     static std::unique_ptr<HyprlandDesktopEnv> hyprland(new HyprlandDesktopEnv);
     return hyprland.get();
@@ -19,6 +19,7 @@
 #ifndef CRYSTALDOCK_DESKTOP_ENV_H_
 #define CRYSTALDOCK_DESKTOP_ENV_H_
 
+#include <map>
 #include <vector>
 
 #include <QString>
@@ -36,7 +37,9 @@ class DesktopEnv {
  public:
   virtual ~DesktopEnv() = default;
 
-  static DesktopEnv* getDesktopEnv();
+  // The instance for the desktop environment with this name, see getDesktopEnvName().
+  static DesktopEnv* getDesktopEnv(const QString& desktopEnvName);
+  // Reads XDG_CURRENT_DESKTOP. Done once at start-up, see SessionContext.
   static QString getDesktopEnvName();
 
   virtual QString getApplicationMenuIcon() const { return "start-here"; }
@@ -64,6 +67,28 @@ class DesktopEnv {
   //   wallpaper: path to the wallpaper file.
   virtual bool setWallpaper(int screen, const QString& wallpaper) { return false; }
 
+  // Sets the wallpapers for the current desktop for the specified screens, with as
+  // few calls to the desktop environment as possible. May return before the
+  // wallpapers have been applied.
+  // Args:
+  //   wallpapers: paths to the wallpaper files, by screen.
+  virtual bool setWallpapers(const std::map<int, QString>& wallpapers) {
+    if (wallpapers.empty()) {
+      return true;
+    }
+    if (!supportSeparateSreenWallpapers()) {
+      // The last one wins anyway.
+      const auto& [screen, wallpaper] = *wallpapers.rbegin();
+      return setWallpaper(screen, wallpaper);
+    }
+    for (const auto& [screen, wallpaper] : wallpapers) {
+      if (!setWallpaper(screen, wallpaper)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   // Returns the app ID of the default web browser.
   // Uses Firefox as fallback if default web browser not set.
   QString defaultWebBrowser() const;
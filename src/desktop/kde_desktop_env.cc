@@ -22,6 +22,8 @@
 #include <iostream>
 
 #include <QDBusMessage>
+#include <QDBusPendingCall>
+#include <QDBusPendingCallWatcher>
 
 #include <model/multi_dock_model.h>
 #include <utils/command_utils.h>
@@ -81,15 +83,34 @@ std::vector<QString> KdeDesktopEnv::getDefaultLaunchers() const {
 }
 
 bool KdeDesktopEnv::setWallpaper(int screen, const QString& wallpaper) {
-  const QDBusMessage response = plasmaShellDBus_.call(
-      "evaluateScript",
-      "var allDesktops = desktops();"
-      "d = allDesktops[" + QString::number(screen) + "];" +
-      "d.wallpaperPlugin ='org.kde.image';"
-      "d.currentConfigGroup = Array('Wallpaper', 'org.kde.image','General');"
-      "d.writeConfig('Image','file://"
-      + wallpaper + "')");
-  return response.type() != QDBusMessage::ErrorMessage;
+  return setWallpapers({{screen, wallpaper}});
+}
+
+bool KdeDesktopEnv::setWallpapers(const std::map<int, QString>& wallpapers) {
+  if (wallpapers.empty()) {
+    return true;
+  }
+
+  QString script = "var allDesktops = desktops();";
+  for (const auto& [screen, wallpaper] : wallpapers) {
+    QString path = wallpaper;
+    path.replace("\\", "\\\\").replace("'", "\\'");
+    script += "d = allDesktops[" + QString::number(screen) + "];"
+              "d.wallpaperPlugin ='org.kde.image';"
+              "d.currentConfigGroup = Array('Wallpaper', 'org.kde.image','General');"
+              "d.writeConfig('Image','file://" + path + "');";
+  }
+
+  auto* watcher =
+      new QDBusPendingCallWatcher(plasmaShellDBus_.asyncCall("evaluateScript", script));
+  QObject::connect(watcher, &QDBusPendingCallWatcher::finished, [](QDBusPendingCallWatcher* call) {
+    if (call->isError()) {
+      std::cerr << "Could not set the wallpapers: "
+                << call->error().message().toStdString() << std::endl;
+    }
+    call->deleteLater();
+  });
+  return plasmaShellDBus_.isValid();
 }
 
 }  // namespace crystaldock
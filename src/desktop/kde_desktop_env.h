@@ -41,6 +41,9 @@ class KdeDesktopEnv : public DesktopEnv {
 
   bool setWallpaper(int screen, const QString& wallpaper) override;
 
+  // Sets all the wallpapers with a single asynchronous script evaluation.
+  bool setWallpapers(const std::map<int, QString>& wallpapers) override;
+
  private:
   QDBusInterface plasmaShellDBus_;
   QString qdbusCommand_;
@@ -22,6 +22,9 @@ namespace crystaldock {
 
 org_kde_plasma_virtual_desktop_management* KdeVirtualDesktopManager::virtual_desktop_management_;
 std::vector<VirtualDesktopInfo> KdeVirtualDesktopManager::desktops_;
+std::shared_ptr<const std::vector<VirtualDesktopInfo>> KdeVirtualDesktopManager::snapshot_ =
+    std::make_shared<const std::vector<VirtualDesktopInfo>>();
+uint64_t KdeVirtualDesktopManager::version_ = 0;
 std::string KdeVirtualDesktopManager::currentDesktop_;
 
 /* static */ KdeVirtualDesktopManager* KdeVirtualDesktopManager::self() {
@@ -46,12 +49,18 @@ std::string KdeVirtualDesktopManager::currentDesktop_;
     VirtualDesktopManager* virtualDesktopManager) {
   virtualDesktopManager->currentDesktop = KdeVirtualDesktopManager::currentDesktop;
   virtualDesktopManager->desktops = KdeVirtualDesktopManager::desktops;
+  virtualDesktopManager->desktopsVersion = KdeVirtualDesktopManager::desktopsVersion;
   virtualDesktopManager->numberOfDesktops = KdeVirtualDesktopManager::numberOfDesktops;
   virtualDesktopManager->setCurrentDesktop = KdeVirtualDesktopManager::setCurrentDesktop;
 }
 
 /* static */ int KdeVirtualDesktopManager::numberOfDesktops() {
-  return desktops_.size();
+  return snapshot_->size();
+}
+
+/* static */ void KdeVirtualDesktopManager::updateSnapshot() {
+  snapshot_ = std::make_shared<const std::vector<VirtualDesktopInfo>>(desktops_);
+  ++version_;
 }
 
 /* static */ std::string_view KdeVirtualDesktopManager::currentDesktop() {
@@ -83,6 +92,7 @@ std::string KdeVirtualDesktopManager::currentDesktop_;
   desktops_.insert(desktops_.begin() + position, info);
   org_kde_plasma_virtual_desktop_add_listener(
       virtual_desktop, &virtual_desktop_listener_, NULL);
+  updateSnapshot();
   emit self()->numberOfDesktopsChanged(desktops_.size());
 }
 
@@ -94,6 +104,7 @@ std::string KdeVirtualDesktopManager::currentDesktop_;
   for (unsigned int pos = 0; pos < desktops_.size(); ++pos) {
     desktops_[pos].number = pos + 1;
   }
+  updateSnapshot();
   emit self()->numberOfDesktopsChanged(desktops_.size());
 }
 
@@ -118,6 +129,7 @@ std::string KdeVirtualDesktopManager::currentDesktop_;
                [virtual_desktop](auto& e) { return e.virtual_desktop == virtual_desktop; });
   if (pos != desktops_.end()) {
     pos->id = desktop_id;
+    updateSnapshot();
   }
 }
 
@@ -129,6 +141,7 @@ std::string KdeVirtualDesktopManager::currentDesktop_;
                [virtual_desktop](auto& e) { return e.virtual_desktop == virtual_desktop; });
   if (pos != desktops_.end()) {
     pos->name = name;
+    updateSnapshot();
     emit KdeVirtualDesktopManager::self()->desktopNameChanged(pos->id, pos->name);
   }
 }
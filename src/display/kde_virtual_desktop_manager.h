@@ -19,7 +19,10 @@
 #ifndef KDE_VIRTUAL_DESKTOP_MANAGER_H_
 #define KDE_VIRTUAL_DESKTOP_MANAGER_H_
 
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "plasma_virtual_desktop.h"
 #include "window_system.h"
@@ -44,11 +47,14 @@ class KdeVirtualDesktopManager : public QObject {
   static void bindVirtualDesktopManagerFunctions(VirtualDesktopManager* virtualDesktopManager);
 
   static int numberOfDesktops();
-  static std::vector<VirtualDesktopInfo> desktops() { return desktops_; }
+  static const std::vector<VirtualDesktopInfo>& desktops() { return *snapshot_; }
+  static uint64_t desktopsVersion() { return version_; }
   static std::string_view currentDesktop();
   static void setCurrentDesktop(std::string_view);
 
  private:
+  // Publishes desktops_ as the new snapshot.
+  static void updateSnapshot();
 
   // org_kde_plasma_virtual_desktop_management interface.
 
@@ -110,7 +116,12 @@ class KdeVirtualDesktopManager : public QObject {
 
   static org_kde_plasma_virtual_desktop_management* virtual_desktop_management_;
 
+  // Updated by the protocol events.
   static std::vector<VirtualDesktopInfo> desktops_;
+  // Copy of desktops_ for the callers, replaced rather than modified on each change so
+  // that it stays immutable.
+  static std::shared_ptr<const std::vector<VirtualDesktopInfo>> snapshot_;
+  static uint64_t version_;
   // Current desktop ID.
   static std::string currentDesktop_;
 };
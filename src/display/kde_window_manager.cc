@@ -18,15 +18,28 @@
 
 #include "kde_window_manager.h"
 
+#include <algorithm>
+#include <utility>
+
+#include "window_event_queue.h"
+#include "window_event_trace.h"
+#include <utils/runtime_metrics.h>
+
 namespace crystaldock {
 
 org_kde_plasma_window_management* KdeWindowManager::window_management_;
 std::unordered_map<struct org_kde_plasma_window*, std::unique_ptr<WindowInfo>>
     KdeWindowManager::windows_;
-std::unordered_map<std::string, struct org_kde_plasma_window*> KdeWindowManager::uuids_;
-std::vector<std::string> KdeWindowManager::stackingOrder_;
+std::vector<const WindowInfo*> KdeWindowManager::windowList_;
+std::unordered_map<std::string, struct org_kde_plasma_window*, KdeWindowManager::UuidHash,
+                   std::equal_to<>> KdeWindowManager::uuids_;
+std::string KdeWindowManager::stackingOrderUuids_;
+std::vector<void*> KdeWindowManager::stackingOrder_;
+bool KdeWindowManager::isStackingOrderValid_ = true;
 struct org_kde_plasma_window* KdeWindowManager::activeWindow_;
 bool KdeWindowManager::showingDesktop_;
+std::unordered_set<struct org_kde_plasma_window*> KdeWindowManager::pendingGeometryWindows_;
+QTimer* KdeWindowManager::geometryTimer_ = nullptr;
 
 /* static */ KdeWindowManager* KdeWindowManager::self() {
   static KdeWindowManager self;
@@ -38,16 +51,24 @@ bool KdeWindowManager::showingDesktop_;
   window_management_ = window_management;
   org_kde_plasma_window_management_add_listener(
       window_management_, &window_management_listener_, NULL);
+  connectSignals();
+}
+
+/* static */ void KdeWindowManager::connectSignals() {
   connect(KdeWindowManager::self(), &KdeWindowManager::activeWindowChanged,
       WindowSystem::self(), &WindowSystem::activeWindowChanged);
   connect(KdeWindowManager::self(), &KdeWindowManager::windowAdded,
       WindowSystem::self(), &WindowSystem::windowAdded);
   connect(KdeWindowManager::self(), &KdeWindowManager::windowGeometryChanged,
       WindowSystem::self(), &WindowSystem::windowGeometryChanged);
+  connect(KdeWindowManager::self(), &KdeWindowManager::windowOutputsChanged,
+      WindowSystem::self(), &WindowSystem::windowOutputsChanged);
   connect(KdeWindowManager::self(), &KdeWindowManager::windowLeftCurrentActivity,
       WindowSystem::self(), &WindowSystem::windowLeftCurrentActivity);
   connect(KdeWindowManager::self(), &KdeWindowManager::windowLeftCurrentDesktop,
       WindowSystem::self(), &WindowSystem::windowLeftCurrentDesktop);
+  connect(KdeWindowManager::self(), &KdeWindowManager::windowDesktopChanged,
+      WindowSystem::self(), &WindowSystem::windowDesktopChanged);
   connect(KdeWindowManager::self(), &KdeWindowManager::windowRemoved,
       WindowSystem::self(), &WindowSystem::windowRemoved);
   connect(KdeWindowManager::self(), &KdeWindowManager::windowStateChanged,
@@ -64,22 +85,34 @@ bool KdeWindowManager::showingDesktop_;
   windowManager->closeWindow = KdeWindowManager::closeWindow;
   windowManager->resetActiveWindow = KdeWindowManager::resetActiveWindow;
   windowManager->windows = KdeWindowManager::windows;
+  windowManager->stackingOrder = KdeWindowManager::stackingOrder;
   windowManager->setShowingDesktop = KdeWindowManager::setShowingDesktop;
   windowManager->showingDesktop = KdeWindowManager::showingDesktop;
 }
 
-/* static */ std::vector<const WindowInfo*> KdeWindowManager::windows() {
-  std::vector<const WindowInfo*> windows;
-  for (const auto& element : windows_) {
-    if (element.second) {
-      windows.push_back(element.second.get());
+/* static */ std::span<const WindowInfo* const> KdeWindowManager::windows() {
+  return windowList_;
+}
+
+/* static */ std::span<void* const> KdeWindowManager::stackingOrder() {
+  if (isStackingOrderValid_) {
+    return stackingOrder_;
+  }
+
+  stackingOrder_.clear();
+  std::string_view uuids = stackingOrderUuids_;
+  while (!uuids.empty()) {
+    const auto end = uuids.find(';');
+    const std::string_view uuid = uuids.substr(0, end);
+    // Windows may be in the order before we know about them.
+    const auto it = uuid.empty() ? uuids_.end() : uuids_.find(uuid);
+    if (it != uuids_.end() && windows_.count(it->second) > 0) {
+      stackingOrder_.push_back(it->second);
     }
+    uuids = (end == std::string_view::npos) ? std::string_view() : uuids.substr(end + 1);
   }
-  std::sort(windows.begin(), windows.end(),
-            [](const WindowInfo* w1, const WindowInfo* w2) {
-    return w1->mapping_order < w2->mapping_order;
-  });
-  return windows;
+  isStackingOrderValid_ = true;
+  return stackingOrder_;
 }
 
 /* static */ void* KdeWindowManager::activeWindow() {
@@ -142,32 +175,37 @@ bool KdeWindowManager::showingDesktop_;
            : ORG_KDE_PLASMA_WINDOW_MANAGEMENT_SHOW_DESKTOP_DISABLED);
   */
 
-  // So we make our own implementation.
-  for (const auto& uuid : stackingOrder_) {
-    auto* window = uuids_[uuid];
-    if (windows_[window]->desktop != WindowSystem::currentDesktop()) {
+  // So we make our own implementation. The requests go out from bottom to top, so that
+  // the windows keep their stacking order when restored, then are sent with a single flush.
+  const std::string_view currentDesktop = WindowSystem::currentDesktop();
+  struct org_kde_plasma_window* topRestored = nullptr;
+  for (void* handle : stackingOrder()) {
+    auto* window = static_cast<struct org_kde_plasma_window*>(handle);
+    WindowInfo* info = windows_.find(window)->second.get();
+    if (info->desktop != currentDesktop) {
       continue;
     }
 
     if (show) {
-      windows_[window]->restoreAfterShowDesktop = !windows_[window]->minimized;
-      if (!windows_[window]->minimized) {
+      info->restoreAfterShowDesktop = !info->minimized;
+      if (!info->minimized) {
         org_kde_plasma_window_set_state(
             window,
             ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_MINIMIZED,
             ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_MINIMIZED);
       }
-      showingDesktop_ = true;
-    } else {
-      if (windows_[window]->restoreAfterShowDesktop) {
-        org_kde_plasma_window_set_state(
-            window,
-            ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_ACTIVE,
-            ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_ACTIVE);
-      }
-      showingDesktop_ = false;
+    } else if (info->restoreAfterShowDesktop) {
+      // Only unminimizes; activating every window would raise each one in turn.
+      org_kde_plasma_window_set_state(
+          window, ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_MINIMIZED, 0);
+      topRestored = window;
     }
   }
+  if (topRestored) {
+    activateWindow(topRestored);
+  }
+  showingDesktop_ = show;
+  WindowEventQueue::flush();
 }
 
 // org_kde_plasma_window_management interface.
@@ -198,11 +236,8 @@ bool KdeWindowManager::showingDesktop_;
     void *data,
     struct org_kde_plasma_window_management *org_kde_plasma_window_management,
     const char *uuids) {
-  QStringList ids = QString(uuids).split(";", Qt::SkipEmptyParts);
-  stackingOrder_.clear();
-  for (const auto& id : ids) {
-    stackingOrder_.push_back(id.toStdString());
-  }
+  stackingOrderUuids_.assign(uuids);
+  isStackingOrderValid_ = false;
 }
 
 /* static */ void KdeWindowManager::window_with_uuid(
@@ -212,13 +247,26 @@ bool KdeWindowManager::showingDesktop_;
     const char *uuid) {
   struct org_kde_plasma_window* window =
       org_kde_plasma_window_management_get_window_by_uuid(window_management_, uuid);
+  addWindow(window, uuid);
+  org_kde_plasma_window_add_listener(window, &window_listener_, NULL);
+}
+
+/* static */ void KdeWindowManager::addWindow(struct org_kde_plasma_window* window,
+                                             const char* uuid) {
+  if (WindowEventRecorder::isRecording()) {
+    WindowEventRecorder::record(window, WindowEvent::Type::Toplevel);
+  }
+  if (windows_.count(window) > 0) {
+    std::erase(windowList_, windows_[window].get());
+  }
   windows_[window] = std::make_unique<WindowInfo>();
   windows_[window]->window = window;
   static uint32_t mapping_order = 0;
   windows_[window]->mapping_order = mapping_order++;
+  // Mapping orders are increasing so this keeps windowList_ sorted.
+  windowList_.push_back(windows_[window].get());
   uuids_[std::string{uuid}] = window;
-
-  org_kde_plasma_window_add_listener(window, &window_listener_, NULL);
+  isStackingOrderValid_ = false;
 }
 
 // org_kde_plasma_window interface.
@@ -231,7 +279,11 @@ bool KdeWindowManager::showingDesktop_;
     return;
   }
 
-  windows_[window]->title = title;
+  if (WindowEventRecorder::isRecording()) {
+    WindowEventRecorder::record(window, WindowEvent::Type::Title, title);
+  }
+
+  windows_[window]->qTitle = QString::fromUtf8(title);
   if (windows_[window]->initialized) {
     emit self()->windowTitleChanged(windows_[window].get());
   }
@@ -245,7 +297,11 @@ bool KdeWindowManager::showingDesktop_;
     return;
   }
 
-  windows_[window]->appId = app_id;
+  if (WindowEventRecorder::isRecording()) {
+    WindowEventRecorder::record(window, WindowEvent::Type::AppId, app_id);
+  }
+
+  windows_[window]->appIdAtom = AtomTable::intern(app_id);
 
   if (std::string(app_id) == "crystal-dock") {
     org_kde_plasma_window_set_state(
@@ -265,6 +321,11 @@ bool KdeWindowManager::showingDesktop_;
     return;
   }
 
+  if (WindowEventRecorder::isRecording()) {
+    WindowEventRecorder::record(window, WindowEvent::Type::State, {},
+                                WindowEventTrace::fromKdeState(flags));
+  }
+
   windows_[window]->skipTaskbar = flags & ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_SKIPTASKBAR;
   windows_[window]->onAllDesktops = flags & ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_ON_ALL_DESKTOPS;
   windows_[window]->demandsAttention = flags & ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_DEMANDS_ATTENTION;
@@ -308,8 +369,23 @@ bool KdeWindowManager::showingDesktop_;
     return;
   }
 
+  if (WindowEventRecorder::isRecording()) {
+    WindowEventRecorder::record(window, WindowEvent::Type::Closed);
+  }
+
+  pendingGeometryWindows_.erase(window);
   emit self()->windowRemoved(windows_[window]->window);
+  const WindowInfo* info = windows_[window].get();
+  auto it = std::lower_bound(windowList_.begin(), windowList_.end(), info,
+                             [](const WindowInfo* w1, const WindowInfo* w2) {
+    return w1->mapping_order < w2->mapping_order;
+  });
+  if (it != windowList_.end() && *it == info) {
+    windowList_.erase(it);
+  }
   windows_.erase(window);
+  std::erase_if(uuids_, [window](const auto& entry) { return entry.second == window; });
+  isStackingOrderValid_ = false;
 }
 
 /* static */ void KdeWindowManager::initial_state(
@@ -318,6 +394,10 @@ bool KdeWindowManager::showingDesktop_;
     return;
   }
 
+  if (WindowEventRecorder::isRecording()) {
+    WindowEventRecorder::record(window, WindowEvent::Type::Done);
+  }
+
   windows_[window]->initialized = true;
   if (!windows_[window]->skipTaskbar) {
     emit self()->windowAdded(windows_[window].get());
@@ -346,8 +426,42 @@ bool KdeWindowManager::showingDesktop_;
   windows_[window]->y = y;
   windows_[window]->width = width;
   windows_[window]->height = height;
-  if (windows_[window]->initialized) {
-    emit self()->windowGeometryChanged(windows_[window].get());
+  if (!windows_[window]->initialized) {
+    // The plasma protocol has no output events, so this is the closest equivalent.
+    WindowSystem::updateOutputsFromGeometry(windows_[window].get());
+    return;
+  }
+
+  // The latest geometry is emitted by the flush, so the end of a move is never lost.
+  if (!pendingGeometryWindows_.insert(window).second) {
+    RuntimeMetrics::add(RuntimeMetrics::Counter::EventsCoalesced);
+  }
+  if (geometryTimer_ == nullptr) {
+    geometryTimer_ = new QTimer(self());
+    geometryTimer_->setSingleShot(true);
+    geometryTimer_->setInterval(kGeometryCoalesceMs);
+    connect(geometryTimer_, &QTimer::timeout, self(), &KdeWindowManager::flushGeometryChanges);
+  }
+  if (!geometryTimer_->isActive()) {
+    geometryTimer_->start();
+  }
+}
+
+/* static */ void KdeWindowManager::flushGeometryChanges() {
+  const auto windows = std::move(pendingGeometryWindows_);
+  pendingGeometryWindows_.clear();
+  for (auto* window : windows) {
+    auto it = windows_.find(window);
+    if (it == windows_.end()) {
+      continue;
+    }
+
+    WindowInfo* info = it->second.get();
+    const bool outputsChanged = WindowSystem::updateOutputsFromGeometry(info);
+    emit self()->windowGeometryChanged(info);
+    if (outputsChanged) {
+      emit self()->windowOutputsChanged(info);
+    }
   }
 }
 
@@ -367,7 +481,14 @@ bool KdeWindowManager::showingDesktop_;
   if (windows_.count(window) == 0) {
     return;
   }
-  windows_[window]->desktop = id;
+  WindowInfo* info = windows_[window].get();
+  if (info->desktop == id) {
+    return;
+  }
+  info->desktop = id;
+  if (info->initialized) {
+    emit self()->windowDesktopChanged(info);
+  }
 }
 
 /* static */ void KdeWindowManager::virtual_desktop_left(
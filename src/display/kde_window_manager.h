@@ -19,8 +19,15 @@
 #ifndef KDE_WINDOW_MANAGER_H_
 #define KDE_WINDOW_MANAGER_H_
 
+#include <functional>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <QTimer>
 
 #include "plasma_window_management.h"
 #include "window_system.h"
@@ -37,7 +44,9 @@ class KdeWindowManager : public QObject {
   void windowAdded(const WindowInfo*);
   void windowRemoved(void*);
   void windowLeftCurrentDesktop(void*);
+  void windowDesktopChanged(const WindowInfo*);
   void windowGeometryChanged(const WindowInfo*);
+  void windowOutputsChanged(const WindowInfo*);
   void windowStateChanged(const WindowInfo*);
   void windowTitleChanged(const WindowInfo*);
   void activeWindowChanged(void*);
@@ -48,8 +57,11 @@ class KdeWindowManager : public QObject {
   static void init(struct org_kde_plasma_window_management* window_management);
 
   static void bindWindowManagerFunctions(WindowManager* windowManager);
+  // Forwards the signals to WindowSystem. Called by init().
+  static void connectSignals();
 
-  static std::vector<const WindowInfo*> windows();
+  static std::span<const WindowInfo* const> windows();
+  static std::span<void* const> stackingOrder();
   static void* activeWindow();
   // We manually reset active window, usually when the new active window is the dock itself.
   // We don't want to always do this (e.g. handle this in state_change() handler) because
@@ -63,6 +75,15 @@ class KdeWindowManager : public QObject {
   static void setShowingDesktop(bool show);
 
  private:
+  // Geometry changes of a window are coalesced to at most one signal per this interval,
+  // e.g. while it's being dragged.
+  static constexpr int kGeometryCoalesceMs = 16;
+
+  // Starts tracking a new window.
+  static void addWindow(struct org_kde_plasma_window* window, const char* uuid);
+
+  // Emits the coalesced geometry changes.
+  static void flushGeometryChanges();
 
   // org_kde_plasma_window_management interface.
 
@@ -210,10 +231,32 @@ class KdeWindowManager : public QObject {
   static org_kde_plasma_window_management* window_management_;
 
   static std::unordered_map<struct org_kde_plasma_window*, std::unique_ptr<WindowInfo>> windows_;
-  static std::unordered_map<std::string, struct org_kde_plasma_window*> uuids_;
-  static std::vector<std::string> stackingOrder_;
+  // The values of windows_ in mapping order, kept sorted as windows are added/removed.
+  static std::vector<const WindowInfo*> windowList_;
+  // Hashes UUIDs as string views, so that they can be looked up without copying them.
+  struct UuidHash {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view uuid) const {
+      return std::hash<std::string_view>{}(uuid);
+    }
+  };
+
+  static std::unordered_map<std::string, struct org_kde_plasma_window*, UuidHash,
+                            std::equal_to<>> uuids_;
+  // The ';'-separated UUIDs of the windows from bottom to top, as last sent. The stacking
+  // order changes on every focus change but is seldom needed, so it's only resolved into
+  // stackingOrder_ by stackingOrder().
+  static std::string stackingOrderUuids_;
+  static std::vector<void*> stackingOrder_;
+  static bool isStackingOrderValid_;
   static struct org_kde_plasma_window* activeWindow_;
   static bool showingDesktop_;
+  // Initialized windows whose geometry has changed since the last flush.
+  static std::unordered_set<struct org_kde_plasma_window*> pendingGeometryWindows_;
+  static QTimer* geometryTimer_;
+
+  friend class WindowEventReplayer;
 };
 
 }
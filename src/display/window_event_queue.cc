@@ -0,0 +1,151 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "window_event_queue.h"
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <iostream>
+
+#include <QCoreApplication>
+#include <QMetaObject>
+
+namespace crystaldock {
+
+wl_display* WindowEventQueue::display_ = nullptr;
+wl_event_queue* WindowEventQueue::queue_ = nullptr;
+wl_registry* WindowEventQueue::registry_ = nullptr;
+std::thread WindowEventQueue::thread_;
+int WindowEventQueue::wakeupFd_ = -1;
+std::atomic<bool> WindowEventQueue::stopped_ = false;
+std::mutex WindowEventQueue::mutex_;
+std::condition_variable WindowEventQueue::dispatched_;
+bool WindowEventQueue::dispatchPending_ = false;
+
+/* static */ void WindowEventQueue::init(wl_display* display, wl_registry* registry) {
+  display_ = display;
+  queue_ = wl_display_create_queue(display);
+  if (!queue_) {
+    std::cerr << "Failed to create Wayland event queue" << std::endl;
+    return;
+  }
+  // Objects created from the wrapper go on the queue right away, so that none of their
+  // events is dispatched on Qt's queue first.
+  registry_ = static_cast<wl_registry*>(wl_proxy_create_wrapper(registry));
+  wl_proxy_set_queue(reinterpret_cast<wl_proxy*>(registry_), queue_);
+}
+
+/* static */ void* WindowEventQueue::bind(wl_registry* registry, uint32_t name,
+                                          const wl_interface* interface, uint32_t version) {
+  return wl_registry_bind(registry_ ? registry_ : registry, name, interface, version);
+}
+
+/* static */ void WindowEventQueue::start() {
+  if (!queue_ || thread_.joinable()) {
+    return;
+  }
+
+  wakeupFd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (wakeupFd_ < 0) {
+    std::cerr << "Failed to create eventfd, dispatching window events on Qt's queue"
+              << std::endl;
+    return;
+  }
+  stopped_ = false;
+  thread_ = std::thread(read);
+  QObject::connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit,
+                   [] { stop(); });
+}
+
+/* static */ void WindowEventQueue::stop() {
+  if (!thread_.joinable()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  dispatched_.notify_all();
+  const uint64_t one = 1;
+  (void)!write(wakeupFd_, &one, sizeof(one));
+  thread_.join();
+  close(wakeupFd_);
+  wakeupFd_ = -1;
+}
+
+/* static */ void WindowEventQueue::flush() {
+  // wl_display_flush() is thread-safe, so this doesn't need to wait for the worker thread.
+  if (display_) {
+    wl_display_flush(display_);
+  }
+}
+
+/* static */ void WindowEventQueue::read() {
+  const int displayFd = wl_display_get_fd(display_);
+  while (!stopped_) {
+    // Fails if there are events on the queue already.
+    while (wl_display_prepare_read_queue(display_, queue_) != 0) {
+      dispatchAndWait();
+      if (stopped_) {
+        return;
+      }
+    }
+    wl_display_flush(display_);
+
+    pollfd fds[] = {{displayFd, POLLIN, 0}, {wakeupFd_, POLLIN, 0}};
+    if (poll(fds, 2, -1) < 0 && errno != EINTR) {
+      wl_display_cancel_read(display_);
+      std::cerr << "Failed to poll the Wayland display" << std::endl;
+      return;
+    }
+    if (fds[0].revents & POLLIN) {
+      // Cooperates with Qt's reader: events go to whichever queues they belong to.
+      wl_display_read_events(display_);
+    } else {
+      wl_display_cancel_read(display_);
+    }
+    if (fds[0].revents & (POLLERR | POLLHUP)) {
+      return;
+    }
+  }
+}
+
+/* static */ void WindowEventQueue::dispatchAndWait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (!dispatchPending_) {
+    dispatchPending_ = true;
+    QMetaObject::invokeMethod(QCoreApplication::instance(), &dispatch, Qt::QueuedConnection);
+  }
+  dispatched_.wait(lock, [] { return !dispatchPending_ || stopped_; });
+}
+
+/* static */ void WindowEventQueue::dispatch() {
+  wl_display_dispatch_queue_pending(display_, queue_);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    dispatchPending_ = false;
+  }
+  dispatched_.notify_all();
+}
+
+}  // namespace crystaldock
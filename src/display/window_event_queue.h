@@ -0,0 +1,83 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CRYSTALDOCK_WINDOW_EVENT_QUEUE_H_
+#define CRYSTALDOCK_WINDOW_EVENT_QUEUE_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <wayland-client.h>
+
+namespace crystaldock {
+
+// A Wayland event queue of its own for the window management protocols
+// (zwlr_foreign_toplevel_* and org_kde_plasma_window*), so that a storm of window
+// events doesn't hold up Qt's queue, which carries the pointer events.
+//
+// A worker thread reads the events into the queue, then has them dispatched on the GUI
+// thread in one batch, so that the window tables stay owned by the GUI thread. Any
+// events that arrive meanwhile go into the next batch.
+class WindowEventQueue {
+ public:
+  // Creates the queue. Must be called before the globals are bound to it.
+  static void init(wl_display* display, wl_registry* registry);
+
+  // Binds the global with the registry, with the new object on the queue.
+  static void* bind(wl_registry* registry, uint32_t name, const wl_interface* interface,
+                    uint32_t version);
+
+  // Starts reading events, once the listeners have been added.
+  static void start();
+
+  static void stop();
+
+  // Sends the requests made so far right away, e.g. after issuing a batch of them, rather
+  // than waiting for the next flush by Qt or by the worker thread.
+  static void flush();
+
+ private:
+  // Runs on the worker thread.
+  static void read();
+
+  // Runs on the GUI thread.
+  static void dispatch();
+
+  // Asks the GUI thread to dispatch the queue and waits until it has.
+  static void dispatchAndWait();
+
+  static wl_display* display_;
+  static wl_event_queue* queue_;
+  // The registry, as a proxy on the queue.
+  static wl_registry* registry_;
+  static std::thread thread_;
+  // Wakes the worker thread up for stopping.
+  static int wakeupFd_;
+  static std::atomic<bool> stopped_;
+
+  static std::mutex mutex_;
+  static std::condition_variable dispatched_;
+  static bool dispatchPending_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_WINDOW_EVENT_QUEUE_H_
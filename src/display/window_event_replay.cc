@@ -0,0 +1,99 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// Replays a window event trace against a dock on the offscreen platform and prints
+// the profile as JSON, e.g.
+//
+// window_event_replay --synthetic=150,30,2000,5 --speed=0
+// window_event_replay --kde --speed=1 session.trace
+//
+// Traces are recorded by running the dock with --record-window-events=<path>.
+
+#include <iostream>
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QStringList>
+#include <QTemporaryDir>
+
+#include "window_event_replayer.h"
+#include "window_event_trace.h"
+#include "window_system.h"
+#include <model/multi_dock_model.h>
+#include <utils/profiler.h>
+#include <view/dock_panel.h>
+
+using crystaldock::WindowEvent;
+using crystaldock::WindowEventTrace;
+
+int main(int argc, char** argv) {
+  if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+  }
+  QApplication app(argc, argv);
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Replays window events against a dock.");
+  parser.addHelpOption();
+  parser.addPositionalArgument("trace", "The trace file to replay.");
+  parser.addOption({"kde", "Use the KDE window manager instead of the wlroots one."});
+  parser.addOption({"speed", "Replay speed, or 0 for as fast as possible.", "speed", "0"});
+  parser.addOption({"synthetic", "Replay a synthetic trace instead of a file.",
+                    "windows,apps,titleChanges,intervalMs"});
+  parser.addOption({"save", "Save the replayed trace to the file.", "path"});
+  parser.process(app);
+
+  std::vector<WindowEvent> events;
+  if (parser.isSet("synthetic")) {
+    const QStringList params = parser.value("synthetic").split(',');
+    if (params.size() != 4) {
+      std::cerr << "--synthetic needs windows,apps,titleChanges,intervalMs" << std::endl;
+      return 1;
+    }
+    events = WindowEventTrace::synthetic(params[0].toInt(), params[1].toInt(),
+                                         params[2].toInt(), params[3].toInt());
+  } else if (parser.positionalArguments().size() == 1) {
+    if (!WindowEventTrace::load(parser.positionalArguments()[0], &events)) {
+      return 1;
+    }
+  } else {
+    parser.showHelp(1);
+  }
+  if (parser.isSet("save") && !WindowEventTrace::save(parser.value("save"), events)) {
+    return 1;
+  }
+
+  const bool kde = parser.isSet("kde");
+  crystaldock::WindowSystem::initHeadless(kde);
+  crystaldock::Profiler::enable(/*dumpPath=*/QString());
+
+  QTemporaryDir configDir;
+  crystaldock::MultiDockModel model(
+      crystaldock::SessionContext::fromEnvironment(configDir.path()));
+  model.addDock(crystaldock::PanelPosition::Bottom, 0, /*showApplicationMenu=*/false,
+                /*showPager=*/false, /*showTaskManager=*/true, /*showClock=*/false);
+  crystaldock::DockPanel dock(nullptr, &model, /*dockId=*/1);
+  dock.show();
+
+  crystaldock::WindowEventReplayer replayer(kde, {&dock});
+  replayer.replay(events, parser.value("speed").toDouble());
+
+  std::cout << crystaldock::Profiler::toJson().toStdString();
+  return 0;
+}
@@ -0,0 +1,158 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "window_event_replayer.h"
+
+#include <string>
+
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QTimer>
+
+#include "kde_window_manager.h"
+#include "wlr_window_manager.h"
+#include <utils/profiler.h>
+
+namespace crystaldock {
+
+WindowEventReplayer::WindowEventReplayer(bool kdeWindowManager,
+                                         const std::vector<QWidget*>& docks)
+    : kdeWindowManager_(kdeWindowManager) {
+  for (auto* dock : docks) {
+    dock->installEventFilter(this);
+  }
+}
+
+void WindowEventReplayer::replay(const std::vector<WindowEvent>& events, double speed) {
+  clock_.start();
+  for (const auto& event : events) {
+    if (speed > 0) {
+      const int64_t delayMs = static_cast<int64_t>(event.timeMs / speed) - clock_.elapsed();
+      if (delayMs > 0) {
+        runEventLoop(delayMs);
+      }
+    }
+    dispatch(event);
+    if (speed <= 0) {
+      QCoreApplication::processEvents();
+    }
+  }
+  runEventLoop(kDrainMs);
+}
+
+bool WindowEventReplayer::eventFilter(QObject* watched, QEvent* e) {
+  if (e->type() == QEvent::Paint) {
+    const int64_t now = clock_.nsecsElapsed();
+    for (const auto time : unpaintedEventsNs_) {
+      Profiler::record("WindowEventReplayer/event-to-paint", now - time);
+    }
+    unpaintedEventsNs_.clear();
+  }
+  return QObject::eventFilter(watched, e);
+}
+
+void WindowEventReplayer::dispatch(const WindowEvent& event) {
+  {
+    PROFILE_SCOPE("WindowEventReplayer/dispatch");
+    if (kdeWindowManager_) {
+      dispatchKde(event, handle(event.window));
+    } else {
+      dispatchWlr(event, handle(event.window));
+    }
+  }
+
+  // The docks only hear about new windows once they are done.
+  if (event.type != WindowEvent::Type::Toplevel && event.type != WindowEvent::Type::AppId) {
+    unpaintedEventsNs_.push_back(clock_.nsecsElapsed());
+  }
+}
+
+void WindowEventReplayer::dispatchKde(const WindowEvent& event, void* windowHandle) {
+  auto* window = static_cast<struct org_kde_plasma_window*>(windowHandle);
+  switch (event.type) {
+    case WindowEvent::Type::Toplevel:
+      KdeWindowManager::addWindow(window,
+                                  ("replay-" + std::to_string(event.window)).c_str());
+      break;
+    case WindowEvent::Type::Title:
+      KdeWindowManager::title_changed(nullptr, window, event.text.c_str());
+      break;
+    case WindowEvent::Type::AppId:
+      // The dock's own windows would be sent requests.
+      if (event.text != "crystal-dock") {
+        KdeWindowManager::app_id_changed(nullptr, window, event.text.c_str());
+      }
+      break;
+    case WindowEvent::Type::State:
+      KdeWindowManager::state_changed(nullptr, window,
+                                      WindowEventTrace::toKdeState(event.state));
+      break;
+    case WindowEvent::Type::Done:
+      KdeWindowManager::initial_state(nullptr, window);
+      break;
+    case WindowEvent::Type::Closed:
+      KdeWindowManager::unmapped(nullptr, window);
+      break;
+  }
+}
+
+void WindowEventReplayer::dispatchWlr(const WindowEvent& event, void* windowHandle) {
+  auto* window = static_cast<struct zwlr_foreign_toplevel_handle_v1*>(windowHandle);
+  switch (event.type) {
+    case WindowEvent::Type::Toplevel:
+      WlrWindowManager::addWindow(window);
+      break;
+    case WindowEvent::Type::Title:
+      WlrWindowManager::title(nullptr, window, event.text.c_str());
+      break;
+    case WindowEvent::Type::AppId:
+      WlrWindowManager::app_id(nullptr, window, event.text.c_str());
+      break;
+    case WindowEvent::Type::State: {
+      wl_array states;
+      wl_array_init(&states);
+      WindowEventTrace::toWlrState(event.state, &states);
+      WlrWindowManager::state(nullptr, window, &states);
+      wl_array_release(&states);
+      break;
+    }
+    case WindowEvent::Type::Done:
+      WlrWindowManager::done(nullptr, window);
+      break;
+    case WindowEvent::Type::Closed:
+      WlrWindowManager::closed(nullptr, window);
+      break;
+  }
+}
+
+/* static */ void WindowEventReplayer::runEventLoop(int ms) {
+  QEventLoop loop;
+  QTimer::singleShot(ms, Qt::PreciseTimer, &loop, &QEventLoop::quit);
+  loop.exec();
+}
+
+void* WindowEventReplayer::handle(int window) {
+  auto& handle = handles_[window];
+  if (!handle) {
+    handle = std::make_unique<char>();
+  }
+  return handle.get();
+}
+
+}  // namespace crystaldock
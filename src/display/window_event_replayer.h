@@ -0,0 +1,81 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CRYSTALDOCK_WINDOW_EVENT_REPLAYER_H_
+#define CRYSTALDOCK_WINDOW_EVENT_REPLAYER_H_
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QObject>
+#include <QWidget>
+
+#include "window_event_trace.h"
+
+namespace crystaldock {
+
+// Feeds a window event trace to the listener callbacks of the KDE or wlroots window
+// manager, as if the events came from the compositor. The window system must have
+// been set up with WindowSystem::initHeadless() for the same window manager.
+//
+// With the profiler enabled, records the time from each event to the next paint of
+// the docks ("WindowEventReplayer/event-to-paint") and the time spent handling each
+// event, including the docks' slots ("WindowEventReplayer/dispatch").
+class WindowEventReplayer : public QObject {
+  Q_OBJECT
+
+ public:
+  WindowEventReplayer(bool kdeWindowManager, const std::vector<QWidget*>& docks);
+
+  // Replays the events at their recorded times divided by speed, e.g. 2 for twice
+  // as fast, or as fast as possible if speed is 0. Runs the event loop meanwhile.
+  void replay(const std::vector<WindowEvent>& events, double speed);
+
+ protected:
+  bool eventFilter(QObject* watched, QEvent* e) override;
+
+ private:
+  // How long to keep running the event loop after the last event, for the docks to
+  // repaint.
+  static constexpr int kDrainMs = 200;
+
+  void dispatch(const WindowEvent& event);
+  void dispatchKde(const WindowEvent& event, void* windowHandle);
+  void dispatchWlr(const WindowEvent& event, void* windowHandle);
+
+  // Runs the event loop for the duration.
+  static void runEventLoop(int ms);
+
+  // A unique fake protocol handle for the window, never dereferenced.
+  void* handle(int window);
+
+  bool kdeWindowManager_;
+  std::unordered_map<int, std::unique_ptr<char>> handles_;
+  QElapsedTimer clock_;
+  // Dispatch times of the events that the docks haven't repainted for yet.
+  std::vector<int64_t> unpaintedEventsNs_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_WINDOW_EVENT_REPLAYER_H_
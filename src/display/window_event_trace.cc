@@ -0,0 +1,263 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "window_event_trace.h"
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+
+#include <QByteArray>
+#include <QStringList>
+#include <QTextStream>
+
+#include "plasma_window_management.h"
+#include "wlr_foreign_toplevel_management.h"
+
+namespace crystaldock {
+
+namespace {
+
+constexpr const char* kTypeNames[] = {"toplevel", "title", "app_id", "state", "done", "closed"};
+
+struct StateBit {
+  uint32_t bit;
+  uint32_t protocolValue;
+};
+
+constexpr StateBit kKdeStates[] = {
+    {WindowEvent::kActivated, ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_ACTIVE},
+    {WindowEvent::kMinimized, ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_MINIMIZED},
+    {WindowEvent::kMaximized, ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_MAXIMIZED},
+    {WindowEvent::kFullscreen, ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_FULLSCREEN},
+    {WindowEvent::kDemandsAttention, ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_DEMANDS_ATTENTION},
+    {WindowEvent::kSkipTaskbar, ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_SKIPTASKBAR},
+    {WindowEvent::kOnAllDesktops, ORG_KDE_PLASMA_WINDOW_MANAGEMENT_STATE_ON_ALL_DESKTOPS},
+};
+
+// wlroots has no attention, taskbar or desktop states.
+constexpr StateBit kWlrStates[] = {
+    {WindowEvent::kActivated, ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_ACTIVATED},
+    {WindowEvent::kMinimized, ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_MINIMIZED},
+    {WindowEvent::kMaximized, ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_MAXIMIZED},
+    {WindowEvent::kFullscreen, ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_FULLSCREEN},
+};
+
+}  // namespace
+
+/* static */ bool WindowEventTrace::load(const QString& path,
+                                         std::vector<WindowEvent>* events) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    std::cerr << "Failed to open window event trace " << path.toStdString() << std::endl;
+    return false;
+  }
+
+  events->clear();
+  int lineNumber = 0;
+  QTextStream in(&file);
+  while (!in.atEnd()) {
+    const QString line = in.readLine();
+    ++lineNumber;
+    if (line.isEmpty() || line.startsWith('#')) {
+      continue;
+    }
+    WindowEvent event;
+    if (!fromLine(line, &event)) {
+      std::cerr << path.toStdString() << ":" << lineNumber << ": invalid event" << std::endl;
+      return false;
+    }
+    events->push_back(std::move(event));
+  }
+  return true;
+}
+
+/* static */ bool WindowEventTrace::save(const QString& path,
+                                         const std::vector<WindowEvent>& events) {
+  QFile file(path);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+    std::cerr << "Failed to write window event trace " << path.toStdString() << std::endl;
+    return false;
+  }
+
+  QTextStream out(&file);
+  for (const auto& event : events) {
+    out << toLine(event) << "\n";
+  }
+  return true;
+}
+
+/* static */ std::vector<WindowEvent> WindowEventTrace::synthetic(
+    int numWindows, int numApps, int numTitleChanges, int intervalMs) {
+  std::vector<WindowEvent> events;
+  int64_t time = 0;
+  for (int i = 0; i < numWindows; ++i) {
+    const std::string appId = "app-" + std::to_string(i % std::max(numApps, 1));
+    events.push_back({time, WindowEvent::Type::Toplevel, i});
+    events.push_back({time, WindowEvent::Type::AppId, i, appId});
+    events.push_back({time, WindowEvent::Type::Title, i, appId + " - window " + std::to_string(i)});
+    events.push_back({time, WindowEvent::Type::State, i, {}, WindowEvent::kActivated});
+    events.push_back({time, WindowEvent::Type::Done, i});
+    time += intervalMs;
+  }
+  for (int i = 0; i < numTitleChanges && numWindows > 0; ++i) {
+    const int window = i % numWindows;
+    events.push_back({time, WindowEvent::Type::Title, window,
+                      "Title change " + std::to_string(i)});
+    events.push_back({time, WindowEvent::Type::Done, window});
+    time += intervalMs;
+  }
+  for (int i = 0; i < numWindows; ++i) {
+    events.push_back({time, WindowEvent::Type::Closed, i});
+    time += intervalMs;
+  }
+  return events;
+}
+
+/* static */ uint32_t WindowEventTrace::fromKdeState(uint32_t flags) {
+  uint32_t state = 0;
+  for (const auto& s : kKdeStates) {
+    if (flags & s.protocolValue) {
+      state |= s.bit;
+    }
+  }
+  return state;
+}
+
+/* static */ uint32_t WindowEventTrace::toKdeState(uint32_t state) {
+  uint32_t flags = 0;
+  for (const auto& s : kKdeStates) {
+    if (state & s.bit) {
+      flags |= s.protocolValue;
+    }
+  }
+  return flags;
+}
+
+/* static */ uint32_t WindowEventTrace::fromWlrState(wl_array* states) {
+  uint32_t state = 0;
+  void* entry;
+  wl_array_for_each(entry, states) {
+    for (const auto& s : kWlrStates) {
+      if (*static_cast<uint32_t*>(entry) == s.protocolValue) {
+        state |= s.bit;
+      }
+    }
+  }
+  return state;
+}
+
+/* static */ void WindowEventTrace::toWlrState(uint32_t state, wl_array* states) {
+  for (const auto& s : kWlrStates) {
+    if (state & s.bit) {
+      *static_cast<uint32_t*>(wl_array_add(states, sizeof(uint32_t))) = s.protocolValue;
+    }
+  }
+}
+
+/* static */ QString WindowEventTrace::toLine(const WindowEvent& event) {
+  QString payload;
+  switch (event.type) {
+    case WindowEvent::Type::Title:
+    case WindowEvent::Type::AppId:
+      payload = QString::fromLatin1(
+          QByteArray::fromStdString(event.text).toPercentEncoding());
+      break;
+    case WindowEvent::Type::State:
+      payload = QString::number(event.state);
+      break;
+    default:
+      break;
+  }
+  return QString("%1 %2 %3 %4").arg(event.timeMs).arg(kTypeNames[static_cast<int>(event.type)])
+      .arg(event.window).arg(payload).trimmed();
+}
+
+/* static */ bool WindowEventTrace::fromLine(const QString& line, WindowEvent* event) {
+  const QStringList fields = line.split(' ');
+  if (fields.size() < 3) {
+    return false;
+  }
+
+  bool ok = false;
+  event->timeMs = fields[0].toLongLong(&ok);
+  if (!ok) {
+    return false;
+  }
+  const auto type = std::find(std::begin(kTypeNames), std::end(kTypeNames), fields[1]);
+  if (type == std::end(kTypeNames)) {
+    return false;
+  }
+  event->type = static_cast<WindowEvent::Type>(type - std::begin(kTypeNames));
+  event->window = fields[2].toInt(&ok);
+  if (!ok) {
+    return false;
+  }
+
+  const QString payload = fields.size() > 3 ? fields[3] : QString();
+  event->text.clear();
+  event->state = 0;
+  switch (event->type) {
+    case WindowEvent::Type::Title:
+    case WindowEvent::Type::AppId:
+      event->text = QByteArray::fromPercentEncoding(payload.toLatin1()).toStdString();
+      break;
+    case WindowEvent::Type::State:
+      event->state = payload.toUInt(&ok);
+      return ok;
+    default:
+      break;
+  }
+  return true;
+}
+
+QFile* WindowEventRecorder::file_;
+QElapsedTimer WindowEventRecorder::clock_;
+std::unordered_map<const void*, int> WindowEventRecorder::windowIds_;
+int WindowEventRecorder::nextWindowId_;
+
+/* static */ bool WindowEventRecorder::start(const QString& path) {
+  auto file = std::make_unique<QFile>(path);
+  if (!file->open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+    std::cerr << "Failed to write window event trace " << path.toStdString() << std::endl;
+    return false;
+  }
+  // Lives for the rest of the process, so that events are recorded until exit.
+  file_ = file.release();
+  clock_.start();
+  return true;
+}
+
+/* static */ void WindowEventRecorder::record(const void* handle, WindowEvent::Type type,
+                                              const std::string& text, uint32_t state) {
+  auto it = windowIds_.find(handle);
+  if (it == windowIds_.end()) {
+    it = windowIds_.emplace(handle, nextWindowId_++).first;
+  }
+  const WindowEvent event{clock_.elapsed(), type, it->second, text, state};
+  file_->write((WindowEventTrace::toLine(event) + "\n").toUtf8());
+  // The dock might not exit cleanly, e.g. when its session ends.
+  file_->flush();
+  if (type == WindowEvent::Type::Closed) {
+    // Handles may be reused by new windows.
+    windowIds_.erase(it);
+  }
+}
+
+}  // namespace crystaldock
@@ -0,0 +1,105 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CRYSTALDOCK_WINDOW_EVENT_TRACE_H_
+#define CRYSTALDOCK_WINDOW_EVENT_TRACE_H_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QString>
+
+#include <wayland-client.h>
+
+namespace crystaldock {
+
+// A toplevel event from the window manager, independent of the protocol, so that
+// a trace recorded on KDE can be replayed against wlroots and vice versa.
+struct WindowEvent {
+  enum class Type { Toplevel, Title, AppId, State, Done, Closed };
+
+  // Bits of state.
+  static constexpr uint32_t kActivated = 1 << 0;
+  static constexpr uint32_t kMinimized = 1 << 1;
+  static constexpr uint32_t kMaximized = 1 << 2;
+  static constexpr uint32_t kFullscreen = 1 << 3;
+  static constexpr uint32_t kDemandsAttention = 1 << 4;
+  static constexpr uint32_t kSkipTaskbar = 1 << 5;
+  static constexpr uint32_t kOnAllDesktops = 1 << 6;
+
+  // Since the start of the trace.
+  int64_t timeMs;
+  Type type;
+  // Identifies the window within the trace.
+  int window;
+  // The title or the app id.
+  std::string text;
+  uint32_t state = 0;
+};
+
+// Trace files have one event per line: "<timeMs> <type> <window> <payload>",
+// with the text payload percent-encoded.
+class WindowEventTrace {
+ public:
+  static bool load(const QString& path, std::vector<WindowEvent>* events);
+
+  static bool save(const QString& path, const std::vector<WindowEvent>& events);
+
+  // numWindows windows of numApps applications are opened every intervalMs, then
+  // there are numTitleChanges title changes, round-robin, then they are all closed.
+  static std::vector<WindowEvent> synthetic(int numWindows, int numApps,
+                                            int numTitleChanges, int intervalMs);
+
+  // Conversions from/to the protocols' states.
+  static uint32_t fromKdeState(uint32_t flags);
+  static uint32_t toKdeState(uint32_t state);
+  static uint32_t fromWlrState(wl_array* states);
+  // The array must have been initialized.
+  static void toWlrState(uint32_t state, wl_array* states);
+
+  static QString toLine(const WindowEvent& event);
+  static bool fromLine(const QString& line, WindowEvent* event);
+};
+
+// Records the events of the running window manager to a trace file, when started
+// with --record-window-events=<path>.
+class WindowEventRecorder {
+ public:
+  static bool start(const QString& path);
+
+  static bool isRecording() { return file_ != nullptr; }
+
+  // Identifies windows by their protocol handles.
+  static void record(const void* handle, WindowEvent::Type type, const std::string& text = {},
+                     uint32_t state = 0);
+
+ private:
+  static QFile* file_;
+  static QElapsedTimer clock_;
+  static std::unordered_map<const void*, int> windowIds_;
+  static int nextWindowId_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_WINDOW_EVENT_TRACE_H_
@@ -3,9 +3,16 @@
 #include <algorithm>
 #include <iostream>
 #include <string>
+#include <utility>
 
-#include <QDBusReply>
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
 #include <QGuiApplication>
+#include <QRect>
+
+#include <qpa/qplatformwindow_p.h>
 
 #include <LayerShellQt/Shell>
 #include <LayerShellQt/Window>
@@ -13,12 +20,19 @@
 #include "kde_auto_hide_manager.h"
 #include "kde_virtual_desktop_manager.h"
 #include "kde_window_manager.h"
+#include "window_event_queue.h"
 #include "wlr_window_manager.h"
+#include <utils/runtime_metrics.h>
+#include <utils/startup_trace.h>
 
 namespace crystaldock {
 
 namespace {
 
+constexpr char kActivityManagerService[] = "org.kde.ActivityManager";
+constexpr char kActivityManagerPath[] = "/ActivityManager/Activities";
+constexpr char kActivityManagerInterface[] = "org.kde.ActivityManager.Activities";
+
 LayerShellQt::Window* getLayerShellWin(QWidget* widget) {
   QWindow* win = WindowSystem::getWindow(widget);
   if (win == nullptr) {
@@ -37,12 +51,16 @@ kde_screen_edge_manager_v1* WindowSystem::kde_screen_edge_manager_;
 
 zwlr_foreign_toplevel_manager_v1* WindowSystem::wlr_window_manager_;
 
+xdg_activation_v1* WindowSystem::xdg_activation_;
+
 VirtualDesktopManager WindowSystem::virtualDesktopManager_;
 WindowManager WindowSystem::windowManager_;
 AutoHideManager WindowSystem::autoHideManager_;
 
 std::vector<QScreen*> WindowSystem::screens_;
-std::unique_ptr<QDBusInterface> WindowSystem::activityManager_;
+uint64_t WindowSystem::screensVersion_ = 0;
+std::unique_ptr<QDBusServiceWatcher> WindowSystem::activityManagerWatcher_;
+bool WindowSystem::hasActivityManager_ = false;
 
 /* static */ WindowSystem* WindowSystem::self() {
   static WindowSystem self;
@@ -50,11 +68,16 @@ std::unique_ptr<QDBusInterface> WindowSystem::activityManager_;
 }
 
 /* static */ bool WindowSystem::init(struct wl_display* display) {
+  StartupPhase phase("WindowSystem::init");
   struct wl_registry *registry = wl_display_get_registry(display);
   wl_registry_add_listener(registry, &registry_listener_, NULL);
+  WindowEventQueue::init(display, registry);
 
-  // wait for the "initial" set of globals to appear
-  wl_display_roundtrip(display);
+  {
+    StartupPhase roundtripPhase("wl_display_roundtrip");
+    // wait for the "initial" set of globals to appear
+    wl_display_roundtrip(display);
+  }
 
   if (!kde_window_management_ && !wlr_window_manager_) {
     std::cerr << "Failed to bind required Wayland interfaces" << std::endl;
@@ -73,6 +96,8 @@ std::unique_ptr<QDBusInterface> WindowSystem::activityManager_;
     WlrWindowManager::init(wlr_window_manager_);
     WlrWindowManager::bindWindowManagerFunctions(&windowManager_);
   }
+  initMetrics();
+  WindowEventQueue::start();
 
   if (kde_screen_edge_manager_) {
     KdeAutoHideManager::init(kde_screen_edge_manager_);
@@ -81,23 +106,24 @@ std::unique_ptr<QDBusInterface> WindowSystem::activityManager_;
 
   LayerShellQt::Shell::useLayerShell();
 
-  activityManager_ = std::make_unique<QDBusInterface>(
-      "org.kde.ActivityManager", "/ActivityManager/Activities",
-      "org.kde.ActivityManager.Activities");
-  if (activityManager_->isValid()) {
-    const QDBusReply<QString> reply = activityManager_->call("CurrentActivity");
-    if (reply.isValid()) {
-      WindowSystem::self()->setCurrentActivity(reply.value().toStdString());
-    }
-    connect(activityManager_.get(), SIGNAL(CurrentActivityChanged(QString)),
-            WindowSystem::self(), SLOT(onCurrentActivityChanged(QString)));
-  }
+  initActivityManager();
 
   initScreens();
 
   return true;
 }
 
+/* static */ void WindowSystem::initHeadless(bool kdeWindowManager) {
+  if (kdeWindowManager) {
+    KdeWindowManager::connectSignals();
+    KdeWindowManager::bindWindowManagerFunctions(&windowManager_);
+  } else {
+    WlrWindowManager::connectSignals();
+    WlrWindowManager::bindWindowManagerFunctions(&windowManager_);
+  }
+  initScreens();
+}
+
 /* static */ bool WindowSystem::hasVirtualDesktopManager() {
   return kde_virtual_desktop_management_ != nullptr;
 }
@@ -106,8 +132,57 @@ std::unique_ptr<QDBusInterface> WindowSystem::activityManager_;
   return kde_screen_edge_manager_ != nullptr;
 }
 
-/* static */ bool WindowSystem::hasActivityManager() {
-  return activityManager_->isValid();
+/* static */ void WindowSystem::initMetrics() {
+  using Counter = RuntimeMetrics::Counter;
+  connect(self(), &WindowSystem::windowAdded, [] { RuntimeMetrics::add(Counter::WindowAdded); });
+  connect(self(), &WindowSystem::windowRemoved,
+          [] { RuntimeMetrics::add(Counter::WindowRemoved); });
+  connect(self(), &WindowSystem::windowStateChanged,
+          [] { RuntimeMetrics::add(Counter::WindowStateChanged); });
+  connect(self(), &WindowSystem::windowTitleChanged,
+          [] { RuntimeMetrics::add(Counter::WindowTitleChanged); });
+  connect(self(), &WindowSystem::windowGeometryChanged,
+          [] { RuntimeMetrics::add(Counter::WindowGeometryChanged); });
+  connect(self(), &WindowSystem::windowOutputsChanged,
+          [] { RuntimeMetrics::add(Counter::WindowOutputsChanged); });
+  connect(self(), &WindowSystem::activeWindowChanged,
+          [] { RuntimeMetrics::add(Counter::ActiveWindowChanged); });
+}
+
+/* static */ void WindowSystem::initActivityManager() {
+  QDBusConnection bus = QDBusConnection::sessionBus();
+  bus.connect(kActivityManagerService, kActivityManagerPath, kActivityManagerInterface,
+              "CurrentActivityChanged", self(), SLOT(onCurrentActivityChanged(QString)));
+
+  // The activity manager may start after the dock, or restart.
+  activityManagerWatcher_ = std::make_unique<QDBusServiceWatcher>(
+      kActivityManagerService, bus, QDBusServiceWatcher::WatchForOwnerChange);
+  connect(activityManagerWatcher_.get(), &QDBusServiceWatcher::serviceRegistered, self(),
+          [] { queryCurrentActivity(); });
+  connect(activityManagerWatcher_.get(), &QDBusServiceWatcher::serviceUnregistered, self(),
+          [] {
+            hasActivityManager_ = false;
+            self()->onCurrentActivityChanged(QString());
+          });
+  queryCurrentActivity();
+}
+
+/* static */ void WindowSystem::queryCurrentActivity() {
+  QDBusMessage message = QDBusMessage::createMethodCall(
+      kActivityManagerService, kActivityManagerPath, kActivityManagerInterface,
+      "CurrentActivity");
+  // Not worth starting the service for, e.g. on non-KDE sessions.
+  message.setAutoStartService(false);
+  auto* watcher = new QDBusPendingCallWatcher(
+      QDBusConnection::sessionBus().asyncCall(message), self());
+  connect(watcher, &QDBusPendingCallWatcher::finished, self(), [](QDBusPendingCallWatcher* call) {
+    call->deleteLater();
+    const QDBusPendingReply<QString> reply = *call;
+    if (reply.isValid()) {
+      hasActivityManager_ = true;
+      self()->onCurrentActivityChanged(reply.value());
+    }
+  });
 }
 
 /* static */ void WindowSystem::setAnchorAndStrut(
@@ -128,17 +203,44 @@ std::unique_ptr<QDBusInterface> WindowSystem::activityManager_;
 }
 
 void WindowSystem::initScreens() {
-  screens_.clear();
-  for (auto* screen : QGuiApplication::screens()) {
-    screens_.push_back(screen);
+  const auto screens = QGuiApplication::screens();
+  screens_.assign(screens.begin(), screens.end());
+  sortScreens();
+  static bool connected = false;
+  if (!connected) {
+    connected = true;
+    connect(qApp, &QGuiApplication::screenAdded, self(), &WindowSystem::onScreenAdded);
+    connect(qApp, &QGuiApplication::screenRemoved, self(), &WindowSystem::onScreenRemoved);
   }
+}
+
+/* static */ void WindowSystem::sortScreens() {
   std::sort(screens_.begin(), screens_.end(), [](QScreen* s1, QScreen* s2) {
     return s1->geometry().center().manhattanLength() < s2->geometry().center().manhattanLength();
   });
+  ++screensVersion_;
 }
 
-/*static*/ std::vector<QScreen*> WindowSystem::screens() {
-  return screens_;
+/* static */ void WindowSystem::onScreenAdded(QScreen* screen) {
+  screens_.push_back(screen);
+  sortScreens();
+  emit self()->screenAdded(screen->name());
+}
+
+/* static */ void WindowSystem::onScreenRemoved(QScreen* screen) {
+  // Emitted before the screen is destroyed.
+  std::erase(screens_, screen);
+  ++screensVersion_;
+  emit self()->screenRemoved(screen->name());
+}
+
+/* static */ int WindowSystem::screenIndex(const QString& name) {
+  for (int i = 0; i < static_cast<int>(screens_.size()); ++i) {
+    if (screens_[i]->name() == name) {
+      return i;
+    }
+  }
+  return -1;
 }
 
 /*static*/ void WindowSystem::setScreen(QWidget* widget, int screen) {
@@ -165,6 +267,78 @@ void WindowSystem::initScreens() {
   return nullptr;
 }
 
+/*static*/ bool WindowSystem::updateOutputsFromGeometry(WindowInfo* info) {
+  const QRect geometry(info->x, info->y, info->width, info->height);
+  if (!geometry.isValid()) {
+    return false;
+  }
+
+  decltype(info->outputs) outputs;
+  for (int i = 0; i < static_cast<int>(screens_.size()); ++i) {
+    if (screens_[i]->geometry().intersects(geometry)) {
+      if (auto* output = getWlOutputForScreen(i)) {
+        outputs.insert(output);
+      }
+    }
+  }
+
+  if (outputs == info->outputs) {
+    return false;
+  }
+  info->outputs = std::move(outputs);
+  return true;
+}
+
+/* static */ void WindowSystem::requestActivationToken(
+    const QString& appId, QWidget* widget, ActivationTokenCallback callback) {
+  if (!hasActivation()) {
+    callback(QString());
+    return;
+  }
+
+  auto* token = xdg_activation_v1_get_activation_token(xdg_activation_);
+  if (!token) {
+    callback(QString());
+    return;
+  }
+
+  if (!appId.isEmpty()) {
+    xdg_activation_token_v1_set_app_id(token, appId.toUtf8().constData());
+  }
+
+  auto* app = dynamic_cast<QGuiApplication*>(QGuiApplication::instance());
+  auto* waylandApp = app ? app->nativeInterface<QNativeInterface::QWaylandApplication>()
+                         : nullptr;
+  if (waylandApp && waylandApp->lastInputSeat()) {
+    xdg_activation_token_v1_set_serial(
+        token, waylandApp->lastInputSerial(), waylandApp->lastInputSeat());
+  }
+
+  if (widget) {
+    QWindow* window = getWindow(widget);
+    auto* waylandWindow = window
+        ? window->nativeInterface<QNativeInterface::Private::QWaylandWindow>() : nullptr;
+    if (waylandWindow && waylandWindow->surface()) {
+      xdg_activation_token_v1_set_surface(token, waylandWindow->surface());
+    }
+  }
+
+  // Owned by the token until done() is received.
+  auto* data = new ActivationTokenCallback(std::move(callback));
+  xdg_activation_token_v1_add_listener(token, &activation_token_listener_, data);
+  xdg_activation_token_v1_commit(token);
+}
+
+// xdg_activation_token_v1 interface.
+
+/* static */ void WindowSystem::activation_token_done(
+    void* data, struct xdg_activation_token_v1* token, const char* tokenString) {
+  auto* callback = static_cast<ActivationTokenCallback*>(data);
+  (*callback)(QString::fromUtf8(tokenString));
+  delete callback;
+  xdg_activation_token_v1_destroy(token);
+}
+
 // wl_registry interface.
 
 /* static */ void WindowSystem::registry_global(
@@ -183,7 +357,7 @@ void WindowSystem::initScreens() {
     }
   } else if (std::string(interface) == "org_kde_plasma_window_management") {
     kde_window_management_ =
-        reinterpret_cast<org_kde_plasma_window_management*>(wl_registry_bind(
+        reinterpret_cast<org_kde_plasma_window_management*>(WindowEventQueue::bind(
             registry, name, &org_kde_plasma_window_management_interface, 16));
     if (!kde_window_management_) {
       std::cerr << "Failed to bind org_kde_plasma_window_management Wayland interface. "
@@ -199,12 +373,19 @@ void WindowSystem::initScreens() {
     }
   } else if (std::string(interface) == "zwlr_foreign_toplevel_manager_v1") {
     wlr_window_manager_ =
-        reinterpret_cast<zwlr_foreign_toplevel_manager_v1*>(wl_registry_bind(
+        reinterpret_cast<zwlr_foreign_toplevel_manager_v1*>(WindowEventQueue::bind(
             registry, name, &zwlr_foreign_toplevel_manager_v1_interface, 3));
     if (!wlr_window_manager_) {
       std::cerr << "Failed to bind zwlr_foreign_toplevel_manager_v1 Wayland interface"
                 << std::endl;
     }
+  } else if (std::string(interface) == "xdg_activation_v1") {
+    xdg_activation_ =
+        reinterpret_cast<xdg_activation_v1*>(wl_registry_bind(
+            registry, name, &xdg_activation_v1_interface, 1));
+    if (!xdg_activation_) {
+      std::cerr << "Failed to bind xdg_activation_v1 Wayland interface" << std::endl;
+    }
   }
 }
 
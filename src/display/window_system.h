@@ -19,7 +19,9 @@
 #ifndef CRYSTALDOCK_WINDOW_SYSTEM_H_
 #define CRYSTALDOCK_WINDOW_SYSTEM_H_
 
+#include <functional>
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -27,7 +29,7 @@
 
 #include <wayland-client.h>
 
-#include <QDBusInterface>
+#include <QDBusServiceWatcher>
 #include <QObject>
 #include <QPixmap>
 #include <QRect>
@@ -40,6 +42,10 @@
 #include "plasma_virtual_desktop.h"
 #include "plasma_window_management.h"
 #include "wlr_foreign_toplevel_management.h"
+#include "xdg_activation.h"
+
+#include <utils/atom_table.h>
+#include <utils/small_set.h>
 
 #include <LayerShellQt/Window>
 
@@ -53,39 +59,52 @@ struct VirtualDesktopInfo {
   void* virtual_desktop;
 };
 
+// Kept compact, since there is one per window: the state flags are packed, the outputs
+// (nearly always one or two) are stored inline, and the title is stored once, for display.
+// The items refer to windows by handle and read the title from here.
 struct WindowInfo {
   // Pointer to an implementation-specific windows struct.
   void* window;
-  std::string appId;
-  std::string title;
-  std::string icon;
-  std::string desktop;
-  std::string activity;
-  bool initialized;
-  bool skipTaskbar;
-  bool onAllDesktops;
-  bool demandsAttention;
-  bool minimized;
-  bool maximized;
-  bool fullscreen;
-  bool restoreAfterShowDesktop;
+  // Interned appId, for matching windows to programs.
+  AtomTable::Atom appIdAtom = AtomTable::kEmpty;
+  uint32_t mapping_order;
   int32_t x;
   int32_t y;
   uint32_t width;
   uint32_t height;
-  uint32_t mapping_order;
-  std::unordered_set<wl_output*> outputs;
+  bool initialized : 1;
+  bool skipTaskbar : 1;
+  bool onAllDesktops : 1;
+  bool demandsAttention : 1;
+  bool minimized : 1;
+  bool maximized : 1;
+  bool fullscreen : 1;
+  bool restoreAfterShowDesktop : 1;
+  QString qTitle;
+  std::string icon;
+  std::string desktop;
+  std::string activity;
+  SmallSet<wl_output*, 2> outputs;
+
+  const std::string& appId() const { return AtomTable::name(appIdAtom); }
 };
 
 struct VirtualDesktopManager {
   int (*numberOfDesktops)();
-  std::vector<VirtualDesktopInfo> (*desktops)();
+  // Immutable until the desktops change.
+  const std::vector<VirtualDesktopInfo>& (*desktops)();
+  // Changes whenever the desktops change.
+  uint64_t (*desktopsVersion)();
   std::string_view (*currentDesktop)();
   void (*setCurrentDesktop)(std::string_view);
 };
 
 struct WindowManager {
-  std::vector<const WindowInfo*> (*windows)();
+  // All windows in mapping order. Only valid until the next window is added or removed.
+  std::span<const WindowInfo* const> (*windows)();
+  // The windows from bottom to top, or none if the compositor doesn't tell. Only valid
+  // until the next window is added or removed, or the stacking order changes.
+  std::span<void* const> (*stackingOrder)();
   void* (*activeWindow)();
   // We manually reset active window, usually when the new active window is the dock itself.
   // We don't want to always do this (e.g. handle this in state_change() handler) because
@@ -117,7 +136,11 @@ class WindowSystem : public QObject {
   void windowAdded(const WindowInfo*);
   void windowRemoved(void*);
   void windowLeftCurrentDesktop(void*);
+  // The window has moved to another virtual desktop, not necessarily from/to the current one.
+  void windowDesktopChanged(const WindowInfo*);
   void windowGeometryChanged(const WindowInfo*);
+  // The set of outputs the window is on has changed.
+  void windowOutputsChanged(const WindowInfo*);
   void windowStateChanged(const WindowInfo*);
   void windowTitleChanged(const WindowInfo*);
   void activeWindowChanged(void*);
@@ -125,6 +148,11 @@ class WindowSystem : public QObject {
 
   void currentActivityChanged(std::string_view);
 
+  // Screens have been plugged in or unplugged. The indices of the other screens may
+  // have changed, so screens are identified by name.
+  void screenAdded(const QString& name);
+  void screenRemoved(const QString& name);
+
  private:
   // We need this to be non-static for the slot.
   std::string currentActivity_;
@@ -142,10 +170,15 @@ class WindowSystem : public QObject {
  public:
   static WindowSystem* self();
   static bool init(struct wl_display* display);
+  // Initializes without a compositor connection, e.g. for benchmarks and for
+  // replaying window event traces on the offscreen platform. There are no windows
+  // unless they are fed to the window manager by WindowEventReplayer.
+  static void initHeadless(bool kdeWindowManager = false);
 
   static bool hasVirtualDesktopManager();
   static bool hasAutoHideManager();
-  static bool hasActivityManager();
+  // Known asynchronously, false until the activity manager has replied.
+  static bool hasActivityManager() { return hasActivityManager_; }
 
   static int numberOfDesktops() {
     if (hasVirtualDesktopManager()) {
@@ -154,11 +187,17 @@ class WindowSystem : public QObject {
     return 1;
   }
 
-  static std::vector<VirtualDesktopInfo> desktops() {
+  // Valid until the desktops next change, so don't keep the reference.
+  static const std::vector<VirtualDesktopInfo>& desktops() {
     if (hasVirtualDesktopManager()) {
       return virtualDesktopManager_.desktops();
     }
-    return {};
+    static const std::vector<VirtualDesktopInfo> kNoDesktops;
+    return kNoDesktops;
+  }
+
+  static uint64_t desktopsVersion() {
+    return hasVirtualDesktopManager() ? virtualDesktopManager_.desktopsVersion() : 0;
   }
 
   static std::string_view currentDesktop() {
@@ -175,7 +214,8 @@ class WindowSystem : public QObject {
     }
   }
 
-  static std::vector<const WindowInfo*> windows() { return windowManager_.windows(); }
+  static std::span<const WindowInfo* const> windows() { return windowManager_.windows(); }
+  static std::span<void* const> stackingOrder() { return windowManager_.stackingOrder(); }
   static void* activeWindow() { return windowManager_.activeWindow(); }
   // We manually reset active window, usually when the new active window is the dock itself.
   // We don't want to always do this (e.g. handle this in state_change() handler) because
@@ -200,11 +240,29 @@ class WindowSystem : public QObject {
                                 uint32_t strutSize);
   static void setLayer(QWidget* widget, LayerShellQt::Window::Layer layer);
 
-  static std::vector<QScreen*> screens();
+  // The screens, ordered by position. Kept up to date as screens are plugged in or
+  // unplugged, see screensVersion().
+  static const std::vector<QScreen*>& screens() { return screens_; }
+  // Changes whenever the screens change.
+  static uint64_t screensVersion() { return screensVersion_; }
+  // Returns the index of the screen with the specified name, or -1.
+  static int screenIndex(const QString& name);
   // Sets the widget to display on the screen with index `screen` (0-based).
   static void setScreen(QWidget* widget, int screen);
   // Return wl_output object for the screen with index `screen` (0-based).
   static wl_output* getWlOutputForScreen(int screen);
+  // For window managers that report the window geometry but not its outputs, derives
+  // the outputs from the geometry. Returns whether they have changed.
+  static bool updateOutputsFromGeometry(WindowInfo* info);
+
+  static bool hasActivation() { return xdg_activation_ != nullptr; }
+  // Called with the activation token, or an empty string if there is none.
+  using ActivationTokenCallback = std::function<void(const QString& token)>;
+  // Asynchronously requests an xdg-activation token for launching the application with
+  // the given app ID, on behalf of the last input event on `widget`. The callback is
+  // invoked immediately with an empty token if the compositor doesn't support it.
+  static void requestActivationToken(const QString& appId, QWidget* widget,
+                                     ActivationTokenCallback callback);
 
   static QWindow* getWindow(QWidget* widget) {
     widget->winId();  // we need this for widget->windowHandle() to not return nullptr.
@@ -235,6 +293,25 @@ class WindowSystem : public QObject {
 
 
   static void initScreens();
+  static void sortScreens();
+  static void onScreenAdded(QScreen* screen);
+  static void onScreenRemoved(QScreen* screen);
+
+  // xdg_activation_token_v1 interface.
+  static void activation_token_done(void* data,
+                                    struct xdg_activation_token_v1* token,
+                                    const char* tokenString);
+
+  static constexpr struct xdg_activation_token_v1_listener activation_token_listener_ = {
+      activation_token_done
+  };
+
+  // Watches the activity manager over D-Bus, without blocking.
+  static void initActivityManager();
+
+  // Counts the window events for the runtime metrics.
+  static void initMetrics();
+  static void queryCurrentActivity();
 
   static org_kde_plasma_virtual_desktop_management* kde_virtual_desktop_management_;
   static org_kde_plasma_window_management* kde_window_management_;
@@ -242,13 +319,17 @@ class WindowSystem : public QObject {
 
   static zwlr_foreign_toplevel_manager_v1* wlr_window_manager_;
 
+  static xdg_activation_v1* xdg_activation_;
+
   static VirtualDesktopManager virtualDesktopManager_;
   static WindowManager windowManager_;
   static AutoHideManager autoHideManager_;
 
   static std::vector<QScreen*> screens_;
+  static uint64_t screensVersion_;
 
-  static std::unique_ptr<QDBusInterface> activityManager_;
+  static std::unique_ptr<QDBusServiceWatcher> activityManagerWatcher_;
+  static bool hasActivityManager_;
 };
 
 }  // namespace crystaldock
@@ -18,16 +18,21 @@
 
 #include "wlr_window_manager.h"
 
+#include <algorithm>
 #include <iostream>
 
 #include <QGuiApplication>
 
+#include "window_event_queue.h"
+#include "window_event_trace.h"
+
 namespace crystaldock {
 
 zwlr_foreign_toplevel_manager_v1* WlrWindowManager::window_manager_;
 
 std::unordered_map<struct zwlr_foreign_toplevel_handle_v1*, std::unique_ptr<WindowInfo>>
     WlrWindowManager::windows_;
+std::vector<const WindowInfo*> WlrWindowManager::windowList_;
 struct zwlr_foreign_toplevel_handle_v1* WlrWindowManager::activeWindow_;
 struct zwlr_foreign_toplevel_handle_v1* WlrWindowManager::activeWindowBeforeShowDesktop_;
 bool WlrWindowManager::showingDesktop_;
@@ -42,12 +47,18 @@ bool WlrWindowManager::showingDesktop_;
   window_manager_ = window_manager;
   zwlr_foreign_toplevel_manager_v1_add_listener(
       window_manager_, &window_manager_listener_, NULL);
+  connectSignals();
+}
+
+/* static */ void WlrWindowManager::connectSignals() {
   connect(WlrWindowManager::self(), &WlrWindowManager::activeWindowChanged,
       WindowSystem::self(), &WindowSystem::activeWindowChanged);
   connect(WlrWindowManager::self(), &WlrWindowManager::windowAdded,
       WindowSystem::self(), &WindowSystem::windowAdded);
   connect(WlrWindowManager::self(), &WlrWindowManager::windowGeometryChanged,
       WindowSystem::self(), &WindowSystem::windowGeometryChanged);
+  connect(WlrWindowManager::self(), &WlrWindowManager::windowOutputsChanged,
+      WindowSystem::self(), &WindowSystem::windowOutputsChanged);
   connect(WlrWindowManager::self(), &WlrWindowManager::windowLeftCurrentDesktop,
       WindowSystem::self(), &WindowSystem::windowLeftCurrentDesktop);
   connect(WlrWindowManager::self(), &WlrWindowManager::windowRemoved,
@@ -66,22 +77,13 @@ bool WlrWindowManager::showingDesktop_;
   windowManager->closeWindow = WlrWindowManager::closeWindow;
   windowManager->resetActiveWindow = WlrWindowManager::resetActiveWindow;
   windowManager->windows = WlrWindowManager::windows;
+  windowManager->stackingOrder = WlrWindowManager::stackingOrder;
   windowManager->setShowingDesktop = WlrWindowManager::setShowingDesktop;
   windowManager->showingDesktop = WlrWindowManager::showingDesktop;
 }
 
-/* static */ std::vector<const WindowInfo*> WlrWindowManager::windows() {
-  std::vector<const WindowInfo*> windows;
-  for (const auto& element : windows_) {
-    if (element.second) {
-      windows.push_back(element.second.get());
-    }
-  }
-  std::sort(windows.begin(), windows.end(),
-            [](const WindowInfo* w1, const WindowInfo* w2) {
-    return w1->mapping_order < w2->mapping_order;
-  });
-  return windows;
+/* static */ std::span<const WindowInfo* const> WlrWindowManager::windows() {
+  return windowList_;
 }
 
 /* static */ void* WlrWindowManager::activeWindow() {
@@ -93,19 +95,19 @@ bool WlrWindowManager::showingDesktop_;
   emit WlrWindowManager::self()->activeWindowChanged(nullptr);
 }
 
+/* static */ struct wl_seat* WlrWindowManager::seat() {
+  auto app = dynamic_cast<QGuiApplication*>(QGuiApplication::instance());
+  auto waylandApp = app->nativeInterface<QNativeInterface::QWaylandApplication>();
+  return waylandApp ? waylandApp->seat() : nullptr;
+}
+
 /* static */ void WlrWindowManager::activateWindow(void* window_handle) {
   auto* window = static_cast<struct zwlr_foreign_toplevel_handle_v1*>(window_handle);
   if (!window) {
     return;
   }
 
-  auto app = dynamic_cast<QGuiApplication*>(QGuiApplication::instance());
-  auto waylandApp = app->nativeInterface<QNativeInterface::QWaylandApplication>();
-  if (!waylandApp) {
-    return;
-  }
-
-  auto seat = waylandApp->seat();
+  auto* seat = WlrWindowManager::seat();
   if (!seat) {
     return;
   }
@@ -140,26 +142,42 @@ bool WlrWindowManager::showingDesktop_;
 }
 
 /* static */ void WlrWindowManager::setShowingDesktop(bool show) {
-  for (const auto& [window, windowInfo] : windows_) {
-    if (show) {
-      windowInfo->restoreAfterShowDesktop = !windowInfo->minimized;
-      if (!windowInfo->minimized) {
+  // The protocol doesn't tell the stacking order so the requests go out in mapping order,
+  // then are sent with a single flush.
+  if (show) {
+    for (const WindowInfo* constInfo : windowList_) {
+      auto* window = static_cast<struct zwlr_foreign_toplevel_handle_v1*>(constInfo->window);
+      WindowInfo* info = windows_.find(window)->second.get();
+      info->restoreAfterShowDesktop = !info->minimized;
+      if (!info->minimized) {
         zwlr_foreign_toplevel_handle_v1_set_minimized(window);
       }
-      if (activeWindow_) {
-        activeWindowBeforeShowDesktop_ = activeWindow_;
-      }
-      showingDesktop_ = true;
-    } else {
-      if (windowInfo->restoreAfterShowDesktop) {
-        activateWindow(window);
-      }
-      if (activeWindowBeforeShowDesktop_) {
-        activateWindow(activeWindowBeforeShowDesktop_);
+    }
+    if (activeWindow_) {
+      activeWindowBeforeShowDesktop_ = activeWindow_;
+    }
+    showingDesktop_ = true;
+  } else {
+    // Only unminimizes; activating every window would raise and focus each one in turn.
+    struct zwlr_foreign_toplevel_handle_v1* lastRestored = nullptr;
+    for (const WindowInfo* info : windowList_) {
+      if (info->restoreAfterShowDesktop) {
+        auto* window = static_cast<struct zwlr_foreign_toplevel_handle_v1*>(info->window);
+        zwlr_foreign_toplevel_handle_v1_unset_minimized(window);
+        lastRestored = window;
       }
-      showingDesktop_ = false;
     }
+    // Then the one activation, of the window that was active before.
+    auto* toActivate = (activeWindowBeforeShowDesktop_ &&
+                        windows_.count(activeWindowBeforeShowDesktop_) > 0)
+        ? activeWindowBeforeShowDesktop_ : lastRestored;
+    auto* seat = WlrWindowManager::seat();
+    if (toActivate && seat) {
+      zwlr_foreign_toplevel_handle_v1_activate(toActivate, seat);
+    }
+    showingDesktop_ = false;
   }
+  WindowEventQueue::flush();
 }
 
 // zwlr_foreign_toplevel_manager_v1 interface.
@@ -168,12 +186,23 @@ bool WlrWindowManager::showingDesktop_;
     void *data,
     struct zwlr_foreign_toplevel_manager_v1 *zwlr_foreign_toplevel_manager_v1,
     struct zwlr_foreign_toplevel_handle_v1 *window) {
+  addWindow(window);
+  zwlr_foreign_toplevel_handle_v1_add_listener(window, &window_listener_, NULL);
+}
+
+/* static */ void WlrWindowManager::addWindow(struct zwlr_foreign_toplevel_handle_v1* window) {
+  if (WindowEventRecorder::isRecording()) {
+    WindowEventRecorder::record(window, WindowEvent::Type::Toplevel);
+  }
+  if (windows_.count(window) > 0) {
+    std::erase(windowList_, windows_[window].get());
+  }
   windows_[window] = std::make_unique<WindowInfo>();
   windows_[window]->window = window;
   static uint32_t mapping_order = 0;
   windows_[window]->mapping_order = mapping_order++;
-
-  zwlr_foreign_toplevel_handle_v1_add_listener(window, &window_listener_, NULL);
+  // Mapping orders are increasing so this keeps windowList_ sorted.
+  windowList_.push_back(windows_[window].get());
 }
 
 /* static */ void WlrWindowManager::finished(
@@ -190,7 +219,11 @@ bool WlrWindowManager::showingDesktop_;
     return;
   }
 
-  windows_[window]->title = title;
+  if (WindowEventRecorder::isRecording()) {
+    WindowEventRecorder::record(window, WindowEvent::Type::Title, title);
+  }
+
+  windows_[window]->qTitle = QString::fromUtf8(title);
   if (windows_[window]->initialized) {
     emit self()->windowTitleChanged(windows_[window].get());
   }
@@ -204,7 +237,11 @@ bool WlrWindowManager::showingDesktop_;
     return;
   }
 
-  windows_[window]->appId = app_id;
+  if (WindowEventRecorder::isRecording()) {
+    WindowEventRecorder::record(window, WindowEvent::Type::AppId, app_id);
+  }
+
+  windows_[window]->appIdAtom = AtomTable::intern(app_id);
 }
 
 /* static */ void WlrWindowManager::output_enter(
@@ -215,7 +252,9 @@ bool WlrWindowManager::showingDesktop_;
     return;
   }
 
-  windows_[window]->outputs.insert(output);
+  if (windows_[window]->outputs.insert(output) && windows_[window]->initialized) {
+    emit self()->windowOutputsChanged(windows_[window].get());
+  }
 }
 
 /* static */ void WlrWindowManager::output_leave(
@@ -226,7 +265,9 @@ bool WlrWindowManager::showingDesktop_;
     return;
   }
 
-  windows_[window]->outputs.erase(output);
+  if (windows_[window]->outputs.erase(output) > 0 && windows_[window]->initialized) {
+    emit self()->windowOutputsChanged(windows_[window].get());
+  }
 }
 
 /* static */ void WlrWindowManager::state(
@@ -237,6 +278,11 @@ bool WlrWindowManager::showingDesktop_;
     return;
   }
 
+  if (WindowEventRecorder::isRecording()) {
+    WindowEventRecorder::record(window, WindowEvent::Type::State, {},
+                                WindowEventTrace::fromWlrState(state));
+  }
+
   windows_[window]->minimized = false;
   windows_[window]->maximized = false;
   windows_[window]->fullscreen = false;
@@ -286,6 +332,10 @@ bool WlrWindowManager::showingDesktop_;
     return;
   }
 
+  if (WindowEventRecorder::isRecording()) {
+    WindowEventRecorder::record(window, WindowEvent::Type::Done);
+  }
+
   windows_[window]->initialized = true;
   emit self()->windowAdded(windows_[window].get());
 }
@@ -297,7 +347,19 @@ bool WlrWindowManager::showingDesktop_;
     return;
   }
 
+  if (WindowEventRecorder::isRecording()) {
+    WindowEventRecorder::record(window, WindowEvent::Type::Closed);
+  }
+
   emit self()->windowRemoved(windows_[window]->window);
+  const WindowInfo* info = windows_[window].get();
+  auto it = std::lower_bound(windowList_.begin(), windowList_.end(), info,
+                             [](const WindowInfo* w1, const WindowInfo* w2) {
+    return w1->mapping_order < w2->mapping_order;
+  });
+  if (it != windowList_.end() && *it == info) {
+    windowList_.erase(it);
+  }
   windows_.erase(window);
 }
 
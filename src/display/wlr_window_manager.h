@@ -38,6 +38,7 @@ class WlrWindowManager : public QObject {
   void windowRemoved(void*);
   void windowLeftCurrentDesktop(void*);
   void windowGeometryChanged(const WindowInfo*);
+  void windowOutputsChanged(const WindowInfo*);
   void windowStateChanged(const WindowInfo*);
   void windowTitleChanged(const WindowInfo*);
   void activeWindowChanged(void*);
@@ -47,8 +48,12 @@ class WlrWindowManager : public QObject {
   static void init(struct zwlr_foreign_toplevel_manager_v1* window_manager);
 
   static void bindWindowManagerFunctions(WindowManager* windowManager);
+  // Forwards the signals to WindowSystem. Called by init().
+  static void connectSignals();
 
-  static std::vector<const WindowInfo*> windows();
+  static std::span<const WindowInfo* const> windows();
+  // The protocol doesn't tell the stacking order.
+  static std::span<void* const> stackingOrder() { return {}; }
   static void* activeWindow();
   // We manually reset active window, usually when the new active window is the dock itself.
   // We don't want to always do this (e.g. handle this in state_change() handler) because
@@ -62,6 +67,11 @@ class WlrWindowManager : public QObject {
   static void setShowingDesktop(bool show);
 
  private:
+  // The seat to activate windows with, or nullptr.
+  static struct wl_seat* seat();
+
+  // Starts tracking a new toplevel.
+  static void addWindow(struct zwlr_foreign_toplevel_handle_v1* window);
 
   // zwlr_foreign_toplevel_manager_v1 interface.
 
@@ -134,10 +144,14 @@ class WlrWindowManager : public QObject {
 
   static std::unordered_map<struct zwlr_foreign_toplevel_handle_v1*, std::unique_ptr<WindowInfo>>
       windows_;
+  // The values of windows_ in mapping order, kept sorted as windows are added/removed.
+  static std::vector<const WindowInfo*> windowList_;
   static struct zwlr_foreign_toplevel_handle_v1* activeWindow_;
   // So when we show desktop on/off we can restore the active window.
   static struct zwlr_foreign_toplevel_handle_v1* activeWindowBeforeShowDesktop_;
   static bool showingDesktop_;
+
+  friend class WindowEventReplayer;
 };
 
 }
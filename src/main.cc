@@ -16,6 +16,7 @@
  * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cstring>
 #include <iostream>
 
 #include <QApplication>
@@ -23,11 +24,82 @@
 #include <QIcon>
 #include <QSharedMemory>
 
+#include <display/window_event_trace.h>
+#include <model/dock_control_service.h>
 #include <model/multi_dock_model.h>
+#include <utils/profiler.h>
+#include <utils/startup_trace.h>
 #include <view/multi_dock_view.h>
 
+namespace {
+
+// Whether to profile the docks, with --profile[=dump.json] or
+// CRYSTAL_DOCK_PROFILE=1|dump.json. The JSON dump path, if any, is returned in dumpPath.
+bool useProfiler(int argc, char** argv, QString* dumpPath) {
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--profile") == 0) {
+      return true;
+    }
+    if (std::strncmp(argv[i], "--profile=", 10) == 0) {
+      *dumpPath = QString::fromLocal8Bit(argv[i] + 10);
+      return true;
+    }
+  }
+  const QString value = qEnvironmentVariable("CRYSTAL_DOCK_PROFILE");
+  if (value.isEmpty() || value == "0") {
+    return false;
+  }
+  if (value != "1") {
+    *dumpPath = value;
+  }
+  return true;
+}
+
+// The path to record the window events to, with --record-window-events=<path>.
+QString windowEventTracePath(int argc, char** argv) {
+  constexpr char kFlag[] = "--record-window-events=";
+  for (int i = 1; i < argc; ++i) {
+    if (std::strncmp(argv[i], kFlag, sizeof(kFlag) - 1) == 0) {
+      return QString::fromLocal8Bit(argv[i] + sizeof(kFlag) - 1);
+    }
+  }
+  return QString();
+}
+
+// The path to write the startup trace to, with --startup-trace=<path> or
+// CRYSTAL_DOCK_STARTUP_TRACE=<path>.
+QString startupTracePath(int argc, char** argv) {
+  constexpr char kFlag[] = "--startup-trace=";
+  for (int i = 1; i < argc; ++i) {
+    if (std::strncmp(argv[i], kFlag, sizeof(kFlag) - 1) == 0) {
+      return QString::fromLocal8Bit(argv[i] + sizeof(kFlag) - 1);
+    }
+  }
+  return qEnvironmentVariable("CRYSTAL_DOCK_STARTUP_TRACE");
+}
+
+}  // namespace
+
 int main(int argc, char** argv) {
+  const QString startupTrace = startupTracePath(argc, argv);
+  if (!startupTrace.isEmpty()) {
+    crystaldock::StartupTrace::enable(startupTrace);
+  }
+
+  const int64_t appStartUs = crystaldock::StartupTrace::nowUs();
   QApplication app(argc, argv);
+  if (crystaldock::StartupTrace::enabled()) {
+    crystaldock::StartupTrace::addPhase("QApplication", appStartUs);
+  }
+
+  QString profileDumpPath;
+  if (useProfiler(argc, argv, &profileDumpPath)) {
+#ifdef CRYSTALDOCK_PROFILER
+    crystaldock::Profiler::enable(profileDumpPath);
+#else
+    std::cerr << "Crystal Dock was built without the profiler." << std::endl;
+#endif
+  }
 
   // Forces single-instance.
   QSharedMemory sharedMemory;
@@ -43,15 +115,35 @@ int main(int argc, char** argv) {
     }
   }
 
+  // Has to be started before the window system is initialized, to record the initial
+  // windows too.
+  const QString tracePath = windowEventTracePath(argc, argv);
+  if (!tracePath.isEmpty() && !crystaldock::WindowEventRecorder::start(tracePath)) {
+    return -1;
+  }
+
   if (!crystaldock::MultiDockView::checkPlatformSupported(app)) {
     return -1;
   }
 
   QApplication::setWindowIcon(QIcon::fromTheme("user-desktop"));
 
-  crystaldock::MultiDockModel model(QDir::homePath() + "/.crystal-dock-2");
+  int64_t phaseStartUs = crystaldock::StartupTrace::nowUs();
+  crystaldock::MultiDockModel model(
+      crystaldock::SessionContext::fromEnvironment(QDir::homePath() + "/.crystal-dock-2"));
+  if (crystaldock::StartupTrace::enabled()) {
+    crystaldock::StartupTrace::addPhase("MultiDockModel", phaseStartUs);
+  }
+  phaseStartUs = crystaldock::StartupTrace::nowUs();
   crystaldock::MultiDockView view(&model);
+  if (crystaldock::StartupTrace::enabled()) {
+    crystaldock::StartupTrace::addPhase("MultiDockView", phaseStartUs);
+  }
 
   view.show();
+
+  crystaldock::DockControlService controlService(&model);
+  controlService.registerService();
+
   return app.exec();
 }
@@ -20,60 +20,99 @@
 
 #include <algorithm>
 #include <iostream>
+#include <iterator>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
 
 #include <QApplication>
+#include <QDateTime>
 #include <QDir>
+#include <QFile>
 #include <QFileInfo>
+#include <QSaveFile>
 #include <QStringBuilder>
+#include <QThreadPool>
 #include <QUrl>
 
 #include <utils/command_utils.h>
 #include <utils/desktop_file.h>
+#include <utils/runtime_metrics.h>
+#include <utils/startup_trace.h>
 
 namespace crystaldock {
 
 namespace {
 
-bool isHidden(const DesktopFile& desktopFile) {
-  if (desktopFile.noDisplay() || desktopFile.hidden()) {
-    return true;
-  }
-
-  QString desktopEnvName = DesktopEnv::getDesktopEnvName();
-  // Some desktop files still use the legacy "X-Desktop" name.
-  if (!desktopFile.showOnDesktop(desktopEnvName) &&
-      !desktopFile.showOnDesktop("X-" + desktopEnvName)) {
-    return true;
-  }
-
-  // Do not show LXQt special entries (Log Out / Reboot etc.) in the standard categories,
-  // as they are already available in special sections (Session / Power).
-  if (desktopFile.exec().startsWith("lxqt-leave")) {
-    return true;
-  }
-
-  if (desktopFile.categories().isEmpty()) {
-    return true;
+// Window app IDs that don't match the app IDs of their desktop files.
+constexpr std::pair<std::string_view, std::string_view> kBuiltinAliases[] = {
+  // Qt6 D-Bus Viewer.
+  {"qdbusviewer", "org.qt.qdbusviewer6"},
+  // VirtualBox.
+  {"virtualboxvm", "virtualbox"},
+  {"virtualboxmachine", "virtualbox"},
+  {"virtualboxmanager", "virtualbox"},
+  // Google Chrome Flatpak.
+  {"google-chrome", "com.google.chrome"},
+};
+
+constexpr bool hasUniqueAliases() {
+  for (size_t i = 0; i < std::size(kBuiltinAliases); ++i) {
+    for (size_t j = i + 1; j < std::size(kBuiltinAliases); ++j) {
+      if (kBuiltinAliases[i].first == kBuiltinAliases[j].first) {
+        return false;
+      }
+    }
   }
-
-  return false;
+  return true;
 }
+static_assert(hasUniqueAliases(), "Duplicate built-in app ID alias");
 
 }  // namespace
 
-ApplicationMenuConfig::ApplicationMenuConfig(const QStringList& entryDirs)
-    : entryDirs_(entryDirs),
-      fileWatcher_(entryDirs),
-      desktopEnv_(DesktopEnv::getDesktopEnv()) {
+ApplicationMenuConfig::ApplicationMenuConfig(const SessionContext& session,
+                                             const QString& snapshotFile,
+                                             const QString& aliasFile)
+    : entryDirs_(session.entryDirs),
+      snapshotFile_(snapshotFile),
+      aliasFile_(aliasFile),
+      fileWatcher_(session.entryDirs),
+      desktopName_(session.desktopName),
+      legacyDesktopName_(session.legacyDesktopName),
+      desktopEnv_(session.desktopEnv) {
+  StartupPhase phase("ApplicationMenuConfig");
   initCategories();
   initSystemCategories();
-  loadEntries();
+  clearEntries();
+  snapshotCheckTimer_.setSingleShot(true);
+  snapshotCheckTimer_.setInterval(kSnapshotCheckDelayMs);
+  connect(&snapshotCheckTimer_, &QTimer::timeout, this, &ApplicationMenuConfig::checkSnapshot);
+  if (snapshotFile_.isEmpty()) {
+    loadEntries();
+  } else if (loadSnapshot()) {
+    // The docks can be shown right away, the entry directories are checked later.
+    loadSnapshotEntries();
+    snapshotCheckTimer_.start();
+  } else {
+    loadEntries();
+    saveSnapshot();
+  }
+  reloadTimer_.setSingleShot(true);
+  reloadTimer_.setInterval(kReloadDelayMs);
+  connect(&reloadTimer_, SIGNAL(timeout()), this, SLOT(reload()));
   connect(&fileWatcher_, SIGNAL(directoryChanged(const QString&)),
-          this, SLOT(reload()));
+          &reloadTimer_, SLOT(start()));
   connect(&fileWatcher_, SIGNAL(fileChanged(const QString&)),
-          this, SLOT(reload()));
+          &reloadTimer_, SLOT(start()));
 }
 
+ApplicationMenuConfig::ApplicationMenuConfig(const QStringList& entryDirs)
+    : ApplicationMenuConfig([&entryDirs] {
+        SessionContext session = SessionContext::fromEnvironment(QString());
+        session.entryDirs = entryDirs;
+        return session;
+      }()) {}
+
 QStringList ApplicationMenuConfig::getEntryDirs() {
   QStringList entryDirs{QDir::homePath() + "/.local/share/applications"};
   QStringList dataDirs = qEnvironmentVariable("XDG_DATA_DIRS").split(":", Qt::SkipEmptyParts);
@@ -113,189 +152,497 @@ void ApplicationMenuConfig::initCategories() {
   for (int i = 0; i < kNumCategories; ++i) {
     categories_.push_back(Category(
         kCategories[i][0], kCategories[i][1], kCategories[i][2]));
-    categoryMap_[kCategories[i][0]] = i;
   }
 }
 
+int ApplicationMenuConfig::categoryIndex(const QString& name) const {
+  for (int i = 0; i < static_cast<int>(categories_.size()); ++i) {
+    if (categories_[i].name == name) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+uint8_t ApplicationMenuConfig::desktopBits(const QStringList& desktops) const {
+  uint8_t bits = 0;
+  for (const auto& desktop : desktops) {
+    bits |= (desktop == desktopName_) ? kThisDesktop
+          : (desktop == legacyDesktopName_) ? kThisLegacyDesktop
+          : kOtherDesktops;
+  }
+  return bits;
+}
+
+/* static */ bool ApplicationMenuConfig::isHidden(const ApplicationEntry& entry,
+                                                  const DesktopFile& desktopFile) {
+  if (desktopFile.noDisplay() || desktopFile.hidden()) {
+    return true;
+  }
+
+  // Some desktop files still use the legacy "X-Desktop" name.
+  auto showOn = [&entry](uint8_t desktop) {
+    return (entry.onlyShowIn == 0 || (entry.onlyShowIn & desktop)) &&
+           !(entry.notShowIn & desktop);
+  };
+  if (!showOn(kThisDesktop) && !showOn(kThisLegacyDesktop)) {
+    return true;
+  }
+
+  // Do not show LXQt special entries (Log Out / Reboot etc.) in the standard categories,
+  // as they are already available in special sections (Session / Power).
+  if (entry.command.startsWith("lxqt-leave")) {
+    return true;
+  }
+
+  return entry.categories == 0;
+}
+
+void ApplicationMenuConfig::sortEntries() {
+  const auto& arena = *arena_;
+  for (auto& category : categories_) {
+    std::sort(category.entryIndices.begin(), category.entryIndices.end(),
+              [&arena](uint32_t a, uint32_t b) { return arena[a] < arena[b]; });
+  }
+}
+
+void ApplicationMenuConfig::buildAppIdTable() {
+  appIds_.reserve(entries_.size() + shortAppIds_.size() + commands_.size() +
+                  wmClasses_.size() + names_.size() + std::size(kBuiltinAliases));
+  // Keys already in the table take precedence.
+  for (auto* map : {&entries_, &shortAppIds_, &commands_, &wmClasses_, &names_}) {
+    for (const auto& [key, handle] : *map) {
+      appIds_.emplace(normalizeAppId(QString::fromStdString(key)), handle);
+    }
+  }
+  // entries_ is kept for isAppMenuEntry().
+  shortAppIds_.clear();
+  commands_.clear();
+  wmClasses_.clear();
+  names_.clear();
+
+  // The user's aliases take precedence, the built-in ones are only for the app IDs that
+  // don't match anything.
+  const std::vector<std::pair<std::string, std::string>> aliases = readAliases();
+  for (const auto& [alias, appId] : aliases) {
+    auto it = appIds_.find(appId);
+    if (it != appIds_.end()) {
+      appIds_.insert_or_assign(alias, it->second);
+    }
+  }
+  for (const auto& [alias, appId] : kBuiltinAliases) {
+    auto it = appIds_.find(std::string(appId));
+    if (it != appIds_.end()) {
+      appIds_.emplace(std::string(alias), it->second);
+    }
+  }
+}
+
+std::vector<std::pair<std::string, std::string>> ApplicationMenuConfig::readAliases() const {
+  std::vector<std::pair<std::string, std::string>> aliases;
+  if (aliasFile_.isEmpty()) {
+    return aliases;
+  }
+  QFile file(aliasFile_);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    return aliases;
+  }
+  while (!file.atEnd()) {
+    const QString line = QString::fromUtf8(file.readLine()).trimmed();
+    const int index = line.indexOf('=');
+    if (line.isEmpty() || line.startsWith('#') || index <= 0) {
+      continue;
+    }
+    aliases.emplace_back(normalizeAppId(line.left(index)), normalizeAppId(line.mid(index + 1)));
+  }
+  return aliases;
+}
+
 void ApplicationMenuConfig::initSystemCategories() {
   systemCategories_ = desktopEnv_->getApplicationMenuSystemCategories();
 }
 
 void ApplicationMenuConfig::clearEntries() {
+  // A new arena, as copies of the categories may still refer to the old one.
+  arena_ = std::make_shared<std::vector<ApplicationEntry>>();
   for (auto& category : categories_) {
-    category.entries.clear();
+    category.arena = arena_;
+    category.entryIndices.clear();
   }
   entries_.clear();
   shortAppIds_.clear();
+  commands_.clear();
   wmClasses_.clear();
   names_.clear();
+  appIds_.clear();
+  searchIndex_.clear();
+  searchEntries_.clear();
+  resolvedAppIds_.clear();
 }
 
-bool ApplicationMenuConfig::loadEntries() {
+bool ApplicationMenuConfig::loadEntries(QStringList* changedAppIds,
+                                        QStringList* removedAppIds) {
+  // Lists the desktop files in load order, reusing the ones that haven't changed.
+  struct File {
+    QString path;
+    std::string key;
+    qint64 modificationTime;
+    qint64 size;
+    bool parsed;
+  };
+  std::vector<File> files;
+  std::unordered_map<std::string, ParsedDesktopFile> desktopFiles;
+  std::unordered_map<std::string, ParsedDirectory> directories;
   for (const QString& entryDir : entryDirs_) {
     if (!QDir::root().exists(entryDir)) {
       continue;
     }
 
-    QDir dir(entryDir);
-    QStringList files = dir.entryList({"*.desktop"}, QDir::Files, QDir::Name);
-    if (files.isEmpty()) {
+    const std::string dirKey = entryDir.toStdString();
+    if (directories.count(dirKey) > 0) {
       continue;
     }
-
-    for (int i = 0; i < files.size(); ++i) {
-      const QString& file = entryDir + "/" + files.at(i);
-      loadEntry(file);
+    const qint64 dirModificationTime = QFileInfo(entryDir).lastModified().toMSecsSinceEpoch();
+    auto snapshot = snapshotDirectories_.find(dirKey);
+    QStringList fileNames;
+    std::vector<File> dirFiles;
+    if (snapshot != snapshotDirectories_.end() &&
+        snapshot->second.modificationTime == dirModificationTime) {
+      // Unchanged since the snapshot was saved, no need to list or stat its files.
+      for (const QString& fileName : std::as_const(snapshot->second.fileNames)) {
+        const QString path = entryDir + "/" + fileName;
+        auto it = desktopFiles_.find(path.toStdString());
+        if (it != desktopFiles_.end()) {
+          fileNames.append(fileName);
+          dirFiles.push_back({path, {}, it->second.modificationTime, it->second.size, false});
+        }
+      }
+    } else {
+      QDir dir(entryDir);
+      const QFileInfoList fileInfos =
+          dir.entryInfoList({"*.desktop"}, QDir::Files, QDir::Name);
+      for (const QFileInfo& fileInfo : fileInfos) {
+        fileNames.append(fileInfo.fileName());
+        dirFiles.push_back({entryDir + "/" + fileInfo.fileName(), {},
+                            fileInfo.lastModified().toMSecsSinceEpoch(), fileInfo.size(),
+                            false});
+      }
+    }
+    directories[dirKey] = {dirModificationTime, fileNames};
+
+    for (File& file : dirFiles) {
+      file.key = file.path.toStdString();
+      if (desktopFiles.count(file.key) == 0) {
+        auto it = desktopFiles_.find(file.key);
+        if (it != desktopFiles_.end() && it->second.modificationTime == file.modificationTime &&
+            it->second.size == file.size) {
+          desktopFiles[file.key] = std::move(it->second);
+          file.parsed = true;
+        } else {
+          desktopFiles[file.key] = {file.modificationTime, file.size, DesktopFile()};
+        }
+        if (it != desktopFiles_.end()) {
+          desktopFiles_.erase(it);
+        }
+      } else {
+        file.parsed = true;
+      }
+      files.push_back(std::move(file));
+    }
+  }
+  snapshotDirectories_.clear();
+  directories_ = std::move(directories);
+
+  // Parses the new/modified files, in parallel if there are many of them.
+  std::vector<File*> toParse;
+  for (auto& file : files) {
+    if (!file.parsed) {
+      toParse.push_back(&file);
+    }
+  }
+  std::vector<DesktopFile> parsed(toParse.size());
+  if (toParse.size() < kMinFilesToParseInParallel) {
+    for (size_t i = 0; i < toParse.size(); ++i) {
+      parsed[i] = DesktopFile(toParse[i]->path);
+    }
+  } else {
+    QThreadPool pool;
+    const int numChunks = std::max(1, pool.maxThreadCount());
+    for (int chunk = 0; chunk < numChunks; ++chunk) {
+      pool.start([&toParse, &parsed, chunk, numChunks]() {
+        for (size_t i = chunk; i < toParse.size(); i += numChunks) {
+          parsed[i] = DesktopFile(toParse[i]->path);
+        }
+      });
     }
+    pool.waitForDone();
+  }
+  for (size_t i = 0; i < toParse.size(); ++i) {
+    if (changedAppIds) { changedAppIds->append(parsed[i].appId()); }
+    desktopFiles[toParse[i]->key].desktopFile = std::move(parsed[i]);
   }
 
+  // Nothing added, modified or removed, the current entries are still valid.
+  if (toParse.empty() && desktopFiles_.empty()) {
+    desktopFiles_ = std::move(desktopFiles);
+    return true;
+  }
+
+  // Merges the entries in load order, so that earlier directories take precedence.
+  clearEntries();
+  for (const auto& file : files) {
+    loadEntry(file.path, desktopFiles[file.key].desktopFile);
+  }
+  sortEntries();
+  buildAppIdTable();
+
+  // What's left are the desktop files that have been removed.
+  if (removedAppIds) {
+    for (const auto& [file, parsed] : desktopFiles_) {
+      removedAppIds->append(parsed.desktopFile.appId());
+    }
+  }
+  desktopFiles_ = std::move(desktopFiles);
   return true;
 }
 
-bool ApplicationMenuConfig::loadEntry(const QString &file) {
-  DesktopFile desktopFile(file);
+void ApplicationMenuConfig::loadSnapshotEntries() {
+  std::unordered_set<std::string> loadedDirs;
+  for (const QString& entryDir : entryDirs_) {
+    const std::string dirKey = entryDir.toStdString();
+    if (!loadedDirs.insert(dirKey).second) {
+      continue;
+    }
+    auto snapshot = snapshotDirectories_.find(dirKey);
+    if (snapshot == snapshotDirectories_.end()) {
+      continue;
+    }
+    for (const QString& fileName : std::as_const(snapshot->second.fileNames)) {
+      const QString path = entryDir + "/" + fileName;
+      auto it = desktopFiles_.find(path.toStdString());
+      if (it != desktopFiles_.end()) {
+        loadEntry(path, it->second.desktopFile);
+      }
+    }
+  }
+  sortEntries();
+  buildAppIdTable();
+}
 
+void ApplicationMenuConfig::checkSnapshot() {
+  for (const QString& entryDir : entryDirs_) {
+    auto snapshot = snapshotDirectories_.find(entryDir.toStdString());
+    // Entry directories that didn't exist aren't in the snapshot.
+    const bool exists = QDir::root().exists(entryDir);
+    if (exists != (snapshot != snapshotDirectories_.end()) ||
+        (exists && QFileInfo(entryDir).lastModified().toMSecsSinceEpoch() !=
+             snapshot->second.modificationTime)) {
+      reload();
+      return;
+    }
+  }
+  directories_ = std::move(snapshotDirectories_);
+  snapshotDirectories_.clear();
+}
+
+bool ApplicationMenuConfig::loadEntry(const QString &file, const DesktopFile& desktopFile) {
   if (desktopFile.type() != "Application") {
     return false;
   }
 
-  auto categories = desktopFile.categories();
-  if (categories.isEmpty()) {
-    categories = {kUncategorized};
+  const QString appId = desktopFile.appId();
+  if (entries_.count(appId.toStdString()) > 0) {
+    return true;
   }
 
-  const QString appId = desktopFile.appId();
-  for (int i = 0; i < categories.size(); ++i) {
-    const std::string category = categories[i].toStdString();
-    if (categoryMap_.count(category) > 0 &&
-        entries_.count(appId.toStdString()) == 0) {
-      const QString command = filterFieldCodes(desktopFile.exec().simplified());
-      ApplicationEntry newEntry(appId,
-                                desktopFile.name(),
-                                desktopFile.genericName(),
-                                desktopFile.icon(),
-                                command,
-                                file,
-                                isHidden(desktopFile));
-      auto& entries = categories_[categoryMap_[category]].entries;
-      auto next = std::lower_bound(entries.begin(), entries.end(), newEntry);
-      entries.insert(next, newEntry);
-
-      auto* entry = &(*--next);
-      const auto appId = newEntry.appId.toLower();
-      entries_[appId.toStdString()] = entry;
-      auto shortAppId = appId.simplified().replace(" ", "");
-      shortAppId = shortAppId.mid(shortAppId.lastIndexOf('.') + 1);
-      shortAppIds_[shortAppId.toStdString()] = entry;
-      const auto shortCommand = getShortCommand(command).toLower().toStdString();
-      if (!shortCommand.empty()) {
-        commands_[shortCommand] = entry;
-      }
-      const auto wmClass =
-          desktopFile.wmClass().toLower().simplified().replace(" ", "").toStdString();
-      if (!wmClass.empty()) {
-        wmClasses_[wmClass] = entry;
-      }
-      const auto name = desktopFile.name().toLower().simplified().replace(" ", "").toStdString();
-      if (!name.empty()) {
-        names_[name] = entry;
+  // Goes in the first of its categories that is on the menu.
+  const QStringList categories = desktopFile.categories();
+  uint32_t categoryBits = 0;
+  int first = -1;
+  for (const auto& category : categories) {
+    const int index = categoryIndex(category);
+    if (index >= 0) {
+      categoryBits |= 1u << index;
+      if (first < 0) {
+        first = index;
       }
     }
   }
+  if (categories.isEmpty()) {
+    first = categoryIndex(kUncategorized);
+  }
+  if (first < 0) {
+    return true;
+  }
+
+  const QString command = filterFieldCodes(desktopFile.exec().simplified());
+  ApplicationEntry newEntry(appId, desktopFile.name(), desktopFile.genericName(),
+                            desktopFile.icon(), command, file);
+  newEntry.categories = categoryBits;
+  newEntry.onlyShowIn = desktopBits(desktopFile.onlyShowIn());
+  newEntry.notShowIn = desktopBits(desktopFile.notShowIn());
+  newEntry.hidden = isHidden(newEntry, desktopFile);
+  const auto handle = static_cast<uint32_t>(arena_->size());
+  arena_->push_back(std::move(newEntry));
+  // Sorted once all the entries are loaded, see sortEntries().
+  categories_[first].entryIndices.push_back(handle);
+
+  const auto& entry = arena_->back();
+  const auto lowerAppId = entry.appId.toLower();
+  entries_[lowerAppId.toStdString()] = handle;
+  auto shortAppId = lowerAppId.simplified().replace(" ", "");
+  shortAppId = shortAppId.mid(shortAppId.lastIndexOf('.') + 1);
+  shortAppIds_[shortAppId.toStdString()] = handle;
+  const auto shortCommand = getShortCommand(command).toLower().toStdString();
+  if (!shortCommand.empty()) {
+    commands_[shortCommand] = handle;
+  }
+  const auto wmClass =
+      desktopFile.wmClass().toLower().simplified().replace(" ", "").toStdString();
+  if (!wmClass.empty()) {
+    wmClasses_[wmClass] = handle;
+  }
+  const auto name = entry.name.toLower().simplified().replace(" ", "").toStdString();
+  if (!name.empty()) {
+    names_[name] = handle;
+  }
+  searchIndex_.add({entry.name, entry.genericName, desktopFile.keywords().join(' ')});
+  searchEntries_.push_back(handle);
+  return true;
+}
+
+bool ApplicationMenuConfig::loadSnapshot() {
+  QFile file(snapshotFile_);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+  const qint64 size = file.size();
+  uchar* data = file.map(0, size);
+  if (data == nullptr) {
+    return false;
+  }
+  QDataStream in(QByteArray::fromRawData(reinterpret_cast<const char*>(data), size));
+  in.setVersion(QDataStream::Qt_6_6);
+
+  QByteArray magic;
+  qint32 version = 0;
+  QStringList entryDirs;
+  in >> magic >> version >> entryDirs;
+  if (magic != kSnapshotMagic || version != kSnapshotVersion || entryDirs != entryDirs_) {
+    return false;
+  }
+
+  qint32 numDirs = 0;
+  in >> numDirs;
+  for (qint32 i = 0; i < numDirs && in.status() == QDataStream::Ok; ++i) {
+    QString dir;
+    ParsedDirectory directory;
+    in >> dir >> directory.modificationTime >> directory.fileNames;
+    for (const auto& fileName : std::as_const(directory.fileNames)) {
+      ParsedDesktopFile parsed;
+      in >> parsed.modificationTime >> parsed.size;
+      parsed.desktopFile.load(in);
+      desktopFiles_[(dir + "/" + fileName).toStdString()] = std::move(parsed);
+    }
+    snapshotDirectories_[dir.toStdString()] = std::move(directory);
+  }
 
+  if (in.status() != QDataStream::Ok) {
+    std::cerr << "Corrupted application menu snapshot: " << snapshotFile_.toStdString()
+              << std::endl;
+    desktopFiles_.clear();
+    snapshotDirectories_.clear();
+    return false;
+  }
   return true;
 }
 
+void ApplicationMenuConfig::saveSnapshot() const {
+  QSaveFile file(snapshotFile_);
+  if (!file.open(QIODevice::WriteOnly)) {
+    std::cerr << "Could not write application menu snapshot: " << snapshotFile_.toStdString()
+              << std::endl;
+    return;
+  }
+  QDataStream out(&file);
+  out.setVersion(QDataStream::Qt_6_6);
+
+  out << QByteArray(kSnapshotMagic) << kSnapshotVersion << entryDirs_;
+  out << static_cast<qint32>(directories_.size());
+  for (const auto& [dir, directory] : directories_) {
+    const QString dirPath = QString::fromStdString(dir);
+    out << dirPath << directory.modificationTime << directory.fileNames;
+    for (const auto& fileName : directory.fileNames) {
+      const auto& parsed = desktopFiles_.at((dirPath + "/" + fileName).toStdString());
+      out << parsed.modificationTime << parsed.size;
+      parsed.desktopFile.save(out);
+    }
+  }
+  file.commit();
+}
+
 void ApplicationMenuConfig::reload() {
-  clearEntries();
-  loadEntries();
-  emit configChanged();
+  MetricsScope metrics(RuntimeMetrics::Counter::ApplicationMenuReloads,
+                       RuntimeMetrics::Histogram::ApplicationMenuReload);
+  reloadTimer_.stop();
+  snapshotCheckTimer_.stop();
+  QStringList changedAppIds;
+  QStringList removedAppIds;
+  loadEntries(&changedAppIds, &removedAppIds);
+  if (changedAppIds.isEmpty() && removedAppIds.isEmpty()) {
+    return;
+  }
+
+  if (!snapshotFile_.isEmpty()) {
+    saveSnapshot();
+  }
+  emit entriesChanged(changedAppIds, removedAppIds);
 }
 
 const ApplicationEntry* ApplicationMenuConfig::findApplication(const std::string& appId) const {
+  const QString id = QString::fromStdString(appId);
   for (const auto& category : systemCategories_) {
-    for (const auto& entry : category.entries) {
-      if (entry.appId.toStdString() == appId) {
+    for (const auto& entry : category.entries()) {
+      if (entry.appId == id) {
         return &entry;
       }
     }
   }
-  return entries_.count(appId) > 0
-      ? entries_.at(appId)
-      : shortAppIds_.count(appId) > 0
-          ? shortAppIds_.at(appId)
-          : commands_.count(appId) > 0
-              ? commands_.at(appId)
-              : wmClasses_.count(appId) > 0
-                  ? wmClasses_.at(appId)
-                  : names_.count(appId) > 0
-                      ? names_.at(appId)
-                      : nullptr;
+  return findEntry(appIds_, appId);
 }
 
 const ApplicationEntry* ApplicationMenuConfig::tryMatchingApplicationId(
     const std::string& appId) const {
-  QString id = QString::fromStdString(appId).toLower();
-  if (auto* app = findApplication(id.toStdString())) {
-    return app;
+  auto it = resolvedAppIds_.find(appId);
+  if (it != resolvedAppIds_.end()) {
+    return it->second;
   }
 
-  id = id.simplified().replace(" ", "");
-  if (auto* app = findApplication(id.toStdString())) {
-    return app;
-  }
+  const ApplicationEntry* app = resolveApplicationId(appId);
+  resolvedAppIds_[appId] = app;
+  return app;
+}
 
-  id = id.mid(id.lastIndexOf('.') + 1);
-  if (auto* app = findApplication(id.toStdString())) {
+const ApplicationEntry* ApplicationMenuConfig::resolveApplicationId(
+    const std::string& appId) const {
+  const std::string id = normalizeAppId(QString::fromStdString(appId));
+  if (auto* app = findApplication(id)) {
     return app;
   }
 
-  // Special fix for Qt6 D-Bus Viewer.
-  if (id == "qdbusviewer") {
-    if (auto* app = findApplication("org.qt.qdbusviewer6")) {
-      return app;
-    }
-  }
-
-  // Special fix for VirtualBox.
-  if (id == "virtualboxvm" || id == "virtualboxmachine" || id == "virtualboxmanager") {
-    if (auto* app = findApplication("virtualbox")) {
-      return app;
-    }
-  }
-
-  // Special fix for Google Chrome Flatpak.
-  if (id == "google-chrome") {
-    if (auto* app = findApplication("com.google.chrome")) {
-      return app;
-    }
+  const auto dot = id.rfind('.');
+  if (dot != std::string::npos) {
+    return findApplication(id.substr(dot + 1));
   }
-
   return nullptr;
 }
 
 const std::vector<ApplicationEntry> ApplicationMenuConfig::searchApplications(
     const QString& text, unsigned int maxNumResults) const {
   std::vector<ApplicationEntry> entries;
-  for (const auto& category : categories_) {
-    for (const auto& entry : category.entries) {
-      if (text.length() == 1) {
-        if (entry.name.startsWith(text, Qt::CaseInsensitive)) {
-          entries.push_back(entry);
-        }
-      } else {
-        if (entry.name.contains(text, Qt::CaseInsensitive) ||
-            entry.genericName.contains(text, Qt::CaseInsensitive)) {
-          entries.push_back(entry);
-        }
-      }
-      if (entries.size() == maxNumResults) {
-        goto end_loop;
-      }
-    }
+  for (const int id : searchIndex_.search(text, maxNumResults)) {
+    entries.push_back(entry(searchEntries_[id]));
   }
-end_loop:
-  std::sort(entries.begin(), entries.end());
   return entries;
 }
 
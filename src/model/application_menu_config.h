@@ -19,9 +19,11 @@
 #ifndef CRYSTALDOCK_APPLICATION_MENU_CONFIG_H_
 #define CRYSTALDOCK_APPLICATION_MENU_CONFIG_H_
 
-#include <list>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <QDir>
@@ -30,9 +32,13 @@
 #include <QObject>
 #include <QString>
 #include <QStringList>
+#include <QTimer>
 
 #include "application_menu_entry.h"
+#include "session_context.h"
 #include <desktop/desktop_env.h>
+#include <utils/desktop_file.h>
+#include <utils/search_index.h>
 
 namespace crystaldock {
 
@@ -41,8 +47,33 @@ class ApplicationMenuConfig : public QObject {
 
  public:
   static constexpr char kUncategorized[] = "Uncategorized";
-
-  ApplicationMenuConfig(const QStringList& entryDirs = getEntryDirs());
+  static constexpr int kReloadDelayMs = 500;
+  // How long after start-up the entries loaded from the snapshot are checked against
+  // the entry directories, so that the check doesn't delay the first frame.
+  static constexpr int kSnapshotCheckDelayMs = 1000;
+  // Below this, parsing desktop files on a thread pool isn't worth the overhead.
+  static constexpr size_t kMinFilesToParseInParallel = 64;
+
+  // The desktops of OnlyShowIn / NotShowIn that matter, see ApplicationEntry.
+  enum DesktopBits : uint8_t {
+    kThisDesktop = 1,
+    // The legacy "X-" name of this desktop.
+    kThisLegacyDesktop = 2,
+    kOtherDesktops = 4,
+  };
+
+  static constexpr char kSnapshotMagic[] = "CDAM";
+  static constexpr qint32 kSnapshotVersion = 2;
+
+  // If snapshotFile is not empty, the parsed entries are saved to it and loaded back from it
+  // on the next start, so that only directories modified in between need to be listed and
+  // parsed again. If aliasFile is not empty, it has app ID aliases that are merged with the
+  // built-in ones, see tryMatchingApplicationId().
+  explicit ApplicationMenuConfig(const SessionContext& session,
+                                 const QString& snapshotFile = QString(),
+                                 const QString& aliasFile = QString());
+  // For the entry directories, in the current session.
+  explicit ApplicationMenuConfig(const QStringList& entryDirs);
 
   ~ApplicationMenuConfig() = default;
 
@@ -60,17 +91,27 @@ class ApplicationMenuConfig : public QObject {
     return entries_.count(appId) > 0;
   }
 
-  // Tries to find a matching application ID using different heuristics.
+  // Tries to find a matching application ID using different heuristics: the app ID,
+  // lowercased and without spaces, then its last dot-separated part, each matched against
+  // the app IDs, short commands, WM classes and names of the entries, then the aliases.
+  // Aliases are lines of "window app ID=desktop file app ID", e.g. for applications whose
+  // Wayland app ID doesn't match their desktop file. The results, including failed
+  // matches, are cached until the config is reloaded.
   const ApplicationEntry* tryMatchingApplicationId(const std::string& appId) const;
 
-  // Searches for applications with the name containing the given text.
+  // Searches for applications by name, generic name and keywords, tolerating typos.
+  // Returns the best matches first.
   const std::vector<ApplicationEntry> searchApplications(
       const QString& text, unsigned int maxNumResults) const;
 
  signals:
-  void configChanged();
+  // Emitted after a reload that changed any entries, with the app IDs of the
+  // entries whose desktop files were added/modified and removed.
+  void entriesChanged(const QStringList& changedAppIds, const QStringList& removedAppIds);
 
  public slots:
+  // Reloads the entries, re-parsing only the desktop files that have been added or modified
+  // since the last load. Does nothing if no desktop files have changed.
   void reload();
 
  private:
@@ -83,39 +124,125 @@ class ApplicationMenuConfig : public QObject {
   // Clears all application entries.
   void clearEntries();
 
-  // Loads application entries from entryDir.
-  bool loadEntries();
+  // Loads/saves the snapshot of the parsed desktop files.
+  bool loadSnapshot();
+  void saveSnapshot() const;
+
+  // Loads application entries from entryDir. If not null, changedAppIds / removedAppIds
+  // receive the app IDs of the desktop files that have been added or modified / removed
+  // since the last load.
+  bool loadEntries(QStringList* changedAppIds = nullptr, QStringList* removedAppIds = nullptr);
+
+  // Loads the application entries from the snapshot alone, trusting the entry
+  // directories not to have changed until checkSnapshot().
+  void loadSnapshotEntries();
+
+  // Reloads if any entry directory has changed since the snapshot was saved.
+  void checkSnapshot();
+
+  // Loads an application entry from the parsed .desktop file.
+  bool loadEntry(const QString& file, const DesktopFile& desktopFile);
+
+  // Sorts the entries of each category by name, once they have all been loaded.
+  void sortEntries();
+
+  // Merges the lookup maps and the aliases into appIds_, once all the entries have been
+  // loaded.
+  void buildAppIdTable();
+  // Reads the aliases of aliasFile_, as (alias, app ID) pairs.
+  std::vector<std::pair<std::string, std::string>> readAliases() const;
+
+  // Lowercases and removes spaces.
+  static std::string normalizeAppId(const QString& appId) {
+    return appId.toLower().simplified().replace(" ", "").toStdString();
+  }
+
+  // The entry with the handle, an index into the arena.
+  const ApplicationEntry& entry(uint32_t handle) const { return (*arena_)[handle]; }
+  // The entry with the key in the map, or nullptr.
+  const ApplicationEntry* findEntry(const std::unordered_map<std::string, uint32_t>& map,
+                                    const std::string& key) const {
+    auto it = map.find(key);
+    return it != map.end() ? &entry(it->second) : nullptr;
+  }
+
+  // Returns the index of the category with the name, or -1.
+  int categoryIndex(const QString& name) const;
+
+  // Returns the DesktopBits of the desktops in the list.
+  uint8_t desktopBits(const QStringList& desktops) const;
+
+  // Whether the entry shouldn't be shown on the Application Menu.
+  static bool isHidden(const ApplicationEntry& entry, const DesktopFile& desktopFile);
 
-  // Loads an application entry from the .desktop file.
-  bool loadEntry(const QString& file);
+  // The uncached version of tryMatchingApplicationId().
+  const ApplicationEntry* resolveApplicationId(const std::string& appId) const;
 
   // The directories that contains the list of all application entries as
   // desktop files, e.g. /usr/share/applications
   const QStringList entryDirs_;
 
+  // All the application entries, in load order. The lookup maps below hold their indices,
+  // which stay valid as the arena grows.
+  std::shared_ptr<std::vector<ApplicationEntry>> arena_;
   // Application entries, organized by categories.
   std::vector<Category> categories_;
   // System entries (e.g. Lock Screen / Shut Down), organized by categories.
   std::vector<Category> systemCategories_;
-  // Map from category names to category indices in the above vector,
-  // to make loading entries faster.
-  std::unordered_map<std::string, int> categoryMap_;
   // Map from app ids to application entries for fast look-up.
-  std::unordered_map<std::string, const ApplicationEntry*> entries_;
+  std::unordered_map<std::string, uint32_t> entries_;
   // Map from a short-form app ids to application entries for fast look-up.
-  std::unordered_map<std::string, const ApplicationEntry*> shortAppIds_;
+  std::unordered_map<std::string, uint32_t> shortAppIds_;
   // Map from short commands to application entries for fast look-up.
   // Short command means for example, "command" instead of "/usr/bin/command -a -b"
-  std::unordered_map<std::string, const ApplicationEntry*> commands_;
+  std::unordered_map<std::string, uint32_t> commands_;
   // Map from WM classes to application entries for fast look-up.
-  std::unordered_map<std::string, const ApplicationEntry*> wmClasses_;
+  std::unordered_map<std::string, uint32_t> wmClasses_;
   // Map from names to application entries for fast look-up.
-  std::unordered_map<std::string, const ApplicationEntry*> names_;
+  std::unordered_map<std::string, uint32_t> names_;
+  // All the above (cleared once merged) and the aliases, normalized, with the same
+  // precedence as findApplication(), see buildAppIdTable().
+  std::unordered_map<std::string, uint32_t> appIds_;
+  // Search index over the application entries, with the entry of each item ID.
+  SearchIndex searchIndex_;
+  std::vector<uint32_t> searchEntries_;
+  // Cache of tryMatchingApplicationId() results, nullptr if there's no match.
+  mutable std::unordered_map<std::string, const ApplicationEntry*> resolvedAppIds_;
+
+  // A parsed desktop file, with the modification time and size of the file it was parsed
+  // from, so it's only parsed again if the file has changed.
+  struct ParsedDesktopFile {
+    qint64 modificationTime;
+    qint64 size;
+    DesktopFile desktopFile;
+  };
+  // Parsed desktop files by path.
+  std::unordered_map<std::string, ParsedDesktopFile> desktopFiles_;
+
+  // The desktop files of an entry directory, with the directory's modification time.
+  struct ParsedDirectory {
+    qint64 modificationTime;
+    QStringList fileNames;
+  };
+  // The entry directories as of the last load, by path.
+  std::unordered_map<std::string, ParsedDirectory> directories_;
+  // The entry directories loaded from the snapshot. Only trusted for the first load, since
+  // editing a file in place doesn't change its directory's modification time.
+  std::unordered_map<std::string, ParsedDirectory> snapshotDirectories_;
+  const QString snapshotFile_;
+  const QString aliasFile_;
 
   QFileSystemWatcher fileWatcher_;
+  // Debounces bursts of file system changes (e.g. a package install) into one reload.
+  QTimer reloadTimer_;
+  QTimer snapshotCheckTimer_;
 
+  // Entries are shown on this desktop only, see DesktopFile::showOnDesktop().
+  const QString desktopName_;
+  const QString legacyDesktopName_;
   DesktopEnv* desktopEnv_;
 
+  friend class ApplicationMenuConfigBenchmark;
   friend class ApplicationMenuConfigTest;
 };
 
@@ -0,0 +1,446 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "application_menu_config.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "session_context.h"
+
+namespace crystaldock {
+
+// Benchmarks of loading and querying application menu entries, on synthetic XDG trees
+// of 1k / 10k / 50k desktop files, e.g.:
+//
+// application_menu_config_benchmark -o results.xml,xml
+//
+// or `make benchmark`. The budgets test fails if any of them regresses past a generous
+// limit, and is run on its own by `make benchmark_budgets`. It's not part of ctest, as
+// the limits depend on the machine and the build type.
+class ApplicationMenuConfigBenchmark : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void initTestCase() {
+    QVERIFY(configDir_.isValid());
+  }
+
+  void load_data() { addSizes(); }
+  void load();
+  void loadSnapshot_data() { addSizes(); }
+  void loadSnapshot();
+  void reload_data() { addSizes(); }
+  void reload();
+  void reloadOneChanged_data() { addSizes(); }
+  void reloadOneChanged();
+  void findApplication_data() { addSizes(); }
+  void findApplication();
+  void tryMatchingApplicationId_data() { addSizes(); }
+  void tryMatchingApplicationId();
+  void searchApplications_data() { addSizes(); }
+  void searchApplications();
+  void memoryUsage_data() { addSizes(); }
+  void memoryUsage();
+  void budgets();
+
+ private:
+  // The number of results of the launcher's search, the largest one.
+  static constexpr unsigned int kMaxSearchResults = 200;
+  static constexpr int kBudgetNumFiles = 10000;
+  // The limits of the budgets test, for kBudgetNumFiles desktop files. Well above the
+  // expected numbers so that they catch complexity regressions rather than noise.
+  static constexpr double kMaxLoadMs = 5000;
+  static constexpr double kMaxSnapshotLoadMs = 1000;
+  static constexpr double kMaxReloadMs = 500;
+  static constexpr double kMaxLookupsMs = 200;  // For all lookups of the tree.
+  static constexpr double kMaxKeystrokeMs = 50;
+  static constexpr qint64 kMaxBytesPerEntry = 16 * 1024;
+
+  // A synthetic set of entry directories.
+  struct Tree {
+    std::unique_ptr<QTemporaryDir> root;
+    // In XDG order: user, Flatpak exports, then system.
+    QStringList entryDirs;
+    // Of all desktop files, and some misses.
+    std::vector<std::string> appIds;
+    // Wayland app IDs as windows report them, e.g. capitalized or reverse-DNS.
+    std::vector<std::string> windowAppIds;
+    // What the user types into the search box, one keystroke at a time.
+    QStringList queries;
+    // A desktop file that reloadOneChanged() modifies.
+    QString changingFile;
+  };
+
+  static void addSizes() {
+    QTest::addColumn<int>("numFiles");
+    QTest::newRow("1k files") << 1000;
+    QTest::newRow("10k files") << 10000;
+    QTest::newRow("50k files") << 50000;
+  }
+
+  SessionContext session(const Tree& tree) const {
+    SessionContext session;
+    // Independent of the host's desktop environment.
+    session.setDesktop("generic", configDir_.path());
+    session.entryDirs = tree.entryDirs;
+    return session;
+  }
+
+  // Generated on first use, as writing 50k files takes a while.
+  const Tree& tree(int numFiles);
+
+  static void writeDesktopFile(const QString& path, const QString& appId, const QString& name,
+                               std::mt19937* random);
+
+  // Resolves the app IDs of the tree, bypassing the cache.
+  static void resolveAll(const ApplicationMenuConfig& config, const Tree& tree) {
+    for (const auto& appId : tree.windowAppIds) {
+      config.resolveApplicationId(appId);
+    }
+  }
+
+  // Types each query, returning the slowest keystroke in ms.
+  static double typeQueries(const ApplicationMenuConfig& config, const Tree& tree) {
+    double slowest = 0;
+    QElapsedTimer timer;
+    for (const QString& query : tree.queries) {
+      for (int length = 1; length <= query.size(); ++length) {
+        timer.start();
+        const auto results = config.searchApplications(query.left(length), kMaxSearchResults);
+        slowest = std::max(slowest, timer.nsecsElapsed() / 1e6);
+      }
+    }
+    return slowest;
+  }
+
+  // The fastest of a few runs of f in ms.
+  template <typename F>
+  static double bestOfMs(F f) {
+    constexpr int kNumRuns = 3;
+    double best = 0;
+    QElapsedTimer timer;
+    for (int i = 0; i < kNumRuns; ++i) {
+      timer.start();
+      f();
+      const double ms = timer.nsecsElapsed() / 1e6;
+      best = (i == 0) ? ms : std::min(best, ms);
+    }
+    return best;
+  }
+
+  // A value in kB from /proc/self/status, e.g. "VmRSS", or -1 if not available.
+  static qint64 procStatusKb(const QByteArray& key) {
+    QFile file("/proc/self/status");
+    if (!file.open(QIODevice::ReadOnly)) {
+      return -1;
+    }
+    for (const QByteArray& line : file.readAll().split('\n')) {
+      if (line.startsWith(key + ":")) {
+        return line.mid(key.size() + 1).trimmed().split(' ').front().toLongLong();
+      }
+    }
+    return -1;
+  }
+
+  // How much the resident memory grows by loading the tree, in bytes.
+  qint64 loadedBytes(const Tree& tree) {
+    const qint64 before = procStatusKb("VmRSS");
+    ApplicationMenuConfig config(session(tree));
+    return (procStatusKb("VmRSS") - before) * 1024;
+  }
+
+  QTemporaryDir configDir_;
+  std::map<int, Tree> trees_;
+};
+
+const ApplicationMenuConfigBenchmark::Tree& ApplicationMenuConfigBenchmark::tree(int numFiles) {
+  auto it = trees_.find(numFiles);
+  if (it != trees_.end()) {
+    return it->second;
+  }
+
+  static constexpr const char* kNameParts[] = {
+      "Photo", "Sound", "Text", "Code", "Map", "Note", "Mail", "Chat", "Paint", "Video",
+      "Disk", "Net", "Task", "Game", "Star", "Music", "Book", "File", "Cloud", "Web"};
+  static constexpr const char* kKindParts[] = {
+      "Studio", "Editor", "Viewer", "Manager", "Player", "Browser", "Monitor", "Tool", "Works",
+      "Lab", "Box", "Craft", "Center", "Shell", "Pad", "Reader", "Sync", "Maker", "Hub",
+      "Explorer"};
+  std::mt19937 random(numFiles);
+  Tree tree;
+  tree.root = std::make_unique<QTemporaryDir>();
+  for (const char* dir : {"user/applications", "flatpak/exports/share/applications",
+                          "usr/share/applications"}) {
+    tree.entryDirs.append(tree.root->path() + "/" + dir);
+    QDir().mkpath(tree.entryDirs.back());
+  }
+  std::vector<QString> systemFiles;
+  for (int i = 0; i < numFiles; ++i) {
+    const QString kind = kKindParts[(i / std::size(kNameParts)) % std::size(kKindParts)];
+    QString name = kNameParts[i % std::size(kNameParts)] + kind;
+    const int repeat = i / (std::size(kNameParts) * std::size(kKindParts));
+    if (repeat > 0) {
+      name += QString::number(repeat);
+    }
+    // Mostly system packages, some Flatpaks and a few user entries, half of which
+    // override system ones.
+    const int where = random() % 100;
+    QString appId = (random() % 10 < 4) ? "org.example." + name : name.toLower();
+    QString dir = tree.entryDirs[2];
+    if (where < 3 && !systemFiles.empty()) {
+      dir = tree.entryDirs[0];
+      if (random() % 2 == 0) {
+        appId = systemFiles[random() % systemFiles.size()];
+      }
+    } else if (where < 15) {
+      dir = tree.entryDirs[1];
+      appId = "io.flatpak." + name;
+    } else {
+      systemFiles.push_back(appId);
+    }
+    const QString path = dir + "/" + appId + ".desktop";
+    writeDesktopFile(path, appId, name, &random);
+    if (i == numFiles / 2) {
+      tree.changingFile = path;
+    }
+
+    if (i % std::max(1, numFiles / 1000) == 0) {
+      tree.appIds.push_back(appId.toLower().toStdString());
+      const std::string windowAppId = (random() % 2 == 0) ? name.toStdString()
+          : "org.example." + name.toLower().toStdString();
+      tree.windowAppIds.push_back(windowAppId);
+      // Windows without desktop files, e.g. scripts and games.
+      tree.appIds.push_back("unknown-" + std::to_string(i));
+      tree.windowAppIds.push_back("Unknown" + std::to_string(i));
+    }
+  }
+  tree.queries = {"photo studio", "sond plyer", "editor", "code3", "xyzzy"};
+  return trees_.emplace(numFiles, std::move(tree)).first->second;
+}
+
+/* static */ void ApplicationMenuConfigBenchmark::writeDesktopFile(
+    const QString& path, const QString& appId, const QString& name, std::mt19937* random) {
+  static constexpr const char* kCategories[] = {
+      "Utility", "Utility", "Utility", "Development", "Development", "Network", "Network",
+      "AudioVideo", "AudioVideo", "Game", "Game", "Graphics", "Office", "Education",
+      "Science", "Settings", "System", "System"};
+  static constexpr const char* kAdditionalCategories[] = {
+      "GTK", "Qt", "KDE", "GNOME", "TextEditor", "WebBrowser", "Player", "Viewer", "Monitor",
+      "FileManager", "TerminalEmulator", "RasterGraphics", "Chat", "Email", "Database"};
+  static constexpr const char* kLocales[] = {
+      "de", "fr", "es", "it", "ja", "zh_CN", "pt_BR", "ru", "pl", "nl", "sv", "cs", "ko", "tr",
+      "uk", "fi", "da", "nb", "hu", "el", "ca", "ro", "sk", "sl", "hr", "bg", "lt", "lv", "et",
+      "he", "ar", "vi", "id", "th", "eu", "gl", "sr", "zh_TW", "pt", "en_GB"};
+  auto percent = [random] { return (*random)() % 100; };
+
+  // 40% untranslated, 30% partially and 30% fully translated.
+  const int translation = percent();
+  const size_t numLocales = (translation < 40) ? 0
+      : (translation < 70) ? 5 + (*random)() % 10 : std::size(kLocales);
+  const QByteArray genericName = (QString(kCategories[(*random)() % std::size(kCategories)])
+      + " Application").toUtf8();
+  auto localized = [&](const char* key, const QByteArray& value) {
+    QByteArray lines = QByteArray(key) + "=" + value + "\n";
+    for (size_t i = 0; i < numLocales; ++i) {
+      lines += QByteArray(key) + "[" + kLocales[i] + "]=" + value + " (" + kLocales[i] + ")\n";
+    }
+    return lines;
+  };
+
+  QByteArray data = "[Desktop Entry]\nType=Application\nVersion=1.0\n";
+  data += localized("Name", name.toUtf8());
+  data += localized("GenericName", genericName);
+  data += localized("Comment", "Use " + name.toUtf8() + " on your desktop");
+  data += localized("Keywords", name.toLower().toUtf8() + ";" + genericName.toLower() + ";");
+  data += "Icon=" + appId.toUtf8() + "\n";
+  data += "Exec=/usr/bin/" + name.toLower().toUtf8() + " %U\n";
+  data += "Terminal=false\n";
+  // 5% uncategorized, the rest with a main category and up to 2 additional ones.
+  if (percent() >= 5) {
+    data += "Categories=";
+    data += kCategories[(*random)() % std::size(kCategories)];
+    for (unsigned i = (*random)() % 3; i > 0; --i) {
+      data += ";";
+      data += kAdditionalCategories[(*random)() % std::size(kAdditionalCategories)];
+    }
+    data += ";\n";
+  }
+  const int show = percent();
+  if (show < 8) {
+    data += (show < 4) ? "OnlyShowIn=KDE;\n" : "OnlyShowIn=GNOME;XFCE;\n";
+  } else if (show < 10) {
+    data += "NotShowIn=generic;\n";
+  } else if (show < 12) {
+    data += "OnlyShowIn=generic;\n";
+  }
+  const int visibility = percent();
+  if (visibility < 10) {
+    // E.g. MIME handlers.
+    data += "NoDisplay=true\n";
+  } else if (visibility < 11) {
+    data += "Hidden=true\n";
+  }
+  if (percent() < 30) {
+    data += "StartupWMClass=" + name.toUtf8() + "\n";
+  }
+  if (percent() < 30) {
+    data += "MimeType=image/png;image/jpeg;image/gif;image/webp;text/plain;text/html;"
+            "application/pdf;application/zip;video/mp4;audio/mpeg;\n";
+  }
+  if (percent() < 20) {
+    data += "Actions=new-window;\n\n[Desktop Action new-window]\n";
+    data += localized("Name", "New Window");
+    data += "Exec=/usr/bin/" + name.toLower().toUtf8() + " --new-window\n";
+  }
+
+  QFile file(path);
+  if (file.open(QIODevice::WriteOnly)) {
+    file.write(data);
+  }
+}
+
+void ApplicationMenuConfigBenchmark::load() {
+  QFETCH(int, numFiles);
+  const Tree& files = tree(numFiles);
+  QBENCHMARK {
+    ApplicationMenuConfig config(session(files));
+  }
+}
+
+void ApplicationMenuConfigBenchmark::loadSnapshot() {
+  QFETCH(int, numFiles);
+  const Tree& files = tree(numFiles);
+  const QString snapshotFile = configDir_.path() + QString("/snapshot-%1").arg(numFiles);
+  {
+    // Saves the snapshot.
+    ApplicationMenuConfig saving(session(files), snapshotFile);
+  }
+  QBENCHMARK {
+    ApplicationMenuConfig config(session(files), snapshotFile);
+  }
+}
+
+void ApplicationMenuConfigBenchmark::reload() {
+  QFETCH(int, numFiles);
+  ApplicationMenuConfig config(session(tree(numFiles)));
+  QBENCHMARK {
+    config.reload();
+  }
+}
+
+void ApplicationMenuConfigBenchmark::reloadOneChanged() {
+  QFETCH(int, numFiles);
+  const Tree& files = tree(numFiles);
+  ApplicationMenuConfig config(session(files));
+  QFile file(files.changingFile);
+  QVERIFY(file.open(QIODevice::ReadWrite));
+  QDateTime modificationTime = file.fileTime(QFileDevice::FileModificationTime);
+  QBENCHMARK {
+    modificationTime = modificationTime.addSecs(1);
+    file.setFileTime(modificationTime, QFileDevice::FileModificationTime);
+    config.reload();
+  }
+}
+
+void ApplicationMenuConfigBenchmark::findApplication() {
+  QFETCH(int, numFiles);
+  const Tree& files = tree(numFiles);
+  ApplicationMenuConfig config(session(files));
+  QBENCHMARK {
+    for (const auto& appId : files.appIds) {
+      config.findApplication(appId);
+    }
+  }
+}
+
+void ApplicationMenuConfigBenchmark::tryMatchingApplicationId() {
+  QFETCH(int, numFiles);
+  const Tree& files = tree(numFiles);
+  ApplicationMenuConfig config(session(files));
+  QBENCHMARK {
+    resolveAll(config, files);
+  }
+}
+
+void ApplicationMenuConfigBenchmark::searchApplications() {
+  QFETCH(int, numFiles);
+  const Tree& files = tree(numFiles);
+  ApplicationMenuConfig config(session(files));
+  double slowest = 0;
+  QBENCHMARK {
+    slowest = std::max(slowest, typeQueries(config, files));
+  }
+  qInfo("slowest keystroke: %.2f ms", slowest);
+}
+
+void ApplicationMenuConfigBenchmark::memoryUsage() {
+  QFETCH(int, numFiles);
+  const Tree& files = tree(numFiles);
+  if (procStatusKb("VmRSS") < 0) {
+    QSKIP("/proc/self/status is not available");
+  }
+  const qint64 bytes = loadedBytes(files);
+  qInfo("loaded: %lld kB, %lld bytes per file, peak RSS: %lld kB", bytes / 1024,
+        bytes / numFiles, procStatusKb("VmHWM"));
+  QTest::setBenchmarkResult(bytes, QTest::BytesAllocated);
+}
+
+void ApplicationMenuConfigBenchmark::budgets() {
+  const Tree& files = tree(kBudgetNumFiles);
+  const QString snapshotFile = configDir_.path() + "/budget-snapshot";
+  ApplicationMenuConfig config(session(files), snapshotFile);
+
+  const double loadMs = bestOfMs([&] { ApplicationMenuConfig loading(session(files)); });
+  const double snapshotLoadMs =
+      bestOfMs([&] { ApplicationMenuConfig loading(session(files), snapshotFile); });
+  const double reloadMs = bestOfMs([&] { config.reload(); });
+  const double lookupsMs = bestOfMs([&] { resolveAll(config, files); });
+  const double keystrokeMs = typeQueries(config, files);
+  qInfo("load %.1f ms, snapshot load %.1f ms, reload %.1f ms, lookups %.1f ms, "
+        "keystroke %.2f ms", loadMs, snapshotLoadMs, reloadMs, lookupsMs, keystrokeMs);
+  QVERIFY2(loadMs < kMaxLoadMs, qPrintable(QString("load %1 ms").arg(loadMs)));
+  QVERIFY2(snapshotLoadMs < kMaxSnapshotLoadMs,
+           qPrintable(QString("snapshot load %1 ms").arg(snapshotLoadMs)));
+  QVERIFY2(reloadMs < kMaxReloadMs, qPrintable(QString("reload %1 ms").arg(reloadMs)));
+  QVERIFY2(lookupsMs < kMaxLookupsMs, qPrintable(QString("lookups %1 ms").arg(lookupsMs)));
+  QVERIFY2(keystrokeMs < kMaxKeystrokeMs,
+           qPrintable(QString("keystroke %1 ms").arg(keystrokeMs)));
+
+  if (procStatusKb("VmRSS") >= 0) {
+    const qint64 bytesPerEntry = loadedBytes(files) / kBudgetNumFiles;
+    QVERIFY2(bytesPerEntry < kMaxBytesPerEntry,
+             qPrintable(QString("%1 bytes per entry").arg(bytesPerEntry)));
+  }
+}
+
+}  // namespace crystaldock
+
+QTEST_MAIN(crystaldock::ApplicationMenuConfigBenchmark)
+#include "application_menu_config_benchmark.moc"
@@ -20,6 +20,8 @@
 
 #include <unordered_map>
 
+#include <QFile>
+#include <QSignalSpy>
 #include <QString>
 #include <QTemporaryDir>
 #include <QTest>
@@ -40,6 +42,9 @@ class ApplicationMenuConfigTest: public QObject {
   void loadEntries_singleDir();
   void loadEntries_multipleDirs();
   void tryMatchingApplicationId();
+  void tryMatchingApplicationId_reload();
+  void reload_entriesChanged();
+  void searchApplications();
 
  private:
 
@@ -65,6 +70,8 @@ class ApplicationMenuConfigTest: public QObject {
         desktopFile.setNotShowIn(QString::fromStdString(entry.second));
       } else if (entry.first == "StartupWMClass") {
         desktopFile.setWMClass(QString::fromStdString(entry.second));
+      } else if (entry.first == "Keywords") {
+        desktopFile.setKeywords(QString::fromStdString(entry.second));
       }
     }
     desktopFile.write(filename);
@@ -84,9 +91,9 @@ void ApplicationMenuConfigTest::loadEntries_singleDir() {
 
   for (const auto& category : config.categories_) {
     if (category.name == "Network") {
-      QCOMPARE(static_cast<int>(category.entries.size()), 1);
+      QCOMPARE(static_cast<int>(category.entries().size()), 1);
     } else {
-      QCOMPARE(static_cast<int>(category.entries.size()), 0);
+      QCOMPARE(static_cast<int>(category.entries().size()), 0);
     }
   }
 }
@@ -141,19 +148,19 @@ void ApplicationMenuConfigTest::loadEntries_multipleDirs() {
   QCOMPARE(config.entries_.size(), 8);
   int numHidden = 0;
   for (const auto& pair : config.entries_) {
-    if (pair.second->hidden) { numHidden++; }
+    if (config.entry(pair.second).hidden) { numHidden++; }
   }
   QCOMPARE(numHidden, 4);
 
   for (const auto& category : config.categories_) {
     if (category.name == "Network") {
-      QCOMPARE(static_cast<int>(category.entries.size()), 4);
+      QCOMPARE(static_cast<int>(category.entries().size()), 4);
     } else if (category.name == "Settings") {
-      QCOMPARE(static_cast<int>(category.entries.size()), 3);
+      QCOMPARE(static_cast<int>(category.entries().size()), 3);
     } else if (category.name == "System") {
-      QCOMPARE(static_cast<int>(category.entries.size()), 1);
+      QCOMPARE(static_cast<int>(category.entries().size()), 1);
     } else {
-      QCOMPARE(static_cast<int>(category.entries.size()), 0);
+      QCOMPARE(static_cast<int>(category.entries().size()), 0);
     }
   }
 }
@@ -234,6 +241,96 @@ void ApplicationMenuConfigTest::tryMatchingApplicationId() {
            "sonic unleashed shortcut");
 }
 
+void ApplicationMenuConfigTest::tryMatchingApplicationId_reload() {
+  QTemporaryDir entryDir;
+  QVERIFY(entryDir.isValid());
+
+  ApplicationMenuConfig config({ entryDir.path() });
+
+  QVERIFY(!config.tryMatchingApplicationId("firefox"));
+
+  writeEntry(entryDir.path() + "/firefox.desktop",
+             {"firefox", "Firefox", "Web Browser",
+              "firefox", "firefox", ""},
+             "Network");
+  // The cached failed match is still returned until the config is reloaded.
+  QVERIFY(!config.tryMatchingApplicationId("firefox"));
+  config.reload();
+  QVERIFY(config.tryMatchingApplicationId("firefox"));
+  QCOMPARE(config.tryMatchingApplicationId("firefox")->appId, "firefox");
+}
+
+void ApplicationMenuConfigTest::reload_entriesChanged() {
+  QTemporaryDir entryDir;
+  QVERIFY(entryDir.isValid());
+  writeEntry(entryDir.path() + "/firefox.desktop",
+             {"firefox", "Firefox", "Web Browser", "firefox", "firefox", ""},
+             "Network");
+
+  ApplicationMenuConfig config({ entryDir.path() });
+  QSignalSpy spy(&config, &ApplicationMenuConfig::entriesChanged);
+
+  // Nothing has changed.
+  config.reload();
+  QCOMPARE(spy.count(), 0);
+  QVERIFY(config.findApplication("firefox"));
+
+  writeEntry(entryDir.path() + "/konsole.desktop",
+             {"konsole", "Konsole", "Terminal", "konsole", "konsole", ""},
+             "System");
+  QVERIFY(QFile::remove(entryDir.path() + "/firefox.desktop"));
+  config.reload();
+  QCOMPARE(spy.count(), 1);
+  QCOMPARE(spy[0][0].toStringList(), QStringList{"konsole"});
+  QCOMPARE(spy[0][1].toStringList(), QStringList{"firefox"});
+  QVERIFY(config.findApplication("konsole"));
+  QVERIFY(!config.findApplication("firefox"));
+}
+
+void ApplicationMenuConfigTest::searchApplications() {
+  QTemporaryDir entryDir;
+  QVERIFY(entryDir.isValid());
+  writeEntry(entryDir.path() + "/chrome.desktop",
+             {"chrome", "Chrome", "Web Browser", "chrome", "chrome", ""},
+             "Network");
+  writeEntry(entryDir.path() + "/firefox.desktop",
+             {"firefox", "Firefox", "Web Browser", "firefox", "firefox", ""},
+             "Network");
+  writeEntry(entryDir.path() + "/konsole.desktop",
+             {"konsole", "Konsole", "Terminal", "konsole", "konsole", ""},
+             "System", {{"Keywords", "shell;prompt;"}});
+  writeEntry(entryDir.path() + "/kate.desktop",
+             {"kate", "Kate", "Text Editor", "kate", "kate", ""},
+             "Development");
+
+  ApplicationMenuConfig config({ entryDir.path() });
+
+  auto results = config.searchApplications("fire", 10);
+  QCOMPARE(results.size(), 1);
+  QCOMPARE(results[0].appId, "firefox");
+
+  // Typo tolerance.
+  results = config.searchApplications("firefx", 10);
+  QCOMPARE(results.size(), 1);
+  QCOMPARE(results[0].appId, "firefox");
+
+  // Ties are sorted by name.
+  results = config.searchApplications("browser", 10);
+  QCOMPARE(results.size(), 2);
+  QCOMPARE(results[0].appId, "chrome");
+  QCOMPARE(results[1].appId, "firefox");
+
+  // Keywords.
+  results = config.searchApplications("shell", 10);
+  QCOMPARE(results.size(), 1);
+  QCOMPARE(results[0].appId, "konsole");
+
+  // Name matches rank above generic name matches, and only the best N are returned.
+  results = config.searchApplications("k", 1);
+  QCOMPARE(results.size(), 1);
+  QCOMPARE(results[0].appId, "kate");
+}
+
 }  // namespace crystaldock
 
 QTEST_MAIN(crystaldock::ApplicationMenuConfigTest)
@@ -19,7 +19,11 @@
 #ifndef CRYSTALDOCK_APPLICATION_MENU_ENTRY_H_
 #define CRYSTALDOCK_APPLICATION_MENU_ENTRY_H_
 
-#include <list>
+#include <cstdint>
+#include <memory>
+#include <ranges>
+#include <utility>
+#include <vector>
 
 #include <QString>
 
@@ -48,6 +52,13 @@ struct ApplicationEntry {
   // If it's hidden, it won't show on the Application Menu.
   bool hidden;
 
+  // Bits of the categories the entry is in, by index in ApplicationMenuConfig::categories().
+  uint32_t categories = 0;
+
+  // Bits of the desktops in OnlyShowIn / NotShowIn, see ApplicationMenuConfig::DesktopBits.
+  uint8_t onlyShowIn = 0;
+  uint8_t notShowIn = 0;
+
   ApplicationEntry(const QString& appId2, const QString& name2, const QString& genericName2,
                    const QString& icon2, const QString& command2,
                    const QString& desktopFile2, bool hidden2 = false)
@@ -56,7 +67,7 @@ struct ApplicationEntry {
 };
 
 inline bool operator<(const ApplicationEntry &e1, const ApplicationEntry &e2) {
-  return e1.name.toLower() < e2.name.toLower();
+  return QString::compare(e1.name, e2.name, Qt::CaseInsensitive) < 0;
 }
 
 // A category in the application menu.
@@ -71,16 +82,29 @@ struct Category {
   // Icon name for the category e.g. 'applications-internet'.
   QString icon;
 
-  // Application entries for this category.
-  std::list<ApplicationEntry> entries;
+  // The entries of this category are these entries of the arena, in this order. The
+  // arena is shared by all the categories of the application menu.
+  std::shared_ptr<const std::vector<ApplicationEntry>> arena;
+  std::vector<uint32_t> entryIndices;
 
   Category(const QString& name2, const QString& displayName2,
            const QString& icon2)
       : name(name2), displayName(displayName2), icon(icon2) {}
 
+  // With an arena of its own, e.g. for the system categories.
   Category(const QString& name2, const QString& displayName2,
-           const QString& icon2, std::list<ApplicationEntry> entries2)
-      : name(name2), displayName(displayName2), icon(icon2), entries(entries2) {
+           const QString& icon2, std::vector<ApplicationEntry> entries2)
+      : name(name2), displayName(displayName2), icon(icon2),
+        arena(std::make_shared<const std::vector<ApplicationEntry>>(std::move(entries2))) {
+    for (uint32_t i = 0; i < arena->size(); ++i) {
+      entryIndices.push_back(i);
+    }
+  }
+
+  // Application entries for this category.
+  auto entries() const {
+    return entryIndices | std::views::transform(
+        [arena = arena.get()](uint32_t i) -> const ApplicationEntry& { return (*arena)[i]; });
   }
 };
 
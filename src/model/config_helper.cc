@@ -21,16 +21,14 @@
 #include <QFile>
 #include <QStringList>
 
-#include "desktop/desktop_env.h"
-
 namespace crystaldock {
 
+constexpr char ConfigHelper::kConfigStore[];
 constexpr char ConfigHelper::kConfigPattern[];
 constexpr char ConfigHelper::kAppearanceConfig[];
 
-// Creates a seperate config dir for each desktop environment.
 ConfigHelper::ConfigHelper(const QString& configDir)
-    : configDir_{configDir + "/" + DesktopEnv::getDesktopEnvName()} {
+    : configDir_{configDir} {
   if (!configDir_.exists()) {
     QDir::root().mkpath(configDir_.path());
   }
@@ -51,12 +49,4 @@ std::vector<QString> ConfigHelper::findAllDockConfigs() const {
   return allConfigs;
 }
 
-QString ConfigHelper::findNextDockConfig() const {
-  for (int fileId = 1; ; ++fileId) {
-    if (!configDir_.exists(dockConfigFile(fileId))) {
-      return dockConfigPath(fileId);
-    }
-  }
-}
-
 }  // namespace crystaldock
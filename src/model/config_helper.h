@@ -28,44 +28,70 @@ namespace crystaldock {
 // Helper class for working with configurations.
 class ConfigHelper  {
  public:
-  // Individual dock configs.
+  // All configs, see ConfigStore.
+  static constexpr char kConfigStore[] = "config.json";
+
+  // Individual dock configs of older versions, migrated to the config store.
   static constexpr char kConfigPattern[] = "panel_*.conf";
 
-  // Global appearance config.
+  // Global appearance config of older versions, migrated to the config store.
   static constexpr char kAppearanceConfig[] = "appearance.conf";
 
+  // Persistent icon cache.
+  static constexpr char kIconCacheDir[] = "icon-cache";
+
+  // Persistent cache of wallpaper thumbnails for the pager.
+  static constexpr char kThumbnailCacheDir[] = "thumbnail-cache";
+
+  // Snapshot of the parsed application menu.
+  static constexpr char kApplicationMenuSnapshot[] = "application-menu.cache";
+
+  // User-defined app ID aliases, see ApplicationMenuConfig::tryMatchingApplicationId().
+  static constexpr char kAppIdAliases[] = "app-id-aliases.conf";
+
+  // The config dir of the desktop environment, see SessionContext::configDir.
   explicit ConfigHelper(const QString& configDir);
   ~ConfigHelper() = default;
 
-  // Gets the appearance config file path.
+  QString configStorePath() const {
+    return configDir_.filePath(kConfigStore);
+  }
+
+  // Gets the appearance config file path of older versions.
   QString appearanceConfigPath() const {
     return configDir_.filePath(kAppearanceConfig);
   }
 
+  // Gets the directory for the persistent icon cache.
+  QString iconCacheDir() const {
+    return configDir_.filePath(kIconCacheDir);
+  }
+
+  QString thumbnailCacheDir() const {
+    return configDir_.filePath(kThumbnailCacheDir);
+  }
+
+  // Gets the path of the snapshot of the parsed application menu.
+  QString applicationMenuSnapshotPath() const {
+    return configDir_.filePath(kApplicationMenuSnapshot);
+  }
+
+  // Gets the path of the user-defined app ID aliases.
+  QString appIdAliasesPath() const {
+    return configDir_.filePath(kAppIdAliases);
+  }
+
   static QString wallpaperConfigKey(std::string_view desktopId, int screen) {
     // Screen is 0-based.
     return QString("wallpaper") + QString::fromStdString(std::string(desktopId)) +
         ((screen == 0) ? "" : (QString("_") + QString::number(screen + 1)));
   }
 
-  // Finds the configs of all existing docks.
+  // Finds the dock configs of older versions.
   // Returns a list of dock config paths.
   std::vector<QString> findAllDockConfigs() const;
 
-  // Finds the next available configs for a new dock.
-  QString findNextDockConfig() const;
-
  private:
-  // Gets the config file name of a dock.
-  static QString dockConfigFile(int fileId) {
-    return QString("panel_") + QString::number(fileId) + ".conf";
-  }
-
-  // Gets the config file path of a dock.
-  QString dockConfigPath(int fileId) const {
-    return configDir_.filePath(dockConfigFile(fileId));
-  }
-
   QString dockConfigPath(QString configFile) const {
     return configDir_.filePath(configFile);
   }
@@ -0,0 +1,146 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "config_store.h"
+
+#include <iostream>
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSettings>
+#include <QVariantList>
+
+#include <utils/config_writer.h>
+
+namespace crystaldock {
+
+namespace {
+
+constexpr char kVersionKey[] = "version";
+constexpr char kAppearanceKey[] = "appearance";
+constexpr char kDocksKey[] = "docks";
+constexpr char kInvalidSuffix[] = ".invalid";
+
+}  // namespace
+
+bool ConfigStore::load(ConfigValues* values) {
+  QFile file(path_);
+  if (!file.exists()) {
+    *values = migrate();
+    save(*values);
+    return true;
+  }
+
+  if (!file.open(QIODevice::ReadOnly)) {
+    std::cerr << "Could not read config file: " << path_.toStdString()
+              << ", config changes won't be saved" << std::endl;
+    readOnly_ = true;
+    return false;
+  }
+  QJsonParseError error;
+  const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &error);
+  if (!document.isObject()) {
+    // Kept aside rather than overwritten, so that it can be fixed by hand.
+    std::cerr << "Invalid config file: " << path_.toStdString() << ": "
+              << error.errorString().toStdString() << std::endl;
+    file.close();
+    QFile::remove(path_ + kInvalidSuffix);
+    if (!QFile::rename(path_, path_ + kInvalidSuffix)) {
+      std::cerr << "Could not back up config file: " << path_.toStdString()
+                << ", config changes won't be saved" << std::endl;
+      readOnly_ = true;
+      return false;
+    }
+    *values = migrate();
+    save(*values);
+    return true;
+  }
+
+  const QVariantMap root = document.object().toVariantMap();
+  const int version = root.value(kVersionKey).toInt();
+  if (version > kVersion) {
+    std::cerr << "Config file " << path_.toStdString() << " is of a newer version ("
+              << version << "), some settings may be ignored" << std::endl;
+  }
+  // Upgrades from older schema versions go here.
+
+  values->appearance = root.value(kAppearanceKey).toMap();
+  values->docks.clear();
+  for (const auto& dock : root.value(kDocksKey).toList()) {
+    values->docks.push_back(dock.toMap());
+  }
+  return true;
+}
+
+void ConfigStore::save(const ConfigValues& values) const {
+  if (readOnly_) {
+    return;
+  }
+
+  QVariantList docks;
+  docks.reserve(values.docks.size());
+  for (const auto& dock : values.docks) {
+    docks.push_back(dock);
+  }
+  ConfigWriter::self()->schedule(path_, QVariantMap{
+      {kVersionKey, kVersion},
+      {kAppearanceKey, values.appearance},
+      {kDocksKey, docks}});
+}
+
+ConfigValues ConfigStore::migrate() const {
+  ConfigValues values;
+  if (QFile::exists(configHelper_.appearanceConfigPath())) {
+    values.appearance = readIni(configHelper_.appearanceConfigPath());
+  }
+  for (const auto& path : configHelper_.findAllDockConfigs()) {
+    values.docks.push_back(readIni(path));
+  }
+  return values;
+}
+
+/* static */ QVariantMap ConfigStore::readIni(const QString& path) {
+  QVariantMap values;
+  QSettings settings(path, QSettings::IniFormat);
+  for (const auto& key : settings.allKeys()) {
+    values[key] = typed(settings.value(key));
+  }
+  return values;
+}
+
+/* static */ QVariant ConfigStore::typed(const QVariant& value) {
+  if (value.typeId() != QMetaType::QString) {
+    return value;
+  }
+
+  const QString string = value.toString();
+  if (string == "true" || string == "false") {
+    return string == "true";
+  }
+  bool ok = false;
+  const int number = string.toInt(&ok);
+  // Only if it converts back as is, e.g. not "007".
+  if (ok && QString::number(number) == string) {
+    return number;
+  }
+  return value;
+}
+
+}  // namespace crystaldock
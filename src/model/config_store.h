@@ -0,0 +1,81 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CRYSTALDOCK_CONFIG_STORE_H_
+#define CRYSTALDOCK_CONFIG_STORE_H_
+
+#include <vector>
+
+#include <QString>
+#include <QVariant>
+#include <QVariantMap>
+
+#include "config_helper.h"
+
+namespace crystaldock {
+
+// The values of all configs. Keys are in the form "[group/]name", as with QSettings.
+struct ConfigValues {
+  QVariantMap appearance;
+  // In dock order.
+  std::vector<QVariantMap> docks;
+};
+
+// All configs in a single JSON file, read in one go:
+//
+//   {"version": 1, "appearance": {...}, "docks": [{...}, ...]}
+//
+// Unlike INI files, the values keep their types (bools, numbers, strings). Writes go through
+// ConfigWriter, off the GUI thread, and replace the file atomically.
+class ConfigStore {
+ public:
+  // The schema version. Files of older versions are upgraded when loaded.
+  static constexpr int kVersion = 1;
+
+  explicit ConfigStore(const ConfigHelper& configHelper)
+      : configHelper_(configHelper), path_(configHelper.configStorePath()) {}
+
+  // Reads the store file. If there's none yet, i.e. on the first run after upgrading from an
+  // older version, migrates the INI configs instead and writes them to the store file.
+  // Returns false if the store file exists but can't be read or set aside, in which case
+  // the store becomes read-only so that the file isn't replaced by the defaults.
+  bool load(ConfigValues* values);
+
+  // Schedules writing the values to the store file, unless the store is read-only.
+  void save(const ConfigValues& values) const;
+
+  bool readOnly() const { return readOnly_; }
+
+ private:
+  // Reads appearance.conf and the panel_*.conf files, leaving them as they are.
+  ConfigValues migrate() const;
+
+  static QVariantMap readIni(const QString& path);
+
+  // The value of an INI file with its type, all of them being read as strings.
+  static QVariant typed(const QVariant& value);
+
+  const ConfigHelper& configHelper_;
+  const QString path_;
+  bool readOnly_ = false;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_CONFIG_STORE_H_
@@ -0,0 +1,406 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "dock_control_service.h"
+
+#include <iostream>
+
+#include <QColor>
+#include <QDBusConnection>
+#include <QVariant>
+
+#include "display/window_system.h"
+#include <utils/runtime_metrics.h>
+
+namespace crystaldock {
+
+namespace {
+
+// Applies a change as a single transaction, unless it is part of the caller's.
+class ScopedTransaction {
+ public:
+  explicit ScopedTransaction(MultiDockModel* model) : model_(model) {
+    model_->beginTransaction();
+  }
+
+  ~ScopedTransaction() { model_->commitTransaction(); }
+
+  ScopedTransaction(const ScopedTransaction&) = delete;
+  ScopedTransaction& operator=(const ScopedTransaction&) = delete;
+
+ private:
+  MultiDockModel* model_;
+};
+
+bool toInt(const QVariant& value, int min, int max, int* result) {
+  bool ok = false;
+  *result = value.toInt(&ok);
+  return ok && *result >= min && *result <= max;
+}
+
+bool toFloat(const QVariant& value, float min, float max, float* result) {
+  bool ok = false;
+  *result = value.toFloat(&ok);
+  return ok && *result >= min && *result <= max;
+}
+
+// Also accepts "true"/"false"/"1"/"0", as e.g. qdbus sends variants as strings.
+bool toBool(const QVariant& value, bool* result) {
+  if (value.typeId() == QMetaType::Bool) {
+    *result = value.toBool();
+    return true;
+  }
+  const QString text = value.toString();
+  if (text == "true" || text == "1") {
+    *result = true;
+    return true;
+  }
+  if (text == "false" || text == "0") {
+    *result = false;
+    return true;
+  }
+  return false;
+}
+
+bool toColor(const QVariant& value, QColor* result) {
+  *result = QColor(value.toString());
+  return result->isValid();
+}
+
+template <auto kSetter, int kMin, int kMax>
+bool setInt(MultiDockModel* model, const QVariant& value) {
+  int x;
+  if (!toInt(value, kMin, kMax, &x)) {
+    return false;
+  }
+  (model->*kSetter)(x);
+  return true;
+}
+
+template <auto kSetter, typename Enum, int kCount>
+bool setEnum(MultiDockModel* model, const QVariant& value) {
+  int x;
+  if (!toInt(value, 0, kCount - 1, &x)) {
+    return false;
+  }
+  (model->*kSetter)(static_cast<Enum>(x));
+  return true;
+}
+
+template <auto kSetter>
+bool setFactor(MultiDockModel* model, const QVariant& value) {
+  float x;
+  if (!toFloat(value, 0.0, 1.0, &x)) {
+    return false;
+  }
+  (model->*kSetter)(x);
+  return true;
+}
+
+template <auto kSetter>
+bool setBool(MultiDockModel* model, const QVariant& value) {
+  bool x;
+  if (!toBool(value, &x)) {
+    return false;
+  }
+  (model->*kSetter)(x);
+  return true;
+}
+
+template <auto kSetter>
+bool setColor(MultiDockModel* model, const QVariant& value) {
+  QColor x;
+  if (!toColor(value, &x)) {
+    return false;
+  }
+  (model->*kSetter)(x);
+  return true;
+}
+
+template <auto kSetter>
+bool setString(MultiDockModel* model, const QVariant& value) {
+  (model->*kSetter)(value.toString());
+  return true;
+}
+
+template <auto kSetter>
+bool setDockBool(MultiDockModel* model, int dockId, const QVariant& value) {
+  bool x;
+  if (!toBool(value, &x)) {
+    return false;
+  }
+  (model->*kSetter)(dockId, x);
+  return true;
+}
+
+template <auto kSetter, typename Enum, int kCount>
+bool setDockEnum(MultiDockModel* model, int dockId, const QVariant& value) {
+  int x;
+  if (!toInt(value, 0, kCount - 1, &x)) {
+    return false;
+  }
+  (model->*kSetter)(dockId, static_cast<Enum>(x));
+  return true;
+}
+
+bool setDockScreen(MultiDockModel* model, int dockId, const QVariant& value) {
+  int x;
+  if (!toInt(value, 0, static_cast<int>(WindowSystem::screens().size()) - 1, &x)) {
+    return false;
+  }
+  model->setScreen(dockId, x);
+  return true;
+}
+
+struct AppearanceProperty {
+  const char* name;
+  // Returns false if the value is invalid.
+  bool (*set)(MultiDockModel* model, const QVariant& value);
+};
+
+struct DockProperty {
+  const char* name;
+  // Returns false if the value is invalid.
+  bool (*set)(MultiDockModel* model, int dockId, const QVariant& value);
+};
+
+using M = MultiDockModel;
+
+// The ranges are those of the settings dialogs.
+constexpr AppearanceProperty kAppearanceProperties[] = {
+  {"minimumIconSize", setInt<&M::setMinIconSize, 16, 64>},
+  {"maximumIconSize", setInt<&M::setMaxIconSize, 32, 192>},
+  {"spacingFactor", setFactor<&M::setSpacingFactor>},
+  {"backgroundColor", setColor<&M::setBackgroundColor>},
+  {"backgroundColor2D", setColor<&M::setBackgroundColor2D>},
+  {"backgroundColorMetal2D", setColor<&M::setBackgroundColorMetal2D>},
+  {"borderColor", setColor<&M::setBorderColor>},
+  {"borderColorMetal2D", setColor<&M::setBorderColorMetal2D>},
+  {"activeIndicatorColor", setColor<&M::setActiveIndicatorColor>},
+  {"activeIndicatorColor2D", setColor<&M::setActiveIndicatorColor2D>},
+  {"activeIndicatorColorMetal2D", setColor<&M::setActiveIndicatorColorMetal2D>},
+  {"inactiveIndicatorColor", setColor<&M::setInactiveIndicatorColor>},
+  {"inactiveIndicatorColor2D", setColor<&M::setInactiveIndicatorColor2D>},
+  {"inactiveIndicatorColorMetal2D", setColor<&M::setInactiveIndicatorColorMetal2D>},
+  {"showTooltip", setBool<&M::setShowTooltip>},
+  {"tooltipFontSize", setInt<&M::setTooltipFontSize, 8, 28>},
+  {"panelStyle", setEnum<&M::setPanelStyle, PanelStyle, 8>},
+  {"floatingMargin", setInt<&M::setFloatingMargin, 2, 32>},
+  {"bouncingLauncherIcon", setBool<&M::setBouncingLauncherIcon>},
+  {"zoomCurve", setEnum<&M::setZoomCurve, ZoomCurve, 3>},
+  {"lazyIconCache", setBool<&M::setLazyIconCache>},
+  {"warmReveal", setBool<&M::setWarmReveal>},
+  {"iconCacheSize", setInt<&M::setIconCacheSize, 1, 256>},
+  {"iconSizeBucket", setInt<&M::setIconSizeBucket, 1, 64>},
+  {"Application Menu/label", setString<&M::setApplicationMenuName>},
+  {"Application Menu/iconSize", setInt<&M::setApplicationMenuIconSize, 32, 64>},
+  {"Application Menu/fontSize", setInt<&M::setApplicationMenuFontSize, 10, 40>},
+  {"Application Menu/backgroundAlpha", setFactor<&M::setApplicationMenuBackgroundAlpha>},
+  {"Pager/showDesktopNumber", setBool<&M::setShowDesktopNumber>},
+  {"Pager/showWindows", setBool<&M::setShowPagerWindows>},
+  {"TaskManager/currentDesktopTasksOnly", setBool<&M::setCurrentDesktopTasksOnly>},
+  {"TaskManager/currentScreenTasksOnly", setBool<&M::setCurrentScreenTasksOnly>},
+  {"TaskManager/groupTasksByApplication", setBool<&M::setGroupTasksByApplication>},
+  {"Clock/use24HourClock", setBool<&M::setUse24HourClock>},
+  {"Clock/fontScaleFactor", setFactor<&M::setClockFontScaleFactor>},
+  {"Clock/clockFontFamily", setString<&M::setClockFontFamily>},
+};
+
+constexpr DockProperty kDockProperties[] = {
+  {"position", setDockEnum<&M::setPanelPosition, PanelPosition, 4>},
+  {"screen", setDockScreen},
+  {"visibility", setDockEnum<&M::setVisibility, PanelVisibility, 4>},
+  {"showApplicationMenu", setDockBool<&M::setShowApplicationMenu>},
+  {"showPager", setDockBool<&M::setShowPager>},
+  {"showTaskManager", setDockBool<&M::setShowTaskManager>},
+  {"showClock", setDockBool<&M::setShowClock>},
+  {"showTrash", setDockBool<&M::setShowTrash>},
+};
+
+}  // namespace
+
+DockControlService::DockControlService(MultiDockModel* model)
+    : model_(model) {
+  transactionOwnerWatcher_.setConnection(QDBusConnection::sessionBus());
+  transactionOwnerWatcher_.setWatchMode(QDBusServiceWatcher::WatchForUnregistration);
+  connect(&transactionOwnerWatcher_, SIGNAL(serviceUnregistered(const QString&)),
+          this, SLOT(onServiceUnregistered(const QString&)));
+}
+
+bool DockControlService::registerService() {
+  QDBusConnection bus = QDBusConnection::sessionBus();
+  if (!bus.registerObject(kObjectPath, this, QDBusConnection::ExportScriptableSlots)) {
+    std::cerr << "Failed to register the D-Bus control object." << std::endl;
+    return false;
+  }
+  if (!bus.registerService(kServiceName)) {
+    std::cerr << "Failed to register the D-Bus service " << kServiceName << std::endl;
+    return false;
+  }
+  return true;
+}
+
+QList<int> DockControlService::dockIds() const {
+  QList<int> ids;
+  for (const int dockId : model_->dockIds()) {
+    ids.append(dockId);
+  }
+  return ids;
+}
+
+bool DockControlService::beginTransaction() {
+  if (!transactionOwner_.isEmpty()) {
+    std::cerr << "A transaction is already open by " << transactionOwner_.toStdString()
+              << std::endl;
+    return false;
+  }
+  transactionOwner_ = calledFromDBus() ? message().service() : QString("local");
+  if (calledFromDBus()) {
+    transactionOwnerWatcher_.addWatchedService(transactionOwner_);
+  }
+  model_->beginTransaction();
+  return true;
+}
+
+bool DockControlService::commitTransaction() {
+  const QString caller = calledFromDBus() ? message().service() : QString("local");
+  if (transactionOwner_.isEmpty() || caller != transactionOwner_) {
+    std::cerr << "No transaction open by " << caller.toStdString() << std::endl;
+    return false;
+  }
+  transactionOwnerWatcher_.removeWatchedService(transactionOwner_);
+  transactionOwner_.clear();
+  model_->commitTransaction();
+  return true;
+}
+
+void DockControlService::onServiceUnregistered(const QString& service) {
+  if (service == transactionOwner_) {
+    std::cerr << "Committing the transaction of disconnected client "
+              << service.toStdString() << std::endl;
+    transactionOwnerWatcher_.removeWatchedService(transactionOwner_);
+    transactionOwner_.clear();
+    model_->commitTransaction();
+  }
+}
+
+int DockControlService::addDock(int position, int screen) {
+  if (!checkPlacement(position, screen)) {
+    return 0;
+  }
+  ScopedTransaction transaction(model_);
+  return model_->addDock(static_cast<PanelPosition>(position), screen,
+                         kDefaultShowApplicationMenu, kDefaultShowPager,
+                         kDefaultShowTaskManager, kDefaultShowClock);
+}
+
+int DockControlService::cloneDock(int dockId, int position, int screen) {
+  if (!checkDock(dockId) || !checkPlacement(position, screen)) {
+    return 0;
+  }
+  ScopedTransaction transaction(model_);
+  return model_->cloneDock(dockId, static_cast<PanelPosition>(position), screen);
+}
+
+bool DockControlService::removeDock(int dockId) {
+  if (!checkDock(dockId)) {
+    return false;
+  }
+  if (model_->dockCount() == 1) {
+    std::cerr << "The last dock cannot be removed." << std::endl;
+    return false;
+  }
+  model_->removeDock(dockId);
+  return true;
+}
+
+QStringList DockControlService::launchers(int dockId) const {
+  return checkDock(dockId) ? model_->launchers(dockId) : QStringList();
+}
+
+bool DockControlService::setLaunchers(int dockId, const QStringList& launchers) {
+  if (!checkDock(dockId)) {
+    return false;
+  }
+  ScopedTransaction transaction(model_);
+  model_->setLaunchers(dockId, launchers);
+  model_->saveDockConfig(dockId);
+  return true;
+}
+
+bool DockControlService::setDockProperty(int dockId, const QString& name,
+                                         const QDBusVariant& value) {
+  if (!checkDock(dockId)) {
+    return false;
+  }
+  for (const auto& property : kDockProperties) {
+    if (name == property.name) {
+      ScopedTransaction transaction(model_);
+      if (!property.set(model_, dockId, value.variant())) {
+        std::cerr << "Invalid value for dock property " << property.name << std::endl;
+        return false;
+      }
+      model_->saveDockConfig(dockId);
+      return true;
+    }
+  }
+  std::cerr << "Unknown dock property: " << name.toStdString() << std::endl;
+  return false;
+}
+
+bool DockControlService::setAppearanceProperty(const QString& name, const QDBusVariant& value) {
+  for (const auto& property : kAppearanceProperties) {
+    if (name == property.name) {
+      ScopedTransaction transaction(model_);
+      if (!property.set(model_, value.variant())) {
+        std::cerr << "Invalid value for appearance property " << property.name << std::endl;
+        return false;
+      }
+      model_->saveAppearanceConfig();
+      return true;
+    }
+  }
+  std::cerr << "Unknown appearance property: " << name.toStdString() << std::endl;
+  return false;
+}
+
+QString DockControlService::metrics() const {
+  return RuntimeMetrics::toJson();
+}
+
+bool DockControlService::checkDock(int dockId) const {
+  if (!model_->hasDock(dockId)) {
+    std::cerr << "No dock with ID " << dockId << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool DockControlService::checkPlacement(int position, int screen) const {
+  if (position < 0 || position > static_cast<int>(PanelPosition::Right)) {
+    std::cerr << "Invalid dock position: " << position << std::endl;
+    return false;
+  }
+  if (screen < 0 || screen >= static_cast<int>(WindowSystem::screens().size())) {
+    std::cerr << "Invalid screen: " << screen << std::endl;
+    return false;
+  }
+  return true;
+}
+
+}  // namespace crystaldock
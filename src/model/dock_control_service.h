@@ -0,0 +1,97 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CRYSTALDOCK_DOCK_CONTROL_SERVICE_H_
+#define CRYSTALDOCK_DOCK_CONTROL_SERVICE_H_
+
+#include <QDBusContext>
+#include <QDBusServiceWatcher>
+#include <QDBusVariant>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+#include "multi_dock_model.h"
+
+namespace crystaldock {
+
+// Scripting and monitoring interface to the docks on the session bus, e.g.
+//
+//   qdbus org.crystaldock.CrystalDock /Control org.crystaldock.Control.setLaunchers 1 \
+//       "firefox;org.kde.dolphin"
+//
+// The properties are named and valued as in the config files, enums being integers.
+//
+// Each call is applied on its own, unless the caller has opened a transaction with
+// beginTransaction(), in which case the changes are only written and shown on
+// commitTransaction(). Only one client can have a transaction open at a time, and it is
+// committed if the client disconnects without committing it.
+class DockControlService : public QObject, protected QDBusContext {
+  Q_OBJECT
+  Q_CLASSINFO("D-Bus Interface", "org.crystaldock.Control")
+
+ public:
+  // No pointer ownership.
+  explicit DockControlService(MultiDockModel* model);
+  ~DockControlService() = default;
+
+  // Registers the service on the session bus. Returns false on failure.
+  bool registerService();
+
+ public slots:
+  Q_SCRIPTABLE QList<int> dockIds() const;
+
+  Q_SCRIPTABLE bool beginTransaction();
+  Q_SCRIPTABLE bool commitTransaction();
+
+  // Return the new dock's ID, or 0 on failure.
+  Q_SCRIPTABLE int addDock(int position, int screen);
+  Q_SCRIPTABLE int cloneDock(int dockId, int position, int screen);
+
+  Q_SCRIPTABLE bool removeDock(int dockId);
+
+  Q_SCRIPTABLE QStringList launchers(int dockId) const;
+  Q_SCRIPTABLE bool setLaunchers(int dockId, const QStringList& launchers);
+
+  Q_SCRIPTABLE bool setDockProperty(int dockId, const QString& name, const QDBusVariant& value);
+  Q_SCRIPTABLE bool setAppearanceProperty(const QString& name, const QDBusVariant& value);
+
+  // The runtime metrics since start-up, as JSON.
+  Q_SCRIPTABLE QString metrics() const;
+
+ private slots:
+  void onServiceUnregistered(const QString& service);
+
+ private:
+  static constexpr char kServiceName[] = "org.crystaldock.CrystalDock";
+  static constexpr char kObjectPath[] = "/Control";
+
+  // Checks that the dock exists and the position and screen are valid.
+  bool checkDock(int dockId) const;
+  bool checkPlacement(int position, int screen) const;
+
+  MultiDockModel* model_;  // No ownership.
+  QDBusServiceWatcher transactionOwnerWatcher_;
+  // The bus name of the client with the open transaction, if any.
+  QString transactionOwner_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_DOCK_CONTROL_SERVICE_H_
@@ -0,0 +1,106 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "launcher_entry_watcher.h"
+
+#include <algorithm>
+
+#include <QDBusConnection>
+
+#include <utils/runtime_metrics.h>
+
+namespace crystaldock {
+
+/* static */ LauncherEntryWatcher* LauncherEntryWatcher::self() {
+  static LauncherEntryWatcher self;
+  return &self;
+}
+
+LauncherEntryWatcher::LauncherEntryWatcher() {
+  changesTimer_.setSingleShot(true);
+  changesTimer_.setInterval(kFrameIntervalMs);
+  connect(&changesTimer_, &QTimer::timeout, this, &LauncherEntryWatcher::emitChanges);
+  // From any sender and object path.
+  QDBusConnection::sessionBus().connect(
+      QString(), QString(), "com.canonical.Unity.LauncherEntry", "Update",
+      this, SLOT(onUpdate(QString, QVariantMap)));
+}
+
+const LauncherEntryWatcher::Entry& LauncherEntryWatcher::entry(const QString& appId) const {
+  static const Entry kNoEntry;
+  const auto it = entries_.constFind(appId.toLower());
+  return it != entries_.constEnd() ? *it : kNoEntry;
+}
+
+void LauncherEntryWatcher::onUpdate(const QString& appUri, const QVariantMap& properties) {
+  const QString appId = appIdFromUri(appUri);
+  if (appId.isEmpty()) {
+    return;
+  }
+
+  // Only the properties that have changed are sent.
+  Entry entry = this->entry(appId);
+  for (auto it = properties.constBegin(); it != properties.constEnd(); ++it) {
+    if (it.key() == "count") {
+      entry.count = it.value().toLongLong();
+    } else if (it.key() == "count-visible") {
+      entry.countVisible = it.value().toBool();
+    } else if (it.key() == "progress") {
+      entry.progress = std::clamp(it.value().toDouble(), 0.0, 1.0);
+    } else if (it.key() == "progress-visible") {
+      entry.progressVisible = it.value().toBool();
+    } else if (it.key() == "urgent") {
+      entry.urgent = it.value().toBool();
+    }
+  }
+  if (entry == this->entry(appId)) {
+    return;
+  }
+
+  entries_[appId] = entry;
+  if (changed_.contains(appId)) {
+    RuntimeMetrics::add(RuntimeMetrics::Counter::EventsCoalesced);
+  }
+  changed_.insert(appId);
+  if (!changesTimer_.isActive()) {
+    changesTimer_.start();
+  }
+}
+
+void LauncherEntryWatcher::emitChanges() {
+  const QStringList appIds(changed_.cbegin(), changed_.cend());
+  changed_.clear();
+  emit entriesChanged(appIds);
+}
+
+/* static */ QString LauncherEntryWatcher::appIdFromUri(const QString& appUri) {
+  const QLatin1String kScheme("application://");
+  const QLatin1String kExtension(".desktop");
+  QString appId = appUri;
+  if (appId.startsWith(kScheme)) {
+    appId.remove(0, kScheme.size());
+  }
+  if (appId.endsWith(kExtension)) {
+    appId.chop(kExtension.size());
+  }
+  // Like the app IDs of the desktop files, see DesktopFile.
+  return appId.toLower();
+}
+
+}  // namespace crystaldock
@@ -0,0 +1,85 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CRYSTALDOCK_LAUNCHER_ENTRY_WATCHER_H_
+#define CRYSTALDOCK_LAUNCHER_ENTRY_WATCHER_H_
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <QVariantMap>
+
+namespace crystaldock {
+
+// Count badges and progress of the applications, from the Update signals of the
+// com.canonical.Unity.LauncherEntry D-Bus interface, which e.g. download managers
+// emit many times per second.
+//
+// The updates are merged per application, and the docks told about the changed
+// applications at most once per frame. Must be used on the GUI thread only.
+class LauncherEntryWatcher : public QObject {
+  Q_OBJECT
+
+ public:
+  struct Entry {
+    qint64 count = 0;
+    bool countVisible = false;
+    double progress = 0.0;  // in [0, 1].
+    bool progressVisible = false;
+    bool urgent = false;
+
+    bool operator==(const Entry&) const = default;
+  };
+
+  static LauncherEntryWatcher* self();
+
+  // The application's entry, which shows nothing if it hasn't sent any update. The app ID is
+  // matched case-insensitively.
+  const Entry& entry(const QString& appId) const;
+
+ signals:
+  // The entries of these applications, by lowercased app ID, have changed since the last signal.
+  void entriesChanged(const QStringList& appIds);
+
+ private slots:
+  void onUpdate(const QString& appUri, const QVariantMap& properties);
+
+ private:
+  static constexpr int kFrameIntervalMs = 16;
+
+  LauncherEntryWatcher();
+
+  void emitChanges();
+
+  // Gets the app ID (i.e. the desktop file ID without the extension, lowercased) from an URI
+  // such as application://org.kde.dolphin.desktop.
+  static QString appIdFromUri(const QString& appUri);
+
+  QHash<QString, Entry> entries_;
+  // The applications changed since the last entriesChanged().
+  QSet<QString> changed_;
+  QTimer changesTimer_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_LAUNCHER_ENTRY_WATCHER_H_
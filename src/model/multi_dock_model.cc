@@ -18,12 +18,18 @@
 
 #include "multi_dock_model.h"
 
+#include <algorithm>
 #include <iostream>
 
+#include <QFile>
 #include <QFileInfo>
 #include <QProcess>
+#include <QSet>
 
 #include "display/window_system.h"
+#include <utils/config_writer.h>
+#include <utils/icon_disk_cache.h>
+#include <utils/thumbnail_loader.h>
 
 namespace crystaldock {
 
@@ -64,6 +70,7 @@ constexpr char MultiDockModel::kBackgroundAlpha[];
 constexpr char MultiDockModel::kPagerCategory[];
 constexpr char MultiDockModel::kWallpaper[];
 constexpr char MultiDockModel::kShowDesktopNumber[];
+constexpr char MultiDockModel::kShowWindows[];
 constexpr char MultiDockModel::kTaskManagerCategory[];
 constexpr char MultiDockModel::kCurrentDesktopTasksOnly[];
 constexpr char MultiDockModel::kCurrentScreenTasksOnly[];
@@ -71,14 +78,44 @@ constexpr char MultiDockModel::kClockCategory[];
 constexpr char MultiDockModel::kUse24HourClock[];
 constexpr char MultiDockModel::kFontScaleFactor[];
 
-MultiDockModel::MultiDockModel(const QString& configDir)
-    : configHelper_(configDir),
-      appearanceConfig_(configHelper_.appearanceConfigPath(),
-                        QSettings::IniFormat),
-      desktopEnv_(DesktopEnv::getDesktopEnv()) {
-  loadDocks();
-  connect(&applicationMenuConfig_, SIGNAL(configChanged()),
-          this, SIGNAL(applicationMenuConfigChanged()));
+MultiDockModel::MultiDockModel(const SessionContext& session)
+    : session_(session),
+      configHelper_(session_.configDir),
+      configStore_(configHelper_),
+      applicationMenuConfig_(session_, configHelper_.applicationMenuSnapshotPath(),
+                             configHelper_.appIdAliasesPath()),
+      desktopEnv_(session_.desktopEnv) {
+  IconDiskCache::init(configHelper_.iconCacheDir());
+  ThumbnailLoader::init(configHelper_.thumbnailCacheDir());
+  ConfigValues values;
+  // On failure, runs with the default configs in memory only, the store leaving the file as is.
+  configStore_.load(&values);
+  appearanceConfig_ = std::move(values.appearance);
+  loadAppearance();
+  loadDocks(std::move(values.docks));
+  connect(&applicationMenuConfig_, &ApplicationMenuConfig::entriesChanged, this,
+          [this](const QStringList& changedAppIds, const QStringList& removedAppIds) {
+            // Launchers are resolved against the application menu entries.
+            const auto changed = [&changedAppIds, &removedAppIds](const QString& appId) {
+              return changedAppIds.contains(appId, Qt::CaseInsensitive) ||
+                  removedAppIds.contains(appId, Qt::CaseInsensitive);
+            };
+            for (auto it = launcherConfigs_.begin(); it != launcherConfigs_.end();) {
+              const QStringList dockLaunchers = launchers(it->first);
+              const auto& configs = it->second;
+              // A new entry could also resolve a launcher that didn't resolve before.
+              const bool unresolved = !changedAppIds.isEmpty() &&
+                  configs.size() < static_cast<size_t>(dockLaunchers.size());
+              if (unresolved || std::any_of(dockLaunchers.begin(), dockLaunchers.end(), changed) ||
+                  std::any_of(configs.begin(), configs.end(),
+                              [&changed](const auto& config) { return changed(config.appId); })) {
+                it = launcherConfigs_.erase(it);
+              } else {
+                ++it;
+              }
+            }
+            emit applicationMenuEntriesChanged(changedAppIds, removedAppIds);
+          });
   if (maxIconSize() < minIconSize()) {
     setMaxIconSize(minIconSize());
   }
@@ -86,19 +123,107 @@ MultiDockModel::MultiDockModel(const QString& configDir)
     setActiveIndicatorColor(kDefaultActiveIndicatorColor);
     setInactiveIndicatorColor(kDefaultInactiveIndicatorColor);
   }
+  // There's no view to update yet.
+  pendingAppearanceChange_ = AppearanceChange::None;
 }
 
-void MultiDockModel::loadDocks() {
+MultiDockModel::~MultiDockModel() {
+  ConfigWriter::self()->flush();
+}
+
+void MultiDockModel::loadAppearance() {
+  auto& a = appearance_;
+  a.minIconSize = appearanceProperty(kGeneralCategory, kMinimumIconSize, kDefaultMinSize);
+  a.maxIconSize = appearanceProperty(kGeneralCategory, kMaximumIconSize, kDefaultMaxSize);
+  a.spacingFactor = appearanceProperty(kGeneralCategory, kSpacingFactor,
+                                       QString::number(kDefaultSpacingFactor)).toFloat();
+
+  QColor defaultBackgroundColor(kDefaultBackgroundColor);
+  defaultBackgroundColor.setAlphaF(kDefaultBackgroundAlpha);
+  a.backgroundColor = QColor(appearanceProperty(
+      kGeneralCategory, kBackgroundColor, defaultBackgroundColor.name(QColor::HexArgb)));
+  QColor defaultBackgroundColor2D(kDefaultBackgroundColor2D);
+  defaultBackgroundColor2D.setAlphaF(kDefaultBackgroundAlpha);
+  a.backgroundColor2D = QColor(appearanceProperty(
+      kGeneralCategory, kBackgroundColor2D, defaultBackgroundColor2D.name(QColor::HexArgb)));
+  QColor defaultBackgroundColorMetal2D(kDefaultBackgroundColorMetal2D);
+  defaultBackgroundColorMetal2D.setAlphaF(kDefaultBackgroundAlphaMetal2D);
+  a.backgroundColorMetal2D = QColor(appearanceProperty(
+      kGeneralCategory, kBackgroundColorMetal2D,
+      defaultBackgroundColorMetal2D.name(QColor::HexArgb)));
+
+  auto color = [this](const char* name, const char* defaultValue) {
+    return QColor(appearanceProperty(kGeneralCategory, name, QString(defaultValue)));
+  };
+  a.borderColor = color(kBorderColor, kDefaultBorderColor);
+  a.borderColorMetal2D = color(kBorderColorMetal2D, kDefaultBorderColorMetal2D);
+  a.activeIndicatorColor = color(kActiveIndicatorColor, kDefaultActiveIndicatorColor);
+  a.activeIndicatorColor2D = color(kActiveIndicatorColor2D, kDefaultActiveIndicatorColor2D);
+  a.activeIndicatorColorMetal2D =
+      color(kActiveIndicatorColorMetal2D, kDefaultActiveIndicatorColorMetal2D);
+  a.inactiveIndicatorColor = color(kInactiveIndicatorColor, kDefaultInactiveIndicatorColor);
+  a.inactiveIndicatorColor2D =
+      color(kInactiveIndicatorColor2D, kDefaultInactiveIndicatorColor2D);
+  a.inactiveIndicatorColorMetal2D =
+      color(kInactiveIndicatorColorMetal2D, kDefaultInactiveIndicatorColorMetal2D);
+
+  a.showTooltip = appearanceProperty(kGeneralCategory, kShowTooltip, kDefaultShowTooltip);
+  a.tooltipFontSize =
+      appearanceProperty(kGeneralCategory, kTooltipFontSize, kDefaultTooltipFontSize);
+  a.panelStyle = static_cast<PanelStyle>(appearanceProperty(
+      kGeneralCategory, kPanelStyle, static_cast<int>(kDefaultPanelStyle)));
+  a.floatingMargin =
+      appearanceProperty(kGeneralCategory, kFloatingMargin, kDefaultFloatingMargin);
+  a.bouncingLauncherIcon =
+      appearanceProperty(kGeneralCategory, kBouncingLauncherIcon, kDefaultBouncingLauncherIcon);
+  a.zoomCurve = static_cast<ZoomCurve>(appearanceProperty(
+      kGeneralCategory, kZoomCurve, static_cast<int>(kDefaultZoomCurve)));
+  a.lazyIconCache = appearanceProperty(kGeneralCategory, kLazyIconCache, kDefaultLazyIconCache);
+  a.warmReveal = appearanceProperty(kGeneralCategory, kWarmReveal, kDefaultWarmReveal);
+  a.iconCacheSize = appearanceProperty(kGeneralCategory, kIconCacheSize, kDefaultIconCacheSize);
+  a.iconSizeBucket =
+      appearanceProperty(kGeneralCategory, kIconSizeBucket, kDefaultIconSizeBucket);
+
+  a.applicationMenuName = appearanceProperty(kApplicationMenuCategory, kLabel,
+                                             QString(kDefaultApplicationMenuName));
+  a.applicationMenuIconSize = appearanceProperty(kApplicationMenuCategory, kIconSize,
+                                                 kDefaultApplicationMenuIconSize);
+  a.applicationMenuFontSize = appearanceProperty(kApplicationMenuCategory, kFontSize,
+                                                 kDefaultApplicationMenuFontSize);
+  a.applicationMenuBackgroundAlpha = appearanceProperty(
+      kApplicationMenuCategory, kBackgroundAlpha,
+      QString::number(kDefaultApplicationMenuBackgroundAlpha)).toFloat();
+
+  a.showDesktopNumber =
+      appearanceProperty(kPagerCategory, kShowDesktopNumber, kDefaultShowDesktopNumber);
+  a.showPagerWindows =
+      appearanceProperty(kPagerCategory, kShowWindows, kDefaultShowPagerWindows);
+
+  a.currentDesktopTasksOnly = appearanceProperty(kTaskManagerCategory, kCurrentDesktopTasksOnly,
+                                                 kDefaultCurrentDesktopTasksOnly);
+  a.currentScreenTasksOnly = appearanceProperty(kTaskManagerCategory, kCurrentScreenTasksOnly,
+                                                kDefaultCurrentScreenTasksOnly);
+  a.groupTasksByApplication = appearanceProperty(kTaskManagerCategory, kGroupTasksByApplication,
+                                                 kDefaultGroupTasksByApplication);
+
+  a.use24HourClock = appearanceProperty(kClockCategory, kUse24HourClock, kDefaultUse24HourClock);
+  a.clockFontScaleFactor = appearanceProperty(
+      kClockCategory, kFontScaleFactor, QString::number(kDefaultClockFontScaleFactor)).toFloat();
+  a.clockFontFamily = appearanceProperty(kClockCategory, kClockFontFamily, QString());
+}
+
+void MultiDockModel::loadDocks(std::vector<QVariantMap> docks) {
   // Dock ID starts from 1.
   int dockId = 1;
   dockConfigs_.clear();
-  for (const auto& configPath : configHelper_.findAllDockConfigs()) {
-    dockConfigs_[dockId] = std::make_tuple(
-        configPath,
-        std::make_unique<QSettings>(configPath, QSettings::IniFormat));
+  inactiveDocks_.clear();
+  for (auto& values : docks) {
+    dockConfigs_[dockId] = std::make_pair(std::move(values), DockConfig());
+    loadDockConfig(dockId);
     if (screen(dockId) < static_cast<int>(WindowSystem::screens().size())) {
       ++dockId;
     } else {  // Invalid screen.
+      inactiveDocks_.push_back(std::move(dockConfigs_[dockId].first));
       dockConfigs_.erase(dockId);
     }
   }
@@ -107,18 +232,56 @@ void MultiDockModel::loadDocks() {
   maybeAddDockForMultiScreen();
 }
 
-void MultiDockModel::addDock(PanelPosition position, int screen,
-                             bool showApplicationMenu, bool showPager,
-                             bool showTaskManager, bool showClock) {
-  auto configPath = configHelper_.findNextDockConfig();
-  auto dockId = addDock(configPath, position, screen);
+void MultiDockModel::loadDockConfig(int dockId) {
+  auto& config = mutableDockConfig(dockId);
+  config.position = static_cast<PanelPosition>(dockProperty(
+      dockId, kGeneralCategory, kPosition, static_cast<int>(PanelPosition::Bottom)));
+  config.screen = dockProperty(dockId, kGeneralCategory, kScreen, 0);
+  config.visibility = static_cast<PanelVisibility>(dockProperty(
+      dockId, kGeneralCategory, kVisibility, static_cast<int>(kDefaultVisibility)));
+  config.autoHide = dockProperty(dockId, kGeneralCategory, kAutoHide, kDefaultAutoHide);
+  config.showApplicationMenu = dockProperty(dockId, kGeneralCategory, kShowApplicationMenu,
+                                            kDefaultShowApplicationMenu);
+  config.showPager = dockProperty(dockId, kGeneralCategory, kShowPager, kDefaultShowPager);
+  config.showTaskManager = dockProperty(dockId, kGeneralCategory, kShowTaskManager,
+                                        kDefaultShowTaskManager);
+  config.showClock = dockProperty(dockId, kGeneralCategory, kShowClock, kDefaultShowClock);
+  config.showTrash = dockProperty(dockId, kGeneralCategory, kShowTrash, kDefaultShowTrash);
+  config.launchers = dockProperty(dockId, kGeneralCategory, kLaunchers, QString())
+      .split(";", Qt::SkipEmptyParts);
+}
+
+void MultiDockModel::saveConfigs() const {
+  ConfigValues values{appearanceConfig_, {}};
+  values.docks.reserve(dockConfigs_.size() + inactiveDocks_.size());
+  for (const int dockId : dockIds()) {
+    values.docks.push_back(*dockConfig(dockId));
+  }
+  values.docks.insert(values.docks.end(), inactiveDocks_.begin(), inactiveDocks_.end());
+  configStore_.save(values);
+}
+
+std::vector<int> MultiDockModel::dockIds() const {
+  std::vector<int> ids;
+  ids.reserve(dockConfigs_.size());
+  for (const auto& dock : dockConfigs_) {
+    ids.push_back(dock.first);
+  }
+  std::sort(ids.begin(), ids.end());
+  return ids;
+}
+
+int MultiDockModel::addDock(PanelPosition position, int screen,
+                            bool showApplicationMenu, bool showPager,
+                            bool showTaskManager, bool showClock) {
+  auto dockId = addDock(position, screen, {});
   setVisibility(dockId, kDefaultVisibility);
   setLaunchers(dockId, defaultLaunchers());
   setShowApplicationMenu(dockId, showApplicationMenu);
   setShowPager(dockId, showPager);
   setShowTaskManager(dockId, showTaskManager);
   setShowClock(dockId, showClock);
-  emit dockAdded(dockId);
+  notifyDockAdded(dockId);
 
   if (dockCount() == 1) {
     setMinIconSize(kDefaultMinSize);
@@ -140,37 +303,90 @@ void MultiDockModel::addDock(PanelPosition position, int screen,
     syncAppearanceConfig();
   }
   syncDockConfig(dockId);
+  return dockId;
 }
 
-int MultiDockModel::addDock(const QString& configPath,
-                            PanelPosition position, int screen) {
+int MultiDockModel::addDock(PanelPosition position, int screen, const QVariantMap& values) {
   const auto dockId = nextDockId_;
   ++nextDockId_;
-  dockConfigs_[dockId] = std::make_tuple(
-      configPath,
-      std::make_unique<QSettings>(configPath, QSettings::IniFormat));
+  dockConfigs_[dockId] = std::make_pair(values, DockConfig());
+  loadDockConfig(dockId);
   setPanelPosition(dockId, position);
   setScreen(dockId, screen);
 
   return dockId;
 }
 
-void MultiDockModel::cloneDock(int srcDockId, PanelPosition position,
-                               int screen) {
-  auto configPath = configHelper_.findNextDockConfig();
-
+int MultiDockModel::cloneDock(int srcDockId, PanelPosition position,
+                              int screen) {
   // Clone the dock config.
-  QFile::copy(dockConfigPath(srcDockId), configPath);
-  auto dockId = addDock(configPath, position, screen);
-  emit dockAdded(dockId);
+  auto dockId = addDock(position, screen, *dockConfig(srcDockId));
+  notifyDockAdded(dockId);
 
   syncDockConfig(dockId);
+  return dockId;
 }
 
 void MultiDockModel::removeDock(int dockId) {
-  QFile::remove(dockConfigPath(dockId));
   dockConfigs_.erase(dockId);
-  // No need to emit a signal here.
+  saveConfigs();
+  launcherConfigs_.erase(dockId);
+  changedDocks_.erase(dockId);
+  // Not notified even in a transaction, as its panel would read the removed config.
+  // A dock added in the same transaction has no panel yet.
+  if (addedDocks_.erase(dockId) == 0) {
+    emit dockRemoved(dockId);
+  }
+}
+
+void MultiDockModel::commitTransaction() {
+  if (transactionDepth_ == 0 || --transactionDepth_ > 0) {
+    return;
+  }
+
+  // Taken first, as the slots may change the docks again.
+  const auto addedDocks = std::move(addedDocks_);
+  auto changedDocks = std::move(changedDocks_);
+  const bool isAppearanceChanged = isAppearanceChangedInTransaction_;
+  addedDocks_.clear();
+  changedDocks_.clear();
+  isAppearanceChangedInTransaction_ = false;
+
+  // The docks added in the transaction are created with their final configs below.
+  for (const int dockId : addedDocks) {
+    changedDocks.erase(dockId);
+  }
+  for (const int dockId : addedDocks) {
+    syncDockConfig(dockId);
+  }
+  for (const int dockId : changedDocks) {
+    syncDockConfig(dockId);
+  }
+
+  committingChange_ = isAppearanceChanged ? pendingAppearanceChange_ : AppearanceChange::None;
+  for (const int dockId : changedDocks) {
+    if (hasDock(dockId)) {
+      emit dockConfigChanged(dockId);
+    }
+  }
+  committingChange_ = AppearanceChange::None;
+  if (isAppearanceChanged) {
+    saveAppearanceConfig();
+  }
+
+  for (const int dockId : addedDocks) {
+    if (hasDock(dockId)) {
+      emit dockAdded(dockId);
+    }
+  }
+}
+
+void MultiDockModel::notifyDockAdded(int dockId) {
+  if (inTransaction()) {
+    addedDocks_.insert(dockId);
+  } else {
+    emit dockAdded(dockId);
+  }
 }
 
 void MultiDockModel::maybeAddDockForMultiScreen() {
@@ -196,7 +412,12 @@ bool MultiDockModel::hasPager() const {
   return false;
 }
 
-const std::vector<LauncherConfig> MultiDockModel::launcherConfigs(int dockId) const {
+const std::vector<LauncherConfig>& MultiDockModel::launcherConfigs(int dockId) const {
+  auto it = launcherConfigs_.find(dockId);
+  if (it != launcherConfigs_.end()) {
+    return it->second;
+  }
+
   std::vector<LauncherConfig> entries;
   for (const auto& appId : launchers(dockId)) {
     if (appId == kSeparatorId) {
@@ -220,7 +441,25 @@ const std::vector<LauncherConfig> MultiDockModel::launcherConfigs(int dockId) co
                                        entry->command));
     }
   }
-  return entries;
+  return launcherConfigs_[dockId] = std::move(entries);
+}
+
+std::vector<LauncherConfig> MultiDockModel::launchersByLaunchCount() const {
+  std::vector<LauncherConfig> launchers;
+  QSet<QString> appIds;
+  for (const auto& dock : dockConfigs_) {
+    for (const auto& launcher : launcherConfigs(dock.first)) {
+      if (!launcher.command.isEmpty() && !appIds.contains(launcher.appId)) {
+        appIds.insert(launcher.appId);
+        launchers.push_back(launcher);
+      }
+    }
+  }
+  std::stable_sort(launchers.begin(), launchers.end(),
+                   [this](const LauncherConfig& a, const LauncherConfig& b) {
+                     return launchCount(a.appId) > launchCount(b.appId);
+                   });
+  return launchers;
 }
 
 QStringList MultiDockModel::defaultLaunchers() {
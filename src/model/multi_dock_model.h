@@ -19,7 +19,9 @@
 #ifndef CRYSTALDOCK_MULTI_DOCK_MODEL_H_
 #define CRYSTALDOCK_MULTI_DOCK_MODEL_H_
 
+#include <algorithm>
 #include <memory>
+#include <set>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -27,12 +29,15 @@
 #include <QColor>
 #include <QDir>
 #include <QObject>
-#include <QSettings>
 #include <QString>
+#include <QStringList>
+#include <QVariantMap>
 
 #include "application_menu_config.h"
 #include "config_helper.h"
+#include "config_store.h"
 #include "launcher_config.h"
+#include "session_context.h"
 #include <desktop/desktop_env.h>
 
 namespace crystaldock {
@@ -49,6 +54,9 @@ enum class PanelStyle {
     Metal2D_Floating, Metal2D_NonFloating,
     Glass2D_Floating, Glass2D_NonFloating };
 
+// The curve of icon sizes around the mouse when zoomed.
+enum class ZoomCurve { Parabolic, Cosine, Gaussian };
+
 constexpr int kDefaultMinSize = 48;
 constexpr int kDefaultMaxSize = 128;
 constexpr float kDefaultSpacingFactor = 0.5;
@@ -69,6 +77,13 @@ constexpr char kDefaultInactiveIndicatorColor2D[] = "cyan";
 constexpr char kDefaultInactiveIndicatorColorMetal2D[] = "cyan";
 constexpr int kDefaultFloatingMargin = 6;
 constexpr bool kDefaultBouncingLauncherIcon = true;
+constexpr ZoomCurve kDefaultZoomCurve = ZoomCurve::Parabolic;
+constexpr bool kDefaultLazyIconCache = true;
+constexpr bool kDefaultWarmReveal = false;
+constexpr int kDefaultIconCacheSize = 24;
+constexpr int kDefaultIconSizeBucket = 1;
+constexpr bool kDefaultPrefetchLaunchers = false;
+constexpr bool kDefaultPrefetchLauncherLibraries = true;
 
 constexpr float kLargeClockFontScaleFactor = 1.0;
 constexpr float kMediumClockFontScaleFactor = 0.8;
@@ -88,6 +103,7 @@ constexpr int kDefaultApplicationMenuIconSize = 40;
 constexpr int kDefaultApplicationMenuFontSize = 14;
 constexpr float kDefaultApplicationMenuBackgroundAlpha = 0.8;
 constexpr bool kDefaultShowDesktopNumber = true;
+constexpr bool kDefaultShowPagerWindows = true;
 constexpr bool kDefaultCurrentDesktopTasksOnly = false;
 constexpr bool kDefaultCurrentScreenTasksOnly = false;
 constexpr bool kDefaultGroupTasksByApplication = true;
@@ -102,13 +118,71 @@ constexpr char kShowDesktopName[] = "Show Desktop";
 constexpr char kShowDesktopIcon[] = "user-desktop";
 constexpr char kLogOutId[] = "log-out";
 
+// How much of the view needs updating after appearance changes, from the cheapest.
+enum class AppearanceChange { None, Repaint, Relayout, Reload };
+
+// In-memory copy of the appearance config, so that getters called from paint paths read
+// plain fields instead of going through QSettings. Kept in sync by the setters.
+struct AppearanceSnapshot {
+  int minIconSize;
+  int maxIconSize;
+  float spacingFactor;
+  QColor backgroundColor;
+  QColor backgroundColor2D;
+  QColor backgroundColorMetal2D;
+  QColor borderColor;
+  QColor borderColorMetal2D;
+  QColor activeIndicatorColor;
+  QColor activeIndicatorColor2D;
+  QColor activeIndicatorColorMetal2D;
+  QColor inactiveIndicatorColor;
+  QColor inactiveIndicatorColor2D;
+  QColor inactiveIndicatorColorMetal2D;
+  bool showTooltip;
+  int tooltipFontSize;
+  PanelStyle panelStyle;
+  int floatingMargin;
+  bool bouncingLauncherIcon;
+  ZoomCurve zoomCurve;
+  bool lazyIconCache;
+  bool warmReveal;
+  int iconCacheSize;
+  int iconSizeBucket;
+  QString applicationMenuName;
+  int applicationMenuIconSize;
+  int applicationMenuFontSize;
+  float applicationMenuBackgroundAlpha;
+  bool showDesktopNumber;
+  bool showPagerWindows;
+  bool currentDesktopTasksOnly;
+  bool currentScreenTasksOnly;
+  bool groupTasksByApplication;
+  bool use24HourClock;
+  float clockFontScaleFactor;
+  QString clockFontFamily;
+};
+
+// In-memory copy of a dock's config. Kept in sync by the setters.
+struct DockConfig {
+  PanelPosition position;
+  int screen;
+  PanelVisibility visibility;
+  bool autoHide;
+  bool showApplicationMenu;
+  bool showPager;
+  bool showTaskManager;
+  bool showClock;
+  bool showTrash;
+  QStringList launchers;
+};
+
 // The model.
 class MultiDockModel : public QObject {
   Q_OBJECT
 
  public:
-  MultiDockModel(const QString& configDir);
-  ~MultiDockModel() = default;
+  explicit MultiDockModel(const SessionContext& session);
+  ~MultiDockModel();
 
   MultiDockModel(const MultiDockModel&) = delete;
   MultiDockModel& operator=(const MultiDockModel&) = delete;
@@ -116,186 +190,175 @@ class MultiDockModel : public QObject {
   // Returns the number of docks.
   int dockCount() const { return dockConfigs_.size(); }
 
-  // Adds a new dock in the specified position and screen.
-  void addDock(PanelPosition position, int screen, bool showApplicationMenu,
-               bool showPager, bool showTaskManager, bool showClock);
+  // The IDs of the docks, in increasing order.
+  std::vector<int> dockIds() const;
+
+  bool hasDock(int dockId) const { return dockConfigs_.count(dockId) > 0; }
+
+  // Adds a new dock in the specified position and screen. Returns the new dock's ID.
+  int addDock(PanelPosition position, int screen, bool showApplicationMenu,
+              bool showPager, bool showTaskManager, bool showClock);
 
   void addDock() {
     addDock(PanelPosition::Bottom, 0, true, true, true, true);
   }
 
-  // Clones an existing dock in the specified position and screen.
-  void cloneDock(int srcDockId, PanelPosition position, int screen);
+  // Clones an existing dock in the specified position and screen. Returns the new dock's ID.
+  int cloneDock(int srcDockId, PanelPosition position, int screen);
 
-  // Removes a dock.
+  // Removes a dock. The view deletes its panel.
   void removeDock(int dockId);
 
+  // Between beginTransaction() and the matching commitTransaction(), saveDockConfig() and
+  // saveAppearanceConfig() only record the changes. The commit then writes each changed
+  // config once and notifies the view once per affected dock, however many changes were
+  // made. Transactions can be nested; only the outermost commit applies the changes.
+  void beginTransaction() { ++transactionDepth_; }
+  void commitTransaction();
+
+  bool inTransaction() const { return transactionDepth_ > 0; }
+
+  // Whether the commit in progress reloads all docks after notifying the changed ones,
+  // so that these needn't reload themselves.
+  bool isCommittingReload() const { return committingChange_ == AppearanceChange::Reload; }
+
   void maybeAddDockForMultiScreen();
 
-  int minIconSize() const {
-    return appearanceProperty(kGeneralCategory, kMinimumIconSize,
-                              kDefaultMinSize);
-  }
+  int minIconSize() const { return appearance_.minIconSize; }
 
   void setMinIconSize(int value) {
     if (value > maxIconSize()) {
       setMaxIconSize(value);
     }
+    updateAppearance(appearance_.minIconSize, value, AppearanceChange::Reload);
     setAppearanceProperty(kGeneralCategory, kMinimumIconSize, value);
   }
 
-  int maxIconSize() const {
-    return appearanceProperty(kGeneralCategory, kMaximumIconSize,
-                              kDefaultMaxSize);
-  }
+  int maxIconSize() const { return appearance_.maxIconSize; }
 
   void setMaxIconSize(int value) {
     if (value < minIconSize()) {
       setMinIconSize(value);
     }
+    updateAppearance(appearance_.maxIconSize, value, AppearanceChange::Reload);
     setAppearanceProperty(kGeneralCategory, kMaximumIconSize, value);
   }
 
-  float spacingFactor() const {
-    return appearanceProperty(kGeneralCategory, kSpacingFactor,
-                              QString::number(kDefaultSpacingFactor)).toFloat();
-  }
+  float spacingFactor() const { return appearance_.spacingFactor; }
 
   // Converts float to string to make the entry in the config file human-readable.
   void setSpacingFactor(float value) {
+    updateAppearance(appearance_.spacingFactor, value, AppearanceChange::Relayout);
     setAppearanceProperty(kGeneralCategory, kSpacingFactor, QString::number(value));
   }
 
-  QColor backgroundColor() const {
-    QColor defaultBackgroundColor(kDefaultBackgroundColor);
-    defaultBackgroundColor.setAlphaF(kDefaultBackgroundAlpha);
-    return QColor(appearanceProperty(kGeneralCategory, kBackgroundColor,
-                                     defaultBackgroundColor.name(QColor::HexArgb)));
-  }
+  QColor backgroundColor() const { return appearance_.backgroundColor; }
 
   void setBackgroundColor(const QColor& value) {
+    updateAppearance(appearance_.backgroundColor, QColor(value.name(QColor::HexArgb)),
+                     AppearanceChange::Repaint);
     setAppearanceProperty(kGeneralCategory, kBackgroundColor, value.name(QColor::HexArgb));
   }
 
-  QColor backgroundColor2D() const {
-    QColor defaultBackgroundColor2D(kDefaultBackgroundColor2D);
-    defaultBackgroundColor2D.setAlphaF(kDefaultBackgroundAlpha);
-    return QColor(appearanceProperty(kGeneralCategory, kBackgroundColor2D,
-                                     defaultBackgroundColor2D.name(QColor::HexArgb)));
-  }
+  QColor backgroundColor2D() const { return appearance_.backgroundColor2D; }
 
   void setBackgroundColor2D(const QColor& value) {
+    updateAppearance(appearance_.backgroundColor2D, QColor(value.name(QColor::HexArgb)),
+                     AppearanceChange::Repaint);
     setAppearanceProperty(kGeneralCategory, kBackgroundColor2D, value.name(QColor::HexArgb));
   }
 
-  QColor backgroundColorMetal2D() const {
-    QColor defaultBackgroundColorMetal2D(kDefaultBackgroundColorMetal2D);
-    defaultBackgroundColorMetal2D.setAlphaF(kDefaultBackgroundAlphaMetal2D);
-    return QColor(appearanceProperty(kGeneralCategory, kBackgroundColorMetal2D,
-                                     defaultBackgroundColorMetal2D.name(QColor::HexArgb)));
-  }
+  QColor backgroundColorMetal2D() const { return appearance_.backgroundColorMetal2D; }
 
   void setBackgroundColorMetal2D(const QColor& value) {
+    updateAppearance(appearance_.backgroundColorMetal2D, QColor(value.name(QColor::HexArgb)),
+                     AppearanceChange::Repaint);
     setAppearanceProperty(kGeneralCategory, kBackgroundColorMetal2D, value.name(QColor::HexArgb));
   }
 
-  QColor borderColor() const {
-    return QColor(appearanceProperty(kGeneralCategory, kBorderColor,
-                                     QString(kDefaultBorderColor)));
-  }
+  QColor borderColor() const { return appearance_.borderColor; }
 
   void setBorderColor(const QColor& value) {
+    updateAppearance(appearance_.borderColor, QColor(value.name(QColor::HexRgb)),
+                     AppearanceChange::Repaint);
     setAppearanceProperty(kGeneralCategory, kBorderColor, value.name(QColor::HexRgb));
   }
 
-  QColor borderColorMetal2D() const {
-    return QColor(appearanceProperty(kGeneralCategory, kBorderColorMetal2D,
-                                     QString(kDefaultBorderColorMetal2D)));
-  }
+  QColor borderColorMetal2D() const { return appearance_.borderColorMetal2D; }
 
   void setBorderColorMetal2D(const QColor& value) {
+    updateAppearance(appearance_.borderColorMetal2D, QColor(value.name(QColor::HexRgb)),
+                     AppearanceChange::Repaint);
     setAppearanceProperty(kGeneralCategory, kBorderColorMetal2D, value.name(QColor::HexRgb));
   }
 
-  QColor activeIndicatorColor() const {
-    return QColor(appearanceProperty(kGeneralCategory, kActiveIndicatorColor,
-                                     QString(kDefaultActiveIndicatorColor)));
-  }
+  QColor activeIndicatorColor() const { return appearance_.activeIndicatorColor; }
 
   void setActiveIndicatorColor(const QColor& value) {
+    updateAppearance(appearance_.activeIndicatorColor, QColor(value.name(QColor::HexRgb)),
+                     AppearanceChange::Repaint);
     setAppearanceProperty(kGeneralCategory, kActiveIndicatorColor, value.name(QColor::HexRgb));
   }
 
-  QColor activeIndicatorColor2D() const {
-    return QColor(appearanceProperty(kGeneralCategory, kActiveIndicatorColor2D,
-                                     QString(kDefaultActiveIndicatorColor2D)));
-  }
+  QColor activeIndicatorColor2D() const { return appearance_.activeIndicatorColor2D; }
 
   void setActiveIndicatorColor2D(const QColor& value) {
+    updateAppearance(appearance_.activeIndicatorColor2D, QColor(value.name(QColor::HexRgb)),
+                     AppearanceChange::Repaint);
     setAppearanceProperty(kGeneralCategory, kActiveIndicatorColor2D, value.name(QColor::HexRgb));
   }
 
-  QColor activeIndicatorColorMetal2D() const {
-    return QColor(appearanceProperty(kGeneralCategory, kActiveIndicatorColorMetal2D,
-                                     QString(kDefaultActiveIndicatorColorMetal2D)));
-  }
+  QColor activeIndicatorColorMetal2D() const { return appearance_.activeIndicatorColorMetal2D; }
 
   void setActiveIndicatorColorMetal2D(const QColor& value) {
+    updateAppearance(appearance_.activeIndicatorColorMetal2D, QColor(value.name(QColor::HexRgb)),
+                     AppearanceChange::Repaint);
     setAppearanceProperty(kGeneralCategory, kActiveIndicatorColorMetal2D, value.name(QColor::HexRgb));
   }
 
-  QColor inactiveIndicatorColor() const {
-    return QColor(appearanceProperty(kGeneralCategory, kInactiveIndicatorColor,
-                                     QString(kDefaultInactiveIndicatorColor)));
-  }
+  QColor inactiveIndicatorColor() const { return appearance_.inactiveIndicatorColor; }
 
   void setInactiveIndicatorColor(const QColor& value) {
+    updateAppearance(appearance_.inactiveIndicatorColor, QColor(value.name(QColor::HexRgb)),
+                     AppearanceChange::Repaint);
     setAppearanceProperty(kGeneralCategory, kInactiveIndicatorColor, value.name(QColor::HexRgb));
   }
 
-  QColor inactiveIndicatorColor2D() const {
-    return QColor(appearanceProperty(kGeneralCategory, kInactiveIndicatorColor2D,
-                                     QString(kDefaultInactiveIndicatorColor2D)));
-  }
+  QColor inactiveIndicatorColor2D() const { return appearance_.inactiveIndicatorColor2D; }
 
   void setInactiveIndicatorColor2D(const QColor& value) {
+    updateAppearance(appearance_.inactiveIndicatorColor2D, QColor(value.name(QColor::HexRgb)),
+                     AppearanceChange::Repaint);
     setAppearanceProperty(kGeneralCategory, kInactiveIndicatorColor2D, value.name(QColor::HexRgb));
   }
 
-  QColor inactiveIndicatorColorMetal2D() const {
-    return QColor(appearanceProperty(kGeneralCategory, kInactiveIndicatorColorMetal2D,
-                                     QString(kDefaultInactiveIndicatorColorMetal2D)));
-  }
+  QColor inactiveIndicatorColorMetal2D() const { return appearance_.inactiveIndicatorColorMetal2D; }
 
   void setInactiveIndicatorColorMetal2D(const QColor& value) {
+    updateAppearance(appearance_.inactiveIndicatorColorMetal2D, QColor(value.name(QColor::HexRgb)),
+                     AppearanceChange::Repaint);
     setAppearanceProperty(kGeneralCategory, kInactiveIndicatorColorMetal2D,
                           value.name(QColor::HexRgb));
   }
 
-  bool showTooltip() const {
-    return appearanceProperty(kGeneralCategory, kShowTooltip, kDefaultShowTooltip);
-  }
+  bool showTooltip() const { return appearance_.showTooltip; }
 
   void setShowTooltip(bool value) {
+    updateAppearance(appearance_.showTooltip, value, AppearanceChange::Repaint);
     setAppearanceProperty(kGeneralCategory, kShowTooltip, value);
   }
 
-  int tooltipFontSize() const {
-    return appearanceProperty(kGeneralCategory, kTooltipFontSize,
-                              kDefaultTooltipFontSize);
-  }
+  int tooltipFontSize() const { return appearance_.tooltipFontSize; }
 
   void setTooltipFontSize(int value) {
+    updateAppearance(appearance_.tooltipFontSize, value, AppearanceChange::Relayout);
     setAppearanceProperty(kGeneralCategory, kTooltipFontSize, value);
   }
 
-  PanelStyle panelStyle() {
-    return static_cast<PanelStyle>(
-        appearanceProperty(kGeneralCategory, kPanelStyle,
-                           static_cast<int>(kDefaultPanelStyle)));
-  }
+  PanelStyle panelStyle() const { return appearance_.panelStyle; }
 
   void setPanelStyle(PanelStyle value) {
+    updateAppearance(appearance_.panelStyle, value, AppearanceChange::Reload);
     setAppearanceProperty(kGeneralCategory, kPanelStyle, static_cast<int>(value));
   }
 
@@ -328,24 +391,60 @@ class MultiDockModel : public QObject {
         panelStyle() == PanelStyle::Metal2D_Floating;
   }
 
-  int floatingMargin() const {
-    return appearanceProperty(kGeneralCategory, kFloatingMargin,
-                              kDefaultFloatingMargin);
-  }
+  int floatingMargin() const { return appearance_.floatingMargin; }
 
   void setFloatingMargin(int value) {
+    updateAppearance(appearance_.floatingMargin, value, AppearanceChange::Relayout);
     setAppearanceProperty(kGeneralCategory, kFloatingMargin, value);
   }
 
-  bool bouncingLauncherIcon() const {
-    return appearanceProperty(kGeneralCategory, kBouncingLauncherIcon,
-                              kDefaultBouncingLauncherIcon);
-  }
+  bool bouncingLauncherIcon() const { return appearance_.bouncingLauncherIcon; }
 
   void setBouncingLauncherIcon(bool value) {
+    updateAppearance(appearance_.bouncingLauncherIcon, value, AppearanceChange::Relayout);
     setAppearanceProperty(kGeneralCategory, kBouncingLauncherIcon, value);
   }
 
+  ZoomCurve zoomCurve() const { return appearance_.zoomCurve; }
+
+  void setZoomCurve(ZoomCurve value) {
+    updateAppearance(appearance_.zoomCurve, value, AppearanceChange::Relayout);
+    setAppearanceProperty(kGeneralCategory, kZoomCurve, static_cast<int>(value));
+  }
+
+  // Whether icon items render zoom sizes on demand instead of pre-rendering all of them.
+  bool lazyIconCache() const { return appearance_.lazyIconCache; }
+
+  void setLazyIconCache(bool value) {
+    updateAppearance(appearance_.lazyIconCache, value, AppearanceChange::Reload);
+    setAppearanceProperty(kGeneralCategory, kLazyIconCache, value);
+  }
+
+  // Whether auto-hide docks keep their caches while hidden, so that they are revealed
+  // without rendering them again.
+  bool warmReveal() const { return appearance_.warmReveal; }
+
+  void setWarmReveal(bool value) {
+    updateAppearance(appearance_.warmReveal, value, AppearanceChange::None);
+    setAppearanceProperty(kGeneralCategory, kWarmReveal, value);
+  }
+
+  // Max number of rendered sizes kept per icon item in lazy mode.
+  int iconCacheSize() const { return appearance_.iconCacheSize; }
+
+  void setIconCacheSize(int value) {
+    updateAppearance(appearance_.iconCacheSize, value, AppearanceChange::Reload);
+    setAppearanceProperty(kGeneralCategory, kIconCacheSize, value);
+  }
+
+  // Zoom sizes are rounded to multiples of this (1 means exact sizes).
+  int iconSizeBucket() const { return appearance_.iconSizeBucket; }
+
+  void setIconSizeBucket(int value) {
+    updateAppearance(appearance_.iconSizeBucket, value, AppearanceChange::Reload);
+    setAppearanceProperty(kGeneralCategory, kIconSizeBucket, value);
+  }
+
   bool firstRunMultiScreen() {
     const auto value = appearanceProperty(kGeneralCategory, kFirstRunMultiScreen, true);
     setAppearanceProperty(kGeneralCategory, kFirstRunMultiScreen, false);
@@ -358,44 +457,76 @@ class MultiDockModel : public QObject {
     return value;
   }
 
-  QString applicationMenuName() const {
-    return appearanceProperty(kApplicationMenuCategory, kLabel,
-                              QString(kDefaultApplicationMenuName));
+  // Whether the pinned launchers' executables are read into the page cache when idle
+  // after start-up. Only read at start-up.
+  bool prefetchLaunchers() const {
+    return appearanceProperty(kGeneralCategory, kPrefetchLaunchers, kDefaultPrefetchLaunchers);
+  }
+
+  void setPrefetchLaunchers(bool value) {
+    setAppearanceProperty(kGeneralCategory, kPrefetchLaunchers, value);
   }
 
+  // Whether the shared libraries of the launchers are prefetched too.
+  bool prefetchLauncherLibraries() const {
+    return appearanceProperty(kGeneralCategory, kPrefetchLauncherLibraries,
+                              kDefaultPrefetchLauncherLibraries);
+  }
+
+  void setPrefetchLauncherLibraries(bool value) {
+    setAppearanceProperty(kGeneralCategory, kPrefetchLauncherLibraries, value);
+  }
+
+  // How many times the application has been launched from the docks.
+  int launchCount(const QString& appId) const {
+    return appearanceProperty(kLaunchCountsCategory, appId, 0);
+  }
+
+  void recordLaunch(const QString& appId) {
+    if (!appId.isEmpty()) {
+      setAppearanceProperty(kLaunchCountsCategory, appId, launchCount(appId) + 1);
+      syncAppearanceConfig();
+    }
+  }
+
+  // All docks' launchers, without duplicates, the most frequently launched first.
+  std::vector<LauncherConfig> launchersByLaunchCount() const;
+
+  QString applicationMenuName() const { return appearance_.applicationMenuName; }
+
   void setApplicationMenuName(const QString& value) {
+    updateAppearance(appearance_.applicationMenuName, value, AppearanceChange::Reload);
     setAppearanceProperty(kApplicationMenuCategory, kLabel, value);
   }
 
+  const SessionContext& session() const { return session_; }
+  DesktopEnv* desktopEnv() const { return desktopEnv_; }
+
   QString applicationMenuIcon() const {
     return desktopEnv_->getApplicationMenuIcon();
   }
 
-  int applicationMenuIconSize() const {
-    return appearanceProperty(kApplicationMenuCategory, kIconSize,
-                              kDefaultApplicationMenuIconSize);
-  }
+  int applicationMenuIconSize() const { return appearance_.applicationMenuIconSize; }
 
   void setApplicationMenuIconSize(int value) {
+    updateAppearance(appearance_.applicationMenuIconSize, value, AppearanceChange::Reload);
     setAppearanceProperty(kApplicationMenuCategory, kIconSize, value);
   }
 
-  int applicationMenuFontSize() const {
-    return appearanceProperty(kApplicationMenuCategory, kFontSize,
-                              kDefaultApplicationMenuFontSize);
-  }
+  int applicationMenuFontSize() const { return appearance_.applicationMenuFontSize; }
 
   void setApplicationMenuFontSize(int value) {
+    updateAppearance(appearance_.applicationMenuFontSize, value, AppearanceChange::Reload);
     setAppearanceProperty(kApplicationMenuCategory, kFontSize, value);
   }
 
   float applicationMenuBackgroundAlpha() const {
-    return appearanceProperty(kApplicationMenuCategory, kBackgroundAlpha,
-                              QString::number(kDefaultApplicationMenuBackgroundAlpha)).toFloat();
+    return appearance_.applicationMenuBackgroundAlpha;
   }
 
   // Converts float to string to make the entry in the config file human-readable.
   void setApplicationMenuBackgroundAlpha(float value) {
+    updateAppearance(appearance_.applicationMenuBackgroundAlpha, value, AppearanceChange::Reload);
     setAppearanceProperty(kApplicationMenuCategory, kBackgroundAlpha, QString::number(value));
   }
 
@@ -406,6 +537,7 @@ class MultiDockModel : public QObject {
   }
 
   void setWallpaper(std::string_view desktopId, int screen, const QString& value) {
+    pendingAppearanceChange_ = AppearanceChange::Reload;
     setAppearanceProperty(kPagerCategory,
                           ConfigHelper::wallpaperConfigKey(desktopId, screen),
                           value);
@@ -417,94 +549,111 @@ class MultiDockModel : public QObject {
     emit wallpaperChanged(screen);
   }
 
-  bool showDesktopNumber() const {
-    return appearanceProperty(kPagerCategory, kShowDesktopNumber,
-                              kDefaultShowDesktopNumber);
-  }
+  bool showDesktopNumber() const { return appearance_.showDesktopNumber; }
 
   void setShowDesktopNumber(bool value) {
+    updateAppearance(appearance_.showDesktopNumber, value, AppearanceChange::Repaint);
     setAppearanceProperty(kPagerCategory, kShowDesktopNumber, value);
   }
 
-  bool currentDesktopTasksOnly() const {
-    return appearanceProperty(kTaskManagerCategory, kCurrentDesktopTasksOnly,
-                              kDefaultCurrentDesktopTasksOnly);
+  // Whether the pager shows miniatures of the desktops' windows.
+  bool showPagerWindows() const { return appearance_.showPagerWindows; }
+
+  void setShowPagerWindows(bool value) {
+    updateAppearance(appearance_.showPagerWindows, value, AppearanceChange::Repaint);
+    setAppearanceProperty(kPagerCategory, kShowWindows, value);
   }
 
+  bool currentDesktopTasksOnly() const { return appearance_.currentDesktopTasksOnly; }
+
   void setCurrentDesktopTasksOnly(bool value) {
+    updateAppearance(appearance_.currentDesktopTasksOnly, value, AppearanceChange::Reload);
     setAppearanceProperty(kTaskManagerCategory, kCurrentDesktopTasksOnly, value);
   }
 
-  bool currentScreenTasksOnly() const {
-    return appearanceProperty(kTaskManagerCategory, kCurrentScreenTasksOnly,
-                              kDefaultCurrentScreenTasksOnly);
-  }
+  bool currentScreenTasksOnly() const { return appearance_.currentScreenTasksOnly; }
 
   void setCurrentScreenTasksOnly(bool value) {
+    updateAppearance(appearance_.currentScreenTasksOnly, value, AppearanceChange::Reload);
     setAppearanceProperty(kTaskManagerCategory, kCurrentScreenTasksOnly, value);
   }
 
-  bool groupTasksByApplication() const {
-    return appearanceProperty(kTaskManagerCategory, kGroupTasksByApplication,
-                              kDefaultGroupTasksByApplication);
-  }
+  bool groupTasksByApplication() const { return appearance_.groupTasksByApplication; }
 
   void setGroupTasksByApplication(bool value) {
+    updateAppearance(appearance_.groupTasksByApplication, value, AppearanceChange::Reload);
     setAppearanceProperty(kTaskManagerCategory, kGroupTasksByApplication, value);
   }
 
-  bool use24HourClock() const {
-    return appearanceProperty(kClockCategory, kUse24HourClock,
-                              kDefaultUse24HourClock);
-  }
+  bool use24HourClock() const { return appearance_.use24HourClock; }
 
   void setUse24HourClock(bool value) {
+    updateAppearance(appearance_.use24HourClock, value, AppearanceChange::Repaint);
     setAppearanceProperty(kClockCategory, kUse24HourClock, value);
   }
 
-  float clockFontScaleFactor() const {
-    return appearanceProperty(kClockCategory, kFontScaleFactor,
-                              QString::number(kDefaultClockFontScaleFactor)).toFloat();
-  }
+  float clockFontScaleFactor() const { return appearance_.clockFontScaleFactor; }
 
   // Converts float to string to make the entry in the config file human-readable.
   void setClockFontScaleFactor(float value) {
+    updateAppearance(appearance_.clockFontScaleFactor, value, AppearanceChange::Repaint);
     setAppearanceProperty(kClockCategory, kFontScaleFactor, QString::number(value));
   }
 
-  QString clockFontFamily() const {
-    return appearanceProperty(kClockCategory, kClockFontFamily, QString());
-  }
+  QString clockFontFamily() const { return appearance_.clockFontFamily; }
 
   void setClockFontFamily(const QString& value) {
+    updateAppearance(appearance_.clockFontFamily, value, AppearanceChange::Repaint);
     setAppearanceProperty(kClockCategory, kClockFontFamily, value);
   }
 
+  // Saves the appearance config and notifies the view with the cheapest update that covers
+  // the changes since the last save, or only a repaint if repaintOnly.
   void saveAppearanceConfig(bool repaintOnly = false) {
+    if (inTransaction()) {
+      if (repaintOnly) {
+        pendingAppearanceChange_ = std::max(pendingAppearanceChange_, AppearanceChange::Repaint);
+      }
+      isAppearanceChangedInTransaction_ = true;
+      return;
+    }
     syncAppearanceConfig();
-    if (repaintOnly) {
-      emit appearanceOutdated();
-    } else {
-      emit appearanceChanged();
+    const auto change = repaintOnly ? AppearanceChange::Repaint : pendingAppearanceChange_;
+    pendingAppearanceChange_ = AppearanceChange::None;
+    switch (change) {
+      case AppearanceChange::None:
+        break;
+      case AppearanceChange::Repaint:
+        emit appearanceOutdated();
+        break;
+      case AppearanceChange::Relayout:
+        emit appearanceLayoutChanged();
+        break;
+      case AppearanceChange::Reload:
+        emit appearanceChanged();
+        break;
     }
   }
 
+  // The in-memory copy of the dock's config, for hot paths.
+  const DockConfig& dockConfigSnapshot(int dockId) const {
+    return std::get<2>(dockConfigs_.at(dockId));
+  }
+
   PanelPosition panelPosition(int dockId) const {
-    return static_cast<PanelPosition>(dockProperty(
-        dockId, kGeneralCategory, kPosition,
-        static_cast<int>(PanelPosition::Bottom)));
+    return dockConfigSnapshot(dockId).position;
   }
 
   void setPanelPosition(int dockId, PanelPosition value) {
+    mutableDockConfig(dockId).position = value;
     setDockProperty(dockId, kGeneralCategory, kPosition,
                     static_cast<int>(value));
   }
 
-  int screen(int dockId) const {
-    return dockProperty(dockId, kGeneralCategory, kScreen, 0);
-  }
+  int screen(int dockId) const { return dockConfigSnapshot(dockId).screen; }
 
   void setScreen(int dockId, int value) {
+    mutableDockConfig(dockId).screen = value;
     setDockProperty(dockId, kGeneralCategory, kScreen, value);
   }
 
@@ -512,85 +661,81 @@ class MultiDockModel : public QObject {
     if (autoHide(dockId)) {  // for backward compatibility.
       return PanelVisibility::AutoHide;
     }
-    return static_cast<PanelVisibility>(dockProperty(
-        dockId, kGeneralCategory, kVisibility,
-        static_cast<int>(kDefaultVisibility)));
+    return dockConfigSnapshot(dockId).visibility;
   }
 
   void setVisibility(int dockId, PanelVisibility value) {
+    mutableDockConfig(dockId).visibility = value;
     setDockProperty(dockId, kGeneralCategory, kVisibility,
                     static_cast<int>(value));
     // For backward compatibility.
     setAutoHide(dockId, value == PanelVisibility::AutoHide);
   }
 
-  bool autoHide(int dockId) const {
-    return dockProperty(dockId, kGeneralCategory, kAutoHide, kDefaultAutoHide);
-  }
+  bool autoHide(int dockId) const { return dockConfigSnapshot(dockId).autoHide; }
 
   void setAutoHide(int dockId, bool value) {
+    mutableDockConfig(dockId).autoHide = value;
     setDockProperty(dockId, kGeneralCategory, kAutoHide, value);
   }
 
   bool showApplicationMenu(int dockId) const {
-    return dockProperty(dockId, kGeneralCategory, kShowApplicationMenu,
-                        kDefaultShowApplicationMenu);
+    return dockConfigSnapshot(dockId).showApplicationMenu;
   }
 
   void setShowApplicationMenu(int dockId, bool value) {
+    mutableDockConfig(dockId).showApplicationMenu = value;
     setDockProperty(dockId, kGeneralCategory, kShowApplicationMenu, value);
   }
 
-  bool showPager(int dockId) const {
-    return dockProperty(dockId, kGeneralCategory, kShowPager, kDefaultShowPager);
-  }
+  bool showPager(int dockId) const { return dockConfigSnapshot(dockId).showPager; }
 
   void setShowPager(int dockId, bool value) {
+    mutableDockConfig(dockId).showPager = value;
     setDockProperty(dockId, kGeneralCategory, kShowPager, value);
   }
 
-  bool showTaskManager(int dockId) const {
-    return dockProperty(dockId, kGeneralCategory, kShowTaskManager,
-                        kDefaultShowTaskManager);
-  }
+  bool showTaskManager(int dockId) const { return dockConfigSnapshot(dockId).showTaskManager; }
 
   void setShowTaskManager(int dockId, bool value) {
+    mutableDockConfig(dockId).showTaskManager = value;
     setDockProperty(dockId, kGeneralCategory, kShowTaskManager, value);
   }
 
-  bool showClock(int dockId) const {
-    return dockProperty(dockId, kGeneralCategory, kShowClock,
-                        kDefaultShowClock);
-  }
+  bool showClock(int dockId) const { return dockConfigSnapshot(dockId).showClock; }
 
   void setShowClock(int dockId, bool value) {
+    mutableDockConfig(dockId).showClock = value;
     setDockProperty(dockId, kGeneralCategory, kShowClock, value);
   }
 
-  bool showTrash(int dockId) const {
-    return dockProperty(dockId, kGeneralCategory, kShowTrash,
-                        kDefaultShowTrash);
-  }
+  bool showTrash(int dockId) const { return dockConfigSnapshot(dockId).showTrash; }
 
   void setShowTrash(int dockId, bool value) {
+    mutableDockConfig(dockId).showTrash = value;
     setDockProperty(dockId, kGeneralCategory, kShowTrash, value);
   }
 
-  QStringList launchers(int dockId) const {
-    return dockProperty(dockId, kGeneralCategory, kLaunchers, QString())
-        .split(";", Qt::SkipEmptyParts);
-  }
+  QStringList launchers(int dockId) const { return dockConfigSnapshot(dockId).launchers; }
 
   void setLaunchers(int dockId, QStringList value) {
     setDockProperty(dockId, kGeneralCategory, kLaunchers, value.join(";"));
+    mutableDockConfig(dockId).launchers = std::move(value);
+    launcherConfigs_.erase(dockId);
   }
 
   void saveDockConfig(int dockId) {
+    if (inTransaction()) {
+      changedDocks_.insert(dockId);
+      return;
+    }
     syncDockConfig(dockId);
     emit dockLaunchersChanged(dockId);
   }
 
-  const std::vector<LauncherConfig> launcherConfigs(int dockId) const;
+  // The resolved launchers of the dock. Cached until the dock's launchers or the
+  // application menu entries change.
+  const std::vector<LauncherConfig>& launcherConfigs(int dockId) const;
 
   void addLauncher(int dockId, const LauncherConfig& launcher) {
     auto entries = launchers(dockId);
@@ -640,14 +785,22 @@ class MultiDockModel : public QObject {
  signals:
   // Minor appearance changes that require view update (repaint).
   void appearanceOutdated();
+  // Appearance changes that require relayout (e.g. spacing), but not recreating the items.
+  void appearanceLayoutChanged();
   // Major appearance changes that require view reload.
   void appearanceChanged();
   void dockAdded(int dockId);
+  void dockRemoved(int dockId);
   void dockLaunchersChanged(int dockId);
+  // The dock's config has been changed from outside the dock, e.g. by a script, so the
+  // dock needs to reload it.
+  void dockConfigChanged(int dockId);
   // Wallpaper for the current desktop for screen <screen> has been changed.
   // Will require calling Plasma D-Bus to update the wallpaper.
   void wallpaperChanged(int screen);
-  void applicationMenuConfigChanged();
+  // The application menu entries of these app IDs have been added/modified or removed.
+  void applicationMenuEntriesChanged(const QStringList& changedAppIds,
+                                     const QStringList& removedAppIds);
 
  private:
   // Dock config's categories/properties.
@@ -685,6 +838,13 @@ class MultiDockModel : public QObject {
   static constexpr char kPanelStyle[] = "panelStyle";
   static constexpr char kFloatingMargin[] = "floatingMargin";
   static constexpr char kBouncingLauncherIcon[] = "bouncingLauncherIcon";
+  static constexpr char kZoomCurve[] = "zoomCurve";
+  static constexpr char kLazyIconCache[] = "lazyIconCache";
+  static constexpr char kWarmReveal[] = "warmReveal";
+  static constexpr char kIconCacheSize[] = "iconCacheSize";
+  static constexpr char kIconSizeBucket[] = "iconSizeBucket";
+  static constexpr char kPrefetchLaunchers[] = "prefetchLaunchers";
+  static constexpr char kPrefetchLauncherLibraries[] = "prefetchLauncherLibraries";
 
   static constexpr char kFirstRunMultiScreen[] = "firstRunMultiScreen";
   static constexpr char kFirstRunWindowCountIndicator[] = "firstRunWindowCountIndicator";
@@ -698,12 +858,15 @@ class MultiDockModel : public QObject {
   static constexpr char kPagerCategory[] = "Pager";
   static constexpr char kWallpaper[] = "wallpaper";
   static constexpr char kShowDesktopNumber[] = "showDesktopNumber";  
+  static constexpr char kShowWindows[] = "showWindows";
 
   static constexpr char kTaskManagerCategory[] = "TaskManager";
   static constexpr char kCurrentDesktopTasksOnly[] = "currentDesktopTasksOnly";
   static constexpr char kCurrentScreenTasksOnly[] = "currentScreenTasksOnly";
   static constexpr char kGroupTasksByApplication[] = "groupTasksByApplication";
 
+  static constexpr char kLaunchCountsCategory[] = "LaunchCounts";
+
   static constexpr char kClockCategory[] = "Clock";
   static constexpr char kUse24HourClock[] = "use24HourClock";
   static constexpr char kFontScaleFactor[] = "fontScaleFactor";
@@ -715,16 +878,19 @@ class MultiDockModel : public QObject {
         ? appearanceConfig_.value(name, defaultValue).template value<T>()
         : appearanceConfig_.value(category + '/' + name, defaultValue).template value<T>();
   }
+  // Updates a field of the appearance snapshot, recording the change if the value differs.
   template <typename T>
-  void setAppearanceProperty(QString category, QString name, T value) {
-    if (category.isEmpty()) {
-      appearanceConfig_.setValue(name, value);
-      return;
+  void updateAppearance(T& field, const T& value, AppearanceChange change) {
+    if (field != value) {
+      field = value;
+      pendingAppearanceChange_ = std::max(pendingAppearanceChange_, change);
     }
+  }
 
-    appearanceConfig_.beginGroup(category);
-    appearanceConfig_.setValue(name, value);
-    appearanceConfig_.endGroup();
+  template <typename T>
+  void setAppearanceProperty(QString category, QString name, T value) {
+    appearanceConfig_.insert(category.isEmpty() ? name : category + '/' + name, value);
+    saveConfigs();
   }
 
   template <typename T>
@@ -737,61 +903,87 @@ class MultiDockModel : public QObject {
 
   template <typename T>
   void setDockProperty(int dockId, QString category, QString name, T value) {
-    auto* config = dockConfig(dockId);
-    if (category.isEmpty()) {
-      config->setValue(name, value);
-      return;
-    }
-
-    config->beginGroup(category);
-    config->setValue(name, value);
-    config->endGroup();
+    dockConfig(dockId)->insert(category.isEmpty() ? name : category + '/' + name, value);
+    saveConfigs();
   }
 
-  QString dockConfigPath(int dockId) const {
-    return std::get<0>(dockConfigs_.at(dockId));
+  const QVariantMap* dockConfig(int dockId) const {
+    return &dockConfigs_.at(dockId).first;
   }
 
-  const QSettings* dockConfig(int dockId) const {
-    return std::get<1>(dockConfigs_.at(dockId)).get();
+  QVariantMap* dockConfig(int dockId) {
+    return &dockConfigs_[dockId].first;
   }
 
-  QSettings* dockConfig(int dockId) {
-    return std::get<1>(dockConfigs_[dockId]).get();
+  DockConfig& mutableDockConfig(int dockId) {
+    return dockConfigs_[dockId].second;
   }
 
+  // Loads the dock's config snapshot from its config file.
+  void loadDockConfig(int dockId);
+
   QStringList defaultLaunchers();
 
-  void loadDocks();
+  // Loads the appearance snapshot from the appearance config.
+  void loadAppearance();
+
+  // Loads the docks of the connected screens, keeping the configs of the others.
+  void loadDocks(std::vector<QVariantMap> docks);
+
+  // Adds a dock with the given config values.
+  int addDock(PanelPosition position, int screen, const QVariantMap& values);
 
-  int addDock(const QString& configPath, PanelPosition position, int screen);
+  // Emits dockAdded(), or defers it to the commit if in a transaction.
+  void notifyDockAdded(int dockId);
+
+  // Schedules writing all configs to the config store, off the GUI thread. Writes in quick
+  // succession are coalesced.
+  void saveConfigs() const;
 
   void syncAppearanceConfig() {
-    appearanceConfig_.sync();
+    saveConfigs();
   }
 
   void syncDockConfig(int dockId) {
-    dockConfig(dockId)->sync();
+    saveConfigs();
   }
 
   // Helper(s).
+  const SessionContext session_;
   ConfigHelper configHelper_;
+  ConfigStore configStore_;
 
   // Model data.
 
   // Appearance config.
-  QSettings appearanceConfig_;
-
-  // Dock configs, as map from dockIds to tuples of:
-  // (dock config file path,
-  //  dock config)
-  std::unordered_map<int,
-                     std::tuple<QString,
-                                std::unique_ptr<QSettings>>> dockConfigs_;
+  QVariantMap appearanceConfig_;
+  AppearanceSnapshot appearance_;
+  // The changes since the appearance config was last saved.
+  AppearanceChange pendingAppearanceChange_ = AppearanceChange::None;
+
+  // Transaction state.
+  int transactionDepth_ = 0;
+  // Whether saveAppearanceConfig() has been called in the transaction.
+  bool isAppearanceChangedInTransaction_ = false;
+  // The docks added or with saved config changes in the transaction.
+  std::set<int> addedDocks_;
+  std::set<int> changedDocks_;
+  // The appearance change being notified by commitTransaction().
+  AppearanceChange committingChange_ = AppearanceChange::None;
+
+  // Dock configs, as map from dockIds to pairs of:
+  // (dock config values,
+  //  dock config snapshot)
+  std::unordered_map<int, std::pair<QVariantMap, DockConfig>> dockConfigs_;
+  // Configs of the docks on screens that aren't connected, kept in the config store.
+  std::vector<QVariantMap> inactiveDocks_;
 
   // ID for the next dock.
   int nextDockId_;
 
+  // Cache of launcherConfigs() results, by dockId.
+  mutable std::unordered_map<int, std::vector<LauncherConfig>> launcherConfigs_;
+
   ApplicationMenuConfig applicationMenuConfig_;
   DesktopEnv* desktopEnv_;
 };
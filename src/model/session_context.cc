@@ -0,0 +1,41 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "session_context.h"
+
+#include "application_menu_config.h"
+#include <desktop/desktop_env.h>
+
+namespace crystaldock {
+
+/* static */ SessionContext SessionContext::fromEnvironment(const QString& configRootDir) {
+  SessionContext session;
+  session.setDesktop(DesktopEnv::getDesktopEnvName(), configRootDir);
+  session.entryDirs = ApplicationMenuConfig::getEntryDirs();
+  return session;
+}
+
+void SessionContext::setDesktop(const QString& name, const QString& configRootDir) {
+  desktopName = name;
+  legacyDesktopName = "X-" + name;
+  desktopEnv = DesktopEnv::getDesktopEnv(name);
+  configDir = configRootDir + "/" + name;
+}
+
+}  // namespace crystaldock
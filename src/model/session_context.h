@@ -0,0 +1,58 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CRYSTALDOCK_SESSION_CONTEXT_H_
+#define CRYSTALDOCK_SESSION_CONTEXT_H_
+
+#include <QString>
+#include <QStringList>
+
+namespace crystaldock {
+
+class DesktopEnv;
+
+// What the dock needs to know of the session that doesn't change while it runs. Read from
+// the environment once at start-up and passed to the model, which passes it on, so that
+// e.g. benchmarks can run against a desktop environment and directories of their own.
+struct SessionContext {
+  SessionContext() = default;
+
+  // From XDG_CURRENT_DESKTOP, e.g. "KDE" for "KDE" or "labwc" for "labwc:wlroots", or
+  // "generic" if it's not set.
+  QString desktopName;
+  // The legacy name that some desktop files still use, e.g. "X-KDE".
+  QString legacyDesktopName;
+  DesktopEnv* desktopEnv = nullptr;
+
+  // The directories of the application menu entries.
+  QStringList entryDirs;
+
+  // Where the configs are, separate for each desktop environment.
+  QString configDir;
+
+  // Reads the current session, with the configs under configRootDir.
+  static SessionContext fromEnvironment(const QString& configRootDir);
+
+  // For the desktop environment with this name instead of the current one.
+  void setDesktop(const QString& name, const QString& configRootDir);
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_SESSION_CONTEXT_H_
@@ -0,0 +1,159 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "task_tracker.h"
+
+#include "multi_dock_model.h"
+
+namespace crystaldock {
+
+/* static */ TaskTracker* TaskTracker::self() {
+  static TaskTracker self;
+  return &self;
+}
+
+void TaskTracker::init(const MultiDockModel* model) {
+  if (model_ != nullptr) {
+    return;
+  }
+
+  model_ = model;
+  connect(WindowSystem::self(), &WindowSystem::windowAdded, this, &TaskTracker::onWindowAdded);
+  connect(WindowSystem::self(), &WindowSystem::windowRemoved,
+          this, &TaskTracker::onWindowRemoved);
+  connect(WindowSystem::self(), &WindowSystem::windowLeftCurrentDesktop, this,
+          [this](void* window) {
+            if (model_->currentDesktopTasksOnly()) {
+              onWindowLeft(window);
+            }
+          });
+  connect(WindowSystem::self(), &WindowSystem::windowLeftCurrentActivity,
+          this, &TaskTracker::onWindowLeft);
+  connect(WindowSystem::self(), &WindowSystem::windowOutputsChanged,
+          this, &TaskTracker::onWindowOutputsChanged);
+  connect(WindowSystem::self(), &WindowSystem::currentDesktopChanged,
+          this, &TaskTracker::onFiltersChanged);
+  connect(WindowSystem::self(), &WindowSystem::currentActivityChanged,
+          this, &TaskTracker::onFiltersChanged);
+  // The screens' indices, and so the tasks' screen masks, may have changed.
+  connect(WindowSystem::self(), &WindowSystem::screenAdded,
+          this, &TaskTracker::onFiltersChanged);
+  connect(WindowSystem::self(), &WindowSystem::screenRemoved,
+          this, &TaskTracker::onFiltersChanged);
+  // The docks reload when the filter settings change, so they needn't be notified.
+  connect(model_, &MultiDockModel::appearanceChanged, this, [this] { tasks_.clear(); });
+}
+
+bool TaskTracker::isValid(const WindowInfo* task, int screen) {
+  if (task == nullptr) {
+    return false;
+  }
+
+  auto it = tasks_.find(task->window);
+  if (it == tasks_.end()) {
+    it = tasks_.emplace(task->window, classify(task)).first;
+  }
+  return it->second.valid && isOnScreen(it->second.screens, screen);
+}
+
+void TaskTracker::onWindowAdded(const WindowInfo* task) {
+  update(task);
+}
+
+void TaskTracker::onWindowRemoved(void* window) {
+  tasks_.erase(window);
+  emit taskLeft(window);
+}
+
+void TaskTracker::onWindowLeft(void* window) {
+  auto it = tasks_.find(window);
+  if (it == tasks_.end()) {
+    // Not classified yet, e.g. right after a reload.
+    emit taskLeft(window);
+  } else if (it->second.valid) {
+    it->second.valid = false;
+    emit taskLeft(window);
+  }
+}
+
+void TaskTracker::onWindowOutputsChanged(const WindowInfo* task) {
+  update(task);
+}
+
+void TaskTracker::onFiltersChanged() {
+  for (const auto* task : WindowSystem::windows()) {
+    if (task->initialized) {
+      update(task);
+    }
+  }
+}
+
+TaskTracker::TaskState TaskTracker::classify(const WindowInfo* task) const {
+  TaskState state{true, screensOf(task)};
+  if (task->skipTaskbar) {
+    state.valid = false;
+  } else if (WindowSystem::hasVirtualDesktopManager() && model_->currentDesktopTasksOnly()
+      && !task->onAllDesktops && task->desktop != WindowSystem::currentDesktop()) {
+    state.valid = false;
+  } else if (WindowSystem::hasActivityManager() && !WindowSystem::currentActivity().empty()
+      && !task->activity.empty() && task->activity != WindowSystem::currentActivity()) {
+    state.valid = false;
+  }
+  return state;
+}
+
+/* static */ TaskTracker::ScreenMask TaskTracker::screensOf(const WindowInfo* task) {
+  // Windows that haven't entered any output yet are shown on all screens.
+  if (task->outputs.empty()) {
+    return kAllScreens;
+  }
+
+  ScreenMask screens = kAllScreens;
+  const int numScreens = static_cast<int>(WindowSystem::screens().size());
+  for (int i = 0; i < numScreens && i < 32; ++i) {
+    if (!task->outputs.contains(WindowSystem::getWlOutputForScreen(i))) {
+      screens &= ~(ScreenMask{1} << i);
+    }
+  }
+  return screens;
+}
+
+void TaskTracker::update(const WindowInfo* task) {
+  const TaskState state = classify(task);
+  auto it = tasks_.find(task->window);
+  if (it == tasks_.end()) {
+    tasks_.emplace(task->window, state);
+    if (state.valid) {
+      emit taskEntered(task, state.screens);
+    }
+    return;
+  }
+
+  const TaskState old = it->second;
+  it->second = state;
+  if (state.valid && !old.valid) {
+    emit taskEntered(task, state.screens);
+  } else if (!state.valid && old.valid) {
+    emit taskLeft(task->window);
+  } else if (state.valid && state.screens != old.screens) {
+    emit taskScreensChanged(task, old.screens, state.screens);
+  }
+}
+
+}  // namespace crystaldock
@@ -0,0 +1,101 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CRYSTALDOCK_TASK_TRACKER_H_
+#define CRYSTALDOCK_TASK_TRACKER_H_
+
+#include <cstdint>
+#include <unordered_map>
+
+#include <QObject>
+
+#include <display/window_system.h>
+
+namespace crystaldock {
+
+class MultiDockModel;
+
+// Decides which windows are shown as tasks, once per window event for all docks,
+// rather than once per dock.
+//
+// The classification that doesn't depend on the dock (taskbar, desktop and activity
+// filters) is cached, along with the screens each window is on (from its outputs, so
+// geometry changes within the same outputs cost nothing), and docks are only
+// told about the changes: a task becoming valid or not, or moving between screens.
+// Docks that show the current screen's tasks only check their own screen's bit.
+class TaskTracker : public QObject {
+  Q_OBJECT
+
+ public:
+  // Bits of WindowSystem::screens() indices. Screens past the 32nd are always set.
+  using ScreenMask = uint32_t;
+  static constexpr ScreenMask kAllScreens = ~ScreenMask{0};
+
+  static TaskTracker* self();
+
+  // Starts tracking the windows. Has to be called before the docks connect to the
+  // window system, so that their slots run after the tracker's. Only the first call
+  // has an effect.
+  void init(const MultiDockModel* model);
+
+  // Whether the task should be shown, on the screen if screen >= 0 or on any screen.
+  bool isValid(const WindowInfo* task, int screen);
+
+  static bool isOnScreen(ScreenMask screens, int screen) {
+    return screen < 0 || screen >= 32 || (screens & (ScreenMask{1} << screen));
+  }
+
+ signals:
+  // The task has become valid, on the screens.
+  void taskEntered(const WindowInfo* task, ScreenMask screens);
+  // The window isn't a valid task anymore, or has been removed.
+  void taskLeft(void* window);
+  // The valid task has moved between screens.
+  void taskScreensChanged(const WindowInfo* task, ScreenMask oldScreens, ScreenMask newScreens);
+
+ private slots:
+  void onWindowAdded(const WindowInfo* task);
+  void onWindowRemoved(void* window);
+  void onWindowLeft(void* window);
+  void onWindowOutputsChanged(const WindowInfo* task);
+  // Reclassifies all windows, e.g. on desktop or activity changes.
+  void onFiltersChanged();
+
+ private:
+  struct TaskState {
+    bool valid;
+    ScreenMask screens;
+  };
+
+  TaskTracker() = default;
+
+  TaskState classify(const WindowInfo* task) const;
+
+  static ScreenMask screensOf(const WindowInfo* task);
+
+  // Reclassifies the window and notifies the docks of the change, if any.
+  void update(const WindowInfo* task);
+
+  const MultiDockModel* model_ = nullptr;
+  std::unordered_map<void*, TaskState> tasks_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_TASK_TRACKER_H_
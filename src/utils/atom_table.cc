@@ -0,0 +1,57 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "atom_table.h"
+
+namespace crystaldock {
+
+/* static */ AtomTable::Atom AtomTable::intern(std::string_view str) {
+  if (str.empty()) {
+    return kEmpty;
+  }
+
+  auto& table = atoms();
+  auto it = table.find(str);
+  if (it != table.end()) {
+    return it->second;
+  }
+
+  // std::deque doesn't move its elements, so the keys stay valid.
+  auto& strings = names();
+  const Atom atom = strings.size();
+  strings.emplace_back(str);
+  table[strings.back()] = atom;
+  return atom;
+}
+
+/* static */ const std::string& AtomTable::name(Atom atom) {
+  return names().at(atom);
+}
+
+/* static */ std::deque<std::string>& AtomTable::names() {
+  static std::deque<std::string> names{""};
+  return names;
+}
+
+/* static */ std::unordered_map<std::string_view, AtomTable::Atom>& AtomTable::atoms() {
+  static std::unordered_map<std::string_view, Atom> atoms;
+  return atoms;
+}
+
+}  // namespace crystaldock
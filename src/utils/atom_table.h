@@ -0,0 +1,55 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CRYSTALDOCK_ATOM_TABLE_H_
+#define CRYSTALDOCK_ATOM_TABLE_H_
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <QString>
+
+namespace crystaldock {
+
+// Interned strings (e.g. application IDs), so that they can be compared as integers.
+// Atoms are never freed, which is fine for the small set of distinct IDs seen in a session.
+// Not thread-safe: only used on the main thread.
+class AtomTable {
+ public:
+  using Atom = uint32_t;
+
+  // The atom of the empty string.
+  static constexpr Atom kEmpty = 0;
+
+  static Atom intern(std::string_view str);
+  static Atom intern(const QString& str) { return intern(str.toStdString()); }
+
+  static const std::string& name(Atom atom);
+
+ private:
+  static std::deque<std::string>& names();
+  static std::unordered_map<std::string_view, Atom>& atoms();
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_ATOM_TABLE_H_
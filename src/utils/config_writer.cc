@@ -0,0 +1,92 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config_writer.h"
+
+#include <iostream>
+
+#include <QCoreApplication>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+namespace crystaldock {
+
+/* static */ ConfigWriter* ConfigWriter::self() {
+  static ConfigWriter writer;
+  return &writer;
+}
+
+ConfigWriter::ConfigWriter() {
+  pool_.setMaxThreadCount(1);
+  timer_.setSingleShot(true);
+  timer_.setInterval(kWriteDelayMs);
+  QObject::connect(&timer_, &QTimer::timeout, [this]() { startWrites(); });
+  if (QCoreApplication::instance() != nullptr) {
+    QObject::connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit,
+                     [this]() { flush(); });
+  }
+}
+
+void ConfigWriter::schedule(const QString& path, const QVariantMap& values) {
+  pending_[path] = values;
+  if (!timer_.isActive()) {
+    timer_.start();
+  }
+}
+
+void ConfigWriter::discard(const QString& path) {
+  pending_.remove(path);
+  pool_.waitForDone();
+}
+
+void ConfigWriter::flush() {
+  timer_.stop();
+  startWrites();
+  pool_.waitForDone();
+}
+
+void ConfigWriter::startWrites() {
+  if (pending_.isEmpty()) {
+    return;
+  }
+
+  pool_.start([writes = std::move(pending_)]() {
+    for (auto it = writes.begin(); it != writes.end(); ++it) {
+      write(it.key(), it.value());
+    }
+  });
+  pending_.clear();
+}
+
+/* static */ bool ConfigWriter::write(const QString& path, const QVariantMap& values) {
+  // Writes to a temporary file, renamed over the original on commit().
+  QSaveFile file(path);
+  if (!file.open(QIODevice::WriteOnly)) {
+    std::cerr << "Could not write config file: " << path.toStdString() << std::endl;
+    return false;
+  }
+  file.write(QJsonDocument(QJsonObject::fromVariantMap(values)).toJson());
+  if (!file.commit()) {
+    std::cerr << "Could not replace config file: " << path.toStdString() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+}  // namespace crystaldock
@@ -0,0 +1,68 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CRYSTALDOCK_CONFIG_WRITER_H_
+#define CRYSTALDOCK_CONFIG_WRITER_H_
+
+#include <QMap>
+#include <QString>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVariantMap>
+
+namespace crystaldock {
+
+// Writes JSON config files off the GUI thread.
+//
+// Writes scheduled within kWriteDelayMs of each other are coalesced, keeping only the latest
+// values of each file. Each file is written to a temporary file first then renamed over the
+// original, so it's never left half-written. Scheduled writes are flushed when the
+// application is about to quit.
+class ConfigWriter {
+ public:
+  static constexpr int kWriteDelayMs = 300;
+
+  static ConfigWriter* self();
+
+  // Schedules writing the values, as a JSON object, to the file at path.
+  void schedule(const QString& path, const QVariantMap& values);
+
+  // Drops the scheduled write of the file at path, waiting for any write in progress.
+  void discard(const QString& path);
+
+  // Writes all scheduled values now, and waits until done.
+  void flush();
+
+ private:
+  ConfigWriter();
+
+  // Starts writing the scheduled values on the worker thread.
+  void startWrites();
+
+  static bool write(const QString& path, const QVariantMap& values);
+
+  // Scheduled values, by file path.
+  QMap<QString, QVariantMap> pending_;
+  QTimer timer_;
+  // A single worker thread, so that writes of the same file stay in order.
+  QThreadPool pool_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_CONFIG_WRITER_H_
@@ -0,0 +1,198 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "desktop_entry_parser.h"
+
+#include <cstdlib>
+
+#include <QByteArray>
+#include <QFile>
+#include <QIODevice>
+
+namespace crystaldock {
+
+namespace {
+
+constexpr std::string_view kDesktopEntryGroup = "[Desktop Entry]";
+constexpr std::string_view kUtf8Bom = "\xEF\xBB\xBF";
+
+std::string_view trim(std::string_view s) {
+  constexpr std::string_view kSpaces = " \t\r";
+  const auto first = s.find_first_not_of(kSpaces);
+  if (first == std::string_view::npos) {
+    return {};
+  }
+  return s.substr(first, s.find_last_not_of(kSpaces) - first + 1);
+}
+
+}  // namespace
+
+bool DesktopEntryParser::parse(const QString& file, std::vector<QString>* values) const {
+  QFile inputFile(file);
+  if (!inputFile.open(QIODevice::ReadOnly)) {
+    values->assign(keys_.size(), QString());
+    return false;
+  }
+
+  const qint64 size = inputFile.size();
+  uchar* data = size > 0 ? inputFile.map(0, size) : nullptr;
+  if (data) {
+    parse(std::string_view(reinterpret_cast<const char*>(data), size), values);
+    inputFile.unmap(data);
+  } else {
+    // E.g. files that can't be mapped, or that don't know their size.
+    const QByteArray contents = inputFile.readAll();
+    parse(std::string_view(contents.constData(), contents.size()), values);
+  }
+  return true;
+}
+
+void DesktopEntryParser::parse(std::string_view contents, std::vector<QString>* values) const {
+  values->assign(keys_.size(), QString());
+  std::vector<int> ranks(keys_.size(), 0);
+  if (contents.starts_with(kUtf8Bom)) {
+    contents.remove_prefix(kUtf8Bom.size());
+  }
+
+  bool inGroup = false;
+  while (!contents.empty()) {
+    const auto end = contents.find('\n');
+    const std::string_view line = trim(contents.substr(0, end));
+    contents.remove_prefix(end == std::string_view::npos ? contents.size() : end + 1);
+    if (line.empty() || line.front() == '#') {
+      continue;
+    }
+    if (line.front() == '[') {  // start of a new group.
+      if (inGroup) {
+        break;
+      }
+      inGroup = (line == kDesktopEntryGroup);
+      continue;
+    }
+    if (!inGroup) {
+      continue;
+    }
+
+    const auto equals = line.find('=');
+    if (equals == std::string_view::npos) {
+      continue;
+    }
+    std::string_view key = trim(line.substr(0, equals));
+    const std::string_view value = trim(line.substr(equals + 1));
+    if (value.empty()) {
+      continue;
+    }
+    std::string_view tag;
+    const auto bracket = key.find('[');
+    if (bracket != std::string_view::npos) {
+      if (key.back() != ']') {
+        continue;
+      }
+      tag = key.substr(bracket + 1, key.size() - bracket - 2);
+      key = key.substr(0, bracket);
+    }
+
+    for (size_t i = 0; i < keys_.size(); ++i) {
+      if (keys_[i].name != key) {
+        continue;
+      }
+      const int rank = tag.empty() ? 1 : (keys_[i].localized ? localeRank(tag) : 0);
+      if (rank > ranks[i]) {
+        ranks[i] = rank;
+        (*values)[i] = unescape(value);
+      }
+      break;
+    }
+  }
+}
+
+/* static */ const DesktopEntryParser::Locale& DesktopEntryParser::systemLocale() {
+  static const Locale locale = [] {
+    for (const char* name : {"LC_ALL", "LC_MESSAGES", "LANG"}) {
+      const char* value = std::getenv(name);
+      if (value && *value) {
+        return parseLocale(value);
+      }
+    }
+    return Locale();
+  }();
+  return locale;
+}
+
+/* static */ DesktopEntryParser::Locale DesktopEntryParser::parseLocale(
+    std::string_view locale) {
+  // lang_COUNTRY.ENCODING@MODIFIER, where all but lang are optional.
+  Locale result;
+  const auto at = locale.find('@');
+  if (at != std::string_view::npos) {
+    result.modifier = locale.substr(at + 1);
+    locale = locale.substr(0, at);
+  }
+  locale = locale.substr(0, locale.find('.'));
+  const auto underscore = locale.find('_');
+  if (underscore != std::string_view::npos) {
+    result.country = locale.substr(underscore + 1);
+    locale = locale.substr(0, underscore);
+  }
+  if (locale == "C" || locale == "POSIX") {
+    return Locale();
+  }
+  result.lang = locale;
+  return result;
+}
+
+int DesktopEntryParser::localeRank(std::string_view tag) const {
+  const Locale tagLocale = parseLocale(tag);
+  if (tagLocale.lang.empty() || tagLocale.lang != locale_.lang ||
+      (!tagLocale.country.empty() && tagLocale.country != locale_.country) ||
+      (!tagLocale.modifier.empty() && tagLocale.modifier != locale_.modifier)) {
+    return 0;
+  }
+  // lang_COUNTRY@MODIFIER, then lang_COUNTRY, then lang@MODIFIER, then lang.
+  return 2 + (tagLocale.country.empty() ? 0 : 2) + (tagLocale.modifier.empty() ? 0 : 1);
+}
+
+/* static */ QString DesktopEntryParser::unescape(std::string_view value) {
+  if (value.find('\\') == std::string_view::npos) {
+    return QString::fromUtf8(value.data(), value.size());
+  }
+
+  std::string unescaped;
+  unescaped.reserve(value.size());
+  for (size_t i = 0; i < value.size(); ++i) {
+    if (value[i] != '\\' || i + 1 == value.size()) {
+      unescaped += value[i];
+      continue;
+    }
+    switch (value[++i]) {
+      case 's': unescaped += ' '; break;
+      case 'n': unescaped += '\n'; break;
+      case 't': unescaped += '\t'; break;
+      case 'r': unescaped += '\r'; break;
+      case '\\': unescaped += '\\'; break;
+      default:
+        // Kept as is, e.g. \; in lists.
+        unescaped += '\\';
+        unescaped += value[i];
+    }
+  }
+  return QString::fromStdString(unescaped);
+}
+
+}  // namespace crystaldock
@@ -0,0 +1,83 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CRYSTALDOCK_DESKTOP_ENTRY_PARSER_H_
+#define CRYSTALDOCK_DESKTOP_ENTRY_PARSER_H_
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <QString>
+
+namespace crystaldock {
+
+// Extracts a few keys from the [Desktop Entry] group of desktop files.
+//
+// The file is mapped and scanned in place, and only the values of the requested keys
+// are copied out, as QStrings, so most of a file (e.g. the translations of other
+// locales and the [Desktop Action] groups) costs no allocation. Can be used from
+// any thread.
+class DesktopEntryParser {
+ public:
+  struct Key {
+    std::string_view name;
+    // A localestring, e.g. Name, whose value for the best matching locale is taken.
+    bool localized = false;
+  };
+
+  // The locale that localized keys are matched against, i.e. lang_COUNTRY@MODIFIER,
+  // see https://specifications.freedesktop.org/desktop-entry-spec/latest/localized-keys.html
+  struct Locale {
+    std::string lang;
+    std::string country;
+    std::string modifier;
+  };
+
+  // The keys must outlive the parser.
+  explicit DesktopEntryParser(std::span<const Key> keys, Locale locale = systemLocale())
+      : keys_(keys), locale_(std::move(locale)) {}
+
+  // Parses the file into values, one per key, which are empty for the keys that the file
+  // doesn't have. Returns false if the file can't be read.
+  bool parse(const QString& file, std::vector<QString>* values) const;
+  // Parses the contents of a desktop file.
+  void parse(std::string_view contents, std::vector<QString>* values) const;
+
+  // The locale of LC_ALL, LC_MESSAGES or LANG.
+  static const Locale& systemLocale();
+  static Locale parseLocale(std::string_view locale);
+
+ private:
+  // How well the locale tag of a key, e.g. de_DE in Name[de_DE], matches locale_.
+  // 0 if it doesn't, higher than 1 (that of the key without a tag) if it does.
+  int localeRank(std::string_view tag) const;
+
+  // Unescapes \s, \n, \t, \r and \\.
+  static QString unescape(std::string_view value);
+
+  std::span<const Key> keys_;
+  Locale locale_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_DESKTOP_ENTRY_PARSER_H_
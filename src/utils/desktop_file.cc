@@ -18,33 +18,49 @@
 
 #include "desktop_file.h"
 
+#include <utility>
+#include <vector>
+
 #include <QFile>
 #include <QFileInfo>
 #include <QIODevice>
 #include <QTextStream>
 
+#include "desktop_entry_parser.h"
+
 namespace crystaldock {
 
+namespace {
+
+// The keys that DesktopFile has accessors for.
+constexpr DesktopEntryParser::Key kKeys[] = {
+    {"Name", /*localized=*/true},
+    {"GenericName", /*localized=*/true},
+    {"Keywords", /*localized=*/true},
+    {"StartupWMClass"},
+    {"Icon"},
+    {"Exec"},
+    {"Type"},
+    {"Categories"},
+    {"OnlyShowIn"},
+    {"NotShowIn"},
+    {"NoDisplay"},
+    {"Hidden"},
+};
+
+}  // namespace
+
 DesktopFile::DesktopFile(const QString& file) {
-  QFile inputFile(file);
-  if (inputFile.open(QIODevice::ReadOnly)) {
-    appId_ = QFileInfo(file).completeBaseName().toLower();
-    QTextStream input(&inputFile);
-    bool parsing = false;
-    while (!input.atEnd()) {
-      QString line = input.readLine().trimmed();
-      if (!parsing) {
-        if (line == "[Desktop Entry]") {
-          parsing = true;
-        }
-      } else {
-        int index = line.indexOf('=');
-        if (index >= 0 && index < line.length() - 1) {
-          values_[line.left(index)] = line.mid(index + 1);
-        } else if (line.startsWith("[")) {  // start of a new section.
-          break;
-        }
-      }
+  static const DesktopEntryParser parser(kKeys);
+  std::vector<QString> values;
+  if (!parser.parse(file, &values)) {
+    return;
+  }
+
+  appId_ = QFileInfo(file).completeBaseName().toLower();
+  for (size_t i = 0; i < values.size(); ++i) {
+    if (!values[i].isEmpty()) {
+      values_[QString::fromLatin1(kKeys[i].name)] = std::move(values[i]);
     }
   }
 }
@@ -19,6 +19,7 @@
 #ifndef CRYSTALDOCK_DESKTOP_FILE_H
 #define CRYSTALDOCK_DESKTOP_FILE_H
 
+#include <QDataStream>
 #include <QMap>
 #include <QString>
 #include <QStringList>
@@ -56,6 +57,9 @@ class DesktopFile {
   QStringList categories() const { return values_["Categories"].split(";", Qt::SkipEmptyParts); }
   void setCategories(const QString& categories) { values_["Categories"] = categories; }
 
+  QStringList keywords() const { return values_["Keywords"].split(";", Qt::SkipEmptyParts); }
+  void setKeywords(const QString& keywords) { values_["Keywords"] = keywords; }
+
   QStringList onlyShowIn() const { return values_["OnlyShowIn"].split(";", Qt::SkipEmptyParts); }
   void setOnlyShowIn(const QString& desktops) { values_["OnlyShowIn"] = desktops; }
 
@@ -71,6 +75,13 @@ class DesktopFile {
   // Should we show this entry on this desktop?
   bool showOnDesktop(const QString& desktop) const;
 
+  // Binary serialization, for caching parsed desktop files.
+  void save(QDataStream& out) const { out << appId_ << values_; }
+  bool load(QDataStream& in) {
+    in >> appId_ >> values_;
+    return in.status() == QDataStream::Ok;
+  }
+
  private:
   QString appId_;
   QMap<QString, QString> values_;
@@ -26,41 +26,41 @@
 #include <QRect>
 #include <QString>
 
+#include "outlined_text.h"
+
 namespace crystaldock {
 
+// Draws the text with its baseline starting at (x, y).
 inline void drawBorderedText(int x, int y, const QString& text, int borderWidth,
-                             QColor borderColor, QColor textColor,
-                             QPainter* painter, bool simplified = false) {
-  painter->setPen(borderColor);
-  const int delta = simplified ? 2 * borderWidth : 1;
-  for (int i = -borderWidth; i <= borderWidth; i += delta) {
-    for (int j = -borderWidth; j <= borderWidth; j += delta) {
-      if (i != 0 || j != 0) {
-        painter->drawText(x + i, y + j, text);
-      }
-    }
-  }
-
-  painter->setPen(textColor);
-  painter->drawText(x, y, text);
+                             QColor borderColor, QColor textColor, QPainter* painter) {
+  const QPixmap& pixmap = OutlinedText::get(text, painter->font(), borderWidth, borderColor,
+                                            textColor, painter->device()->devicePixelRatioF());
+  painter->drawPixmap(x - borderWidth, y - borderWidth - painter->fontMetrics().ascent(),
+                      pixmap);
 }
 
+// Draws the single-line text aligned inside the rect according to flags.
 inline void drawBorderedText(int x, int y, int width, int height, int flags,
                              const QString& text, int borderWidth,
-                             QColor borderColor, QColor textColor,
-                             QPainter* painter, bool simplified = false) {
-  painter->setPen(borderColor);
-  const int delta = simplified ? 2 * borderWidth : 1;
-  for (int i = -borderWidth; i <= borderWidth; i += delta) {
-    for (int j = -borderWidth; j <= borderWidth; j += delta) {
-      if (i != 0 || j != 0) {
-        painter->drawText(x + i, y + j, width, height, flags, text);
-      }
-    }
+                             QColor borderColor, QColor textColor, QPainter* painter) {
+  const QPixmap& pixmap = OutlinedText::get(text, painter->font(), borderWidth, borderColor,
+                                            textColor, painter->device()->devicePixelRatioF());
+  // The pixmap covers the text's line box plus the border on each side.
+  const int textWidth = pixmap.deviceIndependentSize().width() - 2 * borderWidth;
+  const int textHeight = pixmap.deviceIndependentSize().height() - 2 * borderWidth;
+  int left = x;
+  if (flags & Qt::AlignRight) {
+    left = x + width - textWidth;
+  } else if (flags & Qt::AlignHCenter) {
+    left = x + (width - textWidth) / 2;
   }
-
-  painter->setPen(textColor);
-  painter->drawText(x, y, width, height, flags, text);
+  int top = y;
+  if (flags & Qt::AlignBottom) {
+    top = y + height - textHeight;
+  } else if (flags & Qt::AlignVCenter) {
+    top = y + (height - textHeight) / 2;
+  }
+  painter->drawPixmap(left - borderWidth, top - borderWidth, pixmap);
 }
 
 inline void drawHighlightedIcon(QColor bgColor, int left, int top, int width, int height,
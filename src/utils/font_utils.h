@@ -25,15 +25,45 @@
 #include <QFont>
 #include <QFontDatabase>
 #include <QFontMetrics>
+#include <QHash>
 #include <QRect>
 #include <QString>
 
 namespace crystaldock {
 
+struct FontLayoutKey {
+  int w;
+  int h;
+  QString referenceString;
+  float scaleFactor;
+  QString fontFamily;
+
+  bool operator==(const FontLayoutKey& other) const = default;
+};
+
+inline size_t qHash(const FontLayoutKey& key, size_t seed = 0) {
+  return qHashMulti(seed, key.w, key.h, key.referenceString, key.scaleFactor, key.fontFamily);
+}
+
 // Returns a QFont with font size adjusted automatically according to the given
 // width, height, reference string and scale factor.
+//
+// The results are cached since this is called on every paint of the clock and
+// the pager. Must be called on the GUI thread only.
 inline QFont adjustFontSize(int w, int h, const QString& referenceString,
                             float scaleFactor, const QString& fontFamily = "") {
+  // The zoom animation goes through every size so keep the cache bounded.
+  static constexpr int kMaxCachedLayouts = 256;
+  static QHash<FontLayoutKey, QFont> cache;
+  FontLayoutKey key{w, h, referenceString, scaleFactor, fontFamily};
+  auto it = cache.constFind(key);
+  if (it != cache.constEnd()) {
+    return *it;
+  }
+  if (cache.size() >= kMaxCachedLayouts) {
+    cache.clear();
+  }
+
   QFont font;
   QFontMetrics metrics(font);
   const QRect& rect = metrics.tightBoundingRect(referenceString);
@@ -45,6 +75,7 @@ inline QFont adjustFontSize(int w, int h, const QString& referenceString,
     font.setFamily(fontFamily);
   }
 
+  cache.insert(std::move(key), font);
   return font;
 }
 
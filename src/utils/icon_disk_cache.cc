@@ -0,0 +1,182 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "icon_disk_cache.h"
+
+#include <cstring>
+#include <iostream>
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QIcon>
+#include <QMutexLocker>
+#include <QSaveFile>
+
+namespace crystaldock {
+
+QMutex IconDiskCache::mutex_;
+QString IconDiskCache::cacheDir_;
+QString IconDiskCache::themeName_;
+QDir IconDiskCache::themeDir_;
+
+/* static */ void IconDiskCache::init(const QString& cacheDir) {
+  QMutexLocker locker(&mutex_);
+  cacheDir_ = cacheDir;
+  themeName_.clear();
+}
+
+/* static */ QImage IconDiskCache::load(const QString& iconName, int size) {
+  QMutexLocker locker(&mutex_);
+  if (iconName.isEmpty() || !checkTheme()) {
+    return QImage();
+  }
+
+  QFile file(cacheFile(iconName, size));
+  if (!file.open(QIODevice::ReadOnly) || file.size() < static_cast<qint64>(sizeof(Header))) {
+    return QImage();
+  }
+
+  uchar* data = file.map(0, file.size());
+  if (data == nullptr) {
+    return QImage();
+  }
+
+  Header header;
+  std::memcpy(&header, data, sizeof(Header));
+  QImage icon;
+  if (std::memcmp(header.magic, kMagic, sizeof(header.magic)) == 0 &&
+      header.version == kVersion &&
+      header.fileTime == fileTime(iconName) &&
+      file.size() == static_cast<qint64>(sizeof(Header)) +
+          static_cast<qint64>(header.bytesPerLine) * header.height) {
+    // copy() detaches the image from the mapped memory before unmapping.
+    icon = QImage(data + sizeof(Header), header.width, header.height, header.bytesPerLine,
+                  QImage::Format_ARGB32_Premultiplied).copy();
+  }
+  file.unmap(data);
+  return icon;
+}
+
+/* static */ void IconDiskCache::store(const QString& iconName, int size, const QImage& icon) {
+  QMutexLocker locker(&mutex_);
+  if (iconName.isEmpty() || icon.isNull() || !checkTheme()) {
+    return;
+  }
+
+  const QImage image = icon.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+  Header header;
+  std::memcpy(header.magic, kMagic, sizeof(header.magic));
+  header.version = kVersion;
+  header.width = image.width();
+  header.height = image.height();
+  header.bytesPerLine = image.bytesPerLine();
+  header.fileTime = fileTime(iconName);
+
+  QSaveFile file(cacheFile(iconName, size));
+  if (!file.open(QIODevice::WriteOnly)) {
+    return;
+  }
+  file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+  file.write(reinterpret_cast<const char*>(image.constBits()), image.sizeInBytes());
+  if (!file.commit()) {
+    std::cerr << "Failed to write icon cache file: " << file.fileName().toStdString()
+              << std::endl;
+  }
+}
+
+/* static */ void IconDiskCache::invalidate() {
+  QMutexLocker locker(&mutex_);
+  if (checkTheme()) {
+    themeDir_.removeRecursively();
+    themeName_.clear();
+  }
+}
+
+/* static */ void IconDiskCache::revalidate() {
+  QMutexLocker locker(&mutex_);
+  themeName_.clear();
+}
+
+/* static */ bool IconDiskCache::checkTheme() {
+  if (cacheDir_.isEmpty()) {
+    return false;
+  }
+
+  const QString themeName = QIcon::themeName();
+  if (themeName == themeName_) {
+    return true;
+  }
+
+  themeName_ = themeName;
+  themeDir_ = QDir(cacheDir_ + "/" + (themeName.isEmpty() ? "default" : themeName));
+  const QString stamp = themeStamp();
+  QFile stampFile(themeDir_.filePath(kStampFile));
+  if (stampFile.open(QIODevice::ReadOnly) && stampFile.readAll() == stamp.toUtf8()) {
+    return true;
+  }
+  stampFile.close();
+
+  // The theme has been modified since the icons were cached.
+  themeDir_.removeRecursively();
+  QDir::root().mkpath(themeDir_.path());
+  if (!stampFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    std::cerr << "Failed to create icon cache in: " << themeDir_.path().toStdString()
+              << std::endl;
+    cacheDir_.clear();
+    return false;
+  }
+  stampFile.write(stamp.toUtf8());
+  return true;
+}
+
+/* static */ QString IconDiskCache::themeStamp() {
+  QString stamp = QIcon::themeName() + ";" + QIcon::fallbackThemeName();
+  for (const auto& theme : {QIcon::themeName(), QIcon::fallbackThemeName()}) {
+    if (theme.isEmpty()) {
+      continue;
+    }
+    for (const auto& searchPath : QIcon::themeSearchPaths()) {
+      const QString themePath = searchPath + "/" + theme;
+      for (const auto& path : {themePath, themePath + "/index.theme",
+                               themePath + "/icon-theme.cache"}) {
+        QFileInfo info(path);
+        if (info.exists()) {
+          stamp += ";" + QString::number(info.lastModified().toSecsSinceEpoch());
+        }
+      }
+    }
+  }
+  return stamp;
+}
+
+/* static */ QString IconDiskCache::cacheFile(const QString& iconName, int size) {
+  const QByteArray key = (iconName + "@" + QString::number(size)).toUtf8();
+  return themeDir_.filePath(
+      QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex() + ".icon");
+}
+
+/* static */ int64_t IconDiskCache::fileTime(const QString& iconName) {
+  if (!iconName.startsWith('/')) {
+    return 0;
+  }
+  return QFileInfo(iconName).lastModified().toMSecsSinceEpoch();
+}
+
+}  // namespace crystaldock
@@ -0,0 +1,90 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CRYSTALDOCK_ICON_DISK_CACHE_H_
+#define CRYSTALDOCK_ICON_DISK_CACHE_H_
+
+#include <QDir>
+#include <QImage>
+#include <QMutex>
+#include <QString>
+
+namespace crystaldock {
+
+// Persistent cache of decoded icon rasters, so that cold start does not need
+// to look up the icon theme or rasterize SVG icons again.
+//
+// Rasters are stored uncompressed under <cacheDir>/<icon theme>/ and are
+// memory-mapped when loaded. The whole theme directory is discarded when the
+// icon theme changes or has been modified (e.g. updated by the package
+// manager). Thread-safe.
+class IconDiskCache {
+ public:
+  // Enables the cache. Until this is called, load() always misses.
+  static void init(const QString& cacheDir);
+
+  // Loads the icon with the specified name and load size from the cache.
+  // Returns a null image if not cached.
+  static QImage load(const QString& iconName, int size);
+
+  // Stores the icon with the specified name and load size in the cache.
+  static void store(const QString& iconName, int size, const QImage& icon);
+
+  // Discards all cached icons for the current icon theme.
+  static void invalidate();
+
+  // Makes the next load or store check again whether the icon theme has been
+  // switched or modified.
+  static void revalidate();
+
+  // Returns a stamp that changes when the current icon theme is switched or modified.
+  static QString themeStamp();
+
+ private:
+  static constexpr char kMagic[] = "CDIC";
+  static constexpr int kVersion = 1;
+  static constexpr char kStampFile[] = "stamp";
+
+  struct Header {
+    char magic[4];
+    int32_t version;
+    int32_t width;
+    int32_t height;
+    int32_t bytesPerLine;
+    // Modification time of the icon file, for icons specified by path.
+    int64_t fileTime;
+  };
+
+  // Makes sure the cache directory matches the current icon theme.
+  static bool checkTheme();
+
+  static QString cacheFile(const QString& iconName, int size);
+
+  // Modification time of the icon file, or 0 for themed icons.
+  static int64_t fileTime(const QString& iconName);
+
+  static QMutex mutex_;
+  static QString cacheDir_;
+  // Name of the icon theme that themeDir_ is for.
+  static QString themeName_;
+  static QDir themeDir_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_ICON_DISK_CACHE_H_
@@ -0,0 +1,192 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "icon_loader.h"
+
+#include <algorithm>
+
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QMutexLocker>
+#include <QPointer>
+#include <QThreadPool>
+
+#include <private/qguiapplication_p.h>
+#include <private/qiconloader_p.h>
+#include <qpa/qplatformintegration.h>
+
+#include "icon_disk_cache.h"
+#include "icon_utils.h"
+
+namespace crystaldock {
+
+QMutex IconLoader::mutex_;
+QHash<std::pair<QString, int>, QImage> IconLoader::preloaded_;
+
+/* static */ bool IconLoader::canLoadInBackground() {
+  static const bool threadedPixmaps = QGuiApplicationPrivate::platformIntegration() &&
+      QGuiApplicationPrivate::platformIntegration()->hasCapability(
+          QPlatformIntegration::ThreadedPixmaps);
+  return threadedPixmaps;
+}
+
+/* static */ void IconLoader::loadAsync(const QStringList& iconNames, int iconLoadSize,
+                                        QObject* context,
+                                        std::function<void(const QPixmap&)> callback) {
+  QPointer<QObject> guard(context);
+  auto deliver = [guard, callback](const QImage& image) {
+    QMetaObject::invokeMethod(QCoreApplication::instance(), [image, guard, callback]() {
+      if (guard) {
+        callback(QPixmap::fromImage(image));
+      }
+    }, Qt::QueuedConnection);
+  };
+
+  // (icon name, file) in the order of iconNames, up to the first cached one.
+  std::vector<std::pair<QString, QString>> files;
+  for (const auto& iconName : iconNames) {
+    if (iconName.isEmpty()) {
+      continue;
+    }
+    const QImage cached = IconDiskCache::load(iconName, iconLoadSize);
+    if (!cached.isNull()) {
+      if (files.empty()) {
+        deliver(cached);
+        return;
+      }
+      break;
+    }
+    QString file = findIconFile(iconName, iconLoadSize);
+    if (!file.isEmpty()) {
+      files.emplace_back(iconName, std::move(file));
+    }
+  }
+
+  if (files.empty()) {
+    // E.g. provided by the platform theme's icon engine rather than by files, so loaded
+    // on the GUI thread, later.
+    QMetaObject::invokeMethod(QCoreApplication::instance(),
+                              [iconNames, iconLoadSize, guard, callback]() {
+      if (!guard) {
+        return;
+      }
+      for (const auto& iconName : iconNames) {
+        const QPixmap icon = iconName.isEmpty() ? QPixmap() : loadIcon(iconName, iconLoadSize);
+        if (!icon.isNull()) {
+          callback(icon);
+          return;
+        }
+      }
+      callback(QPixmap());
+    }, Qt::QueuedConnection);
+    return;
+  }
+
+  QThreadPool::globalInstance()->start([files, iconLoadSize, deliver]() {
+    QImage image;
+    for (const auto& [iconName, file] : files) {
+      image = readIconFile(file, iconLoadSize);
+      if (!image.isNull()) {
+        IconDiskCache::store(iconName, iconLoadSize, image);
+        break;
+      }
+    }
+    deliver(image);
+  });
+}
+
+/* static */ QString IconLoader::findIconFile(const QString& iconName, int iconLoadSize) {
+  // Snap stores icon name as path to the icon file e.g.
+  // /snap/firefox/5134/default256.png
+  if (QFileInfo(iconName).isAbsolute()) {
+    return QFileInfo::exists(iconName) ? iconName : QString();
+  }
+
+  // Vector icons first, then the smallest one that is at least iconLoadSize, else the largest.
+  QString file;
+  int fileSize = 0;
+  const QThemeIconInfo info = QIconLoader::instance()->loadIcon(iconName);
+  for (const auto& entry : info.entries) {
+    if (entry->dir.type == QIconDirInfo::Scalable) {
+      return entry->filename;
+    }
+    const int size = entry->dir.size * std::max<int>(1, entry->dir.scale);
+    if (file.isEmpty() || (fileSize < iconLoadSize ? size > fileSize
+                                                   : size >= iconLoadSize && size < fileSize)) {
+      file = entry->filename;
+      fileSize = size;
+    }
+  }
+  return file;
+}
+
+/* static */ QImage IconLoader::readIconFile(const QString& file, int iconLoadSize) {
+  QImageReader reader(file);
+  QSize size = reader.size();
+  const bool isVector = reader.format().startsWith("svg");
+  if (size.isValid() &&
+      (isVector || size.width() > iconLoadSize || size.height() > iconLoadSize)) {
+    size.scale(iconLoadSize, iconLoadSize, Qt::KeepAspectRatio);
+    reader.setScaledSize(size);
+  }
+  return reader.read();
+}
+
+/* static */ void IconLoader::preload(const std::vector<std::pair<QString, int>>& icons) {
+  std::vector<QString> files(icons.size());
+  std::vector<QImage> images(icons.size());
+  for (size_t i = 0; i < icons.size(); ++i) {
+    images[i] = IconDiskCache::load(icons[i].first, icons[i].second);
+    if (images[i].isNull()) {
+      files[i] = findIconFile(icons[i].first, icons[i].second);
+    }
+  }
+
+  QThreadPool pool;
+  for (size_t i = 0; i < icons.size(); ++i) {
+    if (!files[i].isEmpty()) {
+      pool.start([&icons, &files, &images, i]() {
+        images[i] = readIconFile(files[i], icons[i].second);
+        if (!images[i].isNull()) {
+          IconDiskCache::store(icons[i].first, icons[i].second, images[i]);
+        }
+      });
+    }
+  }
+  pool.waitForDone();
+
+  QMutexLocker locker(&mutex_);
+  for (size_t i = 0; i < icons.size(); ++i) {
+    if (!images[i].isNull()) {
+      preloaded_.insert(icons[i], std::move(images[i]));
+    }
+  }
+}
+
+/* static */ void IconLoader::releasePreloaded() {
+  QMutexLocker locker(&mutex_);
+  preloaded_.clear();
+}
+
+/* static */ QImage IconLoader::preloaded(const QString& iconName, int iconLoadSize) {
+  QMutexLocker locker(&mutex_);
+  return preloaded_.value({iconName, iconLoadSize});
+}
+
+}  // namespace crystaldock
@@ -0,0 +1,75 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CRYSTALDOCK_ICON_LOADER_H_
+#define CRYSTALDOCK_ICON_LOADER_H_
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QPixmap>
+#include <QStringList>
+
+namespace crystaldock {
+
+// Loads icons on worker threads. The icon theme is looked up on the GUI thread, as Qt's
+// icon loader and icon engines aren't thread-safe; only decoding and scaling the icon
+// files are done by the workers.
+class IconLoader {
+ public:
+  // Whether icons can be loaded outside the GUI thread on this platform.
+  static bool canLoadInBackground();
+
+  // Loads the first icon that can be found among iconNames on a worker
+  // thread, then calls callback on the GUI thread with the result (a null
+  // pixmap if none can be found). The callback is dropped if context has
+  // been destroyed by then. Must be called on the GUI thread.
+  static void loadAsync(const QStringList& iconNames, int iconLoadSize, QObject* context,
+                        std::function<void(const QPixmap&)> callback);
+
+  // Loads the icons, given as (icon name, load size), concurrently on worker threads and
+  // waits for them, so that loadIcon() returns them without looking them up again until
+  // releasePreloaded(). Must be called on the GUI thread.
+  static void preload(const std::vector<std::pair<QString, int>>& icons);
+
+  static void releasePreloaded();
+
+  // Returns the preloaded icon, or a null image if it hasn't been preloaded. Thread-safe.
+  static QImage preloaded(const QString& iconName, int iconLoadSize);
+
+ private:
+  // The file in the icon theme that best fits iconLoadSize, the icon itself if it's a path,
+  // or an empty string if there are none. Must be called on the GUI thread.
+  static QString findIconFile(const QString& iconName, int iconLoadSize);
+
+  // Decodes the icon file, scaled down to fit iconLoadSize; vector icons are rendered at
+  // iconLoadSize. Thread-safe.
+  static QImage readIconFile(const QString& file, int iconLoadSize);
+
+  static QMutex mutex_;
+  static QHash<std::pair<QString, int>, QImage> preloaded_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_ICON_LOADER_H_
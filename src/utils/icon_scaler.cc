@@ -0,0 +1,278 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "icon_scaler.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace crystaldock {
+
+namespace {
+
+// Filter weights are in 2.14 fixed point.
+constexpr int kWeightBits = 14;
+constexpr int kRound = 1 << (kWeightBits - 1);
+
+// Returns the weighted sum of the n pixels at src, src + stride, ...
+inline uint32_t filterPixel(const uint32_t* src, ptrdiff_t stride, const int16_t* weights,
+                            int n) {
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  __m128i acc = _mm_set1_epi32(kRound);
+  int k = 0;
+  // Two taps per multiply-add: the channels of both pixels are interleaved.
+  for (; k + 1 < n; k += 2) {
+    const __m128i p0 = _mm_unpacklo_epi8(
+        _mm_cvtsi32_si128(static_cast<int>(src[k * stride])), zero);
+    const __m128i p1 = _mm_unpacklo_epi8(
+        _mm_cvtsi32_si128(static_cast<int>(src[(k + 1) * stride])), zero);
+    const __m128i w = _mm_set1_epi32(static_cast<int>(
+        (static_cast<uint32_t>(static_cast<uint16_t>(weights[k + 1])) << 16) |
+        static_cast<uint16_t>(weights[k])));
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_unpacklo_epi16(p0, p1), w));
+  }
+  if (k < n) {
+    const __m128i p0 = _mm_unpacklo_epi8(
+        _mm_cvtsi32_si128(static_cast<int>(src[k * stride])), zero);
+    const __m128i w = _mm_set1_epi32(static_cast<uint16_t>(weights[k]));
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_unpacklo_epi16(p0, zero), w));
+  }
+  acc = _mm_srai_epi32(acc, kWeightBits);
+  acc = _mm_packs_epi32(acc, acc);
+  acc = _mm_packus_epi16(acc, acc);
+  return static_cast<uint32_t>(_mm_cvtsi128_si32(acc));
+#elif defined(__ARM_NEON)
+  uint32x4_t acc = vdupq_n_u32(kRound);
+  for (int k = 0; k < n; ++k) {
+    const uint16x4_t p = vget_low_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(src[k * stride]))));
+    acc = vmlal_n_u16(acc, p, static_cast<uint16_t>(weights[k]));
+  }
+  const uint16x4_t sum = vmovn_u32(vshrq_n_u32(acc, kWeightBits));
+  return vget_lane_u32(vreinterpret_u32_u8(vmovn_u16(vcombine_u16(sum, sum))), 0);
+#else
+  uint32_t acc[4] = {kRound, kRound, kRound, kRound};
+  for (int k = 0; k < n; ++k) {
+    const uint32_t p = src[k * stride];
+    for (int c = 0; c < 4; ++c) {
+      acc[c] += ((p >> (8 * c)) & 0xff) * static_cast<uint32_t>(weights[k]);
+    }
+  }
+  uint32_t result = 0;
+  for (int c = 0; c < 4; ++c) {
+    result |= (acc[c] >> kWeightBits) << (8 * c);
+  }
+  return result;
+#endif
+}
+
+// Returns the rounded average of four pixels.
+inline uint32_t averagePixels(uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  const auto unpack = [zero](uint32_t p) {
+    return _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(p)), zero);
+  };
+  __m128i sum = _mm_add_epi16(_mm_add_epi16(unpack(a), unpack(b)),
+                              _mm_add_epi16(unpack(c), unpack(d)));
+  sum = _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(2)), 2);
+  return static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_packus_epi16(sum, sum)));
+#elif defined(__ARM_NEON)
+  const uint8x8_t ab = vreinterpret_u8_u32(vset_lane_u32(b, vdup_n_u32(a), 1));
+  const uint8x8_t cd = vreinterpret_u8_u32(vset_lane_u32(d, vdup_n_u32(c), 1));
+  const uint16x8_t sum = vaddl_u8(ab, cd);
+  const uint16x4_t total = vadd_u16(vget_low_u16(sum), vget_high_u16(sum));
+  const uint8x8_t result = vrshrn_n_u16(vcombine_u16(total, total), 2);
+  return vget_lane_u32(vreinterpret_u32_u8(result), 0);
+#else
+  uint32_t result = 0;
+  for (int ch = 0; ch < 4; ++ch) {
+    const int shift = 8 * ch;
+    const uint32_t sum = ((a >> shift) & 0xff) + ((b >> shift) & 0xff) +
+        ((c >> shift) & 0xff) + ((d >> shift) & 0xff);
+    result |= ((sum + 2) >> 2) << shift;
+  }
+  return result;
+#endif
+}
+
+}  // namespace
+
+IconScaler::IconScaler(const QImage& source) {
+  if (source.isNull()) {
+    return;
+  }
+
+  levels_.push_back(source.convertToFormat(QImage::Format_ARGB32_Premultiplied));
+  while (levels_.back().width() / 2 >= kMinLevelSize &&
+         levels_.back().height() / 2 >= kMinLevelSize) {
+    levels_.push_back(halve(levels_.back()));
+  }
+}
+
+QImage IconScaler::scaled(int width, int height) const {
+  if (isNull() || width <= 0 || height <= 0) {
+    return QImage();
+  }
+
+  const QImage& src = level(width, height);
+  if (src.width() == width && src.height() == height) {
+    return src;
+  }
+
+  // Horizontal pass, then vertical pass.
+  const Taps horizontal = taps(src.width(), width);
+  QImage temp(width, src.height(), QImage::Format_ARGB32_Premultiplied);
+  for (int y = 0; y < src.height(); ++y) {
+    const auto* in = reinterpret_cast<const uint32_t*>(src.constScanLine(y));
+    auto* out = reinterpret_cast<uint32_t*>(temp.scanLine(y));
+    for (int x = 0; x < width; ++x) {
+      out[x] = filterPixel(in + horizontal.first[x], 1,
+                           &horizontal.weights[x * horizontal.maxCount], horizontal.count[x]);
+    }
+  }
+
+  const Taps vertical = taps(src.height(), height);
+  const ptrdiff_t stride = temp.bytesPerLine() / 4;
+  const auto* in = reinterpret_cast<const uint32_t*>(temp.constBits());
+  QImage result(width, height, QImage::Format_ARGB32_Premultiplied);
+  for (int y = 0; y < height; ++y) {
+    const uint32_t* row = in + vertical.first[y] * stride;
+    const int16_t* weights = &vertical.weights[y * vertical.maxCount];
+    auto* out = reinterpret_cast<uint32_t*>(result.scanLine(y));
+    for (int x = 0; x < width; ++x) {
+      out[x] = filterPixel(row + x, stride, weights, vertical.count[y]);
+    }
+  }
+  return result;
+}
+
+QImage IconScaler::scaledToHeight(int height) const {
+  if (isNull() || height <= 0) {
+    return QImage();
+  }
+  const QImage& source = levels_.front();
+  const int width = std::max(
+      1, static_cast<int>(std::lround(static_cast<double>(source.width()) * height /
+                                      source.height())));
+  return scaled(width, height);
+}
+
+QImage IconScaler::scaledToWidth(int width) const {
+  if (isNull() || width <= 0) {
+    return QImage();
+  }
+  const QImage& source = levels_.front();
+  const int height = std::max(
+      1, static_cast<int>(std::lround(static_cast<double>(source.height()) * width /
+                                      source.width())));
+  return scaled(width, height);
+}
+
+/* static */ IconScaler::Taps IconScaler::taps(int srcLength, int dstLength) {
+  const double scale = static_cast<double>(srcLength) / dstLength;
+  Taps taps;
+  taps.maxCount = (scale > 1.0) ? static_cast<int>(std::ceil(scale)) + 1 : 2;
+  taps.first.resize(dstLength);
+  taps.count.resize(dstLength);
+  taps.weights.assign(dstLength * taps.maxCount, 0);
+
+  std::vector<double> weights(taps.maxCount);
+  for (int i = 0; i < dstLength; ++i) {
+    int first = 0;
+    int count = 0;
+    if (scale > 1.0) {
+      // Each source pixel is weighted by how much of it the destination pixel covers.
+      const double begin = i * scale;
+      const double end = std::min((i + 1) * scale, static_cast<double>(srcLength));
+      first = static_cast<int>(begin);
+      for (int j = first; j < end && count < taps.maxCount; ++j, ++count) {
+        weights[count] = std::min(end, j + 1.0) - std::max(begin, static_cast<double>(j));
+      }
+    } else {
+      const double center = std::clamp((i + 0.5) * scale - 0.5, 0.0, srcLength - 1.0);
+      first = static_cast<int>(center);
+      const double fraction = center - first;
+      weights[0] = 1.0 - fraction;
+      count = 1;
+      if (first + 1 < srcLength && fraction > 0.0) {
+        weights[1] = fraction;
+        count = 2;
+      }
+    }
+
+    // Normalizes to fixed point and gives the rounding error to the largest weight, so
+    // that the weights add up to exactly 1.
+    double total = 0.0;
+    for (int k = 0; k < count; ++k) {
+      total += weights[k];
+    }
+    int16_t* out = &taps.weights[i * taps.maxCount];
+    int sum = 0;
+    int largest = 0;
+    for (int k = 0; k < count; ++k) {
+      out[k] = static_cast<int16_t>(std::lround(weights[k] / total * (1 << kWeightBits)));
+      sum += out[k];
+      if (out[k] > out[largest]) {
+        largest = k;
+      }
+    }
+    out[largest] = static_cast<int16_t>(out[largest] + (1 << kWeightBits) - sum);
+    taps.first[i] = first;
+    taps.count[i] = count;
+  }
+  return taps;
+}
+
+/* static */ QImage IconScaler::halve(const QImage& image) {
+  // An odd last row or column is averaged with itself.
+  const int width = (image.width() + 1) / 2;
+  const int height = (image.height() + 1) / 2;
+  const int lastX = image.width() - 1;
+  const int lastY = image.height() - 1;
+  QImage result(width, height, QImage::Format_ARGB32_Premultiplied);
+  for (int y = 0; y < height; ++y) {
+    const auto* row0 = reinterpret_cast<const uint32_t*>(image.constScanLine(2 * y));
+    const auto* row1 = reinterpret_cast<const uint32_t*>(
+        image.constScanLine(std::min(2 * y + 1, lastY)));
+    auto* out = reinterpret_cast<uint32_t*>(result.scanLine(y));
+    for (int x = 0; x < width; ++x) {
+      const int x1 = std::min(2 * x + 1, lastX);
+      out[x] = averagePixels(row0[2 * x], row0[x1], row1[2 * x], row1[x1]);
+    }
+  }
+  return result;
+}
+
+const QImage& IconScaler::level(int width, int height) const {
+  for (auto it = levels_.rbegin(); it != levels_.rend(); ++it) {
+    if (it->width() >= width && it->height() >= height) {
+      return *it;
+    }
+  }
+  return levels_.front();
+}
+
+}  // namespace crystaldock
@@ -0,0 +1,74 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CRYSTALDOCK_ICON_SCALER_H_
+#define CRYSTALDOCK_ICON_SCALER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include <QImage>
+
+namespace crystaldock {
+
+// Scales one source icon to many sizes, e.g. to all the zoom sizes of a dock item.
+//
+// Builds a mip pyramid of the source once, each level half the size of the one
+// before, then scales each requested size from the smallest level that is at least
+// as large, so that no resample shrinks by more than 2x. Filters work on
+// premultiplied ARGB32, four channels at a time with SSE2 or NEON where available.
+class IconScaler {
+ public:
+  IconScaler() = default;
+  explicit IconScaler(const QImage& source);
+
+  bool isNull() const { return levels_.empty(); }
+
+  // Results are in QImage::Format_ARGB32_Premultiplied.
+  QImage scaled(int width, int height) const;
+  QImage scaledToHeight(int height) const;
+  QImage scaledToWidth(int width) const;
+
+ private:
+  // Levels are not halved below this size.
+  static constexpr int kMinLevelSize = 8;
+
+  // Filter taps of each destination pixel along one axis.
+  struct Taps {
+    std::vector<int> first;
+    std::vector<int> count;
+    // maxCount weights per destination pixel.
+    std::vector<int16_t> weights;
+    int maxCount = 0;
+  };
+
+  // Box filter when shrinking, linear when enlarging.
+  static Taps taps(int srcLength, int dstLength);
+
+  static QImage halve(const QImage& image);
+
+  // Smallest level that is at least width x height, or the largest one.
+  const QImage& level(int width, int height) const;
+
+  std::vector<QImage> levels_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_ICON_SCALER_H_
@@ -0,0 +1,99 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "icon_theme_watcher.h"
+
+#include <QCoreApplication>
+#include <QEvent>
+#include <QFileInfo>
+#include <QIcon>
+#include <QStringList>
+
+#include "icon_disk_cache.h"
+
+namespace crystaldock {
+
+/* static */ IconThemeWatcher* IconThemeWatcher::self() {
+  static IconThemeWatcher self;
+  return &self;
+}
+
+IconThemeWatcher::IconThemeWatcher() : stamp_(IconDiskCache::themeStamp()) {
+  settleTimer_.setSingleShot(true);
+  settleTimer_.setInterval(kSettleDelayMs);
+  connect(&settleTimer_, &QTimer::timeout, this, &IconThemeWatcher::onSettled);
+  connect(&watcher_, &QFileSystemWatcher::fileChanged, &settleTimer_,
+          static_cast<void (QTimer::*)()>(&QTimer::start));
+  connect(&watcher_, &QFileSystemWatcher::directoryChanged, &settleTimer_,
+          static_cast<void (QTimer::*)()>(&QTimer::start));
+  QCoreApplication::instance()->installEventFilter(this);
+  watchTheme();
+}
+
+bool IconThemeWatcher::eventFilter(QObject* watched, QEvent* e) {
+  if (e->type() == QEvent::ThemeChange) {
+    settleTimer_.start();
+  }
+  return QObject::eventFilter(watched, e);
+}
+
+void IconThemeWatcher::watchTheme() {
+  if (!watcher_.files().isEmpty()) {
+    watcher_.removePaths(watcher_.files());
+  }
+  if (!watcher_.directories().isEmpty()) {
+    watcher_.removePaths(watcher_.directories());
+  }
+
+  QStringList paths;
+  for (const auto& theme : {QIcon::themeName(), QIcon::fallbackThemeName()}) {
+    if (theme.isEmpty()) {
+      continue;
+    }
+    for (const auto& searchPath : QIcon::themeSearchPaths()) {
+      const QString themePath = searchPath + "/" + theme;
+      for (const auto& path : {themePath, themePath + "/index.theme",
+                               themePath + "/icon-theme.cache"}) {
+        if (QFileInfo::exists(path)) {
+          paths << path;
+        }
+      }
+    }
+  }
+  if (!paths.isEmpty()) {
+    watcher_.addPaths(paths);
+  }
+}
+
+void IconThemeWatcher::onSettled() {
+  // Files replaced by the package manager are no longer watched, so always re-watch.
+  watchTheme();
+  const QString stamp = IconDiskCache::themeStamp();
+  if (stamp == stamp_) {
+    return;
+  }
+
+  stamp_ = stamp;
+  // Setting the search paths drops Qt's cached icon lookups, even if they're the same.
+  QIcon::setThemeSearchPaths(QIcon::themeSearchPaths());
+  IconDiskCache::revalidate();
+  emit iconThemeChanged();
+}
+
+}  // namespace crystaldock
@@ -0,0 +1,65 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CRYSTALDOCK_ICON_THEME_WATCHER_H_
+#define CRYSTALDOCK_ICON_THEME_WATCHER_H_
+
+#include <QFileSystemWatcher>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+namespace crystaldock {
+
+// Notices when the icon theme is switched (the platform theme's ThemeChange events)
+// or modified on disk (its index.theme or icon-theme.cache, e.g. updated by the
+// package manager).
+//
+// Before telling, it flushes Qt's icon lookups and lets IconDiskCache re-check
+// the theme, so that icons loaded from then on are the new ones. Must be used on
+// the GUI thread only.
+class IconThemeWatcher : public QObject {
+  Q_OBJECT
+
+ public:
+  static IconThemeWatcher* self();
+
+ signals:
+  void iconThemeChanged();
+
+ protected:
+  bool eventFilter(QObject* watched, QEvent* e) override;
+
+ private:
+  // Changes usually come in bursts, e.g. one ThemeChange event per window.
+  static constexpr int kSettleDelayMs = 500;
+
+  IconThemeWatcher();
+
+  void watchTheme();
+  void onSettled();
+
+  QFileSystemWatcher watcher_;
+  QTimer settleTimer_;
+  QString stamp_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_ICON_THEME_WATCHER_H_
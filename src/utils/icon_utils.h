@@ -19,19 +19,36 @@
 #define CRYSTALDOCK_ICON_UTILS_H_
 
 #include <QIcon>
+#include <QImage>
 #include <QPixmap>
 
+#include "icon_disk_cache.h"
+#include "icon_loader.h"
+
 namespace crystaldock {
 
 inline QPixmap loadIcon(const QString& iconName, int iconLoadSize) {
+  const QImage preloaded = IconLoader::preloaded(iconName, iconLoadSize);
+  if (!preloaded.isNull()) {
+    return QPixmap::fromImage(preloaded);
+  }
+
+  const QImage cached = IconDiskCache::load(iconName, iconLoadSize);
+  if (!cached.isNull()) {
+    return QPixmap::fromImage(cached);
+  }
+
   // Normally desktop file stores icon as icon name in the icon theme.
   QPixmap icon = QIcon::fromTheme(iconName).pixmap(iconLoadSize);
+  if (icon.isNull()) {
+    // Snap stores icon name as path to the icon file e.g.
+    // /snap/firefox/5134/default256.png
+    icon = QPixmap(iconName);
+  }
   if (!icon.isNull()) {
-    return icon;
+    IconDiskCache::store(iconName, iconLoadSize, icon.toImage());
   }
-  // Snap stores icon name as path to the icon file e.g.
-  // /snap/firefox/5134/default256.png
-  return QPixmap(iconName);
+  return icon;
 }
 
 }  // namespace crystaldock
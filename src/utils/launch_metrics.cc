@@ -0,0 +1,76 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "launch_metrics.h"
+
+#include <algorithm>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "profiler.h"
+
+namespace crystaldock {
+
+/* static */ std::map<QString, LaunchMetrics::Samples>& LaunchMetrics::samples() {
+  static std::map<QString, Samples> samples;
+  return samples;
+}
+
+/* static */ void LaunchMetrics::record(const QString& appId, int64_t latencyMs) {
+  auto& s = samples()[appId];
+  ++s.count;
+  s.last = latencyMs;
+  s.total += latencyMs;
+  s.max = std::max(s.max, latencyMs);
+  if (Profiler::enabled()) {
+    Profiler::record("Program/launch-to-window", latencyMs * 1000000);
+  }
+}
+
+/* static */ void LaunchMetrics::recordTimeout(const QString& appId) {
+  ++samples()[appId].timeouts;
+}
+
+/* static */ std::vector<LaunchMetrics::Stats> LaunchMetrics::stats() {
+  std::vector<Stats> result;
+  for (const auto& [appId, s] : samples()) {
+    const double mean = s.count > 0 ? static_cast<double>(s.total) / s.count : 0.0;
+    result.push_back({appId, s.count, s.timeouts, static_cast<double>(s.last), mean,
+                      static_cast<double>(s.max)});
+  }
+  return result;
+}
+
+/* static */ QString LaunchMetrics::toJson() {
+  QJsonArray apps;
+  for (const auto& s : stats()) {
+    apps.append(QJsonObject{
+        {"app_id", s.appId},
+        {"count", static_cast<qint64>(s.count)},
+        {"timeouts", static_cast<qint64>(s.timeouts)},
+        {"last_ms", s.last},
+        {"mean_ms", s.mean},
+        {"max_ms", s.max}});
+  }
+  return QString::fromUtf8(QJsonDocument(QJsonObject{{"launches", apps}}).toJson());
+}
+
+}  // namespace crystaldock
@@ -0,0 +1,70 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CRYSTALDOCK_LAUNCH_METRICS_H_
+#define CRYSTALDOCK_LAUNCH_METRICS_H_
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include <QString>
+
+namespace crystaldock {
+
+// Records the latency from clicking a launcher to its application's first window
+// being mapped, per app ID, so that application start-up regressions can be tracked.
+// Must be used on the GUI thread only.
+class LaunchMetrics {
+ public:
+  // Statistics of an application, in milliseconds.
+  struct Stats {
+    QString appId;
+    int64_t count;
+    // Number of launches for which no window was mapped in time.
+    int64_t timeouts;
+    double last;
+    double mean;
+    double max;
+  };
+
+  static void record(const QString& appId, int64_t latencyMs);
+
+  static void recordTimeout(const QString& appId);
+
+  // Sorted by app ID.
+  static std::vector<Stats> stats();
+
+  static QString toJson();
+
+ private:
+  struct Samples {
+    int64_t count = 0;
+    int64_t timeouts = 0;
+    int64_t last = 0;
+    int64_t total = 0;
+    int64_t max = 0;
+  };
+
+  static std::map<QString, Samples>& samples();
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_LAUNCH_METRICS_H_
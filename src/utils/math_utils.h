@@ -31,6 +31,20 @@ inline float transparencyPercentToAlphaF(int transparencyPercent) {
   return 1 - transparencyPercent / 100.0;
 }
 
+// Zoom curves, mapping t in [0, 1] (distance from the mouse as a fraction of
+// the zoom range) to the zoom level in [0, 1], with f(0) = 1 and f(1) = 0.
+
+inline double cosineCurve(double t) {
+  return (1 + std::cos(M_PI * t)) / 2;
+}
+
+inline double gaussianCurve(double t) {
+  constexpr double kSigma = 0.4;
+  auto g = [](double t) { return std::exp(-t * t / (2 * kSigma * kSigma)); };
+  // Normalizes so that f(1) = 0.
+  return (g(t) - g(1)) / (1 - g(1));
+}
+
 }  // namespace crystaldock
 
 #endif // CRYSTALDOCK_MATH_UTILS_H_
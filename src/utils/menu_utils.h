@@ -38,6 +38,18 @@ inline void patchMenu(unsigned int totalNumItems, int iconSize, QMenu* menu) {
   }
 }
 
+// Number of entries in the menu and its sub-menus.
+inline int countMenuActions(const QMenu& menu) {
+  int count = 0;
+  for (const QAction* action : menu.actions()) {
+    ++count;
+    if (action->menu() != nullptr) {
+      count += countMenuActions(*action->menu());
+    }
+  }
+  return count;
+}
+
 }  // namespace crystaldock
 
 #endif // CRYSTALDOCK_MENU_UTILS_H_
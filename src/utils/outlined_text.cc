@@ -0,0 +1,69 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "outlined_text.h"
+
+#include <algorithm>
+
+#include <QFontMetrics>
+#include <QPainter>
+#include <QPainterPath>
+#include <QPen>
+#include <QtMath>
+
+namespace crystaldock {
+
+QHash<OutlinedText::Key, QPixmap> OutlinedText::cache_;
+
+/* static */ const QPixmap& OutlinedText::get(
+    const QString& text, const QFont& font, int borderWidth, QColor borderColor,
+    QColor textColor, qreal devicePixelRatio) {
+  Key key{text, font, borderWidth, borderColor.rgba(), textColor.rgba(), devicePixelRatio};
+  auto it = cache_.find(key);
+  if (it == cache_.end()) {
+    if (cache_.size() >= kMaxCachedTexts) {
+      cache_.clear();
+    }
+    QPixmap pixmap = render(key);
+    it = cache_.insert(std::move(key), std::move(pixmap));
+  }
+  return *it;
+}
+
+/* static */ QPixmap OutlinedText::render(const Key& key) {
+  QFontMetrics metrics(key.font);
+  const int width = metrics.horizontalAdvance(key.text) + 2 * key.borderWidth;
+  const int height = metrics.height() + 2 * key.borderWidth;
+  QPixmap pixmap(std::max(1, qCeil(width * key.devicePixelRatio)),
+                 std::max(1, qCeil(height * key.devicePixelRatio)));
+  pixmap.setDevicePixelRatio(key.devicePixelRatio);
+  pixmap.fill(Qt::transparent);
+
+  QPainterPath path;
+  path.addText(key.borderWidth, key.borderWidth + metrics.ascent(), key.font, key.text);
+  QPainter painter(&pixmap);
+  painter.setRenderHint(QPainter::Antialiasing);
+  // The stroke is centered on the outlines, hence twice the border width.
+  painter.strokePath(path, QPen(QColor::fromRgba(key.borderColor), 2 * key.borderWidth,
+                                Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
+  painter.fillPath(path, QColor::fromRgba(key.textColor));
+  return pixmap;
+}
+
+}  // namespace crystaldock
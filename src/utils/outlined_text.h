@@ -0,0 +1,77 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CRYSTALDOCK_OUTLINED_TEXT_H_
+#define CRYSTALDOCK_OUTLINED_TEXT_H_
+
+#include <QColor>
+#include <QFont>
+#include <QHash>
+#include <QPixmap>
+#include <QString>
+
+namespace crystaldock {
+
+// Cache of outlined (bordered) text, e.g. tooltips and clock text.
+//
+// Each combination of text, font, colors and border width is rendered once,
+// by stroking and filling its glyph outlines, into a pixmap that is reused
+// until the text changes. Must be used on the GUI thread only.
+class OutlinedText {
+ public:
+  // Gets the rendered text. The text's baseline is at
+  // (borderWidth, borderWidth + ascent) and its line box, including the border,
+  // covers the whole pixmap.
+  static const QPixmap& get(const QString& text, const QFont& font, int borderWidth,
+                            QColor borderColor, QColor textColor, qreal devicePixelRatio);
+
+  static void clear() { cache_.clear(); }
+
+ private:
+  // Window titles in the tooltips can grow the cache without bound, hence the limit.
+  static constexpr int kMaxCachedTexts = 128;
+
+  struct Key {
+    QString text;
+    QFont font;
+    int borderWidth;
+    QRgb borderColor;
+    QRgb textColor;
+    qreal devicePixelRatio;
+
+    bool operator==(const Key& other) const {
+      return text == other.text && font == other.font && borderWidth == other.borderWidth &&
+          borderColor == other.borderColor && textColor == other.textColor &&
+          devicePixelRatio == other.devicePixelRatio;
+    }
+  };
+
+  friend size_t qHash(const Key& key, size_t seed) {
+    return qHashMulti(seed, key.text, key.font, key.borderWidth, key.borderColor,
+                      key.textColor, key.devicePixelRatio);
+  }
+
+  static QPixmap render(const Key& key);
+
+  static QHash<Key, QPixmap> cache_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_OUTLINED_TEXT_H_
@@ -0,0 +1,319 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "prefetcher.h"
+
+#include <elf.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+#include <thread>
+
+#include <QCoreApplication>
+#include <QProcess>
+#include <QStandardPaths>
+
+namespace crystaldock {
+
+namespace {
+
+// From linux/ioprio.h, which isn't exposed by glibc.
+constexpr int kIoprioWhoProcess = 1;
+constexpr int kIoprioClassIdle = 3;
+constexpr int kIoprioClassShift = 13;
+
+#if defined(__x86_64__)
+#define CRYSTALDOCK_MULTIARCH "x86_64-linux-gnu"
+#elif defined(__aarch64__)
+#define CRYSTALDOCK_MULTIARCH "aarch64-linux-gnu"
+#endif
+
+const char* const kDefaultLibraryDirs[] = {
+#ifdef CRYSTALDOCK_MULTIARCH
+  "/usr/lib/" CRYSTALDOCK_MULTIARCH,
+  "/lib/" CRYSTALDOCK_MULTIARCH,
+#endif
+  "/usr/lib64",
+  "/lib64",
+  "/usr/lib",
+  "/lib",
+};
+
+// Gives the calling thread idle CPU and I/O priority.
+void lowerPriority() {
+  sched_param param{};
+  pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+  // With IOPRIO_WHO_PROCESS, 0 is the calling thread.
+  syscall(SYS_ioprio_set, kIoprioWhoProcess, 0, kIoprioClassIdle << kIoprioClassShift);
+}
+
+void appendDirs(std::string_view dirs, std::string_view origin,
+                std::vector<std::string>* result) {
+  while (!dirs.empty()) {
+    const auto end = dirs.find(':');
+    std::string dir(dirs.substr(0, end));
+    dirs = (end == std::string_view::npos) ? std::string_view() : dirs.substr(end + 1);
+    for (const std::string_view token : {"${ORIGIN}", "$ORIGIN"}) {
+      if (dir.starts_with(token)) {
+        dir.replace(0, token.size(), origin);
+      }
+    }
+    if (!dir.empty()) {
+      result->push_back(std::move(dir));
+    }
+  }
+}
+
+}  // namespace
+
+std::atomic<bool> Prefetcher::stopped_ = false;
+
+/* static */ void Prefetcher::prefetch(const QStringList& commands, bool libraries) {
+  std::vector<std::string> executables;
+  for (const auto& command : commands) {
+    const QStringList args = QProcess::splitCommand(command);
+    if (args.isEmpty()) {
+      continue;
+    }
+    const QString path = QStandardPaths::findExecutable(args[0]);
+    if (!path.isEmpty()) {
+      executables.push_back(path.toLocal8Bit().toStdString());
+    }
+  }
+  if (executables.empty()) {
+    return;
+  }
+
+  static const bool connected = [] {
+    if (QCoreApplication::instance() != nullptr) {
+      QObject::connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit,
+                       [] { stopped_ = true; });
+    }
+    return true;
+  }();
+  (void)connected;
+
+  // Not a QThreadPool thread, since its priority is lowered for good.
+  std::thread(run, std::move(executables), libraries).detach();
+}
+
+/* static */ void Prefetcher::run(std::vector<std::string> executables, bool libraries) {
+  lowerPriority();
+  // Library names and paths.
+  std::unordered_set<std::string> seen;
+  for (const auto& executable : executables) {
+    if (!canContinue()) {
+      return;
+    }
+    if (!prefetchFile(executable) || !libraries) {
+      continue;
+    }
+
+    // The libraries of the most frequently launched programs come before the next
+    // program.
+    std::vector<std::string> queue;
+    addNeededLibraries(executable, &seen, &queue);
+    for (size_t i = 0; i < queue.size(); ++i) {
+      if (!canContinue()) {
+        return;
+      }
+      prefetchFile(queue[i]);
+      if (static_cast<int>(seen.size()) < kMaxLibraries) {
+        addNeededLibraries(queue[i], &seen, &queue);
+      }
+    }
+  }
+}
+
+/* static */ bool Prefetcher::waitForIdle() {
+  const unsigned cpus = std::max(std::thread::hardware_concurrency(), 1u);
+  for (int waitedMs = 0; waitedMs < kMaxIdleWaitMs; ) {
+    double load = 0;
+    std::ifstream loadavg("/proc/loadavg");
+    if (!(loadavg >> load) || load / cpus <= kMaxLoadPerCpu) {
+      return true;
+    }
+    for (int i = 0; i < kIdleCheckIntervalMs / 500; ++i, waitedMs += 500) {
+      if (stopped_) {
+        return false;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    }
+  }
+  return false;
+}
+
+/* static */ bool Prefetcher::underMemoryPressure() {
+  // Pressure stall information, since Linux 4.20.
+  std::ifstream pressure("/proc/pressure/memory");
+  std::string line;
+  double avg10 = 0;
+  if (std::getline(pressure, line) &&
+      std::sscanf(line.c_str(), "some avg10=%lf", &avg10) == 1 &&
+      avg10 > kMaxMemoryPressure) {
+    return true;
+  }
+
+  std::ifstream meminfo("/proc/meminfo");
+  int64_t total = 0;
+  int64_t available = -1;
+  while (std::getline(meminfo, line)) {
+    int64_t value = 0;
+    if (std::sscanf(line.c_str(), "MemTotal: %ld", &value) == 1) {
+      total = value;
+    } else if (std::sscanf(line.c_str(), "MemAvailable: %ld", &value) == 1) {
+      available = value;
+      break;
+    }
+  }
+  return total > 0 && available >= 0 && available * 100 < total * kMinAvailableMemoryPercent;
+}
+
+/* static */ bool Prefetcher::prefetchFile(const std::string& path) {
+  const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  const bool ok = fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size <= kMaxFileSize;
+  if (ok) {
+    // Blocks until read, unlike POSIX_FADV_WILLNEED, so that the reads are paced by
+    // the idle I/O priority.
+    ::readahead(fd, 0, st.st_size);
+  }
+  close(fd);
+  return ok;
+}
+
+/* static */ void Prefetcher::addNeededLibraries(const std::string& path,
+                                                 std::unordered_set<std::string>* seen,
+                                                 std::vector<std::string>* libraries) {
+  const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return;
+  }
+  const auto read = [fd](void* buffer, size_t size, off_t offset) {
+    return pread(fd, buffer, size, offset) == static_cast<ssize_t>(size);
+  };
+
+  // Only native 64-bit ELF files, whose dynamic section lists the libraries they need.
+  Elf64_Ehdr header;
+  if (!read(&header, sizeof(header), 0) ||
+      std::memcmp(header.e_ident, ELFMAG, SELFMAG) != 0 ||
+      header.e_ident[EI_CLASS] != ELFCLASS64 ||
+      header.e_phentsize != sizeof(Elf64_Phdr) || header.e_phnum > 256) {
+    close(fd);
+    return;
+  }
+  std::vector<Elf64_Phdr> segments(header.e_phnum);
+  if (!read(segments.data(), segments.size() * sizeof(Elf64_Phdr), header.e_phoff)) {
+    close(fd);
+    return;
+  }
+
+  std::vector<Elf64_Dyn> dynamic;
+  for (const auto& segment : segments) {
+    if (segment.p_type == PT_DYNAMIC) {
+      dynamic.resize(std::min<size_t>(segment.p_filesz / sizeof(Elf64_Dyn), 4096));
+      if (!read(dynamic.data(), dynamic.size() * sizeof(Elf64_Dyn), segment.p_offset)) {
+        dynamic.clear();
+      }
+      break;
+    }
+  }
+
+  std::vector<uint64_t> needed;
+  uint64_t strtab = 0;
+  uint64_t strsz = 0;
+  int64_t runpath = -1;
+  for (const auto& entry : dynamic) {
+    if (entry.d_tag == DT_NULL) {
+      break;
+    } else if (entry.d_tag == DT_NEEDED) {
+      needed.push_back(entry.d_un.d_val);
+    } else if (entry.d_tag == DT_STRTAB) {
+      strtab = entry.d_un.d_ptr;
+    } else if (entry.d_tag == DT_STRSZ) {
+      strsz = std::min<uint64_t>(entry.d_un.d_val, 1024 * 1024);
+    } else if (entry.d_tag == DT_RUNPATH || (entry.d_tag == DT_RPATH && runpath < 0)) {
+      runpath = entry.d_un.d_val;
+    }
+  }
+
+  // The string table's address is in memory, so needs mapping back to the file.
+  std::string strings;
+  for (const auto& segment : segments) {
+    if (segment.p_type == PT_LOAD && strtab >= segment.p_vaddr &&
+        strtab + strsz <= segment.p_vaddr + segment.p_filesz) {
+      strings.resize(strsz);
+      if (!read(strings.data(), strsz, strtab - segment.p_vaddr + segment.p_offset)) {
+        strings.clear();
+      }
+      break;
+    }
+  }
+  close(fd);
+  if (strings.empty()) {
+    return;
+  }
+  const auto string = [&strings](uint64_t offset) {
+    return offset < strings.size() ? std::string(strings.c_str() + offset) : std::string();
+  };
+
+  std::vector<std::string> dirs;
+  const std::string origin = path.substr(0, path.rfind('/'));
+  if (runpath >= 0) {
+    appendDirs(string(runpath), origin, &dirs);
+  }
+  if (const char* libraryPath = std::getenv("LD_LIBRARY_PATH")) {
+    appendDirs(libraryPath, origin, &dirs);
+  }
+  dirs.insert(dirs.end(), std::begin(kDefaultLibraryDirs), std::end(kDefaultLibraryDirs));
+
+  for (const uint64_t offset : needed) {
+    const std::string name = string(offset);
+    if (name.empty() || !seen->insert(name).second) {
+      continue;
+    }
+    if (name.find('/') != std::string::npos) {
+      libraries->push_back(name);
+      continue;
+    }
+    for (const auto& dir : dirs) {
+      std::string candidate = dir + '/' + name;
+      if (access(candidate.c_str(), R_OK) == 0) {
+        libraries->push_back(std::move(candidate));
+        break;
+      }
+    }
+  }
+}
+
+}  // namespace crystaldock
@@ -0,0 +1,82 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CRYSTALDOCK_PREFETCHER_H_
+#define CRYSTALDOCK_PREFETCHER_H_
+
+#include <atomic>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <QStringList>
+
+namespace crystaldock {
+
+// Reads the executables of commands, and optionally the shared libraries they need,
+// into the page cache, so that their first launch after login doesn't wait on the disk.
+//
+// Runs on a worker thread with idle CPU and I/O priority, only while the system is
+// mostly idle, and stops under memory pressure so that it never evicts anything the
+// user is working with. Must be called on the GUI thread.
+class Prefetcher {
+ public:
+  // Prefetches the commands in order, so the most important should come first.
+  static void prefetch(const QStringList& commands, bool libraries);
+
+ private:
+  // Number of shared libraries prefetched at most per run.
+  static constexpr int kMaxLibraries = 512;
+  // Files bigger than this are skipped.
+  static constexpr int64_t kMaxFileSize = 256 * 1024 * 1024;  // 256 MB.
+  // Stops when less than this percentage of memory is available.
+  static constexpr int kMinAvailableMemoryPercent = 20;
+  // Stops when tasks have been stalled on memory for this percentage of the last 10 s.
+  static constexpr double kMaxMemoryPressure = 1.0;
+  // Waits while the load average per CPU is above this.
+  static constexpr double kMaxLoadPerCpu = 0.5;
+  static constexpr int kIdleCheckIntervalMs = 10000;
+  // Gives up if the system doesn't become idle within this.
+  static constexpr int kMaxIdleWaitMs = 10 * 60 * 1000;  // 10 minutes.
+
+  // Runs on the worker thread.
+  static void run(std::vector<std::string> executables, bool libraries);
+
+  // Waits until the system is idle. Returns false if we should give up instead.
+  static bool waitForIdle();
+
+  // Whether we can go on with the next file.
+  static bool canContinue() { return !stopped_ && waitForIdle() && !underMemoryPressure(); }
+
+  static bool underMemoryPressure();
+
+  // Reads the file into the page cache. Returns false if it's missing or too big.
+  static bool prefetchFile(const std::string& path);
+
+  // Appends the libraries that the ELF file at path needs and that aren't in seen yet.
+  static void addNeededLibraries(const std::string& path,
+                                 std::unordered_set<std::string>* seen,
+                                 std::vector<std::string>* libraries);
+
+  static std::atomic<bool> stopped_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_PREFETCHER_H_
@@ -0,0 +1,257 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "process_launcher.h"
+
+#include <signal.h>
+#include <spawn.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <iostream>
+#include <string_view>
+#include <thread>
+
+#include <QDBusArgument>
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusMetaType>
+#include <QDBusVariant>
+#include <QDir>
+#include <QList>
+#include <QProcess>
+#include <QSocketNotifier>
+#include <QTimer>
+
+#include "command_utils.h"
+
+extern char** environ;
+
+namespace crystaldock {
+
+// The (sv) and (sa(sv)) structs of systemd's StartTransientUnit.
+struct SystemdProperty {
+  QString name;
+  QDBusVariant value;
+};
+
+struct SystemdAuxUnit {
+  QString name;
+  QList<SystemdProperty> properties;
+};
+
+QDBusArgument& operator<<(QDBusArgument& argument, const SystemdProperty& property) {
+  argument.beginStructure();
+  argument << property.name << property.value;
+  argument.endStructure();
+  return argument;
+}
+
+const QDBusArgument& operator>>(const QDBusArgument& argument, SystemdProperty& property) {
+  argument.beginStructure();
+  argument >> property.name >> property.value;
+  argument.endStructure();
+  return argument;
+}
+
+QDBusArgument& operator<<(QDBusArgument& argument, const SystemdAuxUnit& unit) {
+  argument.beginStructure();
+  argument << unit.name << unit.properties;
+  argument.endStructure();
+  return argument;
+}
+
+const QDBusArgument& operator>>(const QDBusArgument& argument, SystemdAuxUnit& unit) {
+  argument.beginStructure();
+  argument >> unit.name >> unit.properties;
+  argument.endStructure();
+  return argument;
+}
+
+}  // namespace crystaldock
+
+Q_DECLARE_METATYPE(crystaldock::SystemdProperty)
+Q_DECLARE_METATYPE(crystaldock::SystemdAuxUnit)
+
+namespace crystaldock {
+
+namespace {
+
+// Escapes a string for use in a systemd unit name, see systemd-escape(1).
+QString escapeUnitName(const QString& name) {
+  QString escaped;
+  for (const char c : name.toUtf8()) {
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+        c == ':' || c == '_' || c == '.') {
+      escaped += QLatin1Char(c);
+    } else {
+      escaped += QString("\\x%1").arg(static_cast<unsigned char>(c), 2, 16, QLatin1Char('0'));
+    }
+  }
+  return escaped;
+}
+
+void reportError(const QString& error, ProcessLauncher::ErrorCallback onError) {
+  std::cerr << error.toStdString() << std::endl;
+  if (onError) {
+    QTimer::singleShot(0, [error, onError] { onError(error); });
+  }
+}
+
+}  // namespace
+
+/* static */ bool ProcessLauncher::launch(const QString& command, const QString& appId,
+                                          ErrorCallback onError,
+                                          const QString& activationToken) {
+  const QStringList args = QProcess::splitCommand(command);
+  if (args.isEmpty()) {
+    reportError(QString("Could not run empty command"), onError);
+    return false;
+  }
+
+  std::vector<std::string> argStorage;
+  argStorage.reserve(args.size());
+  for (const auto& arg : args) {
+    argStorage.push_back(arg.toLocal8Bit().toStdString());
+  }
+  std::vector<char*> argv;
+  for (auto& arg : argStorage) {
+    argv.push_back(arg.data());
+  }
+  argv.push_back(nullptr);
+
+  // The template is built once and only its pointers are gathered here.
+  const auto& env = environment();
+  std::vector<char*> envp;
+  envp.reserve(env.size() + 2);
+  for (const auto& var : env) {
+    envp.push_back(const_cast<char*>(var.c_str()));
+  }
+  std::string tokenVar;
+  if (!activationToken.isEmpty()) {
+    tokenVar = "XDG_ACTIVATION_TOKEN=" + activationToken.toStdString();
+    envp.push_back(tokenVar.data());
+  }
+  envp.push_back(nullptr);
+
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+#ifdef __GLIBC__
+#if __GLIBC_PREREQ(2, 29)
+  const std::string home = QDir::homePath().toLocal8Bit().toStdString();
+  posix_spawn_file_actions_addchdir_np(&actions, home.c_str());
+#endif
+#endif
+
+  // Like QProcess::startDetached(), the program gets its own session and default signal
+  // handling.
+  posix_spawnattr_t attr;
+  posix_spawnattr_init(&attr);
+  sigset_t signals;
+  sigemptyset(&signals);
+  posix_spawnattr_setsigmask(&attr, &signals);
+  sigfillset(&signals);
+  posix_spawnattr_setsigdefault(&attr, &signals);
+  posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSID | POSIX_SPAWN_SETSIGMASK |
+                                  POSIX_SPAWN_SETSIGDEF);
+
+  pid_t pid = -1;
+  const int error = posix_spawnp(&pid, argv[0], &actions, &attr, argv.data(), envp.data());
+  posix_spawnattr_destroy(&attr);
+  posix_spawn_file_actions_destroy(&actions);
+  if (error != 0) {
+    reportError(QString("Could not run command: %1 (%2)").arg(command, strerror(error)),
+                onError);
+    return false;
+  }
+
+  reap(pid);
+  moveToScope(pid, appId.isEmpty() ? getShortCommand(command) : appId);
+  return true;
+}
+
+/* static */ const std::vector<std::string>& ProcessLauncher::environment() {
+  static const std::vector<std::string> env = [] {
+    std::vector<std::string> env;
+    for (char** var = environ; *var != nullptr; ++var) {
+      const std::string_view entry(*var);
+      // The activation token is the dock's, and the layer-shell integration is only
+      // meant for the dock.
+      if (entry.starts_with("XDG_ACTIVATION_TOKEN=") ||
+          entry.starts_with("QT_WAYLAND_SHELL_INTEGRATION=")) {
+        continue;
+      }
+      env.emplace_back(entry);
+    }
+    return env;
+  }();
+  return env;
+}
+
+/* static */ void ProcessLauncher::reap(pid_t pid) {
+#ifdef SYS_pidfd_open
+  const int pidfd = static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+  if (pidfd >= 0) {
+    // The pidfd becomes readable when the child exits.
+    auto* notifier = new QSocketNotifier(pidfd, QSocketNotifier::Read);
+    QObject::connect(notifier, &QSocketNotifier::activated, notifier, [notifier, pid, pidfd] {
+      waitpid(pid, nullptr, WNOHANG);
+      notifier->setEnabled(false);
+      close(pidfd);
+      notifier->deleteLater();
+    });
+    return;
+  }
+#endif
+  std::thread([pid] { waitpid(pid, nullptr, 0); }).detach();
+}
+
+/* static */ void ProcessLauncher::moveToScope(pid_t pid, const QString& appId) {
+  static const bool registered = [] {
+    qDBusRegisterMetaType<SystemdProperty>();
+    qDBusRegisterMetaType<QList<SystemdProperty>>();
+    qDBusRegisterMetaType<SystemdAuxUnit>();
+    qDBusRegisterMetaType<QList<SystemdAuxUnit>>();
+    return true;
+  }();
+  (void)registered;
+
+  const QString unit = QString("app-crystaldock-%1-%2.scope")
+      .arg(escapeUnitName(appId)).arg(pid);
+  QList<SystemdProperty> properties;
+  properties.append({"Description",
+                     QDBusVariant(QString("Application launched by Crystal Dock"))});
+  properties.append({"PIDs", QDBusVariant(QVariant::fromValue(QList<uint>{
+      static_cast<uint>(pid)}))});
+  // Garbage-collects the scope even if the app fails.
+  properties.append({"CollectMode", QDBusVariant(QString("inactive-or-failed"))});
+
+  auto message = QDBusMessage::createMethodCall(
+      "org.freedesktop.systemd1", "/org/freedesktop/systemd1",
+      "org.freedesktop.systemd1.Manager", "StartTransientUnit");
+  message << unit << QString("fail") << QVariant::fromValue(properties)
+          << QVariant::fromValue(QList<SystemdAuxUnit>());
+  message.setAutoStartService(false);
+  // Fire and forget: without systemd the app simply stays in the dock's scope.
+  QDBusConnection::sessionBus().send(message);
+}
+
+}  // namespace crystaldock
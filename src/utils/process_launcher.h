@@ -0,0 +1,65 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CRYSTALDOCK_PROCESS_LAUNCHER_H_
+#define CRYSTALDOCK_PROCESS_LAUNCHER_H_
+
+#include <sys/types.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <QString>
+
+namespace crystaldock {
+
+// Launches programs with posix_spawn, which doesn't copy the dock's address space
+// like fork() does, from an environment template that is only built once.
+//
+// Each program is started in its own session and, if systemd is running, moved to its
+// own transient scope unit (app-crystaldock-<app>-<pid>.scope), so that it's not
+// accounted to the dock's cgroup.
+// Must be used on the GUI thread only.
+class ProcessLauncher {
+ public:
+  using ErrorCallback = std::function<void(const QString& error)>;
+
+  // Starts the command detached, in the home directory. appId names the scope unit,
+  // the command's short name being used if it's empty. Returns whether the command
+  // could be started. If not, onError is called with the error from the event loop,
+  // so that the caller isn't blocked. activationToken, if not empty, is passed to the
+  // program as XDG_ACTIVATION_TOKEN.
+  static bool launch(const QString& command, const QString& appId, ErrorCallback onError,
+                     const QString& activationToken = QString());
+
+ private:
+  // The dock's environment without the variables that the programs mustn't inherit.
+  static const std::vector<std::string>& environment();
+
+  // Collects the exit status of the child once it exits, so that it doesn't linger
+  // as a zombie.
+  static void reap(pid_t pid);
+
+  static void moveToScope(pid_t pid, const QString& appId);
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_PROCESS_LAUNCHER_H_
@@ -0,0 +1,97 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "profiler.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace crystaldock {
+
+/* static */ bool Profiler::enabled_ = false;
+
+/* static */ void Profiler::enable(const QString& dumpPath) {
+  enabled_ = true;
+  if (!dumpPath.isEmpty()) {
+    QObject::connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit,
+                     [dumpPath] { dumpJson(dumpPath); });
+  }
+}
+
+/* static */ std::map<std::string, Profiler::Samples>& Profiler::samples() {
+  static std::map<std::string, Samples> samples;
+  return samples;
+}
+
+/* static */ void Profiler::record(const char* section, int64_t nanos) {
+  auto& s = samples()[section];
+  s.nanos[s.next] = nanos;
+  s.next = (s.next + 1) % kWindowSize;
+  s.size = std::min(s.size + 1, kWindowSize);
+  ++s.count;
+}
+
+/* static */ std::vector<Profiler::Stats> Profiler::stats() {
+  std::vector<Stats> result;
+  std::vector<int64_t> sorted;
+  for (const auto& [name, s] : samples()) {
+    if (s.size == 0) {
+      continue;
+    }
+    sorted.assign(s.nanos.begin(), s.nanos.begin() + s.size);
+    std::sort(sorted.begin(), sorted.end());
+    const auto percentile = [&sorted](int p) {
+      return sorted[(sorted.size() - 1) * p / 100] / 1000.0;
+    };
+    result.push_back({name, s.count, percentile(50), percentile(99), sorted.back() / 1000.0});
+  }
+  return result;
+}
+
+/* static */ QString Profiler::toJson() {
+  QJsonArray sections;
+  for (const auto& s : stats()) {
+    sections.append(QJsonObject{
+        {"name", QString::fromStdString(s.name)},
+        {"count", static_cast<qint64>(s.count)},
+        {"p50_us", s.p50},
+        {"p99_us", s.p99},
+        {"max_us", s.max}});
+  }
+  return QString::fromUtf8(
+      QJsonDocument(QJsonObject{{"window", kWindowSize}, {"sections", sections}}).toJson());
+}
+
+/* static */ bool Profiler::dumpJson(const QString& path) {
+  QFile file(path);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    std::cerr << "Failed to write profile to " << path.toStdString() << std::endl;
+    return false;
+  }
+  file.write(toJson().toUtf8());
+  return true;
+}
+
+}  // namespace crystaldock
@@ -0,0 +1,122 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CRYSTALDOCK_PROFILER_H_
+#define CRYSTALDOCK_PROFILER_H_
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <QElapsedTimer>
+#include <QString>
+
+namespace crystaldock {
+
+// Records how long the hot paths of the docks take, e.g. layout, painting and
+// animation, so that users can tell us where the time goes on their hardware.
+//
+// Off unless enabled at start-up (--profile or CRYSTAL_DOCK_PROFILE), in which case
+// the cost of a disabled section is a single branch. Building without
+// CRYSTALDOCK_PROFILER compiles the sections out altogether.
+// Must be used on the GUI thread only.
+class Profiler {
+ public:
+  // Rolling statistics of a section, in microseconds.
+  struct Stats {
+    std::string name;
+    int64_t count;
+    double p50;
+    double p99;
+    double max;
+  };
+
+#ifdef CRYSTALDOCK_PROFILER
+  static bool enabled() { return enabled_; }
+#else
+  static constexpr bool enabled() { return false; }
+#endif
+
+  // If dumpPath is not empty, the statistics are written to it as JSON on exit.
+  static void enable(const QString& dumpPath);
+
+  static void record(const char* section, int64_t nanos);
+
+  // Sorted by section name.
+  static std::vector<Stats> stats();
+
+  static QString toJson();
+
+  static bool dumpJson(const QString& path);
+
+ private:
+  // Number of most recent samples kept per section.
+  static constexpr int kWindowSize = 512;
+
+  struct Samples {
+    std::array<int64_t, kWindowSize> nanos;
+    int size = 0;
+    int next = 0;
+    int64_t count = 0;
+  };
+
+  static std::map<std::string, Samples>& samples();
+
+  static bool enabled_;
+};
+
+// Times the enclosing scope.
+class ProfileScope {
+ public:
+  explicit ProfileScope(const char* section)
+      : section_(Profiler::enabled() ? section : nullptr) {
+    if (section_ != nullptr) {
+      timer_.start();
+    }
+  }
+
+  ~ProfileScope() {
+    if (section_ != nullptr) {
+      Profiler::record(section_, timer_.nsecsElapsed());
+    }
+  }
+
+  ProfileScope(const ProfileScope&) = delete;
+  ProfileScope& operator=(const ProfileScope&) = delete;
+
+ private:
+  const char* section_;
+  QElapsedTimer timer_;
+};
+
+}  // namespace crystaldock
+
+#define CRYSTALDOCK_CONCAT_IMPL(a, b) a##b
+#define CRYSTALDOCK_CONCAT(a, b) CRYSTALDOCK_CONCAT_IMPL(a, b)
+
+#ifdef CRYSTALDOCK_PROFILER
+#define PROFILE_SCOPE(section) \
+    ::crystaldock::ProfileScope CRYSTALDOCK_CONCAT(profileScope, __LINE__)(section)
+#else
+#define PROFILE_SCOPE(section) do {} while (false)
+#endif
+
+#endif  // CRYSTALDOCK_PROFILER_H_
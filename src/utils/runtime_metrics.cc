@@ -0,0 +1,132 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "runtime_metrics.h"
+
+#include <algorithm>
+#include <bit>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "scheduler.h"
+
+namespace crystaldock {
+
+namespace {
+
+// By RuntimeMetrics::Counter.
+constexpr const char* kCounterNames[] = {
+  "window_added",
+  "window_removed",
+  "window_state_changed",
+  "window_title_changed",
+  "window_geometry_changed",
+  "window_outputs_changed",
+  "active_window_changed",
+  "events_coalesced",
+  "layouts",
+  "repaints",
+  "repaint_pixels",
+  "icon_cache_hits",
+  "icon_cache_misses",
+  "icon_cache_bytes",
+  "application_menu_reloads",
+  "reveals",
+};
+
+// By RuntimeMetrics::Histogram.
+constexpr const char* kHistogramNames[] = {
+  "layout",
+  "repaint",
+  "application_menu_reload",
+  "reveal",
+};
+
+}  // namespace
+
+std::array<int64_t, static_cast<int>(RuntimeMetrics::Counter::kCount)>
+    RuntimeMetrics::counters_{};
+std::array<RuntimeMetrics::Durations, static_cast<int>(RuntimeMetrics::Histogram::kCount)>
+    RuntimeMetrics::durations_;
+std::map<int, int> RuntimeMetrics::dockItemCounts_;
+std::map<int, std::function<RuntimeMetrics::DockMemory()>> RuntimeMetrics::dockMemoryProbes_;
+
+static_assert(std::size(kCounterNames) == static_cast<size_t>(RuntimeMetrics::Counter::kCount));
+static_assert(std::size(kHistogramNames) ==
+              static_cast<size_t>(RuntimeMetrics::Histogram::kCount));
+
+/* static */ void RuntimeMetrics::recordDuration(Histogram histogram, int64_t micros) {
+  micros = std::max<int64_t>(micros, 0);
+  auto& d = durations_[static_cast<int>(histogram)];
+  const int bucket = std::min(static_cast<int>(std::bit_width(static_cast<uint64_t>(micros))),
+                              kBucketCount - 1);
+  ++d.buckets[bucket];
+  ++d.count;
+  d.totalMicros += micros;
+  d.maxMicros = std::max(d.maxMicros, micros);
+}
+
+/* static */ QString RuntimeMetrics::toJson() {
+  QJsonObject counters;
+  for (int i = 0; i < static_cast<int>(Counter::kCount); ++i) {
+    counters[kCounterNames[i]] = static_cast<qint64>(counters_[i]);
+  }
+
+  QJsonObject histograms;
+  for (int i = 0; i < static_cast<int>(Histogram::kCount); ++i) {
+    const auto& d = durations_[i];
+    // As [upper bound in us, count] pairs, skipping the empty buckets.
+    QJsonArray buckets;
+    for (int b = 0; b < kBucketCount; ++b) {
+      if (d.buckets[b] > 0) {
+        const qint64 upperBound = (b == kBucketCount - 1) ? -1 : (qint64{1} << b);
+        buckets.append(QJsonArray{upperBound, static_cast<qint64>(d.buckets[b])});
+      }
+    }
+    histograms[kHistogramNames[i]] = QJsonObject{
+        {"count", static_cast<qint64>(d.count)},
+        {"total_us", static_cast<qint64>(d.totalMicros)},
+        {"max_us", static_cast<qint64>(d.maxMicros)},
+        {"buckets_us", buckets}};
+  }
+
+  QJsonObject docks;
+  for (const auto& [dockId, count] : dockItemCounts_) {
+    QJsonObject dock{{"items", count}};
+    const auto probe = dockMemoryProbes_.find(dockId);
+    if (probe != dockMemoryProbes_.end()) {
+      const DockMemory memory = probe->second();
+      dock["memory"] = QJsonObject{
+          {"icon_bytes", static_cast<qint64>(memory.iconBytes)},
+          {"thumbnail_bytes", static_cast<qint64>(memory.thumbnailBytes)},
+          {"buffer_bytes", static_cast<qint64>(memory.bufferBytes)},
+          {"menu_actions", memory.menuActions}};
+    }
+    docks[QString::number(dockId)] = dock;
+  }
+
+  return QString::fromUtf8(QJsonDocument(QJsonObject{
+      {"counters", counters},
+      {"histograms", histograms},
+      {"wakeups_per_second", Scheduler::self()->wakeupsPerSecond()},
+      {"docks", docks}}).toJson());
+}
+
+}  // namespace crystaldock
@@ -0,0 +1,147 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CRYSTALDOCK_RUNTIME_METRICS_H_
+#define CRYSTALDOCK_RUNTIME_METRICS_H_
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <map>
+
+#include <QElapsedTimer>
+#include <QImage>
+#include <QPixmap>
+#include <QString>
+
+namespace crystaldock {
+
+// Counters and duration histograms of the docks, for monitoring them in the field, e.g.
+// with DockControlService::metrics().
+//
+// Unlike the Profiler, always on: counting is an array increment, and timing a section
+// reads the monotonic clock twice, which only the infrequent sections do.
+// Must be used on the GUI thread only.
+class RuntimeMetrics {
+ public:
+  enum class Counter {
+    WindowAdded,
+    WindowRemoved,
+    WindowStateChanged,
+    WindowTitleChanged,
+    WindowGeometryChanged,
+    WindowOutputsChanged,
+    ActiveWindowChanged,
+    // Events merged into an already pending one, e.g. the geometry changes of a window
+    // being dragged.
+    EventsCoalesced,
+    Layouts,
+    Repaints,
+    // Sum of the areas of the repainted regions, in logical pixels.
+    RepaintPixels,
+    IconCacheHits,
+    IconCacheMisses,
+    // Bytes held by the icon store's live icons, so it goes down too.
+    IconCacheBytes,
+    ApplicationMenuReloads,
+    // Hidden docks shown by the pointer hitting their screen edge.
+    Reveals,
+    kCount
+  };
+
+  // Reveal is from the pointer entering a hidden dock to the dock's first frame.
+  enum class Histogram { Layout, Repaint, ApplicationMenuReload, Reveal, kCount };
+
+  // What a dock holds in memory, computed when the metrics are read.
+  struct DockMemory {
+    // Icons of the items, including those shared with other docks via the icon store.
+    int64_t iconBytes = 0;
+    // Wallpaper and window thumbnails.
+    int64_t thumbnailBytes = 0;
+    // Offscreen buffers, e.g. the cached frames and sprites.
+    int64_t bufferBytes = 0;
+    // Entries in the menus, whose memory Qt doesn't tell.
+    int menuActions = 0;
+  };
+
+  static void add(Counter counter, int64_t n = 1) {
+    counters_[static_cast<int>(counter)] += n;
+  }
+
+  static void recordDuration(Histogram histogram, int64_t micros);
+
+  static void setDockItemCount(int dockId, int count) { dockItemCounts_[dockId] = count; }
+
+  static void setDockMemoryProbe(int dockId, std::function<DockMemory()> probe) {
+    dockMemoryProbes_[dockId] = std::move(probe);
+  }
+
+  static void removeDock(int dockId) {
+    dockItemCounts_.erase(dockId);
+    dockMemoryProbes_.erase(dockId);
+  }
+
+  static int64_t bytes(const QPixmap& pixmap) {
+    return static_cast<int64_t>(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+  }
+
+  static int64_t bytes(const QImage& image) { return image.sizeInBytes(); }
+
+  // Also includes the scheduler's timer wakeups.
+  static QString toJson();
+
+ private:
+  // Bucket i counts the durations in [2^(i-1), 2^i) microseconds, the first one those
+  // under 1 us. The last one also counts the longer ones.
+  static constexpr int kBucketCount = 24;
+
+  struct Durations {
+    std::array<int64_t, kBucketCount> buckets{};
+    int64_t count = 0;
+    int64_t totalMicros = 0;
+    int64_t maxMicros = 0;
+  };
+
+  static std::array<int64_t, static_cast<int>(Counter::kCount)> counters_;
+  static std::array<Durations, static_cast<int>(Histogram::kCount)> durations_;
+  static std::map<int, int> dockItemCounts_;
+  static std::map<int, std::function<DockMemory()>> dockMemoryProbes_;
+};
+
+// Counts and times the enclosing scope.
+class MetricsScope {
+ public:
+  MetricsScope(RuntimeMetrics::Counter counter, RuntimeMetrics::Histogram histogram)
+      : histogram_(histogram) {
+    RuntimeMetrics::add(counter);
+    timer_.start();
+  }
+
+  ~MetricsScope() { RuntimeMetrics::recordDuration(histogram_, timer_.nsecsElapsed() / 1000); }
+
+  MetricsScope(const MetricsScope&) = delete;
+  MetricsScope& operator=(const MetricsScope&) = delete;
+
+ private:
+  RuntimeMetrics::Histogram histogram_;
+  QElapsedTimer timer_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_RUNTIME_METRICS_H_
@@ -0,0 +1,173 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "scheduler.h"
+
+#include <vector>
+
+#include <QDBusConnection>
+#include <QTime>
+
+namespace crystaldock {
+
+/* static */ Scheduler* Scheduler::self() {
+  static Scheduler scheduler;
+  return &scheduler;
+}
+
+Scheduler::Scheduler() {
+  clock_.start();
+  QDBusConnection::systemBus().connect(
+      "org.freedesktop.login1", "/org/freedesktop/login1", "org.freedesktop.login1.Manager",
+      "PrepareForSleep", this, SLOT(onPrepareForSleep(bool)));
+  QDBusConnection::sessionBus().connect(
+      "org.freedesktop.ScreenSaver", "/org/freedesktop/ScreenSaver",
+      "org.freedesktop.ScreenSaver", "ActiveChanged",
+      this, SLOT(onScreenSaverActiveChanged(bool)));
+}
+
+Scheduler::TaskId Scheduler::addPeriodic(const void* group, int intervalMs,
+                                         std::function<void()> callback) {
+  const TaskId id = nextId_++;
+  tasks_[id] = Task{group, intervalMs, std::move(callback)};
+  auto& timer = timers_[intervalMs];
+  if (!timer) {
+    timer = std::make_unique<QTimer>();
+    timer->setSingleShot(true);
+    timer->setTimerType(Qt::PreciseTimer);
+    connect(timer.get(), &QTimer::timeout, this, [this, intervalMs]() { onTick(intervalMs); });
+  }
+  updateTimer(intervalMs);
+  return id;
+}
+
+void Scheduler::remove(TaskId id) {
+  auto it = tasks_.find(id);
+  if (it == tasks_.end()) {
+    return;
+  }
+  const int intervalMs = it->second.intervalMs;
+  tasks_.erase(it);
+  updateTimer(intervalMs);
+}
+
+void Scheduler::removeGroup(const void* group) {
+  std::erase_if(tasks_, [group](const auto& entry) { return entry.second.group == group; });
+  suspendedGroups_.erase(group);
+  updateTimers();
+}
+
+void Scheduler::setSuspended(const void* group, bool suspended) {
+  if (suspended == suspendedGroups_.contains(group)) {
+    return;
+  }
+
+  if (suspended) {
+    suspendedGroups_.insert(group);
+  } else {
+    suspendedGroups_.erase(group);
+    runTasks([group](const Task& task) { return task.group == group; });
+  }
+  updateTimers();
+}
+
+double Scheduler::wakeupsPerSecond() {
+  const qint64 now = clock_.elapsed();
+  while (!wakeups_.empty() && wakeups_.front() <= now - kWakeupWindowMs) {
+    wakeups_.pop_front();
+  }
+  return wakeups_.size() * 1000.0 / kWakeupWindowMs;
+}
+
+void Scheduler::onPrepareForSleep(bool start) {
+  sleeping_ = start;
+  if (!sleeping_) {
+    runTasks([](const Task&) { return true; });
+  }
+  updateTimers();
+}
+
+void Scheduler::onScreenSaverActiveChanged(bool active) {
+  idle_ = active;
+  if (!idle_) {
+    runTasks([](const Task&) { return true; });
+  }
+  updateTimers();
+  emit idleChanged(idle_);
+}
+
+void Scheduler::runTasks(const std::function<bool(const Task&)>& matches) {
+  // Callbacks may add or remove tasks.
+  std::vector<TaskId> ids;
+  for (const auto& [id, task] : tasks_) {
+    if (isRunning(task) && matches(task)) {
+      ids.push_back(id);
+    }
+  }
+  for (const TaskId id : ids) {
+    auto it = tasks_.find(id);
+    if (it != tasks_.end()) {
+      auto callback = it->second.callback;
+      callback();
+    }
+  }
+}
+
+void Scheduler::onTick(int intervalMs) {
+  wakeups_.push_back(clock_.elapsed());
+  wakeupsPerSecond();  // Trims the old wakeups.
+  runTasks([intervalMs](const Task& task) { return task.intervalMs == intervalMs; });
+  updateTimer(intervalMs);
+}
+
+void Scheduler::updateTimer(int intervalMs) {
+  auto it = timers_.find(intervalMs);
+  if (it == timers_.end()) {
+    return;
+  }
+
+  bool hasRunningTasks = false;
+  for (const auto& [id, task] : tasks_) {
+    if (task.intervalMs == intervalMs && isRunning(task)) {
+      hasRunningTasks = true;
+      break;
+    }
+  }
+
+  QTimer* timer = it->second.get();
+  if (!hasRunningTasks) {
+    timer->stop();
+  } else if (!timer->isActive()) {
+    // Aligns to the next multiple of the interval since midnight.
+    const int sinceMidnightMs = QTime::currentTime().msecsSinceStartOfDay();
+    int delayMs = intervalMs - sinceMidnightMs % intervalMs;
+    if (delayMs < kMinDelayMs) {
+      delayMs += intervalMs;
+    }
+    timer->start(delayMs);
+  }
+}
+
+void Scheduler::updateTimers() {
+  for (const auto& [intervalMs, timer] : timers_) {
+    updateTimer(intervalMs);
+  }
+}
+
+}  // namespace crystaldock
@@ -0,0 +1,119 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CRYSTALDOCK_SCHEDULER_H_
+#define CRYSTALDOCK_SCHEDULER_H_
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <unordered_set>
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+
+namespace crystaldock {
+
+// Owns the periodic activities of the docks, e.g. the clock and the blinking of
+// programs that demand attention, so that the process doesn't wake up when
+// nothing is changing.
+//
+// Tasks with the same interval share a single timer, aligned to wall-clock
+// multiples of the interval, e.g. minute boundaries for 60 s. Tasks are grouped,
+// usually by dock, and a group can be suspended, e.g. while its dock is hidden.
+// All tasks are suspended during system sleep and while the screen saver is on.
+// Must be used on the GUI thread only.
+class Scheduler : public QObject {
+  Q_OBJECT
+
+ public:
+  using TaskId = int;
+
+  static Scheduler* self();
+
+  // Runs the callback every intervalMs while its group is active. The callback is
+  // also run once when the group is resumed, so that it can catch up.
+  TaskId addPeriodic(const void* group, int intervalMs, std::function<void()> callback);
+
+  void remove(TaskId id);
+
+  // Removes all tasks of the group and forgets whether it's suspended.
+  void removeGroup(const void* group);
+
+  void setSuspended(const void* group, bool suspended);
+
+  // Timer wakeups per second, averaged over the last kWakeupWindowMs.
+  double wakeupsPerSecond();
+
+  bool isIdle() const { return idle_; }
+
+ signals:
+  // The screen saver has been turned on or off, e.g. the outputs have been blanked.
+  void idleChanged(bool idle);
+
+ private slots:
+  void onPrepareForSleep(bool start);
+
+  void onScreenSaverActiveChanged(bool active);
+
+ private:
+  static constexpr int kWakeupWindowMs = 10000;
+  // Timers may fire a little early, so a tick right before a boundary doesn't
+  // arm the timer for that same boundary.
+  static constexpr int kMinDelayMs = 20;
+
+  struct Task {
+    const void* group;
+    int intervalMs;
+    std::function<void()> callback;
+  };
+
+  Scheduler();
+
+  bool isRunning(const Task& task) const {
+    return !sleeping_ && !idle_ && !suspendedGroups_.contains(task.group);
+  }
+
+  // Runs the running tasks that match.
+  void runTasks(const std::function<bool(const Task&)>& matches);
+
+  void onTick(int intervalMs);
+
+  // Arms the timer of the interval if it has running tasks, or stops it.
+  void updateTimer(int intervalMs);
+
+  void updateTimers();
+
+  std::map<TaskId, Task> tasks_;
+  TaskId nextId_ = 0;
+  // Shared timers, by interval.
+  std::map<int, std::unique_ptr<QTimer>> timers_;
+  std::unordered_set<const void*> suspendedGroups_;
+  bool sleeping_ = false;
+  bool idle_ = false;
+
+  QElapsedTimer clock_;
+  std::deque<qint64> wakeups_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_SCHEDULER_H_
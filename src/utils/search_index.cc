@@ -0,0 +1,232 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "search_index.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <utility>
+
+namespace crystaldock {
+
+namespace {
+
+// Base scores of the different kinds of matches.
+constexpr int kExactMatch = 1000;
+constexpr int kPrefixMatch = 800;
+constexpr int kWordPrefixMatch = 600;
+constexpr int kSubstringMatch = 400;
+constexpr int kFuzzyMatch = 200;
+constexpr int kTypoPenalty = 50;
+
+}  // namespace
+
+void SearchIndex::clear() {
+  items_.clear();
+  trigrams_.clear();
+}
+
+int SearchIndex::add(const QStringList& fields) {
+  const int id = size();
+  Item item;
+  for (const auto& field : fields) {
+    item.fields.append(field.toLower());
+    item.words.push_back(splitWords(item.fields.back()));
+    for (const auto trigram : trigrams(item.words.back())) {
+      auto& ids = trigrams_[trigram];
+      if (ids.empty() || ids.back() != id) {
+        ids.push_back(id);
+      }
+    }
+  }
+  items_.push_back(std::move(item));
+  return id;
+}
+
+std::vector<int> SearchIndex::search(const QString& text, unsigned int maxNumResults) const {
+  const QString query = text.simplified().toLower();
+  if (query.isEmpty() || maxNumResults == 0) {
+    return {};
+  }
+
+  const int typos = (query.contains(' ')) ? 0 : maxTypos(query.length());
+
+  // Each typo can break at most 3 trigrams of the query, so a matching item must share
+  // at least this many of them. If it's not positive, every item is a candidate.
+  const auto queryTrigrams = trigrams(splitWords(query));
+  const int minSharedTrigrams = static_cast<int>(queryTrigrams.size()) - 3 * typos;
+
+  std::vector<std::pair<int, int>> results;  // (score, id)
+  auto tryItem = [&](int id) {
+    const int itemScore = score(items_[id], query, typos);
+    if (itemScore > 0) {
+      results.emplace_back(itemScore, id);
+    }
+  };
+
+  if (minSharedTrigrams > 0) {
+    std::vector<int> sharedTrigrams(items_.size(), 0);
+    for (const auto trigram : queryTrigrams) {
+      auto it = trigrams_.find(trigram);
+      if (it == trigrams_.end()) {
+        continue;
+      }
+      for (const int id : it->second) {
+        if (++sharedTrigrams[id] == minSharedTrigrams) {
+          tryItem(id);
+        }
+      }
+    }
+  } else {
+    for (int id = 0; id < size(); ++id) {
+      tryItem(id);
+    }
+  }
+
+  auto better = [this](const std::pair<int, int>& r1, const std::pair<int, int>& r2) {
+    if (r1.first != r2.first) {
+      return r1.first > r2.first;
+    }
+    return items_[r1.second].fields.value(0) < items_[r2.second].fields.value(0);
+  };
+  const size_t numResults = std::min<size_t>(maxNumResults, results.size());
+  std::partial_sort(results.begin(), results.begin() + numResults, results.end(), better);
+
+  std::vector<int> ids;
+  ids.reserve(numResults);
+  for (size_t i = 0; i < numResults; ++i) {
+    ids.push_back(results[i].second);
+  }
+  return ids;
+}
+
+/* static */ int SearchIndex::score(const Item& item, const QString& query, int maxTypos) {
+  constexpr int kNumWeights = std::size(kFieldWeights);
+  int best = 0;
+  for (int i = 0; i < item.fields.size(); ++i) {
+    const int weight = kFieldWeights[std::min(i, kNumWeights - 1)];
+    best = std::max(
+        best, scoreField(item.fields[i], item.words[i], query, maxTypos) * weight / 100);
+  }
+  return best;
+}
+
+/* static */ int SearchIndex::scoreField(const QString& field, const QStringList& words,
+                                         const QString& query, int maxTypos) {
+  if (field.isEmpty()) {
+    return 0;
+  }
+  if (field == query) {
+    return kExactMatch;
+  }
+  if (field.startsWith(query)) {
+    return kPrefixMatch;
+  }
+  for (const auto& word : words) {
+    if (word.startsWith(query)) {
+      return kWordPrefixMatch;
+    }
+  }
+  // A single character matching in the middle of a word is just noise.
+  if (query.length() > 1 && field.contains(query)) {
+    return kSubstringMatch;
+  }
+  if (maxTypos == 0) {
+    return 0;
+  }
+
+  // Compares the query against the word prefixes of about the same length.
+  int bestDistance = maxTypos + 1;
+  const int length = query.length();
+  for (const auto& word : words) {
+    if (word.length() < length - maxTypos) {
+      continue;
+    }
+    for (int prefixLength = length - 1; prefixLength <= length + 1; ++prefixLength) {
+      if (prefixLength > word.length()) {
+        break;
+      }
+      bestDistance = std::min(
+          bestDistance, editDistance(QStringView(word).left(prefixLength), query, maxTypos));
+    }
+  }
+  return (bestDistance <= maxTypos) ? kFuzzyMatch - bestDistance * kTypoPenalty : 0;
+}
+
+/* static */ QStringList SearchIndex::splitWords(const QString& text) {
+  QStringList words;
+  int start = -1;
+  for (int i = 0; i <= text.length(); ++i) {
+    const bool isWordChar = i < text.length() && text[i].isLetterOrNumber();
+    if (isWordChar && start < 0) {
+      start = i;
+    } else if (!isWordChar && start >= 0) {
+      words.append(text.mid(start, i - start));
+      start = -1;
+    }
+  }
+  return words;
+}
+
+/* static */ std::vector<uint64_t> SearchIndex::trigrams(const QStringList& words) {
+  std::vector<uint64_t> result;
+  for (const auto& word : words) {
+    for (int i = 0; i + 3 <= word.length(); ++i) {
+      result.push_back((static_cast<uint64_t>(word[i].unicode()) << 32) |
+                       (static_cast<uint64_t>(word[i + 1].unicode()) << 16) |
+                       word[i + 2].unicode());
+    }
+  }
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
+/* static */ int SearchIndex::editDistance(QStringView a, QStringView b, int max) {
+  if (std::abs(a.length() - b.length()) > max) {
+    return max + 1;
+  }
+
+  // Keeps the last two rows for transpositions.
+  const int n = b.length();
+  std::vector<int> previous2(n + 1), previous(n + 1), current(n + 1);
+  for (int j = 0; j <= n; ++j) {
+    previous[j] = j;
+  }
+  for (int i = 1; i <= a.length(); ++i) {
+    current[0] = i;
+    int rowMin = current[0];
+    for (int j = 1; j <= n; ++j) {
+      const int cost = (a[i - 1] == b[j - 1]) ? 0 : 1;
+      current[j] = std::min({previous[j] + 1, current[j - 1] + 1, previous[j - 1] + cost});
+      if (i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1]) {
+        current[j] = std::min(current[j], previous2[j - 2] + 1);
+      }
+      rowMin = std::min(rowMin, current[j]);
+    }
+    if (rowMin > max) {
+      return max + 1;
+    }
+    std::swap(previous2, previous);
+    std::swap(previous, current);
+  }
+  return std::min(previous[n], max + 1);
+}
+
+}  // namespace crystaldock
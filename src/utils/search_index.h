@@ -0,0 +1,85 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CRYSTALDOCK_SEARCH_INDEX_H_
+#define CRYSTALDOCK_SEARCH_INDEX_H_
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+
+namespace crystaldock {
+
+// A prebuilt index for searching items (e.g. application entries) by their text fields,
+// with ranked, typo-tolerant matching.
+//
+// Every word of every field is indexed by its trigrams, so that a query only needs to score
+// the items that share enough trigrams with it rather than every item.
+class SearchIndex {
+ public:
+  // Weights of the fields of an item, in percent, in the order the fields are added.
+  // Fields after the last weight use the last weight.
+  static constexpr int kFieldWeights[] = {100, 70, 50};
+
+  void clear();
+
+  // Adds an item with the given fields, e.g. {name, generic name, keywords}.
+  // Returns the ID of the item, which increases from 0 in the order items are added.
+  int add(const QStringList& fields);
+
+  int size() const { return static_cast<int>(items_.size()); }
+
+  // Returns the IDs of the best matching items, best first, at most maxNumResults.
+  // Ties are broken by the first field, alphabetically.
+  std::vector<int> search(const QString& query, unsigned int maxNumResults) const;
+
+ private:
+  struct Item {
+    // Lowercased fields.
+    QStringList fields;
+    // Lowercased words of each field.
+    std::vector<QStringList> words;
+  };
+
+  // Scores an item against the lowercased query, 0 if it doesn't match.
+  static int score(const Item& item, const QString& query, int maxTypos);
+  static int scoreField(const QString& field, const QStringList& words, const QString& query,
+                        int maxTypos);
+
+  static QStringList splitWords(const QString& text);
+  static std::vector<uint64_t> trigrams(const QStringList& words);
+
+  // Optimal string alignment distance between a and b, or max + 1 if it exceeds max.
+  static int editDistance(QStringView a, QStringView b, int max);
+
+  static int maxTypos(int queryLength) {
+    return (queryLength < 4) ? 0 : (queryLength < 8) ? 1 : 2;
+  }
+
+  std::vector<Item> items_;
+  // Map from trigrams to the IDs of the items containing them, in increasing order.
+  std::unordered_map<uint64_t, std::vector<int>> trigrams_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_SEARCH_INDEX_H_
@@ -0,0 +1,99 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CRYSTALDOCK_SMALL_SET_H_
+#define CRYSTALDOCK_SMALL_SET_H_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace crystaldock {
+
+// A set of a few trivially copyable values (e.g. pointers), unordered. The first N are
+// stored inline, so small sets don't allocate and stay next to their owner in memory.
+template <typename T, size_t N>
+class SmallSet {
+ public:
+  bool empty() const { return size() == 0; }
+  size_t size() const { return inlineSize_ + overflow_.size(); }
+
+  bool contains(T value) const {
+    const auto* end = inline_.data() + inlineSize_;
+    return std::find(inline_.data(), end, value) != end ||
+        std::find(overflow_.begin(), overflow_.end(), value) != overflow_.end();
+  }
+
+  // Returns true if the value was added.
+  bool insert(T value) {
+    if (contains(value)) {
+      return false;
+    }
+    if (inlineSize_ < N) {
+      inline_[inlineSize_++] = value;
+    } else {
+      overflow_.push_back(value);
+    }
+    return true;
+  }
+
+  // Returns the number of values removed.
+  size_t erase(T value) {
+    auto* end = inline_.data() + inlineSize_;
+    auto* it = std::find(inline_.data(), end, value);
+    if (it != end) {
+      // Refills the slot so that the inline values stay contiguous.
+      if (!overflow_.empty()) {
+        *it = overflow_.back();
+        overflow_.pop_back();
+      } else {
+        *it = inline_[--inlineSize_];
+      }
+      return 1;
+    }
+    return std::erase(overflow_, value);
+  }
+
+  template <typename F>
+  void forEach(F&& f) const {
+    std::for_each(inline_.data(), inline_.data() + inlineSize_, f);
+    std::for_each(overflow_.begin(), overflow_.end(), f);
+  }
+
+  // Same values, regardless of order.
+  bool operator==(const SmallSet& other) const {
+    if (size() != other.size()) {
+      return false;
+    }
+    bool equal = true;
+    forEach([&](T value) { equal = equal && other.contains(value); });
+    return equal;
+  }
+
+ private:
+  std::array<T, N> inline_{};
+  uint8_t inlineSize_ = 0;
+  std::vector<T> overflow_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_SMALL_SET_H_
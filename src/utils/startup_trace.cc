@@ -0,0 +1,85 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "startup_trace.h"
+
+#include <iostream>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace crystaldock {
+
+QString StartupTrace::path_;
+QElapsedTimer StartupTrace::clock_;
+std::vector<StartupTrace::Event> StartupTrace::events_;
+
+/* static */ void StartupTrace::enable(const QString& path) {
+  path_ = path;
+  clock_.start();
+}
+
+/* static */ void StartupTrace::addPhase(std::string name, int64_t startUs) {
+  events_.push_back({std::move(name), /*instant=*/false, startUs, nowUs() - startUs});
+}
+
+/* static */ void StartupTrace::addFirstFrame(int dockId) {
+  const std::string name = "First frame (dock " + std::to_string(dockId) + ")";
+  for (const auto& event : events_) {
+    if (event.instant && event.name == name) {
+      return;
+    }
+  }
+  events_.push_back({name, /*instant=*/true, nowUs(), 0});
+  write();
+}
+
+/* static */ bool StartupTrace::write() {
+  QJsonArray traceEvents;
+  const qint64 pid = QCoreApplication::applicationPid();
+  for (const auto& event : events_) {
+    QJsonObject json{
+        {"name", QString::fromStdString(event.name)},
+        {"cat", "startup"},
+        {"ph", event.instant ? "i" : "X"},
+        {"ts", static_cast<qint64>(event.startUs)},
+        {"pid", pid},
+        {"tid", 1}};
+    if (event.instant) {
+      json["s"] = "p";
+    } else {
+      json["dur"] = static_cast<qint64>(event.durationUs);
+    }
+    traceEvents.append(json);
+  }
+
+  QFile file(path_);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    std::cerr << "Failed to write startup trace to " << path_.toStdString() << std::endl;
+    return false;
+  }
+  file.write(QJsonDocument(QJsonObject{{"traceEvents", traceEvents},
+                                       {"displayTimeUnit", "ms"}}).toJson());
+  return true;
+}
+
+}  // namespace crystaldock
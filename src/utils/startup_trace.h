@@ -0,0 +1,92 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CRYSTALDOCK_STARTUP_TRACE_H_
+#define CRYSTALDOCK_STARTUP_TRACE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <QElapsedTimer>
+#include <QString>
+
+namespace crystaldock {
+
+// Timestamps the phases of start-up, from main() to the first frame of each dock,
+// when started with --startup-trace=<path> or CRYSTAL_DOCK_STARTUP_TRACE=<path>.
+//
+// The trace is written in the Chrome trace event format, which can be loaded in
+// chrome://tracing or Perfetto, each time a dock paints its first frame.
+// Must be used on the GUI thread only.
+class StartupTrace {
+ public:
+  static bool enabled() { return !path_.isEmpty(); }
+
+  // Should be called first thing in main(); the trace's timestamps are relative to it.
+  static void enable(const QString& path);
+
+  // Records a phase that started at startUs and lasted until now.
+  static void addPhase(std::string name, int64_t startUs);
+
+  // Records that the dock has painted its first frame, and writes the trace.
+  static void addFirstFrame(int dockId);
+
+  static int64_t nowUs() { return clock_.nsecsElapsed() / 1000; }
+
+ private:
+  struct Event {
+    std::string name;
+    // Instant events have no duration.
+    bool instant;
+    int64_t startUs;
+    int64_t durationUs;
+  };
+
+  static bool write();
+
+  static QString path_;
+  static QElapsedTimer clock_;
+  static std::vector<Event> events_;
+};
+
+// Records the enclosing scope as a phase of start-up.
+class StartupPhase {
+ public:
+  explicit StartupPhase(std::string name)
+      : name_(StartupTrace::enabled() ? std::move(name) : std::string()),
+        startUs_(StartupTrace::enabled() ? StartupTrace::nowUs() : 0) {}
+
+  ~StartupPhase() {
+    if (!name_.empty()) {
+      StartupTrace::addPhase(std::move(name_), startUs_);
+    }
+  }
+
+  StartupPhase(const StartupPhase&) = delete;
+  StartupPhase& operator=(const StartupPhase&) = delete;
+
+ private:
+  std::string name_;
+  int64_t startUs_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_STARTUP_TRACE_H_
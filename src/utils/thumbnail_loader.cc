@@ -0,0 +1,119 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "thumbnail_loader.h"
+
+#include <cstdio>
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QThreadPool>
+
+namespace crystaldock {
+
+QString ThumbnailLoader::cacheDir_;
+QHash<QString, QPixmap> ThumbnailLoader::thumbnails_;
+QHash<QString, std::vector<ThumbnailLoader::Callback>> ThumbnailLoader::pending_;
+
+/* static */ void ThumbnailLoader::init(const QString& cacheDir) {
+  cacheDir_ = cacheDir;
+}
+
+/* static */ void ThumbnailLoader::loadAsync(const QString& path, const QSize& size,
+                                             QObject* context,
+                                             std::function<void(const QPixmap&)> callback) {
+  const QFileInfo fileInfo(path);
+  const QString key = QString("%1|%2|%3x%4")
+      .arg(fileInfo.absoluteFilePath())
+      .arg(fileInfo.lastModified().toMSecsSinceEpoch())
+      .arg(size.width())
+      .arg(size.height());
+  auto it = thumbnails_.constFind(key);
+  if (it != thumbnails_.constEnd()) {
+    callback(*it);
+    return;
+  }
+
+  auto& callbacks = pending_[key];
+  callbacks.emplace_back(context, std::move(callback));
+  if (callbacks.size() > 1) {  // Already being loaded.
+    return;
+  }
+
+  const QString cacheFile = cacheDir_.isEmpty()
+      ? QString()
+      : cacheDir_ + "/" +
+        QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex() + ".png";
+  QThreadPool::globalInstance()->start([key, path, size, cacheFile]() {
+    const QImage image = load(path, size, cacheFile);
+    QMetaObject::invokeMethod(QCoreApplication::instance(), [key, image]() {
+      onLoaded(key, image);
+    }, Qt::QueuedConnection);
+  });
+}
+
+/* static */ QImage ThumbnailLoader::load(const QString& path, const QSize& size,
+                                          const QString& cacheFile) {
+  if (!cacheFile.isEmpty()) {
+    QImage image(cacheFile);
+    if (image.size() == size) {
+      return image;
+    }
+  }
+
+  QImageReader reader(path);
+  reader.setAutoTransform(true);
+  reader.setScaledSize(size);
+  QImage image = reader.read();
+  if (image.isNull()) {
+    return image;
+  }
+  // Some formats can't decode at a smaller size.
+  if (image.size() != size) {
+    image = image.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+  }
+
+  if (!cacheFile.isEmpty() && QDir().mkpath(cacheDir_)) {
+    const QString tempFile = cacheFile + ".tmp";
+    if (image.save(tempFile, "PNG")) {
+      std::rename(QFile::encodeName(tempFile), QFile::encodeName(cacheFile));
+    }
+  }
+  return image;
+}
+
+/* static */ void ThumbnailLoader::onLoaded(const QString& key, const QImage& image) {
+  const QPixmap thumbnail = QPixmap::fromImage(image);
+  if (!thumbnail.isNull()) {
+    thumbnails_[key] = thumbnail;
+  }
+  const auto callbacks = pending_.take(key);
+  for (const auto& [context, callback] : callbacks) {
+    if (context) {
+      callback(thumbnail);
+    }
+  }
+}
+
+}  // namespace crystaldock
@@ -0,0 +1,71 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CRYSTALDOCK_THUMBNAIL_LOADER_H_
+#define CRYSTALDOCK_THUMBNAIL_LOADER_H_
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QPixmap>
+#include <QPointer>
+#include <QSize>
+#include <QString>
+
+namespace crystaldock {
+
+// Loads downscaled thumbnails of images, e.g. wallpapers for the pager.
+//
+// Images are decoded directly at the thumbnail size on a worker thread, so
+// full-resolution wallpapers are never decoded in full. Thumbnails are cached
+// in memory, shared by all docks, and on disk keyed by the image's path,
+// modification time and the thumbnail size. Must be called on the GUI thread.
+class ThumbnailLoader {
+ public:
+  // Enables the disk cache.
+  static void init(const QString& cacheDir);
+
+  // Loads the thumbnail of the image scaled to size, ignoring its aspect ratio,
+  // then calls callback with the result (a null pixmap if the image can't be read).
+  // The callback is called right away if the thumbnail is in memory, otherwise
+  // later on the GUI thread, and dropped if context has been destroyed by then.
+  static void loadAsync(const QString& path, const QSize& size, QObject* context,
+                        std::function<void(const QPixmap&)> callback);
+
+ private:
+  using Callback = std::pair<QPointer<QObject>, std::function<void(const QPixmap&)>>;
+
+  // Decodes the thumbnail, or loads it from the disk cache. Runs on the worker thread.
+  static QImage load(const QString& path, const QSize& size, const QString& cacheFile);
+
+  static void onLoaded(const QString& key, const QImage& image);
+
+  static QString cacheDir_;
+  static QHash<QString, QPixmap> thumbnails_;
+  // Callbacks waiting for thumbnails being loaded, by key.
+  static QHash<QString, std::vector<Callback>> pending_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_THUMBNAIL_LOADER_H_
@@ -0,0 +1,166 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "application_list_model.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+#include <QUrl>
+
+#include <utils/icon_loader.h>
+
+namespace crystaldock {
+
+ApplicationListModel::ApplicationListModel(MultiDockModel* model, QObject* parent)
+    : QAbstractListModel(parent), model_(model) {
+  connect(model_, &MultiDockModel::applicationMenuEntriesChanged,
+          this, &ApplicationListModel::onEntriesChanged);
+  setFilter(QString());
+}
+
+int ApplicationListModel::rowCount(const QModelIndex& parent) const {
+  return parent.isValid() ? 0 : static_cast<int>(entries_.size());
+}
+
+QVariant ApplicationListModel::data(const QModelIndex& index, int role) const {
+  if (!index.isValid() || index.row() >= rowCount()) {
+    return QVariant();
+  }
+
+  const auto& entry = entries_[index.row()];
+  switch (role) {
+    case Qt::DisplayRole:
+      return entry.name;
+    case Qt::ToolTipRole:
+      return entry.genericName;
+    case Qt::DecorationRole: {
+      auto it = icons_.constFind(entry.icon);
+      if (it != icons_.constEnd()) {
+        return it.value();
+      }
+      loadIcon(entry.icon);
+      return QVariant();
+    }
+    case AppIdRole:
+      return entry.appId;
+    case IconNameRole:
+      return entry.icon;
+    default:
+      return QVariant();
+  }
+}
+
+Qt::ItemFlags ApplicationListModel::flags(const QModelIndex& index) const {
+  return QAbstractListModel::flags(index) | Qt::ItemIsDragEnabled;
+}
+
+QStringList ApplicationListModel::mimeTypes() const {
+  return {"text/uri-list"};
+}
+
+QMimeData* ApplicationListModel::mimeData(const QModelIndexList& indexes) const {
+  if (indexes.isEmpty() || !indexes.first().isValid()) {
+    return nullptr;
+  }
+
+  // The launcher list only takes one desktop file per drop.
+  auto* mimeData = new QMimeData;
+  const auto& entry = entries_[indexes.first().row()];
+  mimeData->setData("text/uri-list", QUrl::fromLocalFile(entry.desktopFile).toEncoded());
+  return mimeData;
+}
+
+void ApplicationListModel::setFilter(const QString& text) {
+  filter_ = text;
+  beginResetModel();
+  entries_.clear();
+  if (text.trimmed().isEmpty()) {
+    std::unordered_set<QString> appIds;
+    for (const auto& category : model_->applicationMenuCategories()) {
+      for (const auto& entry : category.entries()) {
+        if (!entry.hidden && appIds.insert(entry.appId).second) {
+          entries_.push_back(entry);
+        }
+      }
+    }
+    std::sort(entries_.begin(), entries_.end());
+  } else {
+    entries_ = model_->searchApplications(text, kMaxSearchResults);
+  }
+  endResetModel();
+}
+
+void ApplicationListModel::onEntriesChanged(const QStringList& changedAppIds,
+                                            const QStringList& removedAppIds) {
+  if (!filter_.trimmed().isEmpty()) {
+    // The search results can be ranked differently with the new entries.
+    setFilter(filter_);
+    return;
+  }
+
+  for (int row = rowCount() - 1; row >= 0; --row) {
+    const QString& appId = entries_[row].appId;
+    if (changedAppIds.contains(appId) || removedAppIds.contains(appId)) {
+      beginRemoveRows(QModelIndex(), row, row);
+      entries_.erase(entries_.begin() + row);
+      endRemoveRows();
+    }
+  }
+
+  // Inserts the changed entries as they are now, in order, as setFilter() would.
+  std::unordered_set<QString> appIds;
+  for (const auto& category : model_->applicationMenuCategories()) {
+    for (const auto& entry : category.entries()) {
+      if (entry.hidden || !changedAppIds.contains(entry.appId) ||
+          !appIds.insert(entry.appId).second) {
+        continue;
+      }
+      const auto it = std::upper_bound(entries_.begin(), entries_.end(), entry);
+      const int row = static_cast<int>(it - entries_.begin());
+      beginInsertRows(QModelIndex(), row, row);
+      entries_.insert(it, entry);
+      endInsertRows();
+    }
+  }
+}
+
+void ApplicationListModel::loadIcon(const QString& iconName) const {
+  if (iconName.isEmpty() || !pendingIcons_.insert(iconName).second) {
+    return;
+  }
+
+  auto* self = const_cast<ApplicationListModel*>(this);
+  IconLoader::loadAsync({iconName}, kIconSize, self, [self, iconName](const QPixmap& icon) {
+    self->onIconLoaded(iconName, icon);
+  });
+}
+
+void ApplicationListModel::onIconLoaded(const QString& iconName, const QPixmap& icon) {
+  pendingIcons_.erase(iconName);
+  // Also cached if null, so that missing icons aren't looked up again.
+  icons_.insert(iconName, icon);
+  for (int row = 0; row < rowCount(); ++row) {
+    if (entries_[row].icon == iconName) {
+      emit dataChanged(index(row), index(row), {Qt::DecorationRole});
+    }
+  }
+}
+
+}  // namespace crystaldock
@@ -0,0 +1,91 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CRYSTALDOCK_APPLICATION_LIST_MODEL_H_
+#define CRYSTALDOCK_APPLICATION_LIST_MODEL_H_
+
+#include <unordered_set>
+#include <vector>
+
+#include <QAbstractListModel>
+#include <QHash>
+#include <QMimeData>
+#include <QModelIndex>
+#include <QPixmap>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+
+#include <model/application_menu_entry.h>
+#include <model/multi_dock_model.h>
+
+namespace crystaldock {
+
+// List model of the application menu's entries, for picking launchers.
+//
+// Icons are only loaded, asynchronously, when a view asks for them, i.e. for the
+// visible rows, so that the model is cheap to build even with thousands of entries.
+class ApplicationListModel : public QAbstractListModel {
+  Q_OBJECT
+
+ public:
+  static constexpr int kIconSize = 32;
+  static constexpr unsigned int kMaxSearchResults = 200;
+
+  enum Role {
+    AppIdRole = Qt::UserRole,
+    IconNameRole,
+  };
+
+  ApplicationListModel(MultiDockModel* model, QObject* parent = nullptr);
+  ~ApplicationListModel() = default;
+
+  int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex& index, int role) const override;
+  Qt::ItemFlags flags(const QModelIndex& index) const override;
+
+  // Drags carry the desktop files, like drags from the application menu.
+  QStringList mimeTypes() const override;
+  QMimeData* mimeData(const QModelIndexList& indexes) const override;
+
+  const ApplicationEntry& entry(int row) const { return entries_[row]; }
+
+  // Shows all entries by name if text is empty, or the search results for text,
+  // using the application menu's search index.
+  void setFilter(const QString& text);
+
+ private:
+  // Updates only the rows of the entries that have changed.
+  void onEntriesChanged(const QStringList& changedAppIds, const QStringList& removedAppIds);
+
+  void loadIcon(const QString& iconName) const;
+  void onIconLoaded(const QString& iconName, const QPixmap& icon);
+
+  MultiDockModel* model_;
+  QString filter_;
+  std::vector<ApplicationEntry> entries_;
+
+  // Loaded icons by icon name, kept across filter changes.
+  QHash<QString, QPixmap> icons_;
+  mutable std::unordered_set<QString> pendingIcons_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_APPLICATION_LIST_MODEL_H_
@@ -22,6 +22,7 @@
 
 #include <QApplication>
 #include <QDrag>
+#include <QFileInfo>
 #include <QFont>
 #include <QMimeData>
 #include <QSettings>
@@ -35,6 +36,7 @@
 #include "program.h"
 #include <utils/draw_utils.h>
 #include <utils/menu_utils.h>
+#include <utils/profiler.h>
 
 namespace crystaldock {
 
@@ -59,50 +61,30 @@ ApplicationMenu::ApplicationMenu(
   menu_.setStyleSheet(getStyleSheet());
 
   loadConfig();
-  buildMenu();
-
-  createContextMenu();
+  // The menu is built in completeInit(), after the dock has been shown.
 
   connect(&menu_, &QMenu::aboutToHide, this,
           [this]() {
             showingMenu_ = false;
             parent_->setShowingPopup(false);
-            parent_->update();
+            parent_->updateItem(this);
           });
   connect(&contextMenu_, &QMenu::aboutToHide, this,
           [this]() {
             parent_->setShowingPopup(false);
           });
-  connect(model_, SIGNAL(applicationMenuConfigChanged()),
-          this, SLOT(reloadMenu()));
+  connect(model_, &MultiDockModel::applicationMenuEntriesChanged,
+          this, &ApplicationMenu::onEntriesChanged);
 }
 
-void ApplicationMenu::draw(QPainter* painter) const {
+void ApplicationMenu::draw(QPainter* painter, const DrawContext& context) const {
+  PROFILE_SCOPE("ApplicationMenu::draw");
   if (showingMenu_) {
     const auto x = left_ + getWidth() / 2;
     const auto y = top_ + getHeight() / 2;
-    if (parent_->isGlass()) {
-      const QColor baseColor = model_->activeIndicatorColor();
-      // Size (width if horizontal, or height if vertical) of the indicator.
-      const auto size = DockPanel::kIndicatorSizeGlass;
-      drawIndicator(orientation_, x, parent_->taskIndicatorPos(),
-                    parent_->taskIndicatorPos(), y,
-                    size, DockPanel::k3DPanelThickness, baseColor, painter);
-    } else if (parent_->isFlat2D()) {
-      const auto baseColor = model_->activeIndicatorColor2D();
-      const auto size = DockPanel::kIndicatorSizeFlat2D;
-      drawIndicatorFlat2D(orientation_, x, parent_->taskIndicatorPos(),
-                          parent_->taskIndicatorPos(), y,
-                          size, baseColor, painter);
-    } else {  // Metal 2D.
-      const auto baseColor = model_->activeIndicatorColorMetal2D();
-      const auto size = DockPanel::kIndicatorSizeMetal2D;
-      drawIndicatorMetal2D(parent_->position(), x, parent_->taskIndicatorPos(),
-                           parent_->taskIndicatorPos(), y,
-                           size, baseColor, painter);
-    }
+    parent_->drawTaskIndicator(x, y, /*active=*/true, context, painter);
   }
-  IconBasedDockItem::draw(painter);
+  IconBasedDockItem::draw(painter, context);
 }
 
 void ApplicationMenu::mousePressEvent(QMouseEvent *e) {
@@ -110,23 +92,89 @@ void ApplicationMenu::mousePressEvent(QMouseEvent *e) {
     parent_->setShowingPopup(true);
     // Acknowledge.
     showingMenu_ = true;
-    parent_->update();
+    parent_->updateItem(this);
 
+    if (menu_.isEmpty()) {
+      buildMenu();
+    }
     resetSearchMenu();
     const int x = parent_->isBottom() && parent_->is3D()
         ? left_ : left_ - parent_->itemSpacing();
     menu_.exec(parent_->mapToGlobal(QPoint(x, top_)));
   } else if (e->button() == Qt::RightButton) {
+    if (contextMenu_.isEmpty()) {
+      createContextMenu();
+    }
     showPopupMenu(&contextMenu_);
   }
 }
 
+void ApplicationMenu::completeInit() {
+  if (menu_.isEmpty()) {
+    buildMenu();
+  }
+}
+
 void ApplicationMenu::reloadMenu() {
   menu_.clear();
   searchMenu_ = nullptr;
+  searchResultActions_.clear();
+  searchResults_.clear();
+  categoryMenus_.clear();
   buildMenu();
 }
 
+void ApplicationMenu::onEntriesChanged(const QStringList& changedAppIds,
+                                       const QStringList& removedAppIds) {
+  if (menu_.isEmpty()) {
+    // Not built yet, will be built from the current entries.
+    return;
+  }
+
+  // Categories that have become empty or non-empty change the menu's structure.
+  std::vector<const Category*> categories;
+  for (const auto* list : {&model_->applicationMenuCategories(),
+                           &model_->applicationMenuSystemCategories()}) {
+    for (const auto& category : *list) {
+      if (isOnMenu(category)) {
+        categories.push_back(&category);
+      }
+    }
+  }
+  if (categories.size() != categoryMenus_.size() ||
+      !std::equal(categories.begin(), categories.end(), categoryMenus_.begin(),
+                  [](const Category* category, const auto& categoryMenu) {
+                    return category == categoryMenu.first;
+                  })) {
+    reloadMenu();
+    return;
+  }
+
+  // Otherwise only the populated sub-menus that have or had any of the entries are cleared,
+  // to be populated again on next show.
+  const auto changed = [&changedAppIds, &removedAppIds](const QString& appId) {
+    return changedAppIds.contains(appId) || removedAppIds.contains(appId);
+  };
+  for (const auto& [category, menu] : categoryMenus_) {
+    const auto actions = menu->actions();
+    if (actions.isEmpty()) {
+      continue;
+    }
+    if (std::ranges::any_of(actions, [&changed](const QAction* action) {
+          return changed(QFileInfo(action->data().toString()).completeBaseName().toLower());
+        }) || std::ranges::any_of(category->entries(), [&changed](const auto& entry) {
+          return changed(entry.appId);
+        })) {
+      menu->clear();
+    }
+  }
+
+  // The search results are copies of the old entries.
+  searchResults_.clear();
+  lastSearchText_.clear();
+  updateSearchResultActions();
+}
+
 void ApplicationMenu::searchApps(const QString& searchText_) {
   if (searchMenu_ == nullptr) {
     return;
@@ -138,19 +186,15 @@ void ApplicationMenu::searchApps(const QString& searchText_) {
     return;
   }
 
-  const auto actions = searchMenu_->actions();
-  for (int i = 1; i < actions.size(); ++i) {
-    searchMenu_->removeAction(actions[i]);
+  if (text == lastSearchText_) {
+    return;
   }
+  lastSearchText_ = text;
 
   // We need to limit max number of results to avoid the sub-menu being pushed up too much.
-  for (const auto& entry : model_->searchApplications(text, maxNumResults_)) {
-    addEntry(entry, searchMenu_);
-  }
-  if (parent_->isBottom()) {
-    // Work-around for sub-menu alignment issue on Wayland.
-    patchMenu(maxNumResults_ + 1, model_->applicationMenuIconSize(), searchMenu_);
-  }
+  searchResults_ = model_->searchApplications(text, maxNumResults_);
+  std::erase_if(searchResults_, [](const ApplicationEntry& entry) { return entry.hidden; });
+  updateSearchResultActions();
 }
 
 bool ApplicationMenu::eventFilter(QObject* object, QEvent* event) {
@@ -217,12 +261,23 @@ QMenu::separator { \
 "}";
 }
 
+void ApplicationMenu::addMemoryUsage(RuntimeMetrics::DockMemory* memory) const {
+  IconBasedDockItem::addMemoryUsage(memory);
+  memory->menuActions += countMenuActions(menu_) + countMenuActions(contextMenu_);
+}
+
 void ApplicationMenu::loadConfig() {
   setLabel(model_->applicationMenuName());
-  font_ = menu_.font();
-  font_.setPointSize(model_->applicationMenuFontSize());
-  font_.setBold(true);
+  QFont font = menu_.font();
+  font.setPointSize(model_->applicationMenuFontSize());
+  font.setBold(true);
+  const bool fontChanged = font != font_;
+  font_ = font;
   menu_.setFont(font_);
+  // The submenus got the font when they were built.
+  if (fontChanged && !menu_.isEmpty()) {
+    reloadMenu();
+  }
 }
 
 void ApplicationMenu::buildMenu() {
@@ -231,15 +286,8 @@ void ApplicationMenu::buildMenu() {
   addToMenu(model_->applicationMenuCategories());
   menu_.addSeparator();
   addToMenu(model_->applicationMenuSystemCategories());
-  const auto numSubMenus = menu_.actions().size();
-  for (int i = 0; i < numSubMenus; ++i) {
-    QMenu* menu = menu_.actions()[i]->menu();
-    if (menu != nullptr && parent_->isBottom()) {
-      // Work-around for sub-menu alignment issue on Wayland.
-      patchMenu(numSubMenus - i, model_->applicationMenuIconSize(), menu);
-    }
-  }
   maxNumResults_ = menu_.actions().size() - 2;
+  createSearchResultActions();
 }
 
 void ApplicationMenu::addSearchMenu() {
@@ -259,9 +307,14 @@ void ApplicationMenu::addSearchMenu() {
           this, SLOT(searchApps(const QString&)));
 }
 
+/* static */ bool ApplicationMenu::isOnMenu(const Category& category) {
+  return category.name != ApplicationMenuConfig::kUncategorized &&
+      !category.entryIndices.empty();
+}
+
 void ApplicationMenu::addToMenu(const std::vector<Category>& categories) {
   for (const auto& category : categories) {
-    if (category.name == ApplicationMenuConfig::kUncategorized || category.entries.empty()) {
+    if (!isOnMenu(category)) {
       continue;
     }
 
@@ -270,9 +323,26 @@ void ApplicationMenu::addToMenu(const std::vector<Category>& categories) {
     menu->setStyle(&style_);
     menu->setFont(font_);
     menu->installEventFilter(this);
-    for (const auto& entry : category.entries) {
-      addEntry(entry, menu);
-    }
+    categoryMenus_.push_back({&category, menu});
+    // Most categories are never opened, so their entries are only added on first show.
+    // The categories outlive the menu, and their entries are only read when shown.
+    connect(menu, &QMenu::aboutToShow, this, [this, menu, &category]() {
+      if (menu->actions().isEmpty()) {
+        populateMenu(category, menu);
+      }
+    });
+  }
+}
+
+void ApplicationMenu::populateMenu(const Category& category, QMenu* menu) {
+  for (const auto& entry : category.entries()) {
+    addEntry(entry, menu);
+  }
+  if (parent_->isBottom()) {
+    // Work-around for sub-menu alignment issue on Wayland.
+    const auto actions = menu_.actions();
+    patchMenu(actions.size() - actions.indexOf(menu->menuAction()),
+              model_->applicationMenuIconSize(), menu);
   }
 }
 
@@ -283,26 +353,74 @@ void ApplicationMenu::addEntry(const ApplicationEntry &entry, QMenu *menu) {
 
   QAction* action = menu->addAction(loadIcon(entry.icon), entry.name, this,
                   [entry]() {
-                    Program::launch(entry.command);
+                    Program::launch(entry.command, entry.appId);
                   });
   action->setData(entry.desktopFile);
 }
 
+void ApplicationMenu::createSearchResultActions() {
+  const int iconSize = model_->applicationMenuIconSize();
+  QPixmap pix(iconSize, iconSize);
+  pix.fill(QColorConstants::Transparent);
+  blankIcon_ = QIcon(pix);
+
+  for (unsigned int i = 0; i < maxNumResults_; ++i) {
+    QAction* action = searchMenu_->addAction(blankIcon_, "", this, [this, i]() {
+      if (i < searchResults_.size()) {
+        Program::launch(searchResults_[i].command, searchResults_[i].appId);
+      }
+    });
+    searchResultActions_.push_back(action);
+  }
+  updateSearchResultActions();
+}
+
+void ApplicationMenu::updateSearchResultActions() {
+  // Work-around for sub-menu alignment issue on Wayland: keeps the unused actions as blank
+  // items instead of hiding them.
+  const bool keepBlankItems = parent_->isBottom();
+  for (size_t i = 0; i < searchResultActions_.size(); ++i) {
+    QAction* action = searchResultActions_[i];
+    if (i < searchResults_.size()) {
+      const auto& entry = searchResults_[i];
+      if (action->data().toString() != entry.desktopFile) {
+        action->setText(entry.name);
+        action->setIcon(loadIcon(entry.icon));
+        action->setData(entry.desktopFile);
+      }
+      action->setEnabled(true);
+      action->setVisible(true);
+    } else if (!action->data().isNull() || action->isVisible() != keepBlankItems) {
+      action->setText("");
+      action->setIcon(blankIcon_);
+      action->setData(QVariant());
+      action->setEnabled(false);
+      action->setVisible(keepBlankItems);
+    }
+  }
+}
+
 void ApplicationMenu::resetSearchMenu() {
   searchText_->clear();
   searchText_->setFocus();
-  const auto actions = searchMenu_->actions();
-  for (int i = 1; i < actions.size(); ++i) {
-    searchMenu_->removeAction(actions[i]);
-  }
-  if (parent_->isBottom()) {
-    // Work-around for sub-menu alignment issue on Wayland.
-    patchMenu(maxNumResults_ + 1, model_->applicationMenuIconSize(), searchMenu_);
+  lastSearchText_.clear();
+  searchResults_.clear();
+  updateSearchResultActions();
+}
+
+/* static */ QIcon ApplicationMenu::loadIcon(const QString &icon) {
+  auto& cache = iconCache();
+  const std::string key = icon.toStdString();
+  auto it = cache.find(key);
+  if (it == cache.end()) {
+    it = cache.emplace(key, QIcon::fromTheme(icon)).first;
   }
+  return it->second;
 }
 
-QIcon ApplicationMenu::loadIcon(const QString &icon) {
-  return QIcon::fromTheme(icon);
+/* static */ std::unordered_map<std::string, QIcon>& ApplicationMenu::iconCache() {
+  static std::unordered_map<std::string, QIcon> cache;
+  return cache;
 }
 
 void ApplicationMenu::createContextMenu() {
@@ -21,8 +21,15 @@
 
 #include "icon_based_dock_item.h"
 
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <QAction>
 #include <QEvent>
 #include <QFont>
+#include <QIcon>
 #include <QLineEdit>
 #include <QMenu>
 #include <QMouseEvent>
@@ -30,6 +37,7 @@
 #include <QProxyStyle>
 #include <QSize>
 #include <QString>
+#include <QStringList>
 
 #include <model/application_menu_config.h>
 
@@ -69,10 +77,14 @@ class ApplicationMenu : public QObject, public IconBasedDockItem {
       int maxSize);
   virtual ~ApplicationMenu() = default;
 
-  void draw(QPainter* painter) const override;
+  void draw(QPainter* painter, const DrawContext& context) const override;
   void mousePressEvent(QMouseEvent* e) override;
   void loadConfig() override;
 
+  void addMemoryUsage(RuntimeMetrics::DockMemory* memory) const override;
+
+  void completeInit() override;
+
   QSize getMenuSize() { return menu_.sizeHint(); }
 
  public slots:
@@ -80,6 +92,10 @@ class ApplicationMenu : public QObject, public IconBasedDockItem {
 
   void searchApps(const QString& searchText);
 
+  // Updates the menu for the entries that have changed, rebuilding it only if any
+  // category has been added to or removed from it.
+  void onEntriesChanged(const QStringList& changedAppIds, const QStringList& removedAppIds);
+
  protected:
   // To support drag applications from the sub-menu to Edit Launchers dialog.
   bool eventFilter(QObject* object, QEvent* event) override;
@@ -87,13 +103,24 @@ class ApplicationMenu : public QObject, public IconBasedDockItem {
  private:
   QString getStyleSheet();
 
-  QIcon loadIcon(const QString& icon);
+  // Loads the themed icon, cached across all application menus.
+  static QIcon loadIcon(const QString& icon);
+  static std::unordered_map<std::string, QIcon>& iconCache();
 
   // Builds the menu from the application entries;
   void buildMenu();
   void addSearchMenu();
+  // Whether the category has a sub-menu.
+  static bool isOnMenu(const Category& category);
   void addToMenu(const std::vector<Category>& categories);
   void addEntry(const ApplicationEntry& entry, QMenu* menu);
+  // Adds the entries of the category to its sub-menu.
+  void populateMenu(const Category& category, QMenu* menu);
+
+  // Creates the reusable actions for the search results.
+  void createSearchResultActions();
+  // Shows the current search results in the result actions, updating them in place.
+  void updateSearchResultActions();
 
   void resetSearchMenu();
 
@@ -113,11 +140,21 @@ class ApplicationMenu : public QObject, public IconBasedDockItem {
   // The desktop file associated with the application entry being dragged.
   QString draggedEntry_;
 
-  QMenu* searchMenu_;
-  QLineEdit* searchText_;
-  unsigned int maxNumResults_;
-
-  // Context (right-click) menu.
+  // Null until the menu is built.
+  QMenu* searchMenu_ = nullptr;
+  // The category sub-menus, in menu order.
+  std::vector<std::pair<const Category*, QMenu*>> categoryMenus_;
+  QLineEdit* searchText_ = nullptr;
+  unsigned int maxNumResults_ = 0;
+  // The last search text, to skip searching again when it hasn't changed.
+  QString lastSearchText_;
+  std::vector<ApplicationEntry> searchResults_;
+  // A fixed pool of maxNumResults_ actions for the search results. The unused ones are
+  // blank, so that the sub-menu keeps its size (see patchMenu()), or hidden.
+  std::vector<QAction*> searchResultActions_;
+  QIcon blankIcon_;
+
+  // Context (right-click) menu, created on first use.
   QMenu contextMenu_;
 };
 
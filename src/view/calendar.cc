@@ -18,12 +18,24 @@
 
 #include "calendar.h"
 
+#include <QCoreApplication>
 #include <QDate>
 
 namespace crystaldock {
 
-Calendar::Calendar(QWidget* parent)
-    : QDialog(parent),
+/* static */ Calendar* Calendar::self() {
+  static Calendar* calendar = nullptr;
+  if (!calendar) {
+    calendar = new Calendar();
+    // A widget mustn't outlive the application, unlike a static.
+    QObject::connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit,
+                     [] { delete calendar; calendar = nullptr; });
+  }
+  return calendar;
+}
+
+Calendar::Calendar()
+    : QDialog(nullptr),
       calendar_(this) {
   setWindowFlag(Qt::Tool);
   setWindowTitle("Calendar");
@@ -31,11 +43,12 @@ Calendar::Calendar(QWidget* parent)
   resize(calendar_.sizeHint());
 }
 
-void Calendar::showCalendar() {
-  calendar_.setSelectedDate(QDate::currentDate());
-  show();
-  raise();
-  activateWindow();
+/* static */ void Calendar::showCalendar() {
+  Calendar* calendar = self();
+  calendar->calendar_.setSelectedDate(QDate::currentDate());
+  calendar->show();
+  calendar->raise();
+  calendar->activateWindow();
 }
 
 }  // namespace crystaldock
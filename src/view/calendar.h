@@ -25,16 +25,21 @@
 namespace crystaldock {
 
 // A calendar widget. This is shown when the user clicks on the clock.
+//
+// There is only one, shared by the clocks of all docks and created when first shown, since
+// most users never open it and the clocks are recreated on every reload.
 class Calendar : public QDialog {
  public:
-  Calendar(QWidget* parent);
-
   // Toggles showing the calendar.
   //
   // This also resets the selected date to the current date.
-  void showCalendar();
+  static void showCalendar();
 
  private:
+  Calendar();
+
+  static Calendar* self();
+
   QCalendarWidget calendar_;
 };
 
@@ -18,16 +18,22 @@
 
 #include "clock.h"
 
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+
 #include <QColor>
 #include <QDate>
 #include <QFont>
 #include <QIcon>
+#include <QPainter>
 #include <QTime>
-#include <QTimer>
 
 #include "dock_panel.h"
 #include <utils/draw_utils.h>
 #include <utils/font_utils.h>
+#include <utils/menu_utils.h>
+#include <utils/profiler.h>
 
 namespace crystaldock {
 
@@ -38,14 +44,14 @@ Clock::Clock(DockPanel* parent, MultiDockModel* model,
              Qt::Orientation orientation, int minSize, int maxSize)
     : IconlessDockItem(parent, model, "" /* label */, orientation, minSize, maxSize,
                        kWhRatio),
-      calendar_(parent),
       fontFamilyGroup_(this) {
-  createMenu();
-  loadConfig();
 
-  QTimer* timer = new QTimer(this);
-  connect(timer, SIGNAL(timeout()), this, SLOT(updateTime()));
-  timer->start(1000);  // update the time every second.
+  tickTask_ = Scheduler::self()->addPeriodic(
+      parent_, timeFormat().contains('s') ? 1000 : 60000, [this]() { updateTime(); });
+
+  timeZoneWatcher_.addPath(kLocalTimeFile);
+  connect(&timeZoneWatcher_, &QFileSystemWatcher::fileChanged,
+          this, &Clock::onTimeZoneChanged);
 
   connect(&menu_, &QMenu::aboutToHide, this,
           [this]() {
@@ -53,35 +59,94 @@ Clock::Clock(DockPanel* parent, MultiDockModel* model,
           });
 }
 
-void Clock::draw(QPainter *painter) const {
-  const QString timeFormat = model_->use24HourClock() ? "hh:mm" : "hh:mm AP";
-  const QString time = QTime::currentTime().toString(timeFormat);
-  // The reference time used to calculate the font size.
-  const QString referenceTime = QTime(8, 8).toString(timeFormat);
+Clock::~Clock() {
+  Scheduler::self()->remove(tickTask_);
+}
 
+void Clock::draw(QPainter* painter, const DrawContext& context) const {
+  PROFILE_SCOPE("Clock::draw");
   const int margin = parent_->isHorizontal() ? getHeight() * 0.1 : 0;
-  const auto x = left_ + margin;
-  const auto y = top_;
-  const auto w = getWidth() - margin;
-  const auto h = getHeight();
-  painter->setFont(adjustFontSize(w, h, referenceTime,
-                                  model_->clockFontScaleFactor(),
-                                  model_->clockFontFamily()));
-  painter->setRenderHint(QPainter::TextAntialiasing);
-  if (size_ > minSize_) {
-    drawBorderedText(x, y , w, h, Qt::AlignCenter, time,
-                     2 /* borderWidth */, Qt::black, Qt::white, painter,
-                     /*simplified=*/ true);
+  painter->drawPixmap(left_ + margin, top_,
+                      getFace(size_, painter->device()->devicePixelRatioF()));
+}
+
+const QPixmap& Clock::getFace(int size, qreal scale) const {
+  validateFaces(scale);
+  for (auto it = faces_.begin(); it != faces_.end(); ++it) {
+    if (it->first == size) {
+      faces_.splice(faces_.begin(), faces_, it);
+      return faces_.front().second;
+    }
+  }
+
+  faces_.emplace_front(size, renderFace(size, scale));
+  const size_t cacheSize = std::max(model_->iconCacheSize(), 1);
+  while (faces_.size() > cacheSize) {
+    faces_.pop_back();
+  }
+  return faces_.front().second;
+}
+
+QPixmap Clock::renderFace(int size, qreal scale) const {
+  PROFILE_SCOPE("Clock::renderFace");
+  // The reference time used to calculate the font size.
+  const QString referenceTime = QTime(8, 8).toString(timeFormat());
+
+  const int h = getHeightForSize(size);
+  const int margin = parent_->isHorizontal() ? h * 0.1 : 0;
+  const int w = getWidthForSize(size) - margin;
+  QPixmap face(std::ceil(w * scale), std::ceil(h * scale));
+  face.setDevicePixelRatio(scale);
+  face.fill(Qt::transparent);
+
+  QPainter painter(&face);
+  painter.setFont(adjustFontSize(w, h, referenceTime,
+                                 model_->clockFontScaleFactor(),
+                                 model_->clockFontFamily()));
+  painter.setRenderHint(QPainter::TextAntialiasing);
+  if (size > minSize_) {
+    drawBorderedText(0, 0, w, h, Qt::AlignCenter, time_,
+                     2 /* borderWidth */, Qt::black, Qt::white, &painter);
   } else {
-    painter->setPen(Qt::white);
-    painter->drawText(x, y, w, h, Qt::AlignCenter, time);
+    painter.setPen(Qt::white);
+    painter.drawText(0, 0, w, h, Qt::AlignCenter, time_);
   }
+  return face;
+}
+
+void Clock::validateFaces(qreal scale) const {
+  if (!time_.isEmpty() && faceUse24HourClock_ == model_->use24HourClock() &&
+      faceFontScaleFactor_ == model_->clockFontScaleFactor() &&
+      faceFontFamily_ == model_->clockFontFamily() && faceScale_ == scale) {
+    return;
+  }
+
+  faceUse24HourClock_ = model_->use24HourClock();
+  faceFontScaleFactor_ = model_->clockFontScaleFactor();
+  faceFontFamily_ = model_->clockFontFamily();
+  faceScale_ = scale;
+  time_ = QTime::currentTime().toString(timeFormat());
+  faces_.clear();
+}
+
+void Clock::trimCaches() {
+  std::erase_if(faces_, [this](const auto& face) { return face.first != minSize_; });
+}
+
+void Clock::addMemoryUsage(RuntimeMetrics::DockMemory* memory) const {
+  for (const auto& face : faces_) {
+    memory->bufferBytes += RuntimeMetrics::bytes(face.second);
+  }
+  memory->menuActions += countMenuActions(menu_);
 }
 
 void Clock::mousePressEvent(QMouseEvent *e) {
   if (e->button() == Qt::LeftButton) {
-    calendar_.showCalendar();
+    Calendar::showCalendar();
   } else if (e->button() == Qt::RightButton) {
+    if (menu_.isEmpty()) {
+      createMenu();
+    }
     // In case other docks have changed the config.
     loadConfig();
     showPopupMenu(&menu_);
@@ -93,7 +158,18 @@ QString Clock::getLabel() const {
 }
 
 void Clock::updateTime() {
-  parent_->update();
+  time_ = QTime::currentTime().toString(timeFormat());
+  faces_.clear();
+  parent_->updateItem(this);
+}
+
+void Clock::onTimeZoneChanged() {
+  // The file is usually replaced rather than modified, which drops the watch.
+  if (!timeZoneWatcher_.files().contains(kLocalTimeFile)) {
+    timeZoneWatcher_.addPath(kLocalTimeFile);
+  }
+  tzset();
+  updateTime();
 }
 
 void Clock::setFontScaleFactor(float fontScaleFactor) {
@@ -159,6 +235,10 @@ void Clock::createMenu() {
 }
 
 void Clock::loadConfig() {
+  // The menu is only created when it is first shown.
+  if (menu_.isEmpty()) {
+    return;
+  }
   use24HourClockAction_->setChecked(model_->use24HourClock());
   setFontScaleFactor(model_->clockFontScaleFactor());
 }
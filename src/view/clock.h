@@ -21,13 +21,19 @@
 
 #include "iconless_dock_item.h"
 
+#include <list>
+#include <utility>
+
 #include <QAction>
 #include <QActionGroup>
+#include <QFileSystemWatcher>
 #include <QMenu>
 #include <QObject>
+#include <QPixmap>
 #include <QString>
 
 #include "calendar.h"
+#include <utils/scheduler.h>
 
 namespace crystaldock {
 
@@ -38,14 +44,18 @@ class Clock : public QObject, public IconlessDockItem {
  public:
   Clock(DockPanel* parent, MultiDockModel* model, Qt::Orientation orientation,
         int minSize, int maxSize);
-  virtual ~Clock() = default;
+  virtual ~Clock();
 
-  void draw(QPainter* painter) const override;
+  void draw(QPainter* painter, const DrawContext& context) const override;
   void mousePressEvent(QMouseEvent* e) override;
   void loadConfig() override;
   QString getLabel() const override;
   bool beforeTask(const QString& program) override { return false; }
 
+  void trimCaches() override;
+  void warmCache(int size) override { getFace(size, parent_->iconScale()); }
+  void addMemoryUsage(RuntimeMetrics::DockMemory* memory) const override;
+
  public slots:
   void updateTime();
 
@@ -57,6 +67,9 @@ class Clock : public QObject, public IconlessDockItem {
  private:
   static constexpr float kWhRatio = 2.9;
   static constexpr float kDelta = 0.01;
+  static constexpr char kLocalTimeFile[] = "/etc/localtime";
+
+  QString timeFormat() const { return model_->use24HourClock() ? "hh:mm" : "hh:mm AP"; }
 
   float fontScaleFactor() {
     return largeFontAction_->isChecked()
@@ -65,14 +78,37 @@ class Clock : public QObject, public IconlessDockItem {
                                          : kSmallClockFontScaleFactor;
   }
 
+  // The clock face at the size, rendered on first use after each tick, so that zoom frames
+  // and other repaints only draw a pixmap.
+  const QPixmap& getFace(int size, qreal scale) const;
+  QPixmap renderFace(int size, qreal scale) const;
+  // Drops the faces and formats the time again if the format or the font has changed.
+  void validateFaces(qreal scale) const;
+
   // Creates the context menu.
   void createMenu();
 
   void saveConfig();
 
-  Calendar calendar_;
+ private slots:
+  void onTimeZoneChanged();
 
-  // Context menu.
+ private:
+  // The time shown, formatted on each tick.
+  mutable QString time_;
+  // What the faces have been rendered with.
+  mutable bool faceUse24HourClock_ = false;
+  mutable float faceFontScaleFactor_ = 0;
+  mutable QString faceFontFamily_;
+  mutable qreal faceScale_ = 0;
+  // The faces by size, most recently used first, at most as many as the icon cache size.
+  mutable std::list<std::pair<int, QPixmap>> faces_;
+
+  // Ticks on minute boundaries, or every second if the time format shows seconds.
+  Scheduler::TaskId tickTask_;
+  QFileSystemWatcher timeZoneWatcher_;
+
+  // Context menu, created on first use.
   QMenu menu_;
 
   QAction* use24HourClockAction_;
@@ -26,6 +26,8 @@
 #include <QIcon>
 #include <QPainter>
 #include <QPixmap>
+#include <QRect>
+#include <QRectF>
 #include <QTimer>
 
 #include "display/window_system.h"
@@ -33,6 +35,9 @@
 #include "dock_panel.h"
 #include <utils/draw_utils.h>
 #include <utils/font_utils.h>
+#include <utils/menu_utils.h>
+#include <utils/profiler.h>
+#include <utils/thumbnail_loader.h>
 
 namespace crystaldock {
 
@@ -41,13 +46,12 @@ DesktopSelector::DesktopSelector(DockPanel* parent, MultiDockModel* model,
                                  int maxSize, const VirtualDesktopInfo& desktop, int screen)
     : IconBasedDockItem(parent, model, QString::fromStdString(desktop.name),
           orientation, "" /* no icon yet */, minSize, maxSize),
-      desktopEnv_(DesktopEnv::getDesktopEnv()),
+      desktopEnv_(model->desktopEnv()),
       desktop_(desktop),
       screen_(screen),
       desktopWidth_(parent->screenGeometry().width()),
       desktopHeight_(parent->screenGeometry().height()),
       hasCustomWallpaper_(false) {
-  createMenu();
   loadConfig();
   connect(WindowSystem::self(), SIGNAL(desktopNameChanged(std::string_view, std::string_view)),
           this, SLOT(onDesktopNameChanged(std::string_view, std::string_view)));
@@ -55,11 +59,35 @@ DesktopSelector::DesktopSelector(DockPanel* parent, MultiDockModel* model,
           [this]() {
             parent_->setShowingPopup(false);
           });
+
+  const auto onWindowChanged = [this](const WindowInfo* info) {
+    if (affectsWindows(info->window, info)) {
+      invalidateWindows();
+    }
+  };
+  const auto onWindowGone = [this](void* window) {
+    if (affectsWindows(window, nullptr)) {
+      invalidateWindows();
+    }
+  };
+  connect(WindowSystem::self(), &WindowSystem::windowAdded, this, onWindowChanged);
+  connect(WindowSystem::self(), &WindowSystem::windowGeometryChanged, this, onWindowChanged);
+  connect(WindowSystem::self(), &WindowSystem::windowStateChanged, this, onWindowChanged);
+  // Both the cell of the desktop it has left and that of the one it has entered.
+  connect(WindowSystem::self(), &WindowSystem::windowDesktopChanged, this, onWindowChanged);
+  connect(WindowSystem::self(), &WindowSystem::windowRemoved, this, onWindowGone);
+  // The active window is raised and highlighted.
+  connect(WindowSystem::self(), &WindowSystem::activeWindowChanged, this, [this](void* window) {
+    if (layerActiveWindow_ != nullptr || affectsWindows(window, nullptr)) {
+      invalidateWindows();
+    }
+  });
 }
 
-void DesktopSelector::draw(QPainter* painter) const {
+void DesktopSelector::draw(QPainter* painter, const DrawContext& context) const {
+  PROFILE_SCOPE("DesktopSelector::draw");
   if (hasCustomWallpaper_) {
-    IconBasedDockItem::draw(painter);
+    IconBasedDockItem::draw(painter, context);
   } else {
     // Draw rectangles with desktop numbers if no custom wallpapers set.
     QColor fillColor = model_->backgroundColor().lighter();
@@ -67,6 +95,10 @@ void DesktopSelector::draw(QPainter* painter) const {
     painter->fillRect(left_, top_, getWidth(), getHeight(), QBrush(fillColor));
   }
 
+  if (model_->showPagerWindows()) {
+    drawWindows(painter);
+  }
+
   if (model_->showDesktopNumber()) {
     painter->setFont(adjustFontSize(getWidth(), getHeight(),
                                     "0" /* reference string */,
@@ -92,36 +124,58 @@ void DesktopSelector::mousePressEvent(QMouseEvent* e) {
       WindowSystem::setCurrentDesktop(desktop_.id);
     }
   } else if (e->button() == Qt::RightButton) {
+    if (menu_.isEmpty()) {
+      createMenu();
+    }
     // In case other DesktopSelectors have changed the config.
     showDesktopNumberAction_->setChecked(model_->showDesktopNumber());
     showPopupMenu(&menu_);
   }
 }
 
+void DesktopSelector::trimCaches() {
+  IconBasedDockItem::trimCaches();
+  windowsLayer_ = QPixmap();
+  isWindowsLayerValid_ = false;
+}
+
+void DesktopSelector::addMemoryUsage(RuntimeMetrics::DockMemory* memory) const {
+  RuntimeMetrics::DockMemory icons;
+  IconBasedDockItem::addMemoryUsage(&icons);
+  memory->thumbnailBytes += icons.iconBytes + RuntimeMetrics::bytes(windowsLayer_);
+  memory->menuActions += countMenuActions(menu_);
+}
+
 void DesktopSelector::loadConfig() {
   const auto& wallpaper = model_->wallpaper(desktop_.id, screen_);
   if (!wallpaper.isEmpty() && QFile::exists(wallpaper)) {
-    setIconScaled(QPixmap(wallpaper));
-    hasCustomWallpaper_ = true;
+    // Decoded at the largest size the pager shows.
+    const QSize size(getWidthForSize(maxSize_), getHeightForSize(maxSize_));
+    ThumbnailLoader::loadAsync(wallpaper, size, this, [this](const QPixmap& thumbnail) {
+      if (thumbnail.isNull()) {
+        return;
+      }
+      setIcon(thumbnail);
+      hasCustomWallpaper_ = true;
+      parent_->updateItem(this);
+    });
+  } else if (hasCustomWallpaper_) {
+    hasCustomWallpaper_ = false;
+    parent_->updateItem(this);
   }
 
-  showDesktopNumberAction_->setChecked(model_->showDesktopNumber());
+  if (showDesktopNumberAction_ != nullptr) {
+    showDesktopNumberAction_->setChecked(model_->showDesktopNumber());
+    showWindowsAction_->setChecked(model_->showPagerWindows());
+  }
 }
 
 void DesktopSelector::saveConfig() {
   model_->setShowDesktopNumber(showDesktopNumberAction_->isChecked());
+  model_->setShowPagerWindows(showWindowsAction_->isChecked());
   model_->saveAppearanceConfig(true /* repaintOnly */);
 }
 
-void DesktopSelector::setIconScaled(const QPixmap& icon) {
-  if (icon.width() * desktopHeight_ != icon.height() * desktopWidth_) {
-    QPixmap scaledIcon = icon.scaled(desktopWidth_, desktopHeight_);
-    setIcon(scaledIcon);
-  } else {
-    setIcon(icon);
-  }
-}
-
 void DesktopSelector::onDesktopNameChanged(
     std::string_view desktopId, std::string_view desktopName) {
   if (desktop_.id == desktopId) {
@@ -129,6 +183,90 @@ void DesktopSelector::onDesktopNameChanged(
   }
 }
 
+void DesktopSelector::drawWindows(QPainter* painter) const {
+  const qreal dpr = painter->device()->devicePixelRatioF();
+  if (!isWindowsLayerValid_ || windowsLayer_.devicePixelRatio() != dpr) {
+    rebuildWindowsLayer(dpr);
+  }
+  if (!layerWindows_.empty()) {
+    painter->save();
+    painter->setRenderHint(QPainter::SmoothPixmapTransform);
+    painter->drawPixmap(QRect(left_, top_, getWidth(), getHeight()), windowsLayer_);
+    painter->restore();
+  }
+}
+
+void DesktopSelector::rebuildWindowsLayer(qreal devicePixelRatio) const {
+  PROFILE_SCOPE("DesktopSelector::rebuildWindowsLayer");
+  isWindowsLayerValid_ = true;
+  layerWindows_.clear();
+  layerActiveWindow_ = nullptr;
+  const int width = getWidthForSize(maxSize_);
+  const int height = getHeightForSize(maxSize_);
+  if (windowsLayer_.size() != QSize(width, height) * devicePixelRatio) {
+    windowsLayer_ = QPixmap(QSize(width, height) * devicePixelRatio);
+    windowsLayer_.setDevicePixelRatio(devicePixelRatio);
+  }
+  windowsLayer_.fill(Qt::transparent);
+
+  const QRect screen = parent_->screenGeometry();
+  if (screen.isEmpty()) {
+    return;
+  }
+  const qreal scaleX = static_cast<qreal>(width) / screen.width();
+  const qreal scaleY = static_cast<qreal>(height) / screen.height();
+  QColor fillColor = model_->backgroundColor().lighter();
+  fillColor.setAlphaF(0.6);
+  QColor activeFillColor = fillColor.lighter();
+  QPainter painter(&windowsLayer_);
+  painter.setPen(model_->borderColor());
+
+  // Windows are in mapping order, which approximates the stacking order. The active
+  // window is drawn last, on top.
+  const WindowInfo* active = nullptr;
+  const auto drawWindow = [&](const WindowInfo* info, const QColor& color) {
+    const QRect geometry = QRect(info->x, info->y, info->width, info->height)
+        .intersected(screen).translated(-screen.topLeft());
+    const QRectF miniature(geometry.x() * scaleX, geometry.y() * scaleY,
+                           geometry.width() * scaleX, geometry.height() * scaleY);
+    painter.fillRect(miniature, color);
+    painter.drawRect(miniature);
+  };
+  for (const auto* info : WindowSystem::windows()) {
+    if (!affectsWindows(info->window, info) || info->minimized || info->skipTaskbar ||
+        !QRect(info->x, info->y, info->width, info->height).intersects(screen)) {
+      continue;
+    }
+    layerWindows_.insert(info->window);
+    if (info->window == WindowSystem::activeWindow()) {
+      active = info;
+    } else {
+      drawWindow(info, fillColor);
+    }
+  }
+  if (active != nullptr) {
+    drawWindow(active, activeFillColor);
+    layerActiveWindow_ = active->window;
+  }
+}
+
+bool DesktopSelector::affectsWindows(void* window, const WindowInfo* info) const {
+  if (layerWindows_.contains(window)) {
+    return true;
+  }
+  return info != nullptr && info->initialized &&
+      (info->onAllDesktops || info->desktop == desktop_.id);
+}
+
+void DesktopSelector::invalidateWindows() {
+  if (isWindowsLayerValid_) {
+    isWindowsLayerValid_ = false;
+    if (model_->showPagerWindows()) {
+      parent_->updateItem(this);
+    }
+  }
+}
+
 void DesktopSelector::createMenu() {
   if (desktopEnv_->canSetWallpaper()) {
     menu_.addAction(
@@ -145,6 +283,12 @@ void DesktopSelector::createMenu() {
         saveConfig();
       });
   showDesktopNumberAction_->setCheckable(true);
+  showWindowsAction_ = menu_.addAction(
+      QString("Show Windows"), this,
+      [this] {
+        saveConfig();
+      });
+  showWindowsAction_->setCheckable(true);
 
   menu_.addSeparator();
   parent_->addPanelSettings(&menu_);
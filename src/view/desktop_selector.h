@@ -22,10 +22,12 @@
 #include "icon_based_dock_item.h"
 
 #include <memory>
+#include <unordered_set>
 
 #include <QAction>
 #include <QMenu>
 #include <QObject>
+#include <QPixmap>
 #include <QString>
 
 #include "display/window_system.h"
@@ -53,12 +55,21 @@ class DesktopSelector : public QObject, public IconBasedDockItem {
     return isHorizontal() ? size : (size * desktopHeight_ / desktopWidth_);
   }
 
-  void draw(QPainter* painter) const override;
+  void draw(QPainter* painter, const DrawContext& context) const override;
   void mousePressEvent(QMouseEvent* e) override;
   void loadConfig() override;
 
-  // Sets the icon but scales the pixmap to the screen's width/height ratio.
-  void setIconScaled(const QPixmap& icon);
+  // The window miniatures are drawn again on next use.
+  void trimCaches() override;
+
+  // The icons being the wallpaper, they count as thumbnails.
+  void addMemoryUsage(RuntimeMetrics::DockMemory* memory) const override;
+
+  // Whether this is the selector of the desktop on the screen.
+  bool isFor(const VirtualDesktopInfo& desktop, int screen) const {
+    return desktop_.id == desktop.id && desktop_.number == desktop.number &&
+        desktop_.name == desktop.name && screen_ == screen;
+  }
 
  public slots:
   void onDesktopNameChanged(std::string_view desktopId, std::string_view desktopName);
@@ -72,6 +83,17 @@ class DesktopSelector : public QObject, public IconBasedDockItem {
 
   void saveConfig();
 
+  // Draws the miniatures of the desktop's windows into the cell, rebuilding their layer
+  // first if it's out of date.
+  void drawWindows(QPainter* painter) const;
+  void rebuildWindowsLayer(qreal devicePixelRatio) const;
+
+  // Whether the window is on this desktop, or was when the layer was last built.
+  bool affectsWindows(void* window, const WindowInfo* info) const;
+  // Marks the layer out of date. Repaints are coalesced, so it's rebuilt at most once per
+  // frame.
+  void invalidateWindows();
+
   DesktopEnv* desktopEnv_;
 
   VirtualDesktopInfo desktop_;
@@ -79,15 +101,24 @@ class DesktopSelector : public QObject, public IconBasedDockItem {
   int screen_;
   QSettings* config_;
 
-  // Context (right-click) menu.
+  // Context (right-click) menu, created on first use.
   QMenu menu_;
 
-  QAction* showDesktopNumberAction_;
+  QAction* showDesktopNumberAction_ = nullptr;
 
   int desktopWidth_;
   int desktopHeight_;
 
   bool hasCustomWallpaper_;
+
+  // Window miniatures, at the largest size the pager shows.
+  mutable QPixmap windowsLayer_;
+  mutable bool isWindowsLayerValid_ = false;
+  // The windows in windowsLayer_.
+  mutable std::unordered_set<void*> layerWindows_;
+  // The window highlighted as active in windowsLayer_, if any.
+  mutable void* layerActiveWindow_ = nullptr;
+  QAction* showWindowsAction_ = nullptr;
 };
 
 }  // namespace crystaldock
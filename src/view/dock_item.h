@@ -19,19 +19,38 @@
 #ifndef CRYSTALDOCK_DOCK_ITEM_H_
 #define CRYSTALDOCK_DOCK_ITEM_H_
 
+#include <cmath>
+
 #include <QMenu>
 #include <QMouseEvent>
+#include <QHash>
 #include <QPainter>
 #include <QString>
 #include <Qt>
 
 #include <display/window_system.h>
 #include <model/multi_dock_model.h>
+#include <utils/runtime_metrics.h>
 
 namespace crystaldock {
 
 class DockPanel;
 
+// Per-frame state that the items need for drawing, computed once per paint by the dock
+// rather than by each item.
+struct DrawContext {
+  bool showTaskManager = false;
+  bool groupTasksByApplication = true;
+  bool bouncingLauncherIcon = false;
+  void* activeWindow = nullptr;
+  // Size (width if horizontal, or height if vertical) of a task indicator.
+  int indicatorSize = 0;
+  // Position (y if horizontal, or x if vertical) of the task indicators.
+  int indicatorPos = 0;
+  // Number of adjacent items of each app, only when tasks aren't grouped by application.
+  QHash<QString, int> appItemCounts;
+};
+
 // Base class for all dock items, e.g. launchers and pager icons.
 //
 // It's a design decision that DockItem is not a sub-class of QWidget, to make
@@ -51,7 +70,7 @@ class DockItem {
   virtual int getHeightForSize(int size) const = 0;
 
   // Draws itself on the parent's canvas.
-  virtual void draw(QPainter* painter) const = 0;
+  virtual void draw(QPainter* painter, const DrawContext& context) const = 0;
 
   // Mouse press event handler.
   virtual void mousePressEvent(QMouseEvent* e) = 0;
@@ -69,6 +88,21 @@ class DockItem {
   // has been changed by another dock (not their parent dock).
   virtual void loadConfig() {}
 
+  // Does the set-up that the dock's first frame doesn't need, e.g. building menus or
+  // watching files. Called once the dock has been painted and after each reload, so
+  // it has to be idempotent.
+  virtual void completeInit() {}
+
+  // Frees what the item has cached for drawing at sizes other than its minimum size, e.g.
+  // when it's scrolled out of the dock.
+  virtual void trimCaches() {}
+
+  // Renders ahead of time what drawing at the size needs, e.g. after trimCaches().
+  virtual void warmCache(int size) {}
+
+  // Adds what the item holds in memory.
+  virtual void addMemoryUsage(RuntimeMetrics::DockMemory* memory) const {}
+
   // Handles adding the task, e.g. for a Program dock item.
   virtual bool addTask(const WindowInfo* task) { return false; }
 
@@ -103,8 +137,17 @@ class DockItem {
   // For a Program dock item.
   virtual void setDemandsAttention(bool demandsAttention) {}
 
+  // For a Program dock item. Gets the application's badge and progress again, returning
+  // true if they have changed.
+  virtual bool updateLauncherEntry() { return false; }
+
   bool isHorizontal() const { return orientation_ == Qt::Horizontal; }
 
+  // Whether the item can be reused in a dock with this orientation and icon sizes.
+  bool isReusableFor(Qt::Orientation orientation, int minSize, int maxSize) const {
+    return orientation_ == orientation && minSize_ == minSize && maxSize_ == maxSize;
+  }
+
   void setAnimationStartAsCurrent() {
     startLeft_ = left_;
     startTop_ = top_;
@@ -117,23 +160,23 @@ class DockItem {
     endSize_ = size_;
   }
 
-  void startAnimation(int numSteps) {
+  void startAnimation() {
     left_ = startLeft_;
     top_ = startTop_;
     size_ = startSize_;
-    currentStep_ = 0;
-    numSteps_ = numSteps;
   }
 
-  void nextAnimationStep() {
-    ++currentStep_;
-    if (currentStep_ <= numSteps_) {
-      left_ = startLeft_ + (endLeft_ - startLeft_) * currentStep_ / numSteps_;
-      top_ = startTop_ + (endTop_ - startTop_) * currentStep_ / numSteps_;
-      size_ = startSize_ + (endSize_ - startSize_) * currentStep_ / numSteps_;
-    }
+  // Interpolates between the animation start and end, progress being in [0, 1].
+  void setAnimationProgress(float progress) {
+    left_ = startLeft_ + std::round((endLeft_ - startLeft_) * progress);
+    top_ = startTop_ + std::round((endTop_ - startTop_) * progress);
+    size_ = startSize_ + std::round((endSize_ - startSize_) * progress);
   }
 
+  // Advances the item's own time-based animations (e.g. bouncing) to nowMs, on the dock's
+  // animation clock. Returns true if the item needs another frame.
+  virtual bool updateFrameAnimation(qint64 nowMs) { return false; }
+
   // Gets max width, i.e. the width when the item is max zoomed.
   int getMaxWidth() const {
     return getWidthForSize(maxSize_);
@@ -187,8 +230,6 @@ class DockItem {
   int endLeft_;
   int endTop_;
   int endSize_;
-  int currentStep_;
-  int numSteps_;
 
  private:
   friend class DockPanel;
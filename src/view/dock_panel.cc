@@ -22,6 +22,7 @@
 #include <cmath>
 #include <cstdlib>
 #include <iostream>
+#include <limits>
 #include <utility>
 
 #include <QColor>
@@ -37,7 +38,11 @@
 #include <QMessageBox>
 #include <QMimeData>
 #include <QPainter>
+#include <QPen>
+#include <QPoint>
+#include <QPolygon>
 #include <QProcess>
+#include <QRectF>
 #include <QScreen>
 #include <QSize>
 #include <QStringList>
@@ -54,11 +59,44 @@
 #include "separator.h"
 #include "trash.h"
 #include <display/window_system.h>
+#include <model/launcher_entry_watcher.h>
+#include <model/task_tracker.h>
 #include <utils/draw_utils.h>
+#include <utils/icon_loader.h>
+#include <utils/icon_theme_watcher.h>
 #include <utils/icon_utils.h>
+#include <utils/math_utils.h>
+#include <utils/menu_utils.h>
+#include <utils/profiler.h>
+#include <utils/startup_trace.h>
 
 namespace ranges = std::ranges;
 
+QPointer<AppearanceSettingsDialog> DockPanel::appearanceSettingsDialog_;
+QPointer<ApplicationMenuSettingsDialog> DockPanel::applicationMenuSettingsDialog_;
+QPointer<WallpaperSettingsDialog> DockPanel::wallpaperSettingsDialog_;
+QPointer<TaskManagerSettingsDialog> DockPanel::taskManagerSettingsDialog_;
+
+namespace {
+
+// Creates the dialog on first use. It's deleted when closed, or with its parent dock.
+template <typename Dialog, typename... Args>
+Dialog* getOrCreateDialog(QPointer<Dialog>& dialog, Args&&... args) {
+  if (dialog.isNull()) {
+    dialog = new Dialog(std::forward<Args>(args)...);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+  }
+  return dialog;
+}
+
+void showDialog(QDialog* dialog) {
+  dialog->show();
+  dialog->raise();
+  dialog->activateWindow();
+}
+
+}  // namespace
+
 namespace crystaldock {
 
 DockPanel::DockPanel(MultiDockView* parent, MultiDockModel* model, int dockId)
@@ -70,36 +108,36 @@ DockPanel::DockPanel(MultiDockView* parent, MultiDockModel* model, int dockId)
       showPager_(false),
       showClock_(false),
       showTrash_(false),
-      aboutDialog_(QMessageBox::Information, "About Crystal Dock",
-                   QString("<h3>Crystal Dock 2.15 alpha</h3>")
-                   + "<p>Copyright (C) 2025 Viet Dang (dangvd@gmail.com)"
-                   + "<p><a href=\"https://github.com/dangvd/crystal-dock\">https://github.com/dangvd/crystal-dock</a>"
-                   + "<p>License: GPLv3",
-                   QMessageBox::Ok, this, Qt::Tool),
-      addPanelDialog_(this, model, dockId),
-      appearanceSettingsDialog_(this, model),
-      editLaunchersDialog_(this, model, dockId),
-      applicationMenuSettingsDialog_(this, model),
-      wallpaperSettingsDialog_(this, model),
-      taskManagerSettingsDialog_(this, model),
       isMinimized_(true),
       isHidden_(false),
       isEntering_(false),
       isLeaving_(false),
       isAnimationActive_(false),
-      animationTimer_(std::make_unique<QTimer>(this)) {  
+      animationStartMs_(0),
+      animationEndMs_(0) {
+  TaskTracker::self()->init(model);
   setAttribute(Qt::WA_TranslucentBackground);
   setWindowFlag(Qt::FramelessWindowHint);
   setMouseTracking(true);
   setAcceptDrops(true);
 
-  createMenu();
   loadDockConfig();
   loadAppearanceConfig();
   initUi();
 
-  connect(animationTimer_.get(), SIGNAL(timeout()), this,
-      SLOT(updateAnimation()));
+  animationClock_.start();
+  scheduledUpdatesTimer_.setSingleShot(true);
+  scheduledUpdatesTimer_.setInterval(0);
+  connect(&scheduledUpdatesTimer_, &QTimer::timeout, this, &DockPanel::applyScheduledUpdates);
+  hoverScrollTimer_.setInterval(kHoverScrollIntervalMs);
+  connect(&hoverScrollTimer_, &QTimer::timeout, this, [this] {
+    scrollItems(hoverScrollDirection_);
+  });
+  trimTimer_.setSingleShot(true);
+  trimTimer_.setInterval(kTrimDelayMs);
+  connect(&trimTimer_, &QTimer::timeout, this, &DockPanel::trimCaches);
+  connect(Scheduler::self(), &Scheduler::idleChanged, this, &DockPanel::updateTrimTimer);
+  RuntimeMetrics::setDockMemoryProbe(dockId_, [this] { return memoryUsage(); });
   connect(WindowSystem::self(), SIGNAL(numberOfDesktopsChanged(int)),
       this, SLOT(updatePager()));
   connect(WindowSystem::self(), SIGNAL(currentDesktopChanged(std::string_view)),
@@ -108,8 +146,9 @@ DockPanel::DockPanel(MultiDockView* parent, MultiDockModel* model, int dockId)
           this, SLOT(onWindowStateChanged(const WindowInfo*)));
   connect(WindowSystem::self(), SIGNAL(windowTitleChanged(const WindowInfo*)),
           this, SLOT(onWindowTitleChanged(const WindowInfo*)));
+  activeWindow_ = WindowSystem::activeWindow();
   connect(WindowSystem::self(), SIGNAL(activeWindowChanged(void*)),
-          this, SLOT(onActiveWindowChanged()));
+          this, SLOT(onActiveWindowChanged(void*)));
   connect(WindowSystem::self(), SIGNAL(windowAdded(const WindowInfo*)),
           this, SLOT(onWindowAdded(const WindowInfo*)));
   connect(WindowSystem::self(), SIGNAL(windowRemoved(void*)),
@@ -120,24 +159,65 @@ DockPanel::DockPanel(MultiDockView* parent, MultiDockModel* model, int dockId)
           this, SLOT(onWindowLeftCurrentActivity(void*)));
   connect(WindowSystem::self(), SIGNAL(windowGeometryChanged(const WindowInfo*)),
           this, SLOT(onWindowGeometryChanged(const WindowInfo*)));
+  connect(WindowSystem::self(), &WindowSystem::screenAdded, this, &DockPanel::onScreenAdded);
+  connect(WindowSystem::self(), &WindowSystem::screenRemoved, this, &DockPanel::onScreenRemoved);
   connect(WindowSystem::self(), SIGNAL(currentActivityChanged(std::string_view)),
           this, SLOT(onCurrentActivityChanged()));
-  connect(model_, SIGNAL(appearanceOutdated()), this, SLOT(update()));
+  connect(TaskTracker::self(), &TaskTracker::taskEntered, this, &DockPanel::onTaskEntered);
+  connect(TaskTracker::self(), &TaskTracker::taskLeft, this, &DockPanel::onTaskLeft);
+  connect(TaskTracker::self(), &TaskTracker::taskScreensChanged,
+          this, &DockPanel::onTaskScreensChanged);
+  connect(IconThemeWatcher::self(), &IconThemeWatcher::iconThemeChanged,
+          this, &DockPanel::onIconThemeChanged);
+  connect(LauncherEntryWatcher::self(), &LauncherEntryWatcher::entriesChanged,
+          this, &DockPanel::onLauncherEntriesChanged);
+  connect(model_, SIGNAL(appearanceOutdated()), this, SLOT(updateAppearance()));
+  connect(model_, SIGNAL(appearanceLayoutChanged()), this, SLOT(relayout()));
   connect(model_, SIGNAL(appearanceChanged()), this, SLOT(reload()));
   connect(model_, SIGNAL(dockLaunchersChanged(int)),
           this, SLOT(onDockLaunchersChanged(int)));
+  connect(model_, SIGNAL(dockConfigChanged(int)), this, SLOT(onDockConfigChanged(int)));
+
+  if (Profiler::enabled()) {
+    Scheduler::self()->addPeriodic(this, kProfilerOverlayRefreshMs, [this] {
+      update(profilerOverlayRect());
+    });
+  }
 }
 
 void DockPanel::reload() {
+  const qreal oldIconScale = iconScale_;
   loadAppearanceConfig();
+  // The items' icons are rendered for the output scale, so they can't be reused across
+  // a change of scale.
+  if (iconScale_ == oldIconScale) {
+    reusableItems_ = std::move(items_);
+  }
   items_.clear();
+  taskItems_.clear();
+  isCoveringWindowsValid_ = false;
   initUi();
+  // Destroys the items that haven't been reused.
+  reusableItems_.clear();
+  update();
+}
+
+void DockPanel::relayout() {
+  loadAppearanceConfig();
+  initLayoutVars();
+  updateLayout();
+  setStrut();
+}
+
+void DockPanel::updateAppearance() {
+  loadAppearanceConfig();
   update();
 }
 
 void DockPanel::refresh() {
   for (int i = 0; i < itemCount(); ++i) {
     if (items_[i]->shouldBeRemoved()) {
+      unindexTasks(items_[i].get());
       items_.erase(items_.begin() + i);
       resizeTaskManager();
       return;
@@ -150,12 +230,18 @@ void DockPanel::delayedRefresh() {
 }
 
 void DockPanel::onCurrentDesktopChanged() {
-  reloadTasks();
+  // The tasks are updated by TaskTracker.
+  isCoveringWindowsValid_ = false;
+  if (showPager_) {
+    // For the current desktop's highlight.
+    updateAll();
+  }
   intellihideHideUnhide();
 }
 
 void DockPanel::onCurrentActivityChanged() {
-  reloadTasks();
+  // The tasks are updated by TaskTracker.
+  isCoveringWindowsValid_ = false;
   intellihideHideUnhide();
 }
 
@@ -182,44 +268,228 @@ void DockPanel::togglePager() {
 
 void DockPanel::setScreen(int screen) {
   screen_ = screen;
-  for (int i = 0; i < static_cast<int>(screenActions_.size()); ++i) {
-    screenActions_[i]->setChecked(i == screen);
-  }
   screenGeometry_ = WindowSystem::screens()[screen]->geometry();
+  screenName_ = WindowSystem::screens()[screen]->name();
   screenOutput_ = WindowSystem::getWlOutputForScreen(screen);
   WindowSystem::setScreen(this, screen);
 }
 
+void DockPanel::onScreenAdded(const QString& name) {
+  if (isSuspended_) {
+    if (name == screenName_) {
+      resume(WindowSystem::screenIndex(name));
+    }
+    return;
+  }
+  // The screen's index may have changed.
+  screen_ = WindowSystem::screenIndex(screenName_);
+}
+
+void DockPanel::onScreenRemoved(const QString& name) {
+  if (isSuspended_) {
+    return;
+  }
+  if (name == screenName_) {
+    suspend();
+  } else {
+    screen_ = WindowSystem::screenIndex(screenName_);
+  }
+}
+
+void DockPanel::suspend() {
+  isSuspended_ = true;
+  trimTimer_.stop();
+  trimCaches();
+  tooltip_.hide();
+  Scheduler::self()->setSuspended(this, true);
+  // Hiding destroys the surface. The cached frames are rendered again on resume.
+  hide();
+  minimizedFrame_ = QPixmap();
+  isMinimizedFrameValid_ = false;
+  backgroundLayer_ = QPixmap();
+}
+
+void DockPanel::resume(int screen) {
+  isSuspended_ = false;
+  setScreen(screen);
+  // The screen's geometry may be different.
+  initLayoutVars();
+  updateLayout();
+  setStrut();
+  Scheduler::self()->setSuspended(this, isHidden_);
+  show();
+  updateTrimTimer();
+}
+
+void DockPanel::trimCaches() {
+  for (const auto& item : items_) {
+    item->trimCaches();
+  }
+  minimizedFrame_ = QPixmap();
+  isMinimizedFrameValid_ = false;
+  backgroundLayer_ = QPixmap();
+  reflection_ = QImage();
+  for (auto& sprite : indicatorSprites_) {
+    sprite = QPixmap();
+  }
+  indicatorSpriteKey_ = IndicatorSpriteKey();
+  for (auto& sprite : badgeSprites_) {
+    sprite = QPixmap();
+  }
+  isTrimmed_ = true;
+}
+
+void DockPanel::updateTrimTimer() {
+  const bool isUnseen = isSuspended_ || (isHidden_ && !model_->warmReveal())
+      || Scheduler::self()->isIdle();
+  if (isUnseen) {
+    if (!isTrimmed_ && !trimTimer_.isActive()) {
+      trimTimer_.start();
+    }
+    return;
+  }
+
+  trimTimer_.stop();
+  if (isTrimmed_) {
+    // After the frame that reveals the dock, which only needs the minimum sizes.
+    QTimer::singleShot(0, this, &DockPanel::warmCaches);
+  }
+}
+
+void DockPanel::warmCaches() {
+  // Hidden docks are only warmed up by prepareReveal().
+  if (!isTrimmed_ || isSuspended_ || (isHidden_ && !revealTimer_.isValid())) {
+    return;
+  }
+  isTrimmed_ = false;
+  // The sizes of the items around the mouse when it's on the center of one, which the
+  // first zoom needs.
+  const int distance = minSize_ + itemSpacing_;
+  for (const auto& item : visibleItems()) {
+    for (int i = 0; i <= 2; ++i) {
+      item->warmCache(parabolic(i * distance));
+    }
+  }
+}
+
+void DockPanel::prepareReveal() {
+  revealTimer_.start();
+  trimTimer_.stop();
+  warmCaches();
+}
+
+RuntimeMetrics::DockMemory DockPanel::memoryUsage() const {
+  RuntimeMetrics::DockMemory memory;
+  for (const auto& item : items_) {
+    item->addMemoryUsage(&memory);
+  }
+  memory.bufferBytes += RuntimeMetrics::bytes(minimizedFrame_) +
+      RuntimeMetrics::bytes(backgroundLayer_) + RuntimeMetrics::bytes(reflection_);
+  for (const auto& sprite : indicatorSprites_) {
+    memory.bufferBytes += RuntimeMetrics::bytes(sprite);
+  }
+  for (const auto& sprite : badgeSprites_) {
+    memory.bufferBytes += RuntimeMetrics::bytes(sprite);
+  }
+  memory.menuActions += countMenuActions(menu_);
+  return memory;
+}
+
 void DockPanel::changeScreen(int screen) {
   if (screen_ == screen) {
     return;
   }
   model_->cloneDock(dockId_, position_, screen);
-  deleteLater();
   model_->removeDock(dockId_);
 }
 
-void DockPanel::updateAnimation() {
-  for (const auto& item : items_) {
-    item->nextAnimationStep();
+void DockPanel::requestAnimationFrame() {
+  QWindow* window = windowHandle();
+  if (window == nullptr) {
+    update();
+    return;
+  }
+  if (window != animationWindow_) {
+    window->installEventFilter(this);
+    animationWindow_ = window;
+  }
+  // On Wayland this is delivered on the surface's frame callback, i.e. once per vsync.
+  window->requestUpdate();
+}
+
+bool DockPanel::event(QEvent* e) {
+  if (e->type() == QEvent::DevicePixelRatioChange && devicePixelRatioF() != iconScale_) {
+    // E.g. moved to an output with a different (possibly fractional) scale.
+    QTimer::singleShot(0, this, SLOT(reload()));
+  }
+  return QWidget::event(e);
+}
+
+bool DockPanel::eventFilter(QObject* watched, QEvent* e) {
+  if (watched == animationWindow_ && e->type() == QEvent::UpdateRequest) {
+    if (advanceAnimations()) {
+      animationWindow_->requestUpdate();
+    }
+    // Lets the window repaint the widget.
+  }
+  return QWidget::eventFilter(watched, e);
+}
+
+bool DockPanel::advanceAnimations() {
+  PROFILE_SCOPE("DockPanel::advanceAnimations");
+  applyPendingPointer();
+  const qint64 now = animationClock_.elapsed();
+  bool needsFrame = false;
+  for (const auto& item : visibleItems()) {
+    if (item->updateFrameAnimation(now)) {
+      updateItem(item.get());
+      needsFrame = true;
+    }
+  }
+
+  if (!isAnimationActive_) {
+    return needsFrame;
+  }
+
+  const qint64 durationMs = animationEndMs_ - animationStartMs_;
+  const float progress = (durationMs > 0)
+      ? std::min(1.0f, static_cast<float>(now - animationStartMs_) / durationMs)
+      : 1.0f;
+  // Where the items and the background were and are now.
+  QRect damage = animatedBounds();
+  for (const auto& item : visibleItems()) {
+    item->setAnimationProgress(progress);
   }
-  ++currentAnimationStep_;
   backgroundWidth_ = startBackgroundWidth_
-      + (endBackgroundWidth_ - startBackgroundWidth_)
-          * currentAnimationStep_ / numAnimationSteps_;
+      + std::round((endBackgroundWidth_ - startBackgroundWidth_) * progress);
   backgroundHeight_ = startBackgroundHeight_
-      + (endBackgroundHeight_ - startBackgroundHeight_)
-          * currentAnimationStep_ / numAnimationSteps_;
-  if (currentAnimationStep_ == numAnimationSteps_) {
-    animationTimer_->stop();
-    isAnimationActive_ = false;
-    if (isLeaving_) {
-      isLeaving_ = false;
-      updateLayout();
-      if (isHidden_ && !hasFocus()) { setAutoHide(); }
-    }
+      + std::round((endBackgroundHeight_ - startBackgroundHeight_) * progress);
+  damage |= animatedBounds();
+  if (isMinimized_) {
+    minimizedFrameDamage_ += damage;
+  }
+  update(damage);
+  if (progress < 1.0f) {
+    return true;
+  }
+
+  isAnimationActive_ = false;
+  updateTooltip();
+  if (isLeaving_) {
+    isLeaving_ = false;
+    updateLayout();
+    if (isHidden_ && !hasFocus()) { setAutoHide(); }
+  }
+  return needsFrame;
+}
+
+void DockPanel::applyPendingPointer() {
+  if (!isPointerPending_) {
+    return;
   }
-  repaint();
+
+  isPointerPending_ = false;
+  updateLayout(pendingMouseX_, pendingMouseY_);
 }
 
 void DockPanel::showOnlineDocumentation() {
@@ -228,56 +498,55 @@ void DockPanel::showOnlineDocumentation() {
 }
 
 void DockPanel::about() {
-  aboutDialog_.exec();
+  QMessageBox aboutDialog(QMessageBox::Information, "About Crystal Dock",
+                          QString("<h3>Crystal Dock 2.15 alpha</h3>")
+                          + "<p>Copyright (C) 2025 Viet Dang (dangvd@gmail.com)"
+                          + "<p><a href=\"https://github.com/dangvd/crystal-dock\">https://github.com/dangvd/crystal-dock</a>"
+                          + "<p>License: GPLv3",
+                          QMessageBox::Ok, this, Qt::Tool);
+  aboutDialog.exec();
 }
 
 void DockPanel::showAppearanceSettingsDialog() {
-  appearanceSettingsDialog_.reload();
-  appearanceSettingsDialog_.show();
-  appearanceSettingsDialog_.raise();
-  appearanceSettingsDialog_.activateWindow();
+  auto* dialog = getOrCreateDialog(appearanceSettingsDialog_, this, model_);
+  dialog->reload();
+  showDialog(dialog);
 }
 
 void DockPanel::showEditLaunchersDialog() {
-  editLaunchersDialog_.reload();
-  editLaunchersDialog_.show();
-  editLaunchersDialog_.raise();
-  editLaunchersDialog_.activateWindow();
+  auto* dialog = getOrCreateDialog(editLaunchersDialog_, this, model_, dockId_);
+  dialog->reload();
+  showDialog(dialog);
 }
 
 void DockPanel::showApplicationMenuSettingsDialog() {
-  applicationMenuSettingsDialog_.reload();
-  applicationMenuSettingsDialog_.show();
-  applicationMenuSettingsDialog_.raise();
-  applicationMenuSettingsDialog_.activateWindow();
+  auto* dialog = getOrCreateDialog(applicationMenuSettingsDialog_, this, model_);
+  dialog->reload();
+  showDialog(dialog);
 }
 
 void DockPanel::showWallpaperSettingsDialog(int desktop) {
-  wallpaperSettingsDialog_.setFor(desktop, screen_);
-  wallpaperSettingsDialog_.show();
-  wallpaperSettingsDialog_.raise();
-  wallpaperSettingsDialog_.activateWindow();
+  auto* dialog = getOrCreateDialog(wallpaperSettingsDialog_, this, model_);
+  dialog->setFor(desktop, screen_);
+  showDialog(dialog);
 }
 
 void DockPanel::showTaskManagerSettingsDialog() {
-  taskManagerSettingsDialog_.reload();
-  taskManagerSettingsDialog_.show();
-  taskManagerSettingsDialog_.raise();
-  taskManagerSettingsDialog_.activateWindow();
+  auto* dialog = getOrCreateDialog(taskManagerSettingsDialog_, this, model_);
+  dialog->reload();
+  showDialog(dialog);
 }
 
 void DockPanel::addDock() {
-  addPanelDialog_.setMode(AddPanelDialog::Mode::Add);
-  addPanelDialog_.show();
-  addPanelDialog_.raise();
-  addPanelDialog_.activateWindow();
+  auto* dialog = getOrCreateDialog(addPanelDialog_, this, model_, dockId_);
+  dialog->setMode(AddPanelDialog::Mode::Add);
+  showDialog(dialog);
 }
 
 void DockPanel::cloneDock() {
-  addPanelDialog_.setMode(AddPanelDialog::Mode::Clone);
-  addPanelDialog_.show();
-  addPanelDialog_.raise();
-  addPanelDialog_.activateWindow();
+  auto* dialog = getOrCreateDialog(addPanelDialog_, this, model_, dockId_);
+  dialog->setMode(AddPanelDialog::Mode::Clone);
+  showDialog(dialog);
 }
 
 void DockPanel::removeDock() {
@@ -293,111 +562,226 @@ void DockPanel::removeDock() {
                        "Do you really want to remove this panel?",
                        QMessageBox::Yes | QMessageBox::No, this, Qt::Tool);
   if (question.exec() == QMessageBox::Yes) {
-    deleteLater();
     model_->removeDock(dockId_);
   }
 }
 
 void DockPanel::onWindowAdded(const WindowInfo* info) {
-  intellihideHideUnhide();
+  PROFILE_SCOPE("DockPanel::onWindowAdded");
+  if (updateCoveringWindow(info->window, info)) { scheduleIntellihideHideUnhide(); }
   if (autoHide() && !isHidden_) { setAutoHide(); }
-
-  if (!showTaskManager()) {
-    return;
-  }
-
-  if (isValidTask(info)) {
-    if (addTask(info)) {
-      resizeTaskManager();
-    } else {
-      update();
-    }
-  }
 }
 
 void DockPanel::onWindowRemoved(void* window) {
-  intellihideHideUnhide(window);
-
-  if (!showTaskManager()) {
-    return;
-  }
-
-  removeTask(window);
-
-  if (isEmpty()) {
-    intellihideHideUnhide();
+  PROFILE_SCOPE("DockPanel::onWindowRemoved");
+  // The task itself has been removed by onTaskLeft().
+  if (updateCoveringWindow(window, nullptr) || isEmpty()) {
+    scheduleIntellihideHideUnhide();
   }
 }
 
 void DockPanel::onWindowLeftCurrentDesktop(void* window) {
-  if (showTaskManager() && model_->currentDesktopTasksOnly()) {
-    removeTask(window);
-  }
+  PROFILE_SCOPE("DockPanel::onWindowLeftCurrentDesktop");
+  if (updateCoveringWindow(window, nullptr)) { scheduleIntellihideHideUnhide(); }
 }
 
 void DockPanel::onWindowLeftCurrentActivity(void* window) {
-  if (showTaskManager()) {
-    removeTask(window);
-  }
+  PROFILE_SCOPE("DockPanel::onWindowLeftCurrentActivity");
+  if (updateCoveringWindow(window, nullptr)) { scheduleIntellihideHideUnhide(); }
 }
 
 void DockPanel::onWindowGeometryChanged(const WindowInfo* task) {
-  intellihideHideUnhide();
+  PROFILE_SCOPE("DockPanel::onWindowGeometryChanged");
+  if (updateCoveringWindow(task->window, task)) { scheduleIntellihideHideUnhide(); }
+}
 
-  if (!showTaskManager()) {
+void DockPanel::onTaskEntered(const WindowInfo* task, TaskTracker::ScreenMask screens) {
+  PROFILE_SCOPE("DockPanel::onTaskEntered");
+  if (!showTaskManager() || !TaskTracker::isOnScreen(screens, taskScreen())) {
     return;
   }
 
-  if (!model_->currentScreenTasksOnly()) {
-    return;
+  if (addTask(task)) {
+    scheduleRelayout();
+  } else {
+    updateAll();
   }
+}
 
-  QRect windowGeometry(task->x, task->y, task->width, task->height);
-  if (hasTask(task->window)) {
-    if (!windowGeometry.intersects(screenGeometry_)) {
-      removeTask(task->window);
-    }
-  } else {
-    if (windowGeometry.intersects(screenGeometry_) && isValidTask(task)) {
-      if (addTask(task)) {
-        resizeTaskManager();
-      }
-    }
+void DockPanel::onTaskLeft(void* window) {
+  PROFILE_SCOPE("DockPanel::onTaskLeft");
+  if (showTaskManager()) {
+    removeTask(window);
   }
 }
 
+void DockPanel::onTaskScreensChanged(const WindowInfo* task, TaskTracker::ScreenMask oldScreens,
+                                     TaskTracker::ScreenMask newScreens) {
+  PROFILE_SCOPE("DockPanel::onTaskScreensChanged");
+  const int screen = taskScreen();
+  if (!showTaskManager() || screen < 0) {
+    return;
+  }
+
+  const bool wasOnScreen = TaskTracker::isOnScreen(oldScreens, screen);
+  const bool isOnScreen = TaskTracker::isOnScreen(newScreens, screen);
+  if (wasOnScreen && !isOnScreen) {
+    removeTask(task->window);
+  } else if (!wasOnScreen && isOnScreen && addTask(task)) {
+    scheduleRelayout();
+  }
+}
 
 void DockPanel::onWindowStateChanged(const WindowInfo *task) {
-  intellihideHideUnhide();
+  PROFILE_SCOPE("DockPanel::onWindowStateChanged");
+  if (updateCoveringWindow(task->window, task)) { scheduleIntellihideHideUnhide(); }
 
   if (!showTaskManager()) {
     return;
   }
 
-  for (auto& item : items_) {
-    if (item->hasTask(task->window)) {
-      item->setDemandsAttention(task->demandsAttention);
-      return;
-    }
+  if (auto* item = findTaskItem(task->window)) {
+    item->setDemandsAttention(task->demandsAttention);
+  }
+  if (windowListProgram_ != nullptr) {
+    updateWindowListRow(task);
   }
 }
 
 void DockPanel::onWindowTitleChanged(const WindowInfo *task) {
+  PROFILE_SCOPE("DockPanel::onWindowTitleChanged");
+  // Only a pointer check unless a window list is shown.
+  if (windowListProgram_ != nullptr) {
+    updateWindowListRow(task);
+  }
   if (model_->groupTasksByApplication()) {
     return;
   }
 
-  for (auto& item : items_) {
-    if (item->hasTask(task->window)) {
-      item->setLabel(QString::fromStdString(task->title));
-      update();
-      return;
-    }
+  if (auto* item = findTaskItem(task->window)) {
+    item->setLabel(task->qTitle);
+    updateItem(item);
   }
 }
 
-void DockPanel::onActiveWindowChanged() {
-  update();
+void DockPanel::onActiveWindowChanged(void* window) {
+  PROFILE_SCOPE("DockPanel::onActiveWindowChanged");
+  void* previous = activeWindow_;
+  activeWindow_ = window;
+  if (window == previous) {
+    return;
+  }
+
+  // Only the task indicators of the items of the previous and new active windows change,
+  // so docks that have neither don't repaint.
+  for (auto* w : {previous, window}) {
+    if (auto* item = findTaskItem(w)) {
+      updateItem(item);
+    }
+  }
+}
+
+void DockPanel::updateDrawContext() {
+  IndicatorSpriteKey key;
+  key.panelStyle = panelStyle_;
+  key.position = position_;
+  key.activeColor = (isGlass() ? model_->activeIndicatorColor()
+                               : isFlat2D() ? model_->activeIndicatorColor2D()
+                                            : model_->activeIndicatorColorMetal2D()).rgba();
+  key.inactiveColor = (isGlass() ? model_->inactiveIndicatorColor()
+                                 : isFlat2D() ? model_->inactiveIndicatorColor2D()
+                                              : model_->inactiveIndicatorColorMetal2D()).rgba();
+  key.devicePixelRatio = devicePixelRatioF();
+  if (!(key == indicatorSpriteKey_)) {
+    renderIndicatorSprites(key);
+  }
+
+  auto& context = drawContext_;
+  context.showTaskManager = showTaskManager();
+  context.groupTasksByApplication = model_->groupTasksByApplication();
+  context.bouncingLauncherIcon = model_->bouncingLauncherIcon();
+  context.activeWindow = WindowSystem::activeWindow();
+  context.indicatorSize = isGlass() ? kIndicatorSizeGlass
+                                    : isFlat2D() ? kIndicatorSizeFlat2D : kIndicatorSizeMetal2D;
+  context.indicatorPos = taskIndicatorPos();
+  context.appItemCounts.clear();
+  if (!context.groupTasksByApplication) {
+    // Same as itemCount(appId) for every app, in one pass.
+    for (int i = 0; i < itemCount();) {
+      const QString appId = items_[i]->getAppId();
+      int j = i + 1;
+      while (j < itemCount() && items_[j]->getAppId() == appId) { ++j; }
+      if (!context.appItemCounts.contains(appId)) {
+        context.appItemCounts.insert(appId, j - i);
+      }
+      i = j;
+    }
+  }
+}
+
+void DockPanel::drawTaskIndicator(int x, int y, bool active, const DrawContext& context,
+                                  QPainter* painter) {
+  const int anchor = indicatorSpriteAnchor_;
+  const int pos = context.indicatorPos;
+  painter->drawPixmap(isHorizontal() ? x - anchor : pos - anchor,
+                      isHorizontal() ? pos - anchor : y - anchor,
+                      indicatorSprites_[active ? 1 : 0]);
+}
+
+void DockPanel::renderIndicatorSprites(const IndicatorSpriteKey& key) {
+  const int size = isGlass() ? kIndicatorSizeGlass
+                             : isFlat2D() ? kIndicatorSizeFlat2D : kIndicatorSizeMetal2D;
+  // Big enough for the indicators of all styles drawn from the anchor.
+  constexpr int kPadding = 2;
+  const int anchor = size / 2 + kPadding;
+  const int spriteSize = 2 * (size + k3DPanelThickness + kPadding);
+  for (int active = 0; active < 2; ++active) {
+    const QColor color = QColor::fromRgba(active ? key.activeColor : key.inactiveColor);
+    QPixmap sprite(std::ceil(spriteSize * key.devicePixelRatio),
+                   std::ceil(spriteSize * key.devicePixelRatio));
+    sprite.setDevicePixelRatio(key.devicePixelRatio);
+    sprite.fill(Qt::transparent);
+    QPainter painter(&sprite);
+    painter.setRenderHint(QPainter::Antialiasing);
+    if (isGlass()) {
+      drawIndicator(orientation_, anchor, anchor, anchor, anchor, size, k3DPanelThickness,
+                    color, &painter);
+    } else if (isFlat2D()) {
+      drawIndicatorFlat2D(orientation_, anchor, anchor, anchor, anchor, size, color, &painter);
+    } else {  // Metal 2D.
+      drawIndicatorMetal2D(position_, anchor, anchor, anchor, anchor, size, color, &painter);
+    }
+    indicatorSprites_[active] = sprite;
+  }
+  indicatorSpriteAnchor_ = anchor;
+  indicatorSpriteKey_ = key;
+}
+
+void DockPanel::drawBadge(int right, int top, qint64 count, QPainter* painter) {
+  const QString text = (count > kMaxBadgeCount) ? QString::number(kMaxBadgeCount) + "+"
+                                                : QString::number(count);
+  const int length = std::min(static_cast<int>(text.size()), 3);
+  const int height = badgeHeight_;
+  const int width = height + (length - 1) * height / 3;
+  const qreal dpr = devicePixelRatioF();
+  auto& sprite = badgeSprites_[length - 1];
+  if (sprite.isNull() || sprite.devicePixelRatio() != dpr) {
+    sprite = QPixmap(std::ceil(width * dpr), std::ceil(height * dpr));
+    sprite.setDevicePixelRatio(dpr);
+    sprite.fill(Qt::transparent);
+    QPainter spritePainter(&sprite);
+    spritePainter.setRenderHint(QPainter::Antialiasing);
+    spritePainter.setPen(QPen(QColor(128, 16, 16), 1));
+    spritePainter.setBrush(QColor(224, 48, 48));
+    spritePainter.drawRoundedRect(QRectF(0.5, 0.5, width - 1, height - 1),
+                                  (height - 1) / 2.0, (height - 1) / 2.0);
+  }
+
+  const int left = right - width;
+  painter->drawPixmap(left, top, sprite);
+  painter->setFont(badgeFont_);
+  drawBorderedText(left, top, width, height, Qt::AlignCenter, text, 1, QColor(128, 16, 16),
+                   Qt::white, painter);
 }
 
 int DockPanel::taskIndicatorPos() {
@@ -460,6 +844,22 @@ int DockPanel::itemCount(const QString& appId) {
   return last - first;
 }
 
+void DockPanel::updateItem(const DockItem* item) {
+  for (int i = firstVisibleItem(); i <= lastVisibleItem(); ++i) {
+    if (items_[i].get() == item) {
+      // Otherwise the frame is re-rendered in full when the dock is next minimized.
+      if (isMinimized_) {
+        minimizedFrameDamage_ += itemDamageRect(i);
+      }
+      update(itemDamageRect(i));
+      if (i == activeItem_) {
+        updateTooltip();
+      }
+      return;
+    }
+  }
+}
+
 void DockPanel::updatePinnedStatus(const QString& appId, bool pinned) {
   const auto first = ranges::find_if(
       items_,
@@ -475,6 +875,7 @@ void DockPanel::updatePinnedStatus(const QString& appId, bool pinned) {
 
 void DockPanel::setShowingPopup(bool showingPopup) {
   isShowingPopup_ = showingPopup;
+  updateHoverScroll();
   if (!isShowingPopup_) {
     // We have to do these complicated workarounds because QCursor::pos() does not
     // exactly return the current mouse position but it depends on related mouse events.
@@ -548,22 +949,84 @@ void DockPanel::setShowingPopup(bool showingPopup) {
 }
 
 void DockPanel::paintEvent(QPaintEvent* e) {
+  // The rest is set up once the dock has been shown.
+  if (!isInitComplete_ && !isCompleteInitScheduled_) {
+    isCompleteInitScheduled_ = true;
+    QTimer::singleShot(0, this, &DockPanel::completeInit);
+  }
+
   if (!WindowSystem::hasAutoHideManager() && isHidden_ && (autoHide() || intellihide())) {
     return;
   }
 
   QPainter painter(this);
+  {
+    PROFILE_SCOPE("DockPanel::paintEvent");
+    MetricsScope metrics(RuntimeMetrics::Counter::Repaints, RuntimeMetrics::Histogram::Repaint);
+    int64_t area = 0;
+    for (const QRect& rect : e->region()) {
+      area += static_cast<int64_t>(rect.width()) * rect.height();
+    }
+    RuntimeMetrics::add(RuntimeMetrics::Counter::RepaintPixels, area);
+    updateDrawContext();
+    if (isMinimized_ && !isAnimationActive_) {
+      drawMinimizedFrame(painter);
+    } else {
+      drawDock(painter, e->region());
+    }
+  }
+
+  if (Profiler::enabled() && e->region().intersects(profilerOverlayRect())) {
+    drawProfilerOverlay(painter);
+  }
 
+  if (StartupTrace::enabled()) {
+    StartupTrace::addFirstFrame(dockId_);
+  }
+
+  if (revealTimer_.isValid() && !isHidden_) {
+    RuntimeMetrics::add(RuntimeMetrics::Counter::Reveals);
+    RuntimeMetrics::recordDuration(RuntimeMetrics::Histogram::Reveal,
+                                   revealTimer_.nsecsElapsed() / 1000);
+    revealTimer_.invalidate();
+  }
+}
+
+void DockPanel::drawDock(QPainter& painter, const QRegion& region) {
   if (is3D()) {
-    drawGlass3D(painter);
+    drawGlass3D(painter, region);
   } else {
-    draw2D(painter);
+    draw2D(painter, region);
+  }
+}
+
+void DockPanel::drawMinimizedFrame(QPainter& painter) {
+  const qreal dpr = devicePixelRatioF();
+  const QSize size(std::ceil(width() * dpr), std::ceil(height() * dpr));
+  if (minimizedFrame_.size() != size || minimizedFrame_.devicePixelRatio() != dpr) {
+    minimizedFrame_ = QPixmap(size);
+    minimizedFrame_.setDevicePixelRatio(dpr);
+    isMinimizedFrameValid_ = false;
+  }
+  if (!isMinimizedFrameValid_) {
+    minimizedFrameDamage_ = rect();
+    isMinimizedFrameValid_ = true;
   }
 
-  drawTooltip(painter);
+  if (!minimizedFrameDamage_.isEmpty()) {
+    PROFILE_SCOPE("DockPanel::paintEvent/minimizedFrame");
+    QPainter framePainter(&minimizedFrame_);
+    framePainter.setClipRegion(minimizedFrameDamage_);
+    framePainter.setCompositionMode(QPainter::CompositionMode_Source);
+    framePainter.fillRect(rect(), Qt::transparent);
+    framePainter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+    drawDock(framePainter, minimizedFrameDamage_);
+    minimizedFrameDamage_ = QRegion();
+  }
+  painter.drawPixmap(0, 0, minimizedFrame_);
 }
 
-void DockPanel::drawGlass3D(QPainter& painter) {
+void DockPanel::drawGlass3D(QPainter& painter, const QRegion& region) {
   if (isHorizontal()) {
     int y = isTop()
         ? isFloating() ? floatingMargin_ : 0
@@ -571,51 +1034,61 @@ void DockPanel::drawGlass3D(QPainter& painter) {
                        : maxHeight_ - backgroundHeight_;
     if (isBottom()) {  // 3D styles only apply to bottom dock.
       y -= k3DPanelThickness;
-      draw3dDockPanel(
-          (maxWidth_ - backgroundWidth_) / 2, y, backgroundWidth_ - 1, backgroundHeight_ - 1,
-           backgroundHeight_ / 16, borderColor_, backgroundColor_, &painter);
+      drawBackground(
+          painter, (maxWidth_ - backgroundWidth_) / 2, y, backgroundWidth_ - 1,
+          backgroundHeight_ - 1, backgroundHeight_ / 16, /*showBorder=*/true, /*is3D=*/true,
+          borderColor_, backgroundColor_);
     } else {
-      fillRoundedRect(
-          (maxWidth_ - backgroundWidth_) / 2, y, backgroundWidth_ - 1, backgroundHeight_ - 1,
-           backgroundHeight_ / 16, /*showBorder=*/true, borderColor_, backgroundColor_, &painter);
+      drawBackground(
+          painter, (maxWidth_ - backgroundWidth_) / 2, y, backgroundWidth_ - 1,
+          backgroundHeight_ - 1, backgroundHeight_ / 16, /*showBorder=*/true, /*is3D=*/false,
+          borderColor_, backgroundColor_);
     }
   } else {  // Vertical
     const int x =  isLeft()
         ? isFloating() ? floatingMargin_ : 0
         : isFloating() ? maxWidth_ - backgroundWidth_ - floatingMargin_
                        : maxWidth_ - backgroundWidth_;
-    fillRoundedRect(x, (maxHeight_ - backgroundHeight_) / 2, backgroundWidth_ - 1, backgroundHeight_ - 1,
-                    backgroundWidth_ / 16, /*showBorder=*/true, borderColor_, backgroundColor_, &painter);
+    drawBackground(painter, x, (maxHeight_ - backgroundHeight_) / 2, backgroundWidth_ - 1,
+                   backgroundHeight_ - 1, backgroundWidth_ / 16, /*showBorder=*/true,
+                   /*is3D=*/false, borderColor_, backgroundColor_);
   }
 
-  if (isBottom()) {
-    QImage mainImage(width(), height(), QImage::Format_ARGB32);
-    mainImage.fill(0);
-    QPainter mainPainter(&mainImage);
-    // Draw the items from the end to avoid zoomed items getting clipped by
-    // non-zoomed items.
-    for (int i = itemCount() - 1; i >= 0; --i) {
-      items_[i]->draw(&mainPainter);
-    }
-    painter.drawImage(0, 0, mainImage);
+  drawItems(painter, region);
 
+  if (isBottom()) {
+    PROFILE_SCOPE("DockPanel::paintEvent/reflection");
+    // The reflection is the strip of the items just above the panel's surface, mirrored.
     int y = height() - itemSpacing_ - k3DPanelThickness;
     if (isFloating()) { y -= floatingMargin_; }
-    QImage toMirrorImage = mainImage.copy(0, y - itemSpacing_ + 2, width(), itemSpacing_ - 2);
-    QImage mirrorImage = toMirrorImage.mirrored();
+    const int stripHeight = itemSpacing_ - 2;
+    const QRect reflectionRect(0, y, width(), stripHeight);
+    if (stripHeight <= 0 || !region.intersects(reflectionRect)) {
+      return;
+    }
+
+    if (reflection_.size() != reflectionRect.size()) {
+      reflection_ = QImage(reflectionRect.size(), QImage::Format_ARGB32_Premultiplied);
+    }
+    reflection_.fill(0);
+    QPainter reflectionPainter(&reflection_);
+    // Maps the strip's source rows [y - stripHeight, y) upside down onto the buffer.
+    reflectionPainter.translate(0, y);
+    reflectionPainter.scale(1, -1);
+    for (int i = lastVisibleItem(); i >= firstVisibleItem(); --i) {
+      if (region.intersects(itemDamageRect(i))) {
+        items_[i]->draw(&reflectionPainter, drawContext_);
+      }
+    }
+    reflectionPainter.end();
+
     painter.setOpacity(0.3);
-    painter.drawImage(0, y, mirrorImage);
+    painter.drawImage(0, y, reflection_);
     painter.setOpacity(1.0);
-  } else {
-    // Draw the items from the end to avoid zoomed items getting clipped by
-    // non-zoomed items.
-    for (int i = itemCount() - 1; i >= 0; --i) {
-      items_[i]->draw(&painter);
-    }
   }
 }
 
-void DockPanel::draw2D(QPainter& painter) {
+void DockPanel::draw2D(QPainter& painter, const QRegion& region) {
   const QColor bgColor = isGlass2D()
       ? model_->backgroundColor()
       : isFlat2D()
@@ -633,9 +1106,9 @@ void DockPanel::draw2D(QPainter& painter) {
         : isFlat2D()
             ? backgroundHeight_ / 4
             : 0;
-    fillRoundedRect(
-        (maxWidth_ - backgroundWidth_) / 2, y, backgroundWidth_ - 1, backgroundHeight_ - 1,
-         r, showBorder, borderColor, bgColor, &painter);
+    drawBackground(
+        painter, (maxWidth_ - backgroundWidth_) / 2, y, backgroundWidth_ - 1,
+        backgroundHeight_ - 1, r, showBorder, /*is3D=*/false, borderColor, bgColor);
   } else {  // Vertical
     const int x =  isLeft()
         ? isFloating() ? floatingMargin_ : 0
@@ -646,39 +1119,176 @@ void DockPanel::draw2D(QPainter& painter) {
         : isFlat2D()
             ? backgroundWidth_ / 4
             : 0;
-    fillRoundedRect(
-          x, (maxHeight_ - backgroundHeight_) / 2, backgroundWidth_ - 1, backgroundHeight_ - 1,
-          r, showBorder, borderColor, bgColor, &painter);
+    drawBackground(
+        painter, x, (maxHeight_ - backgroundHeight_) / 2, backgroundWidth_ - 1,
+        backgroundHeight_ - 1, r, showBorder, /*is3D=*/false, borderColor, bgColor);
   }
 
+  drawItems(painter, region);
+}
+
+void DockPanel::drawItems(QPainter& painter, const QRegion& region) {
+  PROFILE_SCOPE("DockPanel::paintEvent/items");
   // Draw the items from the end to avoid zoomed items getting clipped by
   // non-zoomed items.
-  for (int i = itemCount() - 1; i >= 0; --i) {
-    items_[i]->draw(&painter);
+  for (int i = lastVisibleItem(); i >= firstVisibleItem(); --i) {
+    if (region.intersects(itemDamageRect(i))) {
+      items_[i]->draw(&painter, drawContext_);
+    }
   }
+  drawOverflowIndicators(painter);
 }
 
-void DockPanel::drawTooltip(QPainter& painter) {
-  if (model_->showTooltip() && !isAnimationActive_ && activeItem_ >= 0 &&
-      activeItem_ < static_cast<int>(items_.size())) {
+void DockPanel::drawOverflowIndicators(QPainter& painter) {
+  if (!isOverflowing_ || visibleItemCount() == 0) {
+    return;
+  }
+
+  // In the spacing before/after the item, within its damage rect.
+  const int depth = std::max(itemSpacing_ / 2, 2);
+  const auto drawArrow = [&](const DockItem& item, bool towardsStart) {
+    const QRect rect(item.left_, item.top_, item.getWidth(), item.getHeight());
+    QPolygon arrow;
     if (isHorizontal()) {
-      const auto& item = items_[activeItem_];
-      QFont font;
-      font.setPointSize(model_->tooltipFontSize());
-      font.setBold(true);
-      QFontMetrics metrics(font);
-      const auto tooltipWidth = metrics.boundingRect(item->getLabel()).width();
-      painter.setFont(font);
-      int x = item->left_ + item->getWidth() / 2 - tooltipWidth / 2;
-      x = std::min(x, maxWidth_ - tooltipWidth);
-      x = std::max(x, 0);
-      int y = isTop() ? maxHeight_ - tooltipSize_ / 2 : tooltipSize_ * 3 / 4;
-      drawBorderedText(x, y, item->getLabel(), /*borderWidth*/ 2, Qt::black, Qt::white, &painter);
-    } else {  // Vertical
-      // Do not draw tooltip for Vertical positions for now because the total
-      // area of the dock would take too much desktop space.
+      const int base = towardsStart ? rect.left() : rect.right() + 1;
+      const int tip = towardsStart ? base - depth : base + depth;
+      const int center = rect.center().y();
+      arrow << QPoint(tip, center) << QPoint(base, center - depth)
+            << QPoint(base, center + depth);
+    } else {
+      const int base = towardsStart ? rect.top() : rect.bottom() + 1;
+      const int tip = towardsStart ? base - depth : base + depth;
+      const int center = rect.center().x();
+      arrow << QPoint(center, tip) << QPoint(center - depth, base)
+            << QPoint(center + depth, base);
+    }
+    painter.drawPolygon(arrow);
+  };
+
+  painter.save();
+  painter.setRenderHint(QPainter::Antialiasing);
+  painter.setPen(Qt::NoPen);
+  painter.setBrush(borderColor_);
+  if (firstVisibleItem() > 0) {
+    drawArrow(*items_[firstVisibleItem()], /*towardsStart=*/true);
+  }
+  if (lastVisibleItem() < itemCount() - 1) {
+    drawArrow(*items_[lastVisibleItem()], /*towardsStart=*/false);
+  }
+  painter.restore();
+}
+
+void DockPanel::drawBackground(QPainter& painter, int x, int y, int width, int height,
+                               int radius, bool showBorder, bool is3D, QColor borderColor,
+                               QColor fillColor) {
+  PROFILE_SCOPE("DockPanel::paintEvent/background");
+  // The 3D sides and the antialiased border extend slightly beyond the rect.
+  constexpr int kPadding = 4;
+  const qreal dpr = devicePixelRatioF();
+  const BackgroundLayerKey key{width, height, radius, showBorder, is3D,
+                               borderColor.rgba(), fillColor.rgba(), dpr};
+  if (backgroundLayer_.isNull() || !(key == backgroundLayerKey_)) {
+    backgroundLayer_ = QPixmap(std::ceil((width + 2 * kPadding) * dpr),
+                               std::ceil((height + 2 * kPadding) * dpr));
+    backgroundLayer_.setDevicePixelRatio(dpr);
+    backgroundLayer_.fill(Qt::transparent);
+    QPainter layerPainter(&backgroundLayer_);
+    if (is3D) {
+      draw3dDockPanel(kPadding, kPadding, width, height, radius, borderColor, fillColor,
+                      &layerPainter);
+    } else {
+      fillRoundedRect(kPadding, kPadding, width, height, radius, showBorder, borderColor,
+                      fillColor, &layerPainter);
+    }
+    backgroundLayerKey_ = key;
+  }
+  painter.drawPixmap(x - kPadding, y - kPadding, backgroundLayer_);
+}
+
+void DockPanel::updateTooltip() {
+  const QRect rect = tooltipRect();
+  if (rect.isEmpty()) {
+    tooltip_.hide();
+    return;
+  }
+
+  tooltip_.showText(tooltipLabel_, QRect(mapToGlobal(rect.topLeft()), rect.size()));
+}
+
+void DockPanel::updateWindowListRow(const WindowInfo* task) {
+  if (findTaskItem(task->window) == windowListProgram_) {
+    windowListProgram_->updateWindowListRow(task);
+  }
+}
+
+void DockPanel::drawProfilerOverlay(QPainter& painter) {
+  const QRect rect = profilerOverlayRect();
+  painter.fillRect(rect, QColor(0, 0, 0, 192));
+  QFont font("monospace");
+  font.setPixelSize(kProfilerOverlayFontSize);
+  painter.setFont(font);
+  painter.setPen(Qt::white);
+  const int lineHeight = QFontMetrics(font).height();
+  int y = rect.top() + QFontMetrics(font).ascent();
+  painter.drawText(rect.left() + 2, y, "section                   p50/p99 (ms)");
+  for (const auto& s : Profiler::stats()) {
+    y += lineHeight;
+    if (y > rect.bottom()) {
+      break;
     }
+    QString name = QString::fromStdString(s.name);
+    name.remove("DockPanel::");
+    painter.drawText(rect.left() + 2, y, QString("%1 %2/%3")
+        .arg(name, -25).arg(s.p50 / 1000, 0, 'f', 2).arg(s.p99 / 1000, 0, 'f', 2));
+  }
+}
+
+QRect DockPanel::profilerOverlayRect() const {
+  return QRect(0, 0, std::min(width(), kProfilerOverlayWidth), height());
+}
+
+QRect DockPanel::tooltipRect() const {
+  if (!model_->showTooltip() || isAnimationActive_ || isHidden_ || activeItem_ < 0 ||
+      activeItem_ >= static_cast<int>(items_.size())) {
+    return QRect();
+  }
+
+  const auto& item = items_[activeItem_];
+  const QString label = item->getLabel();
+  if (label != tooltipLabel_) {
+    tooltipLabel_ = label;
+    tooltipLabelWidth_ = QFontMetrics(tooltipFont_).boundingRect(label).width();
+  }
+  const int w = tooltipLabelWidth_ + 2 * Tooltip::kBorderWidth;
+  const int h = tooltipFontHeight_ + 2 * Tooltip::kBorderWidth;
+  if (isHorizontal()) {
+    const int x = item->left_ + item->getWidth() / 2 - w / 2;
+    const int y = isTop() ? item->top_ + item->getHeight() + kTooltipSpacing
+                          : item->top_ - kTooltipSpacing - h;
+    return QRect(x, y, w, h);
+  }
+
+  const int x = isLeft() ? item->left_ + item->getWidth() + kTooltipSpacing
+                         : item->left_ - kTooltipSpacing - w;
+  const int y = item->top_ + item->getHeight() / 2 - h / 2;
+  return QRect(x, y, w, h);
+}
+
+QRect DockPanel::animatedBounds() const {
+  QRect bounds = isHorizontal()
+      ? QRect((maxWidth_ - backgroundWidth_) / 2, 0, backgroundWidth_, height())
+      : QRect(0, (maxHeight_ - backgroundHeight_) / 2, width(), backgroundHeight_);
+  for (int i = firstVisibleItem(); i <= lastVisibleItem(); ++i) {
+    bounds |= itemDamageRect(i);
   }
+  return bounds;
+}
+
+QRect DockPanel::itemDamageRect(int i) const {
+  const auto& item = items_[i];
+  return isHorizontal()
+      ? QRect(item->left_ - itemSpacing_ / 2, 0, item->getWidth() + itemSpacing_, height())
+      : QRect(0, item->top_ - itemSpacing_ / 2, width(), item->getHeight() + itemSpacing_);
 }
 
 void DockPanel::mouseMoveEvent(QMouseEvent* e) {
@@ -694,11 +1304,21 @@ void DockPanel::mouseMoveEvent(QMouseEvent* e) {
     }
   }
 
-  if (isAnimationActive_) {
+  // Laid out on the next frame, for the latest position by then. A move during the zoom
+  // animation retargets it rather than being dropped.
+  pendingMouseX_ = x;
+  pendingMouseY_ = y;
+  if (isPointerPending_) {
+    RuntimeMetrics::add(RuntimeMetrics::Counter::EventsCoalesced);
     return;
   }
-
-  updateLayout(x, y);
+  isPointerPending_ = true;
+  if (windowHandle() == nullptr) {
+    // No frames to wait for.
+    applyPendingPointer();
+    return;
+  }
+  requestAnimationFrame();
 }
 
 bool DockPanel::checkMouseEnter(int x, int y) {
@@ -766,32 +1386,65 @@ bool DockPanel::intellihideShouldHide(void* excluding_window) {
     return true;
   }
 
-  QRect dockGeometry = getMinimizedDockGeometry();
-  for (const auto* task : WindowSystem::windows()) {
-    if (isValidTask(task) && (!excluding_window || task->window != excluding_window)) {
-      if ((task->maximized || task->fullscreen)
-          && task->outputs.contains(screenOutput_)) {
-        return true;
-      }
+  if (!isCoveringWindowsValid_ || coveringDockGeometry_ != getMinimizedDockGeometry()) {
+    rebuildCoveringWindows();
+  }
+  const size_t excluded = (excluding_window && coveringWindows_.contains(excluding_window))
+      ? 1 : 0;
+  return coveringWindows_.size() > excluded;
+}
 
-      QRect windowGeometry(task->x, task->y, task->width, task->height);
-      if (windowGeometry.isValid() && !task->minimized && windowGeometry.intersects(dockGeometry)) {
-        return true;
-      }
-    }
+bool DockPanel::coversDock(const WindowInfo* task, const QRect& dockGeometry) {
+  if (!isValidTask(task)) {
+    return false;
+  }
+
+  if ((task->maximized || task->fullscreen) && task->outputs.contains(screenOutput_)) {
+    return true;
   }
 
-  return false;
+  QRect windowGeometry(task->x, task->y, task->width, task->height);
+  return windowGeometry.isValid() && !task->minimized && windowGeometry.intersects(dockGeometry);
 }
 
-void DockPanel::intellihideHideUnhide(void* excluding_window) {
+bool DockPanel::updateCoveringWindow(void* window, const WindowInfo* task) {
   if (visibility_ != PanelVisibility::IntelligentAutoHide) {
-    return;
+    isCoveringWindowsValid_ = false;
+    return false;
   }
 
-  if (intellihideShouldHide(excluding_window)) {
-    if (!isHidden_ && isMinimized_) {
-      setAutoHide();
+  bool changed = false;
+  if (!isCoveringWindowsValid_ || coveringDockGeometry_ != getMinimizedDockGeometry()) {
+    rebuildCoveringWindows();
+    changed = true;
+  }
+
+  // A removed window is still in the window system at this point.
+  if (task != nullptr && coversDock(task, coveringDockGeometry_)) {
+    return coveringWindows_.insert(window).second || changed;
+  }
+  return (coveringWindows_.erase(window) > 0) || changed;
+}
+
+void DockPanel::rebuildCoveringWindows() {
+  coveringDockGeometry_ = getMinimizedDockGeometry();
+  coveringWindows_.clear();
+  for (const auto* task : WindowSystem::windows()) {
+    if (coversDock(task, coveringDockGeometry_)) {
+      coveringWindows_.insert(task->window);
+    }
+  }
+  isCoveringWindowsValid_ = true;
+}
+
+void DockPanel::intellihideHideUnhide(void* excluding_window) {
+  if (visibility_ != PanelVisibility::IntelligentAutoHide) {
+    return;
+  }
+
+  if (intellihideShouldHide(excluding_window)) {
+    if (!isHidden_ && isMinimized_) {
+      setAutoHide();
     }
   } else {
     if (isHidden_) {
@@ -800,6 +1453,33 @@ void DockPanel::intellihideHideUnhide(void* excluding_window) {
   }
 }
 
+void DockPanel::scheduleRelayout() {
+  if (isRelayoutScheduled_) {
+    RuntimeMetrics::add(RuntimeMetrics::Counter::EventsCoalesced);
+  }
+  isRelayoutScheduled_ = true;
+  scheduledUpdatesTimer_.start();
+}
+
+void DockPanel::scheduleIntellihideHideUnhide() {
+  if (isIntellihideScheduled_) {
+    RuntimeMetrics::add(RuntimeMetrics::Counter::EventsCoalesced);
+  }
+  isIntellihideScheduled_ = true;
+  scheduledUpdatesTimer_.start();
+}
+
+void DockPanel::applyScheduledUpdates() {
+  if (isRelayoutScheduled_) {
+    isRelayoutScheduled_ = false;
+    resizeTaskManager();
+  }
+  if (isIntellihideScheduled_) {
+    isIntellihideScheduled_ = false;
+    intellihideHideUnhide();
+  }
+}
+
 bool DockPanel::isEmpty() {
   for (const auto& item : items_) {
     if (item->getAppId() != kSeparatorId && item->getAppId() != kLauncherSeparatorId) {
@@ -810,6 +1490,8 @@ bool DockPanel::isEmpty() {
 }
 
 void DockPanel::mousePressEvent(QMouseEvent* e) {
+  // So that the press goes to the item under the pointer now.
+  applyPendingPointer();
   if (isAnimationActive_) {
     return;
   }
@@ -824,9 +1506,17 @@ void DockPanel::enterEvent (QEnterEvent* e) {
   if (isMinimized_) {
     isEntering_ = true;
   }
+  if (isHidden_) {
+    prepareReveal();
+  }
 }
 
 void DockPanel::leaveEvent(QEvent* e) {
+  if (isHidden_ && revealTimer_.isValid()) {
+    // Left again without revealing it.
+    revealTimer_.invalidate();
+    updateTrimTimer();
+  }
   if (isMinimized_ || isShowingPopup_) {
     return;
   }
@@ -834,6 +1524,24 @@ void DockPanel::leaveEvent(QEvent* e) {
   isLeaving_ = true;
   updateLayout();
   activeItem_ = -1;
+  updateHoverScroll();
+  updateTooltip();
+}
+
+void DockPanel::wheelEvent(QWheelEvent* e) {
+  if (!isOverflowing_) {
+    e->ignore();
+    return;
+  }
+
+  const QPoint angle = e->angleDelta();
+  wheelDelta_ += (angle.y() != 0) ? angle.y() : angle.x();
+  const int steps = wheelDelta_ / QWheelEvent::DefaultDeltasPerStep;
+  wheelDelta_ -= steps * QWheelEvent::DefaultDeltasPerStep;
+  // Scrolling up/left shows the items before.
+  if (steps != 0) {
+    scrollItems(-steps);
+  }
 }
 
 void DockPanel::dragEnterEvent(QDragEnterEvent* e) {
@@ -867,18 +1575,40 @@ void DockPanel::dropEvent(QDropEvent* e) {
 }
 
 void DockPanel::initUi() {
+  StartupPhase phase("DockPanel::initUi (dock " + std::to_string(dockId_) + ")");
   initApplicationMenu();
   initPager();
   initLaunchers();
-  initTasks();
+  // On start-up, the dock is first shown with just its launchers.
+  if (isInitComplete_) {
+    initTasks();
+  }
   initTrash();
   initClock();
   initLayoutVars();
   updateLayout();
   setStrut();
+  if (isInitComplete_) {
+    for (const auto& item : items_) {
+      item->completeInit();
+    }
+  }
+}
+
+void DockPanel::completeInit() {
+  StartupPhase phase("DockPanel::completeInit (dock " + std::to_string(dockId_) + ")");
+  isInitComplete_ = true;
+  for (const auto& item : items_) {
+    item->completeInit();
+  }
+  reloadTasks();
 }
 
 void DockPanel::addPanelSettings(QMenu* menu) {
+  // Only created when an item's context menu is first shown.
+  if (menu_.isEmpty()) {
+    createMenu();
+  }
   QAction* action = menu->addMenu(&menu_);
   action->setText("&Panel Settings");
   action->setIcon(QIcon::fromTheme("configure"));
@@ -1007,21 +1737,20 @@ void DockPanel::createMenu() {
 
   menu_.addSeparator();
   menu_.addAction(QString("E&xit"), parent_, SLOT(exit()));
-}
 
-void DockPanel::setPosition(PanelPosition position) {
-  position_ = position;
-  orientation_ = (position_ == PanelPosition::Top ||
-      position_ == PanelPosition::Bottom)
-      ? Qt::Horizontal : Qt::Vertical;
-  positionTop_->setChecked(position == PanelPosition::Top);
-  positionBottom_->setChecked(position == PanelPosition::Bottom);
-  positionLeft_->setChecked(position == PanelPosition::Left);
-  positionRight_->setChecked(position == PanelPosition::Right);
+  connect(&menu_, &QMenu::aboutToShow, this, &DockPanel::updateMenu);
 }
 
-void DockPanel::setVisibility(PanelVisibility visibility) {
-  visibility_ = visibility;
+void DockPanel::updateMenu() {
+  positionTop_->setChecked(position_ == PanelPosition::Top);
+  positionBottom_->setChecked(position_ == PanelPosition::Bottom);
+  positionLeft_->setChecked(position_ == PanelPosition::Left);
+  positionRight_->setChecked(position_ == PanelPosition::Right);
+
+  for (int i = 0; i < static_cast<int>(screenActions_.size()); ++i) {
+    screenActions_[i]->setChecked(i == screen_);
+  }
+
   visibilityAlwaysVisibleAction_->setChecked(
       visibility_ == PanelVisibility::AlwaysVisible);
   visibilityIntelligentAutoHideAction_->setChecked(
@@ -1030,15 +1759,35 @@ void DockPanel::setVisibility(PanelVisibility visibility) {
       visibility_ == PanelVisibility::AutoHide);
   visibilityAlwaysOnTopAction_->setChecked(
       visibility_ == PanelVisibility::AlwaysOnTop);
-}
 
-void DockPanel::setPanelStyle(PanelStyle panelStyle) {
-  panelStyle_ = panelStyle;
   floatingStyleAction_->setChecked(isFloating());
   glass3DStyleAction_->setChecked(is3D());
   glass2DStyleAction_->setChecked(isGlass2D());
   flat2DStyleAction_->setChecked(isFlat2D());
   metal2DStyleAction_->setChecked(isMetal2D());
+
+  applicationMenuAction_->setChecked(showApplicationMenu_);
+  pagerAction_->setVisible(WindowSystem::hasVirtualDesktopManager());
+  pagerAction_->setChecked(showPager_);
+  taskManagerAction_->setChecked(showTaskManager());
+  clockAction_->setChecked(showClock_);
+  trashAction_->setChecked(showTrash_);
+}
+
+void DockPanel::setPosition(PanelPosition position) {
+  position_ = position;
+  orientation_ = (position_ == PanelPosition::Top ||
+      position_ == PanelPosition::Bottom)
+      ? Qt::Horizontal : Qt::Vertical;
+}
+
+void DockPanel::setVisibility(PanelVisibility visibility) {
+  visibility_ = visibility;
+}
+
+void DockPanel::setPanelStyle(PanelStyle panelStyle) {
+  panelStyle_ = panelStyle;
+  backgroundLayer_ = QPixmap();
 }
 
 void DockPanel::loadDockConfig() {
@@ -1047,19 +1796,9 @@ void DockPanel::loadDockConfig() {
   setVisibility(model_->visibility(dockId_));
 
   showApplicationMenu_ = model_->showApplicationMenu(dockId_);
-  applicationMenuAction_->setChecked(showApplicationMenu_);
-
   showPager_ = model_->showPager(dockId_) && WindowSystem::hasVirtualDesktopManager();
-  pagerAction_->setVisible(WindowSystem::hasVirtualDesktopManager());
-  pagerAction_->setChecked(showPager_);
-
-  taskManagerAction_->setChecked(model_->showTaskManager(dockId_));
-
   showClock_ = model_->showClock(dockId_);
-  clockAction_->setChecked(showClock_);
-
   showTrash_ = model_->showTrash(dockId_);
-  trashAction_->setChecked(showTrash_);
 }
 
 void DockPanel::saveDockConfig() {
@@ -1068,13 +1807,14 @@ void DockPanel::saveDockConfig() {
   model_->setVisibility(dockId_, visibility_);
   model_->setShowApplicationMenu(dockId_, showApplicationMenu_);
   model_->setShowPager(dockId_, showPager_);
-  model_->setShowTaskManager(dockId_, taskManagerAction_->isChecked());
+  model_->setShowTaskManager(dockId_, showTaskManager());
   model_->setShowClock(dockId_, showClock_);
   model_->setShowTrash(dockId_, showTrash_);
   model_->saveDockConfig(dockId_);
 }
 
 void DockPanel::loadAppearanceConfig() {
+  isMinimizedFrameValid_ = false;
   minSize_ = model_->minIconSize();
   maxSize_ = model_->maxIconSize();
   spacingFactor_ = model_->spacingFactor();
@@ -1082,12 +1822,20 @@ void DockPanel::loadAppearanceConfig() {
   borderColor_ = model_->borderColor();
   tooltipFontSize_ = model_->tooltipFontSize();
   setPanelStyle(model_->panelStyle());
+  // The same as MultiDockView::preloadIcons() until shown, as the panel's own isn't known yet.
+  iconScale_ = isVisible() ? devicePixelRatioF() : screenIconScale(screen_);
 }
 
 void DockPanel::initApplicationMenu() {
   if (showApplicationMenu_) {
-    items_.push_back(std::make_unique<ApplicationMenu>(
-        this, model_, orientation_, minSize_, maxSize_));
+    auto applicationMenu = takeReusableItem<ApplicationMenu>([](const auto&) { return true; });
+    if (applicationMenu) {
+      // E.g. after its name or font has been changed.
+      applicationMenu->loadConfig();
+    }
+    items_.push_back(applicationMenu ? std::move(applicationMenu)
+                                     : std::make_unique<ApplicationMenu>(
+                                           this, model_, orientation_, minSize_, maxSize_));
   }
 }
 
@@ -1097,12 +1845,24 @@ void DockPanel::initLaunchers() {
       items_.push_back(std::make_unique<Separator>(
           this, model_, orientation_, minSize_, maxSize_,
           launcherConfig.appId == kLauncherSeparatorId));
+    } else if (auto program = takeReusableItem<Program>([&](const Program& program) {
+                 // Launchers load their icon by this name, see below.
+                 return program.pinned() && program.getAppId() == launcherConfig.appId &&
+                     program.getAppLabel() == launcherConfig.name &&
+                     program.command() == launcherConfig.command &&
+                     program.iconNames().value(0) == launcherConfig.icon;
+               })) {
+      // Its tasks are added again in initTasks().
+      program->clearTasks();
+      items_.push_back(std::move(program));
     } else {
-      QPixmap icon = loadIcon(launcherConfig.icon, kIconLoadSize);
-      items_.push_back(std::make_unique<Program>(
+      QPixmap icon = loadIcon(launcherConfig.icon, iconLoadSize());
+      auto launcher = std::make_unique<Program>(
           this, model_, launcherConfig.appId, launcherConfig.name, orientation_,
           icon, minSize_, maxSize_, launcherConfig.command,
-          model_->isAppMenuEntry(launcherConfig.appId.toStdString()), /*pinned=*/true));
+          model_->isAppMenuEntry(launcherConfig.appId.toStdString()), /*pinned=*/true);
+      launcher->setIconNames({launcherConfig.icon});
+      items_.push_back(std::move(launcher));
     }
   }
 }
@@ -1110,8 +1870,16 @@ void DockPanel::initLaunchers() {
 void DockPanel::initPager() {
   if (showPager_) {
     for (const auto& desktop : WindowSystem::desktops()) {
-      items_.push_back(std::make_unique<DesktopSelector>(
-          this, model_, orientation_, minSize_, maxSize_, desktop, screen_));
+      auto desktopSelector = takeReusableItem<DesktopSelector>(
+          [&](const DesktopSelector& selector) { return selector.isFor(desktop, screen_); });
+      if (desktopSelector) {
+        // E.g. after its wallpaper has been changed.
+        desktopSelector->loadConfig();
+      }
+      items_.push_back(desktopSelector ? std::move(desktopSelector)
+                                       : std::make_unique<DesktopSelector>(
+                                             this, model_, orientation_, minSize_, maxSize_,
+                                             desktop, screen_));
     }
   }
 }
@@ -1133,13 +1901,38 @@ void DockPanel::reloadTasks() {
     return;
   }
 
-  const int itemsToKeep = applicationMenuItemCount() + pagerItemCount();
-  items_.resize(itemsToKeep);
-  initLaunchers();
-  initTasks();
-  initTrash();
-  initClock();
-  resizeTaskManager();
+  // Only adds/removes the tasks that entered/left the filter, keeping all other items.
+  std::unordered_set<void*> validWindows;
+  for (const auto* task : WindowSystem::windows()) {
+    if (isValidTask(task)) {
+      validWindows.insert(task->window);
+    }
+  }
+
+  std::vector<void*> staleWindows;
+  for (const auto& [window, item] : taskItems_) {
+    if (!validWindows.contains(window)) {
+      staleWindows.push_back(window);
+    }
+  }
+
+  bool changed = !staleWindows.empty();
+  bool layoutChanged = false;
+  for (auto* window : staleWindows) {
+    layoutChanged = removeTaskItem(window) || layoutChanged;
+  }
+  for (const auto* task : WindowSystem::windows()) {
+    if (validWindows.contains(task->window) && !hasTask(task->window)) {
+      changed = true;
+      layoutChanged = addTask(task) || layoutChanged;
+    }
+  }
+
+  if (layoutChanged) {
+    resizeTaskManager();
+  } else if (changed) {
+    updateAll();
+  }
 }
 
 bool DockPanel::addTask(const WindowInfo* task) {
@@ -1151,167 +1944,284 @@ bool DockPanel::addTask(const WindowInfo* task) {
   // Tries adding the task to existing programs.
   for (auto& item : items_) {
     if (item->addTask(task)) {
+      taskItems_[task->window] = item.get();
       return false;
     }
   }
 
   // Adds a new program.
-  auto app = model_->findApplication(task->appId);
+  auto app = model_->findApplication(task->appId());
   if (!app) {
-    std::cerr << "Could not find application with id: " << task->appId
+    std::cerr << "Could not find application with id: " << task->appId()
               << ". The window icon will have limited functionalities." << std::endl;
   }
-  const QString label = app ? app->name : QString::fromStdString(task->title);
-  const QString appId = app ? app->appId : QString::fromStdString(task->appId);
-  QPixmap appIcon = app ? loadIcon(app->icon, kIconLoadSize) : QPixmap();
-  QString taskIconName = QString::fromStdString(task->icon);
-  QPixmap taskIcon = appIcon.isNull() && !taskIconName.isEmpty()
-      ? loadIcon(taskIconName, kIconLoadSize) : QPixmap();
-  if (app && appIcon.isNull()) {
-    std::cerr << "Could not find icon with name: " << app->icon.toStdString()
-              << " in the current icon theme and its fallbacks."
-              << " The window icon will have limited functionalities." << std::endl;
-  }
+  const QString label = app ? app->name : task->qTitle;
+  const QString appId = app ? app->appId : QString::fromStdString(task->appId());
 
   int i = 0;
   for (; i < itemCount() && items_[i]->beforeTask(label); ++i);
   if (!model_->groupTasksByApplication()) {
     for (; i < itemCount() && items_[i]->getAppLabel() == label; ++i);
   }
-  if (!appIcon.isNull()) {
-    const auto pinned = !model_->groupTasksByApplication() &&
-                        model_->launchers(dockId_).contains(app->appId);
-    items_.insert(items_.begin() + i, std::make_unique<Program>(
+  const auto pinned = app && !model_->groupTasksByApplication() &&
+                      model_->launchers(dockId_).contains(app->appId);
+
+  // Reuses the program from before reload(), if any, with its icons.
+  if (auto program = takeReusableItem<Program>([&](const Program& program) {
+        return program.getAppId() == appId && program.getAppLabel() == label &&
+            program.pinned() == pinned;
+      })) {
+    program->clearTasks();
+    Program* item = program.get();
+    items_.insert(items_.begin() + i, std::move(program));
+    item->addTask(task);
+    taskItems_[task->window] = item;
+    return true;
+  }
+
+  QString taskIconName = QString::fromStdString(task->icon);
+  // If possible, load the icon in the background and draw the fallback icon until then.
+  const bool loadInBackground = IconLoader::canLoadInBackground();
+  QPixmap appIcon = (app && !loadInBackground) ? loadIcon(app->icon, iconLoadSize()) : QPixmap();
+  QPixmap taskIcon = !loadInBackground && appIcon.isNull() && !taskIconName.isEmpty()
+      ? loadIcon(taskIconName, iconLoadSize()) : QPixmap();
+  if (app && !loadInBackground && appIcon.isNull()) {
+    std::cerr << "Could not find icon with name: " << app->icon.toStdString()
+              << " in the current icon theme and its fallbacks."
+              << " The window icon will have limited functionalities." << std::endl;
+  }
+
+  std::unique_ptr<Program> program;
+  if (app && (loadInBackground || !appIcon.isNull())) {
+    program = std::make_unique<Program>(
         this, model_, appId, label, orientation_, appIcon, minSize_,
-        maxSize_, app->command, /*isAppMenuEntry=*/true, pinned));
-  } else if (!taskIcon.isNull()) {
-    items_.insert(items_.begin() + i, std::make_unique<Program>(
-        this, model_, appId, label, orientation_, taskIcon, minSize_, maxSize_));
+        maxSize_, app->command, /*isAppMenuEntry=*/true, pinned);
   } else {
-    items_.insert(items_.begin() + i, std::make_unique<Program>(
-        this, model_, appId, label, orientation_, QPixmap(), minSize_, maxSize_));
+    program = std::make_unique<Program>(
+        this, model_, appId, label, orientation_, taskIcon, minSize_, maxSize_);
   }
+  QStringList iconNames;
+  if (app) {
+    iconNames << app->icon;
+  }
+  iconNames << taskIconName;
+  program->setIconNames(iconNames);
+  Program* item = program.get();
+  items_.insert(items_.begin() + i, std::move(program));
   items_[i]->addTask(task);
+  taskItems_[task->window] = item;
+
+  if (loadInBackground) {
+    IconLoader::loadAsync(iconNames, iconLoadSize(), item, [this, item](const QPixmap& icon) {
+      onTaskIconLoaded(item, icon);
+    });
+  }
 
   return true;
 }
 
-void DockPanel::removeTask(void* window) {
-  for (int i = 0; i < itemCount(); ++i) {
-    if (items_[i]->removeTask(window)) {
-      if (items_[i]->shouldBeRemoved()) {
-        items_.erase(items_.begin() + i);
-        resizeTaskManager();
+void DockPanel::onTaskIconLoaded(Program* program, const QPixmap& icon) {
+  if (icon.isNull()) {
+    std::cerr << "Could not find icon for: " << program->getAppId().toStdString()
+              << " in the current icon theme and its fallbacks."
+              << " The window icon will have limited functionalities." << std::endl;
+    return;
+  }
+
+  replaceIcon(program, icon);
+}
+
+void DockPanel::onIconThemeChanged() {
+  for (const auto& item : items_) {
+    auto* iconItem = dynamic_cast<IconBasedDockItem*>(item.get());
+    if (iconItem == nullptr || iconItem->iconNames().isEmpty()) {
+      continue;
+    }
+
+    if (IconLoader::canLoadInBackground()) {
+      IconLoader::loadAsync(iconItem->iconNames(), iconLoadSize(), this,
+                            [this, iconItem](const QPixmap& icon) {
+                              onThemeIconLoaded(iconItem, icon);
+                            });
+    } else {
+      QPixmap icon;
+      for (const auto& iconName : iconItem->iconNames()) {
+        if (!iconName.isEmpty()) {
+          icon = loadIcon(iconName, iconLoadSize());
+        }
+        if (!icon.isNull()) {
+          break;
+        }
       }
-      return;
+      onThemeIconLoaded(iconItem, icon);
     }
   }
 }
 
-void DockPanel::updateTask(const WindowInfo* task) {
-  for (auto& item : items_) {
-    if (item->updateTask(task)) {
-      return;
+void DockPanel::onLauncherEntriesChanged(const QStringList& appIds) {
+  for (int i = 0; i < itemCount(); ++i) {
+    if (appIds.contains(items_[i]->getAppId(), Qt::CaseInsensitive) &&
+        items_[i]->updateLauncherEntry()) {
+      updateItem(items_[i].get());
     }
   }
 }
 
-bool DockPanel::isValidTask(const WindowInfo* task) {
-  if (task == nullptr) {
-    return false;
+void DockPanel::onThemeIconLoaded(IconBasedDockItem* item, const QPixmap& icon) {
+  // The item may have been removed while its icon was loading.
+  const bool isAlive = ranges::any_of(
+      items_, [item](const auto& other) { return other.get() == item; });
+  // Icons that look the same in the new theme are kept, with their rendered sizes.
+  if (isAlive && !icon.isNull() && !item->hasIcon(icon)) {
+    replaceIcon(item, icon);
   }
+}
 
-  if (task->skipTaskbar) {
-    return false;
+void DockPanel::replaceIcon(IconBasedDockItem* item, const QPixmap& icon) {
+  const int minWidth = item->getMinWidth();
+  const int minHeight = item->getMinHeight();
+  item->setIcon(icon);
+  if (item->getMinWidth() != minWidth || item->getMinHeight() != minHeight) {
+    resizeTaskManager();
+  } else {
+    updateItem(item);
   }
+}
 
-  if (WindowSystem::hasVirtualDesktopManager() && model_->currentDesktopTasksOnly()
-      && !task->onAllDesktops && task->desktop != WindowSystem::currentDesktop()) {
-    return false;
+void DockPanel::removeTask(void* window) {
+  if (removeTaskItem(window)) {
+    scheduleRelayout();
   }
+}
 
-  QRect taskGeometry(task->x, task->y, task->width, task->height);
-  if (model_->currentScreenTasksOnly() && taskGeometry.isValid()
-      && !screenGeometry_.intersects(taskGeometry)) {
+bool DockPanel::removeTaskItem(void* window) {
+  auto* item = findTaskItem(window);
+  if (item == nullptr || !item->removeTask(window)) {
     return false;
   }
 
-  if (WindowSystem::hasActivityManager() && !WindowSystem::currentActivity().empty()
-      && !task->activity.empty() && task->activity != WindowSystem::currentActivity()) {
+  taskItems_.erase(window);
+  if (!item->shouldBeRemoved()) {
+    updateItem(item);
     return false;
   }
 
+  auto it = ranges::find_if(items_, [item](const auto& e) { return e.get() == item; });
+  unindexTasks(item);
+  items_.erase(it);
   return true;
 }
 
+void DockPanel::updateTask(const WindowInfo* task) {
+  if (auto* item = findTaskItem(task->window)) {
+    item->updateTask(task);
+  }
+}
+
+bool DockPanel::isValidTask(const WindowInfo* task) {
+  return TaskTracker::self()->isValid(task, taskScreen());
+}
+
 bool DockPanel::hasTask(void* window) {
-  for (auto& item : items_) {
-    if (item->hasTask(window)) {
-      return true;
-    }
+  return taskItems_.contains(window);
+}
+
+DockItem* DockPanel::findTaskItem(void* window) const {
+  auto it = taskItems_.find(window);
+  return (it != taskItems_.end()) ? it->second : nullptr;
+}
+
+void DockPanel::unindexTasks(const DockItem* item) {
+  if (item == windowListProgram_) {
+    windowListProgram_ = nullptr;
   }
-  return false;
+  std::erase_if(taskItems_, [item](const auto& entry) { return entry.second == item; });
 }
 
 void DockPanel::initClock() {
   if (showClock_) {
-    items_.push_back(std::make_unique<Clock>(
-        this, model_, orientation_, minSize_, maxSize_));
+    auto clock = takeReusableItem<Clock>([](const auto&) { return true; });
+    items_.push_back(clock ? std::move(clock)
+                           : std::make_unique<Clock>(
+                                 this, model_, orientation_, minSize_, maxSize_));
   }
 }
 
 void DockPanel::initTrash() {
   if (showTrash_) {
-    items_.push_back(std::make_unique<Trash>(
-        this, model_, orientation_, minSize_, maxSize_));
+    auto trash = takeReusableItem<Trash>([](const auto&) { return true; });
+    items_.push_back(trash ? std::move(trash)
+                           : std::make_unique<Trash>(
+                                 this, model_, orientation_, minSize_, maxSize_));
   }
 }
 
 void DockPanel::initLayoutVars() {
+  RuntimeMetrics::setDockItemCount(dockId_, itemCount());
+  isZoomLayoutValid_ = false;
+  isMinimizedFrameValid_ = false;
   const auto spacingMultiplier = isMetal2D() ? kSpacingMultiplierMetal2D : kSpacingMultiplier;
   itemSpacing_ = std::round(minSize_* spacingMultiplier * spacingFactor_);
   margin3D_ = static_cast<int>(minSize_ * 0.6);
   floatingMargin_ = model_->floatingMargin();
   parabolicMaxX_ = std::round(2.5 * (minSize_ + itemSpacing_));
-  numAnimationSteps_ = 14;
-  animationSpeed_ = 16;
-
-  QFont font;
-  font.setPointSize(model_->tooltipFontSize());
-  font.setBold(true);
-  QFontMetrics metrics(font);
-  tooltipSize_ = metrics.boundingRect("Tooltip").height();
+  initZoomTable();
+  animationDurationMs_ = 224;
+  headroom_ = model_->bouncingLauncherIcon() ? Program::kBounceHeight : 0;
+
+  tooltipFont_ = QFont();
+  tooltipFont_.setPointSize(model_->tooltipFontSize());
+  tooltipFont_.setBold(true);
+  tooltip_.setFont(tooltipFont_);
+  QFontMetrics metrics(tooltipFont_);
+  tooltipFontHeight_ = metrics.height();
+  tooltipLabel_.clear();
+
+  badgeHeight_ = std::max(minSize_ * 3 / 8, 12);
+  badgeFont_ = QFont();
+  badgeFont_.setPixelSize(badgeHeight_ * 3 / 4);
+  badgeFont_.setBold(true);
+  for (auto& sprite : badgeSprites_) {
+    sprite = QPixmap();
+  }
 
   const int distance = minSize_ + itemSpacing_;
+  // The zoomed dock has to fit on the screen too.
+  const int maxDelta = parabolic(0) + 2 * parabolic(distance) +
+      2 * parabolic(2 * distance) - 5 * minSize_;
+  const int screenLength = isHorizontal() ? screenGeometry_.width() : screenGeometry_.height();
+  updateVisibleItems(screenLength > 0 ? screenLength - maxDelta : std::numeric_limits<int>::max(),
+                     isHorizontal() && isBottom() && is3D() ? itemSpacing_ + 2 * margin3D_
+                                                            : itemSpacing_);
+  const int numItems = visibleItemCount();
   // The difference between minWidth_ and maxWidth_
   // (horizontal mode) or between minHeight_ and
   // maxHeight_ (vertical mode).
   int delta = 0;
-  if (itemCount() >= 5) {
-    delta = parabolic(0) + 2 * parabolic(distance) +
-        2 * parabolic(2 * distance) - 5 * minSize_;
-  } else if (itemCount() == 4) {
+  if (numItems >= 5) {
+    delta = maxDelta;
+  } else if (numItems == 4) {
     delta = parabolic(0) + 2 * parabolic(distance) +
         parabolic(2 * distance) - 4 * minSize_;
-  } else if (itemCount() == 3) {
+  } else if (numItems == 3) {
     delta = parabolic(0) + 2 * parabolic(distance) - 3 * minSize_;
-  } else if (itemCount() == 2) {
+  } else if (numItems == 2) {
     delta = parabolic(0) + parabolic(distance) - 2 * minSize_;
-  } else if (itemCount() == 1) {
+  } else if (numItems == 1) {
     delta = parabolic(0) - minSize_;
   }
 
   if (orientation_ == Qt::Horizontal) {
     minWidth_ = itemSpacing_;
     if (isBottom() && is3D()) { minWidth_ += 2 * margin3D_; }
-    for (const auto& item : items_) {
+    for (const auto& item : visibleItems()) {
       minWidth_ += (item->getMinWidth() + itemSpacing_);
     }
     minBackgroundWidth_ = minWidth_;
     minHeight_ = minSize_ + 2 * itemSpacing_;
     minBackgroundHeight_ = minHeight_;
     maxWidth_ = minWidth_ + delta;
-    maxHeight_ = 2 * itemSpacing_ + maxSize_ + tooltipSize_;
+    maxHeight_ = 2 * itemSpacing_ + maxSize_ + headroom_;
     if (isFloating()) {
       maxHeight_ += 2 * floatingMargin_;
       minHeight_ += 2 * floatingMargin_;
@@ -1322,14 +2232,14 @@ void DockPanel::initLayoutVars() {
     }
   } else {  // Vertical
     minHeight_ = itemSpacing_;
-    for (const auto& item : items_) {
+    for (const auto& item : visibleItems()) {
       minHeight_ += (item->getMinHeight() + itemSpacing_);
     }
     minBackgroundHeight_ = minHeight_;
     minWidth_ = minSize_ + 2 * itemSpacing_;
     minBackgroundWidth_ = minWidth_;
     maxHeight_ = minHeight_ + delta;
-    maxWidth_ = 2 * itemSpacing_ + maxSize_ + tooltipSize_;
+    maxWidth_ = 2 * itemSpacing_ + maxSize_ + headroom_;
     if (isFloating()) {
       maxWidth_ += 2 * floatingMargin_;
       minWidth_ += 2 * floatingMargin_;
@@ -1339,6 +2249,90 @@ void DockPanel::initLayoutVars() {
   resize(maxWidth_, maxHeight_);
 }
 
+void DockPanel::updateVisibleItems(int maxLength, int baseLength) {
+  const int n = itemCount();
+  const auto length = [this](int i) {
+    return (isHorizontal() ? items_[i]->getMinWidth() : items_[i]->getMinHeight()) +
+        itemSpacing_;
+  };
+  const int oldFirst = firstVisibleItem_;
+  const int oldLast = std::min(firstVisibleItem_ + visibleItemCount_, n) - 1;
+
+  int total = baseLength;
+  for (int i = 0; i < n && total <= maxLength; ++i) {
+    total += length(i);
+  }
+  int first = 0;
+  int last = n - 1;
+  isOverflowing_ = n > 0 && total > maxLength;
+  if (isOverflowing_) {
+    // Fills the dock from firstVisibleItem_ on, then backwards if the last item is reached.
+    first = last = std::clamp(firstVisibleItem_, 0, n - 1);
+    total = baseLength + length(first);
+    while (last < n - 1 && total + length(last + 1) <= maxLength) {
+      total += length(++last);
+    }
+    while (first > 0 && total + length(first - 1) <= maxLength) {
+      total += length(--first);
+    }
+  }
+  firstVisibleItem_ = first;
+  visibleItemCount_ = last - first + 1;
+
+  for (int i = oldFirst; i <= oldLast; ++i) {
+    if (i < first || i > last) {
+      items_[i]->trimCaches();
+    }
+  }
+}
+
+void DockPanel::scrollItems(int delta) {
+  if (!isOverflowing_ || isAnimationActive_) {
+    return;
+  }
+
+  const int first = std::clamp(firstVisibleItem_ + delta, 0, itemCount() - visibleItemCount());
+  if (first == firstVisibleItem_) {
+    return;
+  }
+
+  firstVisibleItem_ = first;
+  initLayoutVars();
+  if (isMinimized_) {
+    updateLayout();
+  } else {
+    relayoutAtMouse();
+  }
+}
+
+void DockPanel::relayoutAtMouse() {
+  // For the items' minCenter_, which the zoom layout is based on.
+  if (isHorizontal()) {
+    layoutMinimized<Qt::Horizontal>();
+  } else {
+    layoutMinimized<Qt::Vertical>();
+  }
+  updateLayout(mouseX_, mouseY_);
+}
+
+void DockPanel::updateHoverScroll() {
+  int direction = 0;
+  if (isOverflowing_ && !isMinimized_ && !isShowingPopup_ && activeItem_ >= 0) {
+    if (activeItem_ == firstVisibleItem() && activeItem_ > 0) {
+      direction = -1;
+    } else if (activeItem_ == lastVisibleItem() && activeItem_ < itemCount() - 1) {
+      direction = 1;
+    }
+  }
+
+  hoverScrollDirection_ = direction;
+  if (direction == 0) {
+    hoverScrollTimer_.stop();
+  } else if (!hoverScrollTimer_.isActive()) {
+    hoverScrollTimer_.start();
+  }
+}
+
 QRect DockPanel::getMinimizedDockGeometry() {
   QRect dockGeometry;
   dockGeometry.setX(
@@ -1358,9 +2352,97 @@ QRect DockPanel::getMinimizedDockGeometry() {
   return dockGeometry;
 }
 
+template <Qt::Orientation kOrientation>
+void DockPanel::layoutMinimized() {
+  constexpr bool kHorizontal = kOrientation == Qt::Horizontal;
+  const bool atOrigin = kHorizontal ? isTop() : isLeft();
+  const int cross = itemSpacing_ + (isFloating() ? floatingMargin_ : 0) +
+      (atOrigin ? 0 : kHorizontal ? maxHeight_ - minHeight_ : maxWidth_ - minWidth_);
+  int pos = kHorizontal
+      ? itemSpacing_ + (maxWidth_ - minWidth_) / 2 + (isBottom() && is3D() ? margin3D_ : 0)
+      : itemSpacing_ + (maxHeight_ - minHeight_) / 2;
+  for (const auto& item : visibleItems()) {
+    const int length = kHorizontal ? item->getMinWidth() : item->getMinHeight();
+    item->size_ = minSize_;
+    if constexpr (kHorizontal) {
+      item->left_ = pos;
+      item->top_ = cross;
+    } else {
+      item->left_ = cross;
+      item->top_ = pos;
+    }
+    item->minCenter_ = pos + length / 2;
+    pos += length + itemSpacing_;
+  }
+}
+
+template <Qt::Orientation kOrientation>
+void DockPanel::layoutZoomed(int pos, int begin, int end, int first, int last) {
+  constexpr bool kHorizontal = kOrientation == Qt::Horizontal;
+  // Items are aligned to the screen edge, so away from the origin their cross-axis
+  // position goes down as their size goes up.
+  const bool atOrigin = kHorizontal ? isTop() : isLeft();
+  const int crossBase = itemSpacing_ + (isFloating() ? floatingMargin_ : 0) +
+      (atOrigin ? 0 : headroom_ + maxSize_);
+  const int crossSign = atOrigin ? 0 : 1;
+  const int spacing = itemSpacing_;
+  const int minSize = minSize_;
+  const int* minCenters = itemGeometry_.minCenters.data();
+  int* sizes = itemGeometry_.sizes.data();
+  int* positions = itemGeometry_.positions.data();
+  const int* lengths = itemGeometry_.lengths.data();
+  const int numSizes = itemGeometry_.numSizes;
+  const int* zoomTable = zoomTable_.data();
+  const int zoomTableSize = static_cast<int>(zoomTable_.size());
+  // The indices are of the shown items.
+  const int offset = firstVisibleItem();
+  const auto length = [=](int i) { return lengths[i * numSizes + sizes[i] - minSize]; };
+
+  for (int i = begin; i <= end; ++i) {
+    const int distance = std::abs(minCenters[i] - pos);
+    sizes[i] = distance < zoomTableSize ? zoomTable[distance] : minSize;
+  }
+
+  for (int i = begin; i < first; ++i) {
+    positions[i] = zoomStartPos_[i];
+  }
+  for (int i = last + 1; i <= end; ++i) {
+    positions[i] = zoomEndPos_[i];
+  }
+  if (first == 0 && last < visibleItemCount() - 1) {
+    // Aligns the zoom window with the items after it.
+    for (int i = last; i >= first; --i) {
+      positions[i] = positions[i + 1] - length(i) - spacing;
+    }
+  } else {
+    // Aligns the zoom window with the items before it.
+    for (int i = first; i <= last; ++i) {
+      positions[i] = (i == 0) ? zoomStartPos_[0] : positions[i - 1] + length(i - 1) + spacing;
+    }
+  }
+
+  for (int i = begin; i <= end; ++i) {
+    auto& item = *items_[offset + i];
+    item.size_ = sizes[i];
+    const int cross = crossBase - crossSign * sizes[i];
+    if constexpr (kHorizontal) {
+      item.left_ = positions[i];
+      item.top_ = cross;
+    } else {
+      item.left_ = cross;
+      item.top_ = positions[i];
+    }
+  }
+}
+
 void DockPanel::updateLayout() {
+  MetricsScope metrics(RuntimeMetrics::Counter::Layouts, RuntimeMetrics::Histogram::Layout);
+  // A pointer position from before minimizing would zoom the dock again.
+  isPointerPending_ = false;
+  isZoomLayoutValid_ = false;
+  isMinimizedFrameValid_ = false;
   if (isLeaving_) {
-    for (const auto& item : items_) {
+    for (const auto& item : visibleItems()) {
       item->setAnimationStartAsCurrent();
       if (isHorizontal()) {
         startBackgroundWidth_ = backgroundWidth_;
@@ -1372,36 +2454,21 @@ void DockPanel::updateLayout() {
     }
   }
 
-  for (int i = 0; i < itemCount(); ++i) {
-    items_[i]->size_ = minSize_;
-    if (isHorizontal()) {
-      items_[i]->left_ =
-          (i == 0) ? isBottom() && is3D() ? itemSpacing_ + (maxWidth_ - minWidth_) / 2 + margin3D_
-                                          : itemSpacing_ + (maxWidth_ - minWidth_) / 2
-                   : items_[i - 1]->left_ + items_[i - 1]->getMinWidth() + itemSpacing_;
-      items_[i]->top_ = isTop() ? itemSpacing_
-                                : itemSpacing_ + maxHeight_ - minHeight_;
-      if (isFloating()) { items_[i]->top_ += floatingMargin_; }
-      items_[i]->minCenter_ = items_[i]->left_ + items_[i]->getMinWidth() / 2;
-    } else {  // Vertical
-      items_[i]->left_ = isLeft() ? itemSpacing_
-                                  : itemSpacing_ + maxWidth_ - minWidth_;
-      if (isFloating()) { items_[i]->left_ += floatingMargin_; }
-      items_[i]->top_ = (i == 0) ? itemSpacing_ + (maxHeight_ - minHeight_) / 2
-          : items_[i - 1]->top_ + items_[i - 1]->getMinHeight() + itemSpacing_;
-      items_[i]->minCenter_ = items_[i]->top_ + items_[i]->getMinHeight() / 2;
-    }
+  if (isHorizontal()) {
+    layoutMinimized<Qt::Horizontal>();
+  } else {
+    layoutMinimized<Qt::Vertical>();
   }
 
   backgroundWidth_ = minBackgroundWidth_;
   backgroundHeight_ = minBackgroundHeight_;
 
   if (isLeaving_) {
-    for (const auto& item : items_) {
+    for (const auto& item : visibleItems()) {
       item->endSize_ = item->size_;
       item->endLeft_ = item->left_;
       item->endTop_ = item->top_;
-      item->startAnimation(numAnimationSteps_);
+      item->startAnimation();
     }
 
     endBackgroundWidth_ = minBackgroundWidth_;
@@ -1409,112 +2476,93 @@ void DockPanel::updateLayout() {
     endBackgroundHeight_ = minBackgroundHeight_;
     backgroundHeight_ = startBackgroundHeight_;
 
-    currentAnimationStep_ = 0;
+    animationStartMs_ = animationClock_.elapsed();
+    animationEndMs_ = animationStartMs_ + animationDurationMs_;
     isAnimationActive_ = true;
-    animationTimer_->start(32 - animationSpeed_);
+    requestAnimationFrame();
   } else {
     WindowSystem::setLayer(this,
                            visibility_ == PanelVisibility::AlwaysVisible
                                ? LayerShellQt::Window::LayerBottom
                                : LayerShellQt::Window::LayerTop);
     isMinimized_ = true;
-    if (autoHide()) { isHidden_ = true; }
-    if (intellihide()) { isHidden_ = intellihideShouldHide(); }
+    if (autoHide()) { setHidden(true); }
+    if (intellihide()) { setHidden(intellihideShouldHide()); }
     update();
     // Here we have to wait a bit before setMask() to avoid visual artifacts.
-    QTimer::singleShot(500, [this]{ setMask(); });
+    QTimer::singleShot(500, this, [this]{ setMask(); });
   }
 }
 
 void DockPanel::updateLayout(int x, int y) {
-  if (isEntering_) {
-    for (const auto& item : items_) {
-      item->startSize_ = item->size_;
-      item->startLeft_ = item->left_;
-      item->startTop_ = item->top_;
-    }
-    startBackgroundWidth_ = minBackgroundWidth_;
-    startBackgroundHeight_ = minBackgroundHeight_;
+  PROFILE_SCOPE("DockPanel::updateLayout(x, y)");
+  MetricsScope metrics(RuntimeMetrics::Counter::Layouts, RuntimeMetrics::Histogram::Layout);
+  if (items_.empty()) {
+    return;
   }
 
-  int first_update_index = -1;
-  int last_update_index = 0;
-  if (isHorizontal()) {
-    items_[0]->left_ = isBottom() && is3D() ? itemSpacing_ + margin3D_
-                                            : itemSpacing_;
-  } else {  // Vertical
-    items_[0]->top_ = itemSpacing_;
-  }
-  for (int i = 0; i < itemCount(); ++i) {
-    int delta;
-    if (isHorizontal()) {
-      delta = std::abs(items_[i]->minCenter_ - x);
-    } else {  // Vertical
-      delta = std::abs(items_[i]->minCenter_ - y);
-    }
-    if (delta < parabolicMaxX_) {
-      if (first_update_index == -1) {
-        first_update_index = i;
-      }
-      last_update_index = i;
-    }
-    items_[i]->size_ = parabolic(delta);
-    if (isHorizontal()) {
-      items_[i]->top_ = isTop() ? itemSpacing_
-                                : itemSpacing_ + tooltipSize_ + maxSize_ - items_[i]->size_;
-      if (isFloating()) { items_[i]->top_ += floatingMargin_; }
-    } else {  // Vertical
-      items_[i]->left_ = isLeft() ? itemSpacing_
-                                  : itemSpacing_ + tooltipSize_ + maxSize_ - items_[i]->size_;
-      if (isFloating()) { items_[i]->left_ += floatingMargin_; }
-    }
-    if (i > 0) {
-      if (isHorizontal()) {
-        items_[i]->left_ = items_[i - 1]->left_ + items_[i - 1]->getWidth()
-            + itemSpacing_;
-      } else {  // Vertical
-        items_[i]->top_ = items_[i - 1]->top_ + items_[i - 1]->getHeight()
-            + itemSpacing_;
-      }
+  // While the zoom animation runs the items are between two layouts, so the layout for the
+  // pointer is computed in full and becomes the new target, animated to from where the items
+  // are now.
+  const bool isRetargeting = isAnimationActive_ && !isEntering_;
+  if (isEntering_ || isRetargeting) {
+    for (const auto& item : visibleItems()) {
+      item->setAnimationStartAsCurrent();
     }
-  }
-
-  if (first_update_index == -1) {
+    startBackgroundWidth_ = isEntering_ ? minBackgroundWidth_ : backgroundWidth_;
+    startBackgroundHeight_ = isEntering_ ? minBackgroundHeight_ : backgroundHeight_;
+  }
+
+  // Only the items within the zoom window (parabolicMaxX_ from the mouse) change size.
+  // Items before/after it are at fixed positions (see initZoomLayout()), so we only need to
+  // update the items in the current and the previous zoom windows.
+  const int pos = isHorizontal() ? x : y;
+  // Only the old and new bounds of the updated items and the tooltip need repainting, unless
+  // the whole layout changes.
+  const bool fullRepaint = !isZoomLayoutValid_ || isEntering_ || isRetargeting || isMinimized_
+      || isHidden_;
+  if (fullRepaint) {
+    initZoomLayout();
+  }
+  // Items are ordered by minCenter_. The indices are of the shown items, from offset on.
+  const int offset = firstVisibleItem();
+  const int numItems = visibleItemCount();
+  const auto& minCenters = itemGeometry_.minCenters;
+  int first_update_index = ranges::lower_bound(minCenters, pos - parabolicMaxX_ + 1)
+      - minCenters.begin();
+  int last_update_index = ranges::lower_bound(minCenters, pos + parabolicMaxX_)
+      - minCenters.begin() - 1;
+  if (first_update_index > last_update_index) {
     if ((isHorizontal() && x < maxWidth_ / 2) || (!isHorizontal() && y < maxHeight_ / 2)) {
       first_update_index = last_update_index = 0;
     } else {
-      first_update_index = last_update_index = itemCount() - 1;
+      first_update_index = last_update_index = numItems - 1;
     }
   }
 
-  for (int i = itemCount() - 1; i >= last_update_index + 1; --i) {
-    if (isHorizontal()) {
-      items_[i]->left_ = (i == itemCount() - 1)
-          ? isBottom() && is3D() ? maxWidth_ - itemSpacing_ - items_[i]->getMinWidth() - margin3D_
-                                 : maxWidth_ - itemSpacing_ - items_[i]->getMinWidth()
-          : items_[i + 1]->left_ - items_[i]->getMinWidth() - itemSpacing_;
-    } else {  // Vertical
-      items_[i]->top_ = (i == itemCount() - 1)
-          ? maxHeight_ - itemSpacing_ - items_[i]->getMinHeight()
-          : items_[i + 1]->top_ - items_[i]->getMinHeight() - itemSpacing_;
+  int begin = 0;
+  int end = numItems - 1;
+  QRegion damage;
+  if (!fullRepaint) {
+    begin = std::min(first_update_index, zoomFirstIndex_);
+    end = std::max(last_update_index, zoomLastIndex_);
+    for (int i = begin; i <= end; ++i) {
+      damage += itemDamageRect(offset + i);
     }
   }
-  if (first_update_index == 0 && last_update_index < itemCount() - 1) {
-    for (int i = last_update_index; i >= first_update_index; --i) {
-      if (isHorizontal()) {
-        items_[i]->left_ = items_[i + 1]->left_ - items_[i]->getWidth()
-            - itemSpacing_;
-      } else {  // Vertical
-        items_[i]->top_ = items_[i + 1]->top_ - items_[i]->getHeight()
-            - itemSpacing_;
-      }
-    }
+  zoomFirstIndex_ = first_update_index;
+  zoomLastIndex_ = last_update_index;
+
+  if (isHorizontal()) {
+    layoutZoomed<Qt::Horizontal>(pos, begin, end, first_update_index, last_update_index);
+  } else {
+    layoutZoomed<Qt::Vertical>(pos, begin, end, first_update_index, last_update_index);
   }
 
-  if (isEntering_) {
-    for (const auto& item : items_) {
+  if (isEntering_ || isRetargeting) {
+    for (const auto& item : visibleItems()) {
       item->setAnimationEndAsCurrent();
-      item->startAnimation(numAnimationSteps_);
+      item->startAnimation();
     }
     if (isHorizontal()) {
       endBackgroundWidth_ = maxWidth_;
@@ -1528,10 +2576,20 @@ void DockPanel::updateLayout(int x, int y) {
       backgroundWidth_ = startBackgroundWidth_;
     }
 
-    currentAnimationStep_ = 0;
+    const qint64 now = animationClock_.elapsed();
+    if (isEntering_) {
+      animationEndMs_ = now + animationDurationMs_;
+    } else if (isLeaving_) {
+      // The pointer is back: zoom in again, taking as long as the zoom out has taken so far.
+      isLeaving_ = false;
+      const qint64 elapsedMs = now - animationStartMs_;
+      animationEndMs_ = now + std::min<qint64>(elapsedMs, animationDurationMs_);
+    }
+    // Otherwise the animation keeps its end time, so moving doesn't prolong it.
+    animationStartMs_ = now;
     isAnimationActive_ = true;
     isEntering_ = false;
-    animationTimer_->start(32 - animationSpeed_);
+    requestAnimationFrame();
   }
 
   mouseX_ = x;
@@ -1540,10 +2598,71 @@ void DockPanel::updateLayout(int x, int y) {
   //resize(maxWidth_, maxHeight_);
   WindowSystem::setLayer(this, LayerShellQt::Window::LayerTop);
   isMinimized_ = false;
-  if (autoHide() || intellihide()) { isHidden_ = false; }
+  if (autoHide() || intellihide()) { setHidden(false); }
   setMask();
   updateActiveItem(x, y);
-  update();
+  updateHoverScroll();
+  if (fullRepaint) {
+    update();
+  } else {
+    for (int i = begin; i <= end; ++i) {
+      damage += itemDamageRect(offset + i);
+    }
+    update(damage);
+  }
+  updateTooltip();
+}
+
+void DockPanel::initZoomLayout() {
+  // Only the shown items are laid out.
+  const int offset = firstVisibleItem();
+  const int n = visibleItemCount();
+  zoomStartPos_.resize(n);
+  zoomEndPos_.resize(n);
+  for (int i = 0; i < n; ++i) {
+    if (isHorizontal()) {
+      zoomStartPos_[i] = (i == 0)
+          ? isBottom() && is3D() ? itemSpacing_ + margin3D_ : itemSpacing_
+          : zoomStartPos_[i - 1] + items_[offset + i - 1]->getMinWidth() + itemSpacing_;
+    } else {  // Vertical
+      zoomStartPos_[i] = (i == 0)
+          ? itemSpacing_
+          : zoomStartPos_[i - 1] + items_[offset + i - 1]->getMinHeight() + itemSpacing_;
+    }
+  }
+  for (int i = n - 1; i >= 0; --i) {
+    if (isHorizontal()) {
+      const int width = items_[offset + i]->getMinWidth();
+      zoomEndPos_[i] = (i == n - 1)
+          ? isBottom() && is3D() ? maxWidth_ - itemSpacing_ - width - margin3D_
+                                 : maxWidth_ - itemSpacing_ - width
+          : zoomEndPos_[i + 1] - width - itemSpacing_;
+    } else {  // Vertical
+      zoomEndPos_[i] = (i == n - 1)
+          ? maxHeight_ - itemSpacing_ - items_[offset + i]->getMinHeight()
+          : zoomEndPos_[i + 1] - items_[offset + i]->getMinHeight() - itemSpacing_;
+    }
+  }
+
+  // Sizes are always in [minSize_, maxSize_], see initZoomTable().
+  auto& geometry = itemGeometry_;
+  geometry.numSizes = maxSize_ - minSize_ + 1;
+  geometry.minCenters.resize(n);
+  geometry.sizes.resize(n);
+  geometry.positions.resize(n);
+  geometry.lengths.resize(n * geometry.numSizes);
+  for (int i = 0; i < n; ++i) {
+    const auto& item = items_[offset + i];
+    geometry.minCenters[i] = item->minCenter_;
+    geometry.sizes[i] = std::clamp(item->size_, minSize_, maxSize_);
+    geometry.positions[i] = isHorizontal() ? item->left_ : item->top_;
+    int* lengths = &geometry.lengths[i * geometry.numSizes];
+    for (int size = minSize_; size <= maxSize_; ++size) {
+      lengths[size - minSize_] = isHorizontal() ? item->getWidthForSize(size)
+                                                : item->getHeightForSize(size);
+    }
+  }
+  isZoomLayoutValid_ = true;
 }
 
 void DockPanel::resizeTaskManager() {
@@ -1553,6 +2672,10 @@ void DockPanel::resizeTaskManager() {
   if (isMinimized_) {
     updateLayout();
     return;
+  } else if (isOverflowing_) {
+    // The shown items may have changed.
+    relayoutAtMouse();
+    return;
   } else {
     // Need to call QWidget::resize(), not DockPanel::resize(), in order not to
     // mess up the zooming.
@@ -1599,11 +2722,11 @@ void DockPanel::resizeTaskManager() {
     items_[i]->size_ = parabolic(delta);
     if (isHorizontal()) {
       items_[i]->top_ = isTop() ? itemSpacing_
-                                : itemSpacing_ + tooltipSize_ + maxSize_ - items_[i]->getHeight();
+                                : itemSpacing_ + headroom_ + maxSize_ - items_[i]->getHeight();
       if (isFloating()) { items_[i]->top_ += floatingMargin_; }
     } else {  // Vertical
       items_[i]->left_ = isLeft() ? itemSpacing_
-                                  : itemSpacing_ + tooltipSize_ + maxSize_ - items_[i]->getWidth();
+                                  : itemSpacing_ + headroom_ + maxSize_ - items_[i]->getWidth();
       if (isFloating()) { items_[i]->left_ += floatingMargin_; }
     }
     if (i > 0) {
@@ -1655,20 +2778,25 @@ void DockPanel::setStrut(int width) {
 }
 
 void DockPanel::setMask() {
+  QRect rect(0, 0, maxWidth_, maxHeight_);
   if (isMinimized_) {
     if (isHorizontal()) {
       const int x = (maxWidth_ - minWidth_) / 2;
       const int h = !WindowSystem::hasAutoHideManager() && isHidden_ ? 1 : minHeight_;
       const int y = isTop() ? 0 : maxHeight_ - h;
-      QWidget::setMask(QRegion(x, y, minWidth_, h));
+      rect = QRect(x, y, minWidth_, h);
     } else {  // Vertical.
       const int y = (maxHeight_ - minHeight_) / 2;
       const int w = !WindowSystem::hasAutoHideManager() && isHidden_ ? 1 : minWidth_;
       const int x = isLeft() ? 0 : maxWidth_ - w;
-      QWidget::setMask(QRegion(x, y, w, minHeight_));
+      rect = QRect(x, y, w, minHeight_);
     }
-  } else {
-    QWidget::setMask(QRegion(0, 0, maxWidth_, maxHeight_));
+  }
+  // Each new mask is an input region request plus a surface commit, so hovering
+  // mustn't send the same one again.
+  const QRegion region(rect);
+  if (mask() != region) {
+    QWidget::setMask(region);
   }
 }
 
@@ -1686,8 +2814,21 @@ void DockPanel::updatePosition(PanelPosition position) {
   saveDockConfig();
 }
 
+void DockPanel::onDockConfigChanged(int dockId) {
+  if (dockId_ != dockId) {
+    return;
+  }
+  loadDockConfig();
+  // Otherwise reloaded right after, by the same commit.
+  if (!model_->isCommittingReload()) {
+    reload();
+  }
+  setAutoHide(autoHide() || intellihideShouldHide());
+}
+
 void DockPanel::updateVisibility(PanelVisibility visibility) {
   setVisibility(visibility);
+  isCoveringWindowsValid_ = false;
   setStrut();
   setAutoHide(autoHide() || intellihideShouldHide());
   saveDockConfig();
@@ -1696,7 +2837,7 @@ void DockPanel::updateVisibility(PanelVisibility visibility) {
 void DockPanel::setAutoHide(bool on) {
   if (!WindowSystem::hasAutoHideManager()) {
     if (intellihide() && isHidden_ != on) {
-      isHidden_ = on;
+      setHidden(on);
       repaint();
       setMask();
     }
@@ -1721,23 +2862,45 @@ void DockPanel::setAutoHide(bool on) {
   WindowSystem::setAutoHide(this, edge, on);
 }
 
-void DockPanel::updateActiveItem(int x, int y) {
-  int i = 0;
-  while (i < itemCount() &&
-      ((orientation_ == Qt::Horizontal && items_[i]->left_ < x) ||
-      (orientation_ == Qt::Vertical && items_[i]->top_ < y))) {
-    ++i;
+void DockPanel::setHidden(bool hidden) {
+  isHidden_ = hidden;
+  if (hidden) {
+    tooltip_.hide();
   }
-  activeItem_ = i - 1;
+  // Nothing periodic needs to run while the dock can't be seen.
+  Scheduler::self()->setSuspended(this, hidden);
+  updateTrimTimer();
+}
+
+void DockPanel::updateActiveItem(int x, int y) {
+  // The last item that starts before the mouse, positions being in increasing order.
+  const auto& positions = itemGeometry_.positions;
+  const int i = ranges::lower_bound(positions, isHorizontal() ? x : y) - positions.begin() - 1;
+  activeItem_ = (i >= 0) ? firstVisibleItem() + i : -1;
 }
 
 int DockPanel::parabolic(int x) {
   // Assume x >= 0.
-  if (x > parabolicMaxX_) {
-    return minSize_;
-  } else {
-    return maxSize_ -
-        (x * x * (maxSize_ - minSize_)) / (parabolicMaxX_ * parabolicMaxX_);
+  return (x < static_cast<int>(zoomTable_.size())) ? zoomTable_[x] : minSize_;
+}
+
+void DockPanel::initZoomTable() {
+  const ZoomCurve curve = model_->zoomCurve();
+  zoomTable_.resize(parabolicMaxX_ + 1);
+  for (int x = 0; x <= parabolicMaxX_; ++x) {
+    const double t = static_cast<double>(x) / parabolicMaxX_;
+    switch (curve) {
+      case ZoomCurve::Cosine:
+        zoomTable_[x] = minSize_ + std::round((maxSize_ - minSize_) * cosineCurve(t));
+        break;
+      case ZoomCurve::Gaussian:
+        zoomTable_[x] = minSize_ + std::round((maxSize_ - minSize_) * gaussianCurve(t));
+        break;
+      default:  // Parabolic.
+        zoomTable_[x] = maxSize_ -
+            (x * x * (maxSize_ - minSize_)) / (parabolicMaxX_ * parabolicMaxX_);
+        break;
+    }
   }
 }
 
@@ -19,26 +19,44 @@
 #ifndef CRYSTALDOCK_DOCK_PANEL_H_
 #define CRYSTALDOCK_DOCK_PANEL_H_
 
+#include <algorithm>
+#include <cmath>
 #include <memory>
+#include <span>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <QAction>
 #include <QDragEnterEvent>
 #include <QDragMoveEvent>
 #include <QDropEvent>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QFont>
+#include <QImage>
 #include <QMenu>
 #include <QMessageBox>
 #include <QMouseEvent>
 #include <QPaintEvent>
+#include <QPixmap>
 #include <QPoint>
+#include <QPointer>
 #include <QRect>
+#include <QRegion>
 #include <QSize>
 #include <QString>
+#include <QStringList>
 #include <QTimer>
+#include <QWheelEvent>
 #include <QWidget>
+#include <QWindow>
 
 #include <display/window_system.h>
 #include <model/multi_dock_model.h>
+#include <model/task_tracker.h>
+#include <utils/runtime_metrics.h>
+#include <utils/scheduler.h>
 
 #include "add_panel_dialog.h"
 #include "application_menu_settings_dialog.h"
@@ -46,12 +64,14 @@
 #include "dock_item.h"
 #include "edit_launchers_dialog.h"
 #include "task_manager_settings_dialog.h"
+#include "tooltip.h"
 #include "trash.h"
 #include "wallpaper_settings_dialog.h"
 
 namespace crystaldock {
 
 class MultiDockView;
+class Program;
 
 // A dock panel. The user can have multiple dock panels at the same time.
 class DockPanel : public QWidget {
@@ -59,6 +79,8 @@ class DockPanel : public QWidget {
 
  public:
   static constexpr int kIconLoadSize = 128;
+  // Icon load size at high output scales is capped at this.
+  static constexpr int kMaxIconLoadSize = 512;
   // For certain actions like Lock Screen, we need to delay execution for a bit
   // to avoid graphical issues.
   static constexpr int kExecutionDelayMs = 300;
@@ -69,18 +91,27 @@ class DockPanel : public QWidget {
   static constexpr int kIndicatorSizeMetal2D = 8;
   static constexpr int kIndicatorSpacing = 3;
   static constexpr int kIndicatorMarginGlass2D = 4;
+  // Larger counts are shown as e.g. 99+ in the count badges.
+  static constexpr int kMaxBadgeCount = 99;
   static constexpr float kSpacingMultiplier = 0.5;  // for Glass 2D/3D and Flat 2D.
   static constexpr float kSpacingMultiplierMetal2D = 0.33;
 
   // No pointer ownership.
   DockPanel(MultiDockView* parent, MultiDockModel* model, int dockId);
-  virtual ~DockPanel() = default;
+  virtual ~DockPanel() {
+    Scheduler::self()->removeGroup(this);
+    RuntimeMetrics::removeDock(dockId_);
+  }
 
   int dockId() const { return dockId_; }
   PanelPosition position() const { return position_; }
 
   QRect screenGeometry() { return screenGeometry_; }
 
+  // Whether the dock's screen has been unplugged. The dock is hidden until the screen
+  // is plugged in again.
+  bool isSuspended() const { return isSuspended_; }
+
   void addPanelSettings(QMenu* menu);
 
   int itemSpacing() { return itemSpacing_; }
@@ -111,19 +142,59 @@ class DockPanel : public QWidget {
   // position of task indicators, y-coordinate if horizontal, x if vertical.
   int taskIndicatorPos();
 
+  // Draws a task indicator centered at x if horizontal, or y if vertical, at
+  // taskIndicatorPos(), from pre-rendered sprites.
+  void drawTaskIndicator(int x, int y, bool active, const DrawContext& context,
+                         QPainter* painter);
+
+  // Draws a count badge with its top-right corner at (right, top), from pre-rendered
+  // sprites and text.
+  void drawBadge(int right, int top, qint64 count, QPainter* painter);
+
   // Gets number of items for an application. Useful when Group Tasks By Application is Off.
   int itemCount(const QString& appId);
 
   // Update pinned status of an application. Useful when Group Tasks By Application is Off.
   void updatePinnedStatus(const QString& appId, bool pinned);
 
+  // Repaints only the area of the item, e.g. when the clock ticks.
+  void updateItem(const DockItem* item);
+
+  // Scale of the output that the dock is on, icons being rendered at physical pixels.
+  qreal iconScale() const { return iconScale_; }
+
+  // Size to load the source icons at, for the output scale.
+  int iconLoadSize() const { return iconLoadSizeFor(iconScale_); }
+
+  // The scale of the screen, which the icons are loaded for until the dock is shown and
+  // knows the scale of its output.
+  static qreal screenIconScale(int screen) {
+    const auto& screens = WindowSystem::screens();
+    return (screen >= 0 && screen < static_cast<int>(screens.size()))
+        ? screens[screen]->devicePixelRatio() : 1.0;
+  }
+
+  static int iconLoadSizeFor(qreal iconScale) {
+    return std::clamp(static_cast<int>(std::ceil(kIconLoadSize * iconScale)), kIconLoadSize,
+                      kMaxIconLoadSize);
+  }
+
   // Sets whether the dock is showing some popup menu.
   void setShowingPopup(bool showingPopup);
 
+  // Sets the program whose window list is shown, or nullptr once it's closed.
+  void setWindowListProgram(Program* program) { windowListProgram_ = program; }
+
  public slots:
   // Reloads the items and updates the dock.
   void reload();
 
+  // Re-reads the appearance config and updates the layout, keeping the items.
+  void relayout();
+
+  // Re-reads the appearance config and repaints, e.g. after a color change.
+  void updateAppearance();
+
   // Checks that the items are still valid, removes an invalid one and updates the dock.
   // Should be called after a program with no task is unpinned.
   // Will return as soon as an invalid one is found.
@@ -133,12 +204,18 @@ class DockPanel : public QWidget {
   void onCurrentDesktopChanged();
   void onCurrentActivityChanged();
 
+  void onScreenAdded(const QString& name);
+  void onScreenRemoved(const QString& name);
+
   void onDockLaunchersChanged(int dockId) {
     if (dockId_ == dockId) {
       reload();
     }
   }
 
+  // Applies the dock's config after it has been changed from outside the dock.
+  void onDockConfigChanged(int dockId);
+
   void setStrut();
 
   void updatePosition(PanelPosition position);
@@ -173,7 +250,7 @@ class DockPanel : public QWidget {
   }
 
   void toggleTaskManager() {
-    model_->setShowTaskManager(dockId_, taskManagerAction_->isChecked());
+    model_->setShowTaskManager(dockId_, !showTaskManager());
     reload();
     saveDockConfig();
   }
@@ -197,8 +274,9 @@ class DockPanel : public QWidget {
   // Moves the dock to the new screen.
   void changeScreen(int screen);
 
-  // Slot to update zoom animation.
-  void updateAnimation();
+  // Schedules a repaint on the compositor's next frame callback, advancing all running
+  // animations right before it. Requests within the same frame are coalesced.
+  void requestAnimationFrame();
 
   void showOnlineDocumentation();
 
@@ -222,25 +300,43 @@ class DockPanel : public QWidget {
   void onWindowLeftCurrentDesktop(void* window);
   void onWindowLeftCurrentActivity(void* window);
   void onWindowGeometryChanged(const WindowInfo* task);
+  void onTaskEntered(const WindowInfo* task, TaskTracker::ScreenMask screens);
+  void onTaskLeft(void* window);
+  void onTaskScreensChanged(const WindowInfo* task, TaskTracker::ScreenMask oldScreens,
+                            TaskTracker::ScreenMask newScreens);
   void onWindowStateChanged(const WindowInfo* info);
   void onWindowTitleChanged(const WindowInfo* info);
-  void onActiveWindowChanged();
+  void onActiveWindowChanged(void* window);
 
   void minimize() { leaveEvent(nullptr); }
 
  protected:
+  // Renders the icons again when the output scale changes.
+  virtual bool event(QEvent* e) override;
   virtual void paintEvent(QPaintEvent* e) override;
   virtual void mouseMoveEvent(QMouseEvent* e) override;
   virtual void mousePressEvent(QMouseEvent* e) override;
   virtual void enterEvent(QEnterEvent* e) override;
   virtual void leaveEvent(QEvent* e) override;
+  virtual void wheelEvent(QWheelEvent* e) override;
   virtual void dragEnterEvent(QDragEnterEvent* e) override;
   virtual void dragMoveEvent(QDragMoveEvent* e) override;
   virtual void dropEvent(QDropEvent* e) override;
+  // Advances the animations on the window's frame-paced update requests.
+  virtual bool eventFilter(QObject* watched, QEvent* e) override;
 
  private:
-  // The space between the tooltip and the dock.
+  // The space between the tooltip and the items.
   static constexpr int kTooltipSpacing = 10;
+  // While the mouse is on the first/last shown item of an overflowing dock, the items
+  // scroll by one at this interval.
+  static constexpr int kHoverScrollIntervalMs = 250;
+  // The caches are trimmed once the dock has been hidden (unless in warm reveal mode), or the
+  // outputs blanked, this long.
+  static constexpr int kTrimDelayMs = 5 * 60 * 1000;  // 5 minutes.
+  static constexpr int kProfilerOverlayWidth = 280;
+  static constexpr int kProfilerOverlayFontSize = 10;  // in pixels.
+  static constexpr int kProfilerOverlayRefreshMs = 1000;
 
   bool autoHide() const { return visibility_ == PanelVisibility::AutoHide; }
   bool intellihide() const { return visibility_ == PanelVisibility::IntelligentAutoHide; }
@@ -260,6 +356,22 @@ class DockPanel : public QWidget {
 
   int itemCount() const { return static_cast<int>(items_.size()); }
 
+  // The items that are shown: all of them, unless they don't fit on the screen, in which
+  // case only these are laid out, drawn and hit-tested, the others being reached by
+  // scrolling. See updateVisibleItems().
+  int firstVisibleItem() const {
+    return isOverflowing_ ? std::min(firstVisibleItem_, itemCount()) : 0;
+  }
+  int visibleItemCount() const {
+    return isOverflowing_ ? std::min(visibleItemCount_, itemCount() - firstVisibleItem())
+                          : itemCount();
+  }
+  int lastVisibleItem() const { return firstVisibleItem() + visibleItemCount() - 1; }
+  bool isVisibleItem(int i) const { return i >= firstVisibleItem() && i <= lastVisibleItem(); }
+  std::span<const std::unique_ptr<DockItem>> visibleItems() const {
+    return std::span(items_).subspan(firstVisibleItem(), visibleItemCount());
+  }
+
   int applicationMenuItemCount() const { return showApplicationMenu_ ? 1 : 0; }
 
   int launcherItemCount() const {
@@ -278,11 +390,31 @@ class DockPanel : public QWidget {
     return showTrash_ ? 1 : 0;
   }
 
-  bool showTaskManager() { return model_->showTaskManager(dockId_); }
+  bool showTaskManager() const { return model_->showTaskManager(dockId_); }
 
   void initUi();
 
+  // Adds the tasks and lets the items complete their set-up, after the first frame.
+  void completeInit();
+
+  // Takes an item of type T left over from before reload() that matches, if any, so that
+  // it can be reused instead of being constructed again.
+  template <typename T, typename Matches>
+  std::unique_ptr<T> takeReusableItem(Matches matches) {
+    for (auto& item : reusableItems_) {
+      auto* typed = dynamic_cast<T*>(item.get());
+      if (typed != nullptr && item->isReusableFor(orientation_, minSize_, maxSize_) &&
+          matches(*typed)) {
+        item.release();
+        return std::unique_ptr<T>(typed);
+      }
+    }
+    return nullptr;
+  }
+
   void createMenu();
+  // Syncs the checked states of the menu's actions with the current config.
+  void updateMenu();
 
   void loadDockConfig();
   void saveDockConfig();
@@ -297,9 +429,28 @@ class DockPanel : public QWidget {
   // Returns true if it changes the dock layout (i.e. adding a new program icon).
   bool addTask(const WindowInfo* task);
   void removeTask(void* window);
+  // Same as removeTask() but doesn't resize the task manager.
+  // Returns true if it changes the dock layout (i.e. removing a program icon).
+  bool removeTaskItem(void* window);
   void updateTask(const WindowInfo* task);
   bool isValidTask(const WindowInfo* task);
+
+  // The screen whose tasks this dock shows, or -1 for all screens.
+  int taskScreen() const { return model_->currentScreenTasksOnly() ? screen_ : -1; }
   bool hasTask(void* window);
+  // Returns the item that has the task, or nullptr.
+  DockItem* findTaskItem(void* window) const;
+  // Removes the index entries of the given item, before it's destroyed.
+  void unindexTasks(const DockItem* item);
+  // Sets the icon of a task's program once it has been loaded in the background.
+  void onTaskIconLoaded(Program* program, const QPixmap& icon);
+  // Loads the items' icons again, replacing only those that have changed.
+  void onIconThemeChanged();
+  // Repaints the items of the applications whose badges or progress have changed.
+  void onLauncherEntriesChanged(const QStringList& appIds);
+  void onThemeIconLoaded(IconBasedDockItem* item, const QPixmap& icon);
+  // Sets the item's icon, resizing the dock if the item's size changes.
+  void replaceIcon(IconBasedDockItem* item, const QPixmap& icon);
 
   void initClock();
 
@@ -307,6 +458,21 @@ class DockPanel : public QWidget {
 
   void initLayoutVars();
 
+  // Chooses the items to show so that the minimized dock, baseLength long (along its
+  // orientation) without its items, is at most maxLength long, starting from
+  // firstVisibleItem_ if they don't all fit. Frees the caches of the items no longer shown.
+  void updateVisibleItems(int maxLength, int baseLength);
+
+  // Scrolls the shown items by delta items, if they overflow the screen.
+  void scrollItems(int delta);
+
+  // Lays out the zoomed dock again from scratch for the last mouse position, e.g. after
+  // the shown items have changed.
+  void relayoutAtMouse();
+
+  // Starts/stops scrolling given the item under the mouse.
+  void updateHoverScroll();
+
   QRect getMinimizedDockGeometry();
 
   // Updates width, height, items's size and position when the mouse is outside
@@ -316,6 +482,21 @@ class DockPanel : public QWidget {
   // Updates width, height, items's size and position given the mouse position.
   void updateLayout(int x, int y);
 
+  // The layout kernels, specialized by orientation, with the position and style resolved
+  // into offsets once per call so that the per-item loops don't branch on them.
+
+  // Lays out the items at their minimum sizes.
+  template <Qt::Orientation kOrientation>
+  void layoutMinimized();
+
+  // Sizes and positions the items in [begin, end] for the mouse position pos (along the
+  // dock), [first, last] being the current zoom window.
+  template <Qt::Orientation kOrientation>
+  void layoutZoomed(int pos, int begin, int end, int first, int last);
+
+  // Computes the positions of the items outside the zoom window when zoomed.
+  void initZoomLayout();
+
   // Checks if the mouse has actually entered the dock panel's visibility area.
   bool checkMouseEnter(int x, int y);
 
@@ -325,6 +506,20 @@ class DockPanel : public QWidget {
   // Hides/unhides the dock in Intelligent Auto Hide mode if necessary.
   void intellihideHideUnhide(void* excluding_window = nullptr);
 
+  // Does the window make the dock hide in Intelligent Auto Hide mode?
+  bool coversDock(const WindowInfo* task, const QRect& dockGeometry);
+  // Updates coveringWindows_ for one window, or removes it if task is nullptr.
+  // Returns true if the set changed.
+  bool updateCoveringWindow(void* window, const WindowInfo* task);
+  void rebuildCoveringWindows();
+
+  // Window events come in bursts (e.g. when an application restores many windows). These
+  // coalesce the task manager relayouts and intellihide checks they cause into one each,
+  // run once control returns to the event loop, i.e. after the whole burst has been handled.
+  void scheduleRelayout();
+  void scheduleIntellihideHideUnhide();
+  void applyScheduledUpdates();
+
   // Is the dock empty?
   // The dock is empty if it has no dock items (separators excluded).
   bool isEmpty();
@@ -341,15 +536,89 @@ class DockPanel : public QWidget {
   // Updates the active item given the mouse position.
   void updateActiveItem(int x, int y);
 
-  // Drawing logic for each dock style.
-  void drawGlass3D(QPainter& painter);
-  void draw2D(QPainter& painter);  // for 2D styles.
+  void setHidden(bool hidden);
+
+  // Hides the dock and frees its buffers while its screen is unplugged, keeping the items.
+  void suspend();
+  void resume(int screen);
+
+  // Frees the items' caches for the zoomed sizes and the offscreen buffers, e.g. after the
+  // dock has been hidden for kTrimDelayMs. warmCaches() renders them again.
+  void trimCaches();
+  // Starts or stops the countdown to trimCaches(), rendering the caches again after a
+  // trim if the dock can be seen.
+  void updateTrimTimer();
+  void warmCaches();
+  // Called when the pointer hits the edge of the hidden dock: renders what the first zoomed
+  // frame needs right away and starts timing the reveal.
+  void prepareReveal();
+
+  // For the runtime metrics.
+  RuntimeMetrics::DockMemory memoryUsage() const;
+
+  // Draws the background and the items intersecting region, in the dock's style.
+  void drawDock(QPainter& painter, const QRegion& region);
+
+  // Drawing logic for each dock style. Only items intersecting region are drawn.
+  void drawGlass3D(QPainter& painter, const QRegion& region);
+  void draw2D(QPainter& painter, const QRegion& region);  // for 2D styles.
+
+  // Draws the cached frame of the minimized dock, re-rendering its outdated parts first.
+  void drawMinimizedFrame(QPainter& painter);
+
+  // Repaints the whole dock, including its cached minimized frame, e.g. after a change
+  // that isn't specific to an item.
+  void updateAll() {
+    isMinimizedFrameValid_ = false;
+    update();
+  }
+
+  // Draws the dock's background panel at (x, y), re-rendering it only if its size, shape or
+  // colors have changed since the last paint.
+  void drawBackground(QPainter& painter, int x, int y, int width, int height, int radius,
+                      bool showBorder, bool is3D, QColor borderColor, QColor fillColor);
 
-  void drawTooltip(QPainter& painter);
+  // Draws the items that intersect the region.
+  void drawItems(QPainter& painter, const QRegion& region);
+
+  // Draws the arrows at the ends of an overflowing dock that there are more items that way.
+  void drawOverflowIndicators(QPainter& painter);
+
+  // Shows the tooltip of the active item, or hides it if there is none.
+  void updateTooltip();
+
+  // Updates the window's row in the shown window list, if it's one of its program's.
+  void updateWindowListRow(const WindowInfo* task);
+
+  // The rolling p50/p99 of the profiled sections, in the top-left corner.
+  void drawProfilerOverlay(QPainter& painter);
+
+  QRect profilerOverlayRect() const;
+
+  // Returns the area the tooltip of the active item is shown in, relative to the dock, or an
+  // empty rect if there is no tooltip. It's outside the dock, next to the active item.
+  QRect tooltipRect() const;
+
+  // Returns the area of the dock (across its whole thickness) that the i-th item,
+  // including its indicator and reflection, is drawn in.
+  QRect itemDamageRect(int i) const;
+
+  // The area of the background and of all shown items, for the zoom animation.
+  QRect animatedBounds() const;
 
   // Returns the size given the distance to the mouse.
   int parabolic(int x);
 
+  // Tabulates the zoom curve for distances 0..parabolicMaxX_.
+  void initZoomTable();
+
+  // Advances the zoom animation and the items' animations to the current time.
+  // Returns true if another frame is needed.
+  bool advanceAnimations();
+
+  // Lays out for the latest pointer position, if one is pending.
+  void applyPendingPointer();
+
   MultiDockView* parent_;
 
   // The model.
@@ -375,7 +644,76 @@ class DockPanel : public QWidget {
 
   // Non-config variables.
 
-  int tooltipSize_;  // height (tooltip only shown in horizontal positions).
+  // The output scale that the icons are rendered for.
+  qreal iconScale_ = 1.0;
+
+  // What the cached background layer was rendered for.
+  struct BackgroundLayerKey {
+    int width = 0;
+    int height = 0;
+    int radius = 0;
+    bool showBorder = false;
+    bool is3D = false;
+    QRgb borderColor = 0;
+    QRgb fillColor = 0;
+    qreal devicePixelRatio = 1.0;
+
+    bool operator==(const BackgroundLayerKey&) const = default;
+  };
+
+  // The rendered background panel, including the border and 3D sides.
+  QPixmap backgroundLayer_;
+  BackgroundLayerKey backgroundLayerKey_;
+  // What the cached task indicator sprites were rendered for.
+  struct IndicatorSpriteKey {
+    PanelStyle panelStyle = PanelStyle::Glass3D_Floating;
+    PanelPosition position = PanelPosition::Bottom;
+    QRgb activeColor = 0;
+    QRgb inactiveColor = 0;
+    qreal devicePixelRatio = 0.0;
+
+    bool operator==(const IndicatorSpriteKey&) const = default;
+  };
+
+  void renderIndicatorSprites(const IndicatorSpriteKey& key);
+
+  // The inactive and active task indicators.
+  QPixmap indicatorSprites_[2];
+  IndicatorSpriteKey indicatorSpriteKey_;
+  // Position in the sprites of the point the indicators are drawn at.
+  int indicatorSpriteAnchor_ = 0;
+
+  // The backgrounds of the count badges with 1, 2 and 3 characters, rendered on first use
+  // after initLayoutVars().
+  QPixmap badgeSprites_[3];
+  int badgeHeight_ = 0;
+  QFont badgeFont_;
+
+  // Renders the indicator sprites if needed and fills drawContext_ for this paint.
+  void updateDrawContext();
+
+  DrawContext drawContext_;
+  // The active window as of the last activeWindowChanged signal.
+  void* activeWindow_ = nullptr;
+
+  // The mirrored strip of the items for the Glass 3D bottom reflection, reused across paints.
+  QImage reflection_;
+
+  // The minimized dock as last painted, so that static repaints (clock ticks, attention
+  // blinks, active window changes) are one blit plus redrawing the changed items.
+  QPixmap minimizedFrame_;
+  bool isMinimizedFrameValid_ = false;
+  // The parts of the frame that are out of date, e.g. items that have changed.
+  QRegion minimizedFrameDamage_;
+
+  // Room above the items for the launcher icons to bounce.
+  int headroom_;
+  Tooltip tooltip_{this};
+  QFont tooltipFont_;
+  int tooltipFontHeight_ = 0;
+  // The last measured tooltip label and its width.
+  mutable QString tooltipLabel_;
+  mutable int tooltipLabelWidth_ = 0;
   int itemSpacing_;  // space between items.
   int margin3D_;
   int floatingMargin_;  // margin around the dock in floating mode.
@@ -391,21 +729,75 @@ class DockPanel : public QWidget {
   int maxHeight_;
 
   int parabolicMaxX_;
+  // Item sizes indexed by distance to the mouse, see initZoomTable().
+  std::vector<int> zoomTable_;
+
+  // Zoomed positions (x if horizontal, y if vertical) of the items before/after the zoom window.
+  std::vector<int> zoomStartPos_;
+  std::vector<int> zoomEndPos_;
+  bool isZoomLayoutValid_ = false;
+  // Geometry of the items along the dock's orientation, by item index, kept contiguous for
+  // the zoom layout and hit-testing loops so that they don't chase item pointers or make
+  // virtual calls. Built by initZoomLayout().
+  struct ItemGeometry {
+    std::vector<int> minCenters;
+    // Current size and position (left if horizontal, top if vertical).
+    std::vector<int> sizes;
+    std::vector<int> positions;
+    // Width if horizontal or height if vertical, at lengths[i * numSizes + size - minSize_].
+    std::vector<int> lengths;
+    int numSizes = 0;
+  };
+  ItemGeometry itemGeometry_;
+  // The zoom window of the last updateLayout(x, y).
+  int zoomFirstIndex_ = 0;
+  int zoomLastIndex_ = 0;
+
   QRect screenGeometry_;  // the geometry of the screen that the dock is on.
   wl_output* screenOutput_;
+  // Identifies the screen across hotplugs, which can change the screen indices.
+  QString screenName_;
+  bool isSuspended_ = false;
+  QTimer trimTimer_;
+  // Whether the caches have been trimmed and not rendered again since.
+  bool isTrimmed_ = false;
 
-  // Number of animation steps when zooming in and out.
-  int numAnimationSteps_;
-  // Animation speed, between 0 and 31. The higher the faster.
-  int animationSpeed_;
+  // Duration of the zoom in/out animation.
+  int animationDurationMs_;
 
   Qt::Orientation orientation_;
 
   // The list of all dock items.
   std::vector<std::unique_ptr<DockItem>> items_;
+  // The shown items if they overflow the screen, see visibleItems().
+  bool isOverflowing_ = false;
+  int firstVisibleItem_ = 0;
+  int visibleItemCount_ = 0;
+  // Scrolls the items by hoverScrollDirection_ (-1 or 1) while the mouse is at an end.
+  QTimer hoverScrollTimer_;
+  int hoverScrollDirection_ = 0;
+  // The part of the wheel rotation not yet scrolled by, in eighths of a degree.
+  int wheelDelta_ = 0;
+  // The items from before reload(), for initUi() to reuse the ones that are still wanted.
+  std::vector<std::unique_ptr<DockItem>> reusableItems_;
+  // Index of the items by the windows of their tasks.
+  std::unordered_map<void*, DockItem*> taskItems_;
+  // The program whose window list is shown, which window events then update.
+  Program* windowListProgram_ = nullptr;
+
+  // The windows that make the dock hide in Intelligent Auto Hide mode, kept up to date
+  // incrementally on window events so that intellihideShouldHide() doesn't have to check
+  // all windows. Only valid for coveringDockGeometry_.
+  std::unordered_set<void*> coveringWindows_;
+  bool isCoveringWindowsValid_ = false;
+  QRect coveringDockGeometry_;
+
+  QTimer scheduledUpdatesTimer_;
+  bool isRelayoutScheduled_ = false;
+  bool isIntellihideScheduled_ = false;
   int activeItem_ = -1;
 
-  // Context (right-click) menu.
+  // Context (right-click) menu, created on first use.
   QMenu menu_;
   QAction* positionTop_;
   QAction* positionBottom_;
@@ -428,13 +820,14 @@ class DockPanel : public QWidget {
   // Actions to set the dock on a specific screen.
   std::vector<QAction*> screenActions_;
 
-  QMessageBox aboutDialog_;
-  AddPanelDialog addPanelDialog_;
-  AppearanceSettingsDialog appearanceSettingsDialog_;
-  EditLaunchersDialog editLaunchersDialog_;
-  ApplicationMenuSettingsDialog applicationMenuSettingsDialog_;
-  WallpaperSettingsDialog wallpaperSettingsDialog_;
-  TaskManagerSettingsDialog taskManagerSettingsDialog_;
+  // The dialogs are created on first use. Those of dock-specific settings are per dock,
+  // the others are shared by all docks.
+  QPointer<AddPanelDialog> addPanelDialog_;
+  QPointer<EditLaunchersDialog> editLaunchersDialog_;
+  static QPointer<AppearanceSettingsDialog> appearanceSettingsDialog_;
+  static QPointer<ApplicationMenuSettingsDialog> applicationMenuSettingsDialog_;
+  static QPointer<WallpaperSettingsDialog> wallpaperSettingsDialog_;
+  static QPointer<TaskManagerSettingsDialog> taskManagerSettingsDialog_;
 
   bool isMinimized_;
   // This is needed for Intelligent Auto Hide mode because it could be either be visible
@@ -443,9 +836,20 @@ class DockPanel : public QWidget {
   bool isEntering_;
   bool isLeaving_;
   bool isAnimationActive_;
+  // Whether completeInit() has run / been scheduled.
+  bool isInitComplete_ = false;
+  bool isCompleteInitScheduled_ = false;
   bool isShowingPopup_;
-  std::unique_ptr<QTimer> animationTimer_;
-  int currentAnimationStep_;
+  // The clock all animations are timed by.
+  QElapsedTimer animationClock_;
+  // Since the pointer hit the edge of the hidden dock, until the dock's first frame.
+  QElapsedTimer revealTimer_;
+  // The zoom animation runs from the layout at animationStartMs_ to the target layout at
+  // animationEndMs_. Retargeting it moves the start to the current layout and time.
+  qint64 animationStartMs_;
+  qint64 animationEndMs_;
+  // The window whose update requests drive the animations.
+  QWindow* animationWindow_ = nullptr;
   int backgroundWidth_;
   int startBackgroundWidth_;
   int endBackgroundWidth_;
@@ -457,8 +861,14 @@ class DockPanel : public QWidget {
   // so that we can show the correct tooltip at the end of it.
   int mouseX_;
   int mouseY_;
+  // The latest pointer position not laid out for yet. Pointer moves only record it, so the
+  // layout runs once per frame rather than once per pointer event.
+  int pendingMouseX_ = 0;
+  int pendingMouseY_ = 0;
+  bool isPointerPending_ = false;
 
   friend class Program;  // for leaveEvent.
+  friend class DockPanelBenchmark;
   friend class DockPanelTest;
   friend class ConfigDialogTest;
   friend class EditLaunchersDialogTest;
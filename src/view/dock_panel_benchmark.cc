@@ -0,0 +1,267 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "dock_panel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+#include <QImage>
+#include <QPainter>
+#include <QPixmap>
+#include <QRadialGradient>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "icon_store.h"
+#include "program.h"
+#include <display/window_system.h>
+#include <model/multi_dock_model.h>
+#include <utils/icon_scaler.h>
+
+namespace crystaldock {
+
+// Benchmarks of the dock's hot paths. Runs on the offscreen platform without a
+// compositor, so there are no windows, virtual desktops or activities, e.g.:
+//
+// QT_QPA_PLATFORM=offscreen dock_panel_benchmark -o results.xml,xml
+//
+// or `make benchmark`.
+class DockPanelBenchmark : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void initTestCase() {
+    QVERIFY(configDir_.isValid());
+    WindowSystem::initHeadless();
+    QVERIFY(!WindowSystem::screens().empty());
+    // Independent of the host's desktop environment.
+    SessionContext session = SessionContext::fromEnvironment(configDir_.path());
+    session.setDesktop("generic", configDir_.path());
+    model_ = std::make_unique<MultiDockModel>(session);
+    model_->addDock(PanelPosition::Bottom, 0, /*showApplicationMenu=*/false,
+                    /*showPager=*/false, /*showTaskManager=*/false, /*showClock=*/false);
+    dock_ = std::make_unique<DockPanel>(nullptr, model_.get(), /*dockId=*/1);
+  }
+
+  void cleanupTestCase() {
+    dock_.reset();
+    model_.reset();
+  }
+
+  void updateLayout_data();
+  void updateLayout();
+  void paintEvent_data();
+  void paintEvent();
+  void generateIcons_data();
+  void generateIcons();
+  void scaleIcons_data();
+  void scaleIcons();
+  void scaleIconsQuality();
+  void reload();
+
+ private:
+  static QPixmap makeIcon() {
+    QPixmap icon(DockPanel::kIconLoadSize, DockPanel::kIconLoadSize);
+    icon.fill(Qt::darkCyan);
+    return icon;
+  }
+
+  // An icon with gradients, translucency and hard edges, for comparing scalers.
+  static QImage makeDetailedIcon() {
+    QImage icon(DockPanel::kIconLoadSize, DockPanel::kIconLoadSize,
+                QImage::Format_ARGB32_Premultiplied);
+    icon.fill(Qt::transparent);
+    QPainter painter(&icon);
+    painter.setRenderHint(QPainter::Antialiasing);
+    QRadialGradient gradient(icon.rect().center(), icon.width() / 2);
+    gradient.setColorAt(0, QColor(255, 200, 40));
+    gradient.setColorAt(1, QColor(40, 80, 200, 160));
+    painter.setBrush(gradient);
+    painter.setPen(QPen(Qt::black, 3));
+    painter.drawRoundedRect(icon.rect().adjusted(4, 4, -4, -4), 24, 24);
+    for (int i = 8; i < icon.width() - 8; i += 6) {
+      painter.drawLine(i, icon.height() / 2, i + 3, icon.height() - 12);
+    }
+    return icon;
+  }
+
+  // Replaces the dock's items with numItems programs.
+  void setItems(int numItems) {
+    const QPixmap icon = makeIcon();
+    dock_->items_.clear();
+    for (int i = 0; i < numItems; ++i) {
+      const QString appId = QString("app-%1").arg(i);
+      dock_->items_.push_back(std::make_unique<Program>(
+          dock_.get(), model_.get(), appId, appId, dock_->orientation_, icon,
+          dock_->minSize_, dock_->maxSize_, "true", /*isAppMenuEntry=*/false,
+          /*pinned=*/true));
+    }
+    dock_->initLayoutVars();
+    dock_->updateLayout();
+  }
+
+  // Zooms the dock as if the mouse were at its center.
+  void zoom() {
+    dock_->isMinimized_ = false;
+    dock_->isEntering_ = false;
+    dock_->updateLayout(dock_->maxWidth_ / 2, dock_->maxHeight_ / 2);
+  }
+
+  QTemporaryDir configDir_;
+  std::unique_ptr<MultiDockModel> model_;
+  std::unique_ptr<DockPanel> dock_;
+};
+
+void DockPanelBenchmark::updateLayout_data() {
+  QTest::addColumn<int>("numItems");
+  QTest::newRow("10 items") << 10;
+  QTest::newRow("50 items") << 50;
+  QTest::newRow("200 items") << 200;
+}
+
+void DockPanelBenchmark::updateLayout() {
+  QFETCH(int, numItems);
+  setItems(numItems);
+  zoom();
+  // Sweeps the mouse along the dock, like a user moving across the icons.
+  const int length = dock_->isHorizontal() ? dock_->maxWidth_ : dock_->maxHeight_;
+  const int step = std::max(dock_->minSize_ / 4, 1);
+  int pos = 0;
+  QBENCHMARK {
+    pos = (pos + step) % length;
+    if (dock_->isHorizontal()) {
+      dock_->updateLayout(pos, dock_->maxHeight_ / 2);
+    } else {
+      dock_->updateLayout(dock_->maxWidth_ / 2, pos);
+    }
+  }
+}
+
+void DockPanelBenchmark::paintEvent_data() {
+  QTest::addColumn<int>("style");
+  QTest::newRow("Glass3D_Floating") << static_cast<int>(PanelStyle::Glass3D_Floating);
+  QTest::newRow("Glass3D_NonFloating") << static_cast<int>(PanelStyle::Glass3D_NonFloating);
+  QTest::newRow("Flat2D_Floating") << static_cast<int>(PanelStyle::Flat2D_Floating);
+  QTest::newRow("Flat2D_NonFloating") << static_cast<int>(PanelStyle::Flat2D_NonFloating);
+  QTest::newRow("Metal2D_Floating") << static_cast<int>(PanelStyle::Metal2D_Floating);
+  QTest::newRow("Metal2D_NonFloating") << static_cast<int>(PanelStyle::Metal2D_NonFloating);
+  QTest::newRow("Glass2D_Floating") << static_cast<int>(PanelStyle::Glass2D_Floating);
+  QTest::newRow("Glass2D_NonFloating") << static_cast<int>(PanelStyle::Glass2D_NonFloating);
+}
+
+void DockPanelBenchmark::paintEvent() {
+  QFETCH(int, style);
+  dock_->setPanelStyle(static_cast<PanelStyle>(style));
+  setItems(10);
+  zoom();
+  QImage frame(dock_->size() * dock_->devicePixelRatioF(),
+               QImage::Format_ARGB32_Premultiplied);
+  frame.setDevicePixelRatio(dock_->devicePixelRatioF());
+  QBENCHMARK {
+    frame.fill(Qt::transparent);
+    dock_->render(&frame);
+  }
+}
+
+void DockPanelBenchmark::generateIcons_data() {
+  QTest::addColumn<int>("minSize");
+  QTest::addColumn<int>("maxSize");
+  QTest::newRow("32-64") << 32 << 64;
+  QTest::newRow("48-128") << 48 << 128;
+  QTest::newRow("64-256") << 64 << 256;
+}
+
+void DockPanelBenchmark::generateIcons() {
+  QFETCH(int, minSize);
+  QFETCH(int, maxSize);
+  const QPixmap icon = makeIcon();
+  Program program(dock_.get(), model_.get(), "app", "App", Qt::Horizontal, icon,
+                  minSize, maxSize);
+  QBENCHMARK {
+    // Drops the icons from the previous iteration first, so that they are
+    // rendered again rather than shared from the IconStore.
+    program.generateIcons(icon);
+  }
+}
+
+void DockPanelBenchmark::scaleIcons_data() {
+  QTest::addColumn<bool>("mipChain");
+  QTest::newRow("Qt") << false;
+  QTest::newRow("IconScaler") << true;
+}
+
+void DockPanelBenchmark::scaleIcons() {
+  QFETCH(bool, mipChain);
+  // All the icons of one item, as generateIcons() does.
+  const QImage icon = makeDetailedIcon();
+  const int minSize = 48;
+  const int maxSize = 128;
+  QBENCHMARK {
+    if (mipChain) {
+      IconScaler scaler(icon);
+      for (int size = minSize; size <= maxSize; ++size) {
+        QPixmap::fromImage(scaler.scaledToHeight(size));
+      }
+    } else {
+      for (int size = minSize; size <= maxSize; ++size) {
+        IconStore::render(icon, size, Qt::Horizontal);
+      }
+    }
+  }
+}
+
+void DockPanelBenchmark::scaleIconsQuality() {
+  // Compares IconScaler against Qt's smooth transformation, as PSNR over the
+  // premultiplied channels.
+  const QImage icon = makeDetailedIcon();
+  const IconScaler scaler(icon);
+  double worst = 1000.0;
+  for (int size = 16; size <= 2 * DockPanel::kIconLoadSize; size += 8) {
+    const QImage expected = icon.scaledToHeight(size, Qt::SmoothTransformation)
+        .convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    const QImage actual = scaler.scaledToHeight(size);
+    QCOMPARE(actual.size(), expected.size());
+    double squaredError = 0.0;
+    for (int y = 0; y < size; ++y) {
+      const auto* e = expected.constScanLine(y);
+      const auto* a = actual.constScanLine(y);
+      for (int x = 0; x < expected.width() * 4; ++x) {
+        squaredError += (e[x] - a[x]) * (e[x] - a[x]);
+      }
+    }
+    const double mse = squaredError / (expected.width() * size * 4);
+    const double psnr = (mse > 0) ? 10 * std::log10(255.0 * 255.0 / mse) : 1000.0;
+    qInfo("size %d: PSNR %.1f dB", size, psnr);
+    worst = std::min(worst, psnr);
+  }
+  QVERIFY2(worst > 28.0, qPrintable(QString("worst PSNR %1 dB").arg(worst)));
+}
+
+void DockPanelBenchmark::reload() {
+  QBENCHMARK {
+    dock_->reload();
+  }
+}
+
+}  // namespace crystaldock
+
+QTEST_MAIN(crystaldock::DockPanelBenchmark)
+#include "dock_panel_benchmark.moc"
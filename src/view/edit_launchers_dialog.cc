@@ -108,6 +108,7 @@ EditLaunchersDialog::EditLaunchersDialog(QWidget* parent, MultiDockModel* model,
       SLOT(buttonClicked(QAbstractButton*)));
 
   initSystemCommands();
+  initApplicationList();
   loadData();
 }
 
@@ -171,11 +172,44 @@ void EditLaunchersDialog::removeAllLaunchers() {
   launchers_->clear();
 }
 
+void EditLaunchersDialog::addApplication(const QModelIndex& index) {
+  if (!index.isValid()) {
+    return;
+  }
+
+  const auto& entry = applicationModel_->entry(index.row());
+  addLauncher(entry.name, entry.appId, entry.icon);
+}
+
+void EditLaunchersDialog::initApplicationList() {
+  applicationFilter_ = new QLineEdit(this);
+  applicationFilter_->setGeometry(QRect(820, 20, 380, 40));
+  applicationFilter_->setPlaceholderText("Search applications");
+  applicationFilter_->setClearButtonEnabled(true);
+
+  applicationModel_ = new ApplicationListModel(model_, this);
+  applications_ = new QListView(this);
+  applications_->setGeometry(QRect(820, 70, 380, 440));
+  applications_->setToolTip("Double-click or drag an application to add it as a launcher.");
+  applications_->setModel(applicationModel_);
+  applications_->setIconSize(QSize(ApplicationListModel::kIconSize,
+                                   ApplicationListModel::kIconSize));
+  // So that the view only asks the model about the visible rows.
+  applications_->setUniformItemSizes(true);
+  applications_->setSelectionMode(QAbstractItemView::SingleSelection);
+  applications_->setDragEnabled(true);
+  applications_->setDragDropMode(QAbstractItemView::DragOnly);
+
+  connect(applicationFilter_, &QLineEdit::textChanged,
+          applicationModel_, &ApplicationListModel::setFilter);
+  connect(applications_, &QListView::doubleClicked, this, &EditLaunchersDialog::addApplication);
+}
+
 void EditLaunchersDialog::initSystemCommands() {
   ui->systemCommands->addItem(getListItemIcon(kShowDesktopIcon), kShowDesktopName,
       QVariant::fromValue(LauncherInfo(kShowDesktopIcon, kShowDesktopId)));
   for (const auto& category : model_->applicationMenuSystemCategories()) {
-    for (const auto& entry : category.entries) {
+    for (const auto& entry : category.entries()) {
       ui->systemCommands->addItem(
           getListItemIcon(entry.icon), entry.name,
           QVariant::fromValue(LauncherInfo(entry.icon, entry.appId)));
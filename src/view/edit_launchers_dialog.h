@@ -25,11 +25,15 @@
 #include <QDragEnterEvent>
 #include <QDragMoveEvent>
 #include <QDropEvent>
+#include <QLineEdit>
+#include <QListView>
 #include <QListWidget>
 #include <QListWidgetItem>
 
 #include <model/multi_dock_model.h>
 
+#include "application_list_model.h"
+
 namespace Ui {
   class EditLaunchersDialog;
 }
@@ -85,11 +89,14 @@ class EditLaunchersDialog : public QDialog {
   void addLauncherSeparator();
   void removeSelectedLauncher();
   void removeAllLaunchers();
+  // Adds the application picked at the index of the application list.
+  void addApplication(const QModelIndex& index);
 
  private:
   static constexpr int kListIconSize = 48;
 
   void initSystemCommands();
+  void initApplicationList();
 
   void loadData();
   void saveData();
@@ -102,6 +109,9 @@ class EditLaunchersDialog : public QDialog {
 
   Ui::EditLaunchersDialog* ui;
   LauncherList* launchers_;
+  QLineEdit* applicationFilter_;
+  QListView* applications_;
+  ApplicationListModel* applicationModel_;
 
   MultiDockModel* model_;
   int dockId_;
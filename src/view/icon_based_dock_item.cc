@@ -18,13 +18,17 @@
 
 #include "icon_based_dock_item.h"
 
+#include <algorithm>
+
 #include <QIcon>
 #include <QImage>
 
 #include "dock_panel.h"
+#include "icon_store.h"
 
 #include <utils/draw_utils.h>
 #include <utils/icon_utils.h>
+#include <utils/profiler.h>
 
 namespace crystaldock {
 
@@ -32,7 +36,12 @@ IconBasedDockItem::IconBasedDockItem(DockPanel* parent, MultiDockModel* model, c
                                      Qt::Orientation orientation, const QString& iconName,
                                      int minSize, int maxSize)
     : DockItem(parent, model, label, orientation, minSize, maxSize),
-    icons_(maxSize - minSize + 1) {
+    icons_(maxSize - minSize + 1),
+    sourceKey_(0),
+    iconScale_(1.0),
+    lazy_(model->lazyIconCache()),
+    cacheSize_(std::max(model->iconCacheSize(), 1)),
+    sizeBucket_(std::max(model->iconSizeBucket(), 1)) {
   setIconName(iconName);
 }
 
@@ -40,12 +49,18 @@ IconBasedDockItem::IconBasedDockItem(DockPanel* parent, MultiDockModel* model, c
                                      Qt::Orientation orientation, const QPixmap& icon,
                                      int minSize, int maxSize)
     : DockItem(parent, model, label, orientation, minSize, maxSize),
-    icons_(maxSize - minSize + 1) {
+    icons_(maxSize - minSize + 1),
+    sourceKey_(0),
+    iconScale_(1.0),
+    lazy_(model->lazyIconCache()),
+    cacheSize_(std::max(model->iconCacheSize(), 1)),
+    sizeBucket_(std::max(model->iconSizeBucket(), 1)) {
   setIcon(icon);
 }
 
-void IconBasedDockItem::draw(QPainter* painter) const {
-  const auto& icon = icons_[size_ - minSize_];
+void IconBasedDockItem::draw(QPainter* painter, const DrawContext& context) const {
+  PROFILE_SCOPE("IconBasedDockItem::draw");
+  const auto& icon = getIcon(size_);
   if (!icon.isNull()) {
     painter->drawPixmap(left_, top_, icon);
   } else {  // Fall-back "icon".
@@ -55,25 +70,59 @@ void IconBasedDockItem::draw(QPainter* painter) const {
   }
 }
 
+void IconBasedDockItem::trimCaches() {
+  if (!lazy_ || image_.isNull()) {
+    return;
+  }
+
+  for (int size = minSize_ + 1; size <= maxSize_; ++size) {
+    icons_[size - minSize_] = nullptr;
+  }
+  std::erase_if(lruSizes_, [this](int size) { return size != minSize_; });
+}
+
+void IconBasedDockItem::addMemoryUsage(RuntimeMetrics::DockMemory* memory) const {
+  for (const auto& icon : icons_) {
+    if (icon) {
+      memory->iconBytes += RuntimeMetrics::bytes(*icon);
+    }
+  }
+  memory->iconBytes += RuntimeMetrics::bytes(image_);
+}
+
 void IconBasedDockItem::setIcon(const QPixmap& icon) {
   generateIcons(icon);
 }
 
 void IconBasedDockItem::setIconName(const QString& iconName) {
-  QPixmap icon = loadIcon(iconName, DockPanel::kIconLoadSize);
+  QPixmap icon = loadIcon(iconName, parent_->iconLoadSize());
   if (!icon.isNull()) {
     iconName_ = iconName;
+    iconNames_ = {iconName};
     setIcon(icon);
   }
 }
 
+bool IconBasedDockItem::hasIcon(const QPixmap& icon) const {
+  return IconStore::sourceKey(icon.toImage()) == sourceKey_;
+}
+
 const QPixmap& IconBasedDockItem::getIcon(int size) const {
   if (size < minSize_) {
     size = minSize_;
   } else if (size > maxSize_) {
     size = maxSize_;
   }
-  return icons_[size - minSize_];
+  size = quantizeSize(size);
+  if (lazy_ && !image_.isNull()) {
+    if (!icons_[size - minSize_]) {
+      icons_[size - minSize_] = renderIcon(size);
+    }
+    touchSize(size);
+  }
+  static const QPixmap kNullIcon;
+  const auto& icon = icons_[size - minSize_];
+  return icon ? *icon : kNullIcon;
 }
 
 void IconBasedDockItem::generateIcons(const QPixmap& icon) {
@@ -82,13 +131,44 @@ void IconBasedDockItem::generateIcons(const QPixmap& icon) {
     return;
   }
 
+  std::fill(icons_.begin(), icons_.end(), nullptr);
+  lruSizes_.clear();
+  image_ = image;
+  sourceKey_ = IconStore::sourceKey(image_);
+  iconScale_ = parent_->iconScale();
+  if (lazy_) {
+    // Sizes will be rendered on first use.
+    return;
+  }
+
   for (int size = minSize_; size <= maxSize_; ++size) {
-    icons_[size - minSize_] = QPixmap::fromImage(
-        (orientation_ == Qt::Horizontal)
-            ? image.scaledToHeight(size, Qt::SmoothTransformation)
-            : image.scaledToWidth(size, Qt::SmoothTransformation));
-    //https://doc.qt.io/qt-6/highdpi.html
-    icons_[size - minSize_].setDevicePixelRatio(1.0f);
+    icons_[size - minSize_] = renderIcon(size);
+  }
+  image_ = QImage();
+}
+
+std::shared_ptr<const QPixmap> IconBasedDockItem::renderIcon(int size) const {
+  return IconStore::self()->get(sourceKey_, image_, size, orientation_, iconScale_);
+}
+
+int IconBasedDockItem::quantizeSize(int size) const {
+  if (sizeBucket_ <= 1 || size == minSize_ || size == maxSize_) {
+    return size;
+  }
+  const int bucketed = minSize_ + (size - minSize_ + sizeBucket_ / 2) / sizeBucket_ * sizeBucket_;
+  return std::min(bucketed, maxSize_);
+}
+
+void IconBasedDockItem::touchSize(int size) const {
+  if (!lruSizes_.empty() && lruSizes_.front() == size) {
+    return;
+  }
+
+  lruSizes_.remove(size);
+  lruSizes_.push_front(size);
+  while (static_cast<int>(lruSizes_.size()) > cacheSize_) {
+    icons_[lruSizes_.back() - minSize_] = nullptr;
+    lruSizes_.pop_back();
   }
 }
 
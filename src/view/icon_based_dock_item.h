@@ -19,11 +19,15 @@
 #ifndef CRYSTALDOCK_ICON_BASED_DOCK_ITEM_H_
 #define CRYSTALDOCK_ICON_BASED_DOCK_ITEM_H_
 
+#include <list>
+#include <memory>
 #include <vector>
 
+#include <QImage>
 #include <QPainter>
 #include <QPixmap>
 #include <QString>
+#include <QStringList>
 #include <Qt>
 
 #include "dock_item.h"
@@ -39,17 +43,25 @@ class IconBasedDockItem : public DockItem {
                     Qt::Orientation orientation, const QPixmap& icon, int minSize, int maxSize);
   virtual ~IconBasedDockItem() {}
 
+  // In logical pixels, icons being rendered at the output scale.
   int getWidthForSize(int size) const override {
     const auto& icon = getIcon(size);
-    return !icon.isNull() ? icon.width() : size;
+    return !icon.isNull() ? qRound(icon.width() / icon.devicePixelRatio()) : size;
   }
 
   int getHeightForSize(int size) const override {
     const auto& icon = getIcon(size);
-    return !icon.isNull() ? icon.height() : size;
+    return !icon.isNull() ? qRound(icon.height() / icon.devicePixelRatio()) : size;
   }
 
-  void draw(QPainter* painter) const override;
+  void draw(QPainter* painter, const DrawContext& context) const override;
+
+  // In lazy mode, the other sizes are rendered again on next use.
+  void trimCaches() override;
+
+  void warmCache(int size) override { getIcon(size); }
+
+  void addMemoryUsage(RuntimeMetrics::DockMemory* memory) const override;
 
   // Sets the icon on the fly.
   void setIcon(const QPixmap& icon);
@@ -57,15 +69,52 @@ class IconBasedDockItem : public DockItem {
   const QPixmap& getIcon(int size) const;
   QString getIconName() const { return iconName_; }
 
+  // Names in the icon theme that the icon is loaded from, in order of preference, so
+  // that it can be loaded again when the icon theme changes.
+  const QStringList& iconNames() const { return iconNames_; }
+  void setIconNames(const QStringList& iconNames) { iconNames_ = iconNames; }
+
+  // Whether the icon has the same content as the current one.
+  bool hasIcon(const QPixmap& icon) const;
+
  protected:
-  std::vector<QPixmap> icons_;
+  // Rendered icons, indexed by size - minSize_, shared with other items via
+  // IconStore. In lazy mode, only the sizes in lruSizes_ are non-null.
+  mutable std::vector<std::shared_ptr<const QPixmap>> icons_;
 
   QString iconName_;
+  QStringList iconNames_;
 
  private:
   void generateIcons(const QPixmap& icon);
 
+  // Gets the icon for the specified size from the shared store.
+  std::shared_ptr<const QPixmap> renderIcon(int size) const;
+
+  // Rounds the size to the nearest bucket, if size bucketing is on.
+  int quantizeSize(int size) const;
+
+  // Marks the size as most recently used, evicting the least recently used
+  // size if the cache is full.
+  void touchSize(int size) const;
+
+  // Source image, kept in lazy mode to render sizes on demand.
+  QImage image_;
+  // IconStore key of the source image.
+  size_t sourceKey_;
+  // Output scale that the icons are rendered for.
+  qreal iconScale_;
+
+  // Whether to render sizes on demand, instead of all sizes up front.
+  bool lazy_;
+  // Max number of rendered sizes in lazy mode.
+  int cacheSize_;
+  int sizeBucket_;
+  // Rendered sizes in lazy mode, most recently used first.
+  mutable std::list<int> lruSizes_;
+
   friend class DockPanel;
+  friend class DockPanelBenchmark;
 };
 
 }  // namespace crystaldock
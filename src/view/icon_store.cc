@@ -0,0 +1,97 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "icon_store.h"
+
+#include <QHashFunctions>
+
+#include <utils/runtime_metrics.h>
+
+namespace crystaldock {
+
+/* static */ IconStore* IconStore::self() {
+  static IconStore self;
+  return &self;
+}
+
+/* static */ size_t IconStore::sourceKey(const QImage& source) {
+  size_t seed = qHashMulti(0, source.width(), source.height(),
+                           static_cast<int>(source.format()));
+  return qHashBits(source.constBits(), source.sizeInBytes(), seed);
+}
+
+/* static */ QPixmap IconStore::render(const QImage& source, int size,
+                                       Qt::Orientation orientation) {
+  QPixmap icon = QPixmap::fromImage(
+      (orientation == Qt::Horizontal)
+          ? source.scaledToHeight(size, Qt::SmoothTransformation)
+          : source.scaledToWidth(size, Qt::SmoothTransformation));
+  //https://doc.qt.io/qt-6/highdpi.html
+  icon.setDevicePixelRatio(1.0f);
+  return icon;
+}
+
+std::shared_ptr<const QPixmap> IconStore::get(
+    size_t sourceKey, const QImage& source, int size, Qt::Orientation orientation,
+    qreal scale) {
+  const Key key{sourceKey, size, orientation, qRound(scale * 120)};
+  auto it = icons_.find(key);
+  if (it != icons_.end()) {
+    if (auto icon = it->second.lock()) {
+      ++stats_.hits;
+      RuntimeMetrics::add(RuntimeMetrics::Counter::IconCacheHits);
+      return icon;
+    }
+  }
+
+  ++stats_.misses;
+  RuntimeMetrics::add(RuntimeMetrics::Counter::IconCacheMisses);
+  if (scaler_.isNull() || scalerSource_ != sourceKey) {
+    scaler_ = IconScaler(source);
+    scalerSource_ = sourceKey;
+  }
+  const int physicalSize = qRound(size * scale);
+  QPixmap* scaled = new QPixmap(QPixmap::fromImage(
+      (orientation == Qt::Horizontal) ? scaler_.scaledToHeight(physicalSize)
+                                      : scaler_.scaledToWidth(physicalSize)));
+  //https://doc.qt.io/qt-6/highdpi.html
+  scaled->setDevicePixelRatio(scale);
+  const int64_t bytes = static_cast<int64_t>(scaled->width()) * scaled->height() *
+      scaled->depth() / 8;
+  std::shared_ptr<const QPixmap> icon(scaled, [key, bytes](const QPixmap* p) {
+    IconStore::self()->release(key, bytes);
+    delete p;
+  });
+  icons_[key] = icon;
+  ++stats_.entries;
+  stats_.bytes += bytes;
+  RuntimeMetrics::add(RuntimeMetrics::Counter::IconCacheBytes, bytes);
+  return icon;
+}
+
+void IconStore::release(const Key& key, int64_t bytes) {
+  auto it = icons_.find(key);
+  if (it != icons_.end() && it->second.expired()) {
+    icons_.erase(it);
+  }
+  --stats_.entries;
+  stats_.bytes -= bytes;
+  RuntimeMetrics::add(RuntimeMetrics::Counter::IconCacheBytes, -bytes);
+}
+
+}  // namespace crystaldock
@@ -0,0 +1,105 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CRYSTALDOCK_ICON_STORE_H_
+#define CRYSTALDOCK_ICON_STORE_H_
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+#include <QImage>
+#include <QPixmap>
+#include <QString>
+#include <Qt>
+
+#include <utils/icon_scaler.h>
+
+namespace crystaldock {
+
+struct IconStoreStats {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  // Number of live scaled icons.
+  int entries = 0;
+  // Bytes held by live scaled icons.
+  int64_t bytes = 0;
+
+  double hitRate() const {
+    return (hits + misses > 0) ? static_cast<double>(hits) / (hits + misses) : 0.0;
+  }
+};
+
+// Process-wide store of scaled icons, shared by all icon-based dock items
+// on all docks.
+//
+// Icons are keyed by (source image, size, orientation, scale) and are ref-counted:
+// an icon stays in the store as long as at least one dock item holds it.
+// Only used from the GUI thread.
+class IconStore {
+ private:
+  IconStore() = default;
+
+ public:
+  static IconStore* self();
+
+  // Returns a key identifying the content of the source image.
+  static size_t sourceKey(const QImage& source);
+
+  // Scales the source image to the specified size (height if horizontal,
+  // width if vertical) with Qt's smooth transformation. get() uses IconScaler instead.
+  static QPixmap render(const QImage& source, int size, Qt::Orientation orientation);
+
+  // Gets the scaled icon, scaling and storing it if not already in the store.
+  // The icon is rendered at size * scale physical pixels, with that device pixel ratio.
+  std::shared_ptr<const QPixmap> get(size_t sourceKey, const QImage& source, int size,
+                                     Qt::Orientation orientation, qreal scale = 1.0);
+
+  const IconStoreStats& stats() const { return stats_; }
+
+ private:
+  struct Key {
+    size_t source;
+    int size;
+    Qt::Orientation orientation;
+    // In 1/120ths, as wp_fractional_scale_v1 reports it.
+    int scale;
+
+    bool operator==(const Key& other) const = default;
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const {
+      return key.source ^ (static_cast<size_t>(key.size) << 1) ^
+          (static_cast<size_t>(key.orientation) << 16) ^ (static_cast<size_t>(key.scale) << 20);
+    }
+  };
+
+  // Called when the last holder of an icon releases it.
+  void release(const Key& key, int64_t bytes);
+
+  std::unordered_map<Key, std::weak_ptr<const QPixmap>, KeyHash> icons_;
+  // Scaler of the last source, as its sizes are usually requested together.
+  IconScaler scaler_;
+  size_t scalerSource_ = 0;
+  IconStoreStats stats_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_ICON_STORE_H_
@@ -18,20 +18,28 @@
 
 #include "multi_dock_view.h"
 
+#include <set>
+#include <utility>
+
 #include <QCoreApplication>
 #include <QGuiApplication>
 #include <QMessageBox>
+#include <QTimer>
 
 #include "display/window_system.h"
 
 #include "add_panel_dialog.h"
+#include <utils/icon_loader.h>
+#include <utils/prefetcher.h>
+#include <utils/startup_trace.h>
 
 namespace crystaldock {
 
 MultiDockView::MultiDockView(MultiDockModel* model)
     : model_(model),
-      desktopEnv_(DesktopEnv::getDesktopEnv()) {
+      desktopEnv_(model->desktopEnv()) {
   connect(model_, SIGNAL(dockAdded(int)), this, SLOT(onDockAdded(int)));
+  connect(model_, SIGNAL(dockRemoved(int)), this, SLOT(onDockRemoved(int)));
   connect(model_, SIGNAL(wallpaperChanged(int)), this,
           SLOT(setWallpaper(int)));
   connect(WindowSystem::self(), SIGNAL(currentDesktopChanged(std::string_view)),
@@ -57,10 +65,14 @@ MultiDockView::MultiDockView(MultiDockModel* model)
 }
 
 void MultiDockView::show() {
+  StartupPhase phase("MultiDockView::show");
   for (const auto& dock : docks_) {
-    dock.second->show();
+    if (!dock.second->isSuspended()) {
+      dock.second->show();
+    }
   }
   setWallpaper();
+  schedulePrefetch();
 }
 
 void MultiDockView::exit() {
@@ -74,18 +86,30 @@ void MultiDockView::onDockAdded(int dockId) {
   docks_[dockId]->show();
 }
 
+void MultiDockView::onDockRemoved(int dockId) {
+  auto it = docks_.find(dockId);
+  if (it == docks_.end()) {
+    return;
+  }
+  // Deleted later, as the removal can be requested from the dock's own menu.
+  it->second.release()->deleteLater();
+  docks_.erase(it);
+}
+
 bool MultiDockView::setWallpaper() {
   if (!model_->hasPager()) {
     return false;
   }
 
+  // A single call for all screens.
+  std::map<int, QString> wallpapers;
   for (unsigned int screen = 0; screen < WindowSystem::screens().size(); ++screen) {
-    if (!setWallpaper(screen)) {
+    if (!addWallpaper(screen, &wallpapers)) {
       return false;
     }
   }
 
-  return true;
+  return applyWallpapers(wallpapers);
 }
 
 bool MultiDockView::setWallpaper(int screen) {
@@ -93,9 +117,19 @@ bool MultiDockView::setWallpaper(int screen) {
     return false;
   }
 
+  std::map<int, QString> wallpapers;
+  return addWallpaper(screen, &wallpapers) && applyWallpapers(wallpapers);
+}
+
+bool MultiDockView::addWallpaper(int screen, std::map<int, QString>* wallpapers) {
   QString wallpaper = model_->wallpaper(WindowSystem::currentDesktop(), screen);
   if (wallpaper.isEmpty()) {
-    return false;  // nothing to do here.
+    return true;  // nothing to do here.
+  }
+
+  const auto it = wallpapers_.find(screen);
+  if (it != wallpapers_.end() && it->second == wallpaper) {
+    return true;  // already set.
   }
 
   if (!QFile::exists(wallpaper)) {
@@ -106,14 +140,33 @@ bool MultiDockView::setWallpaper(int screen) {
     return false;
   }
 
-  return desktopEnv_->setWallpaper(screen, wallpaper);
+  (*wallpapers)[screen] = wallpaper;
+  return true;
+}
+
+bool MultiDockView::applyWallpapers(const std::map<int, QString>& wallpapers) {
+  if (wallpapers.empty()) {
+    return true;
+  }
+
+  if (!desktopEnv_->setWallpapers(wallpapers)) {
+    return false;
+  }
+  for (const auto& [screen, wallpaper] : wallpapers) {
+    wallpapers_[screen] = wallpaper;
+  }
+  return true;
 }
 
 void MultiDockView::loadData() {
+  StartupPhase phase("MultiDockView::loadData");
   docks_.clear();
+  preloadIcons();
   for (int dockId = 1; dockId <= model_->dockCount(); ++dockId) {
+    StartupPhase dockPhase("DockPanel (dock " + std::to_string(dockId) + ")");
     docks_[dockId] = std::make_unique<DockPanel>(this, model_, dockId);
   }
+  IconLoader::releasePreloaded();
 
   if (docks_.empty()) {
     AddPanelDialog dialog(nullptr, model_, 0 /* dockId not needed */);
@@ -122,4 +175,38 @@ void MultiDockView::loadData() {
   }
 }
 
+void MultiDockView::preloadIcons() {
+  StartupPhase phase("MultiDockView::preloadIcons");
+  // Docks on screens with the same scale share their icons.
+  std::set<std::pair<QString, int>> icons;
+  for (int dockId = 1; dockId <= model_->dockCount(); ++dockId) {
+    // The same as the dock's until it's shown, see DockPanel::loadAppearanceConfig().
+    const int iconLoadSize =
+        DockPanel::iconLoadSizeFor(DockPanel::screenIconScale(model_->screen(dockId)));
+    if (model_->showApplicationMenu(dockId)) {
+      icons.insert({model_->applicationMenuIcon(), iconLoadSize});
+    }
+    for (const auto& launcherConfig : model_->launcherConfigs(dockId)) {
+      if (!launcherConfig.icon.isEmpty()) {
+        icons.insert({launcherConfig.icon, iconLoadSize});
+      }
+    }
+  }
+  IconLoader::preload({icons.begin(), icons.end()});
+}
+
+void MultiDockView::schedulePrefetch() {
+  if (!model_->prefetchLaunchers()) {
+    return;
+  }
+
+  QTimer::singleShot(kPrefetchDelayMs, this, [this] {
+    QStringList commands;
+    for (const auto& launcher : model_->launchersByLaunchCount()) {
+      commands.append(launcher.command);
+    }
+    Prefetcher::prefetch(commands, model_->prefetchLauncherLibraries());
+  });
+}
+
 }  // namespace crystaldock
@@ -19,6 +19,7 @@
 #ifndef CRYSTALDOCK_MULTI_DOCK_VIEW_H_
 #define CRYSTALDOCK_MULTI_DOCK_VIEW_H_
 
+#include <map>
 #include <memory>
 #include <unordered_map>
 
@@ -49,18 +50,38 @@ class MultiDockView : public QObject {
 
   void onDockAdded(int dockId);
 
+  void onDockRemoved(int dockId);
+
   bool setWallpaper();
   bool setWallpaper(int screen);
 
  private:
+  // Delay after start-up before prefetching the launchers.
+  static constexpr int kPrefetchDelayMs = 60000;  // 1 minute.
+
   void loadData();
 
+  // Loads the icons that the docks are created with concurrently, so that creating the
+  // docks doesn't have to load them one by one for each dock.
+  void preloadIcons();
+
   // Creates a default dock if none exists.
   void createDefaultDock();
 
+  // Adds the wallpaper of the current desktop for the screen, unless it's already set.
+  // Returns false if the wallpaper file is missing.
+  bool addWallpaper(int screen, std::map<int, QString>* wallpapers);
+
+  bool applyWallpapers(const std::map<int, QString>& wallpapers);
+
+  // Prefetches the pinned launchers, if enabled, once start-up has settled.
+  void schedulePrefetch();
+
   MultiDockModel* model_;  // No ownership.
   std::unordered_map<int, std::unique_ptr<DockPanel>> docks_;
   DesktopEnv* desktopEnv_;
+  // The wallpapers last set, by screen.
+  std::map<int, QString> wallpapers_;
 };
 
 }  // namespace crystaldock
@@ -18,20 +18,25 @@
 
 #include "program.h"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
-#include <QDir>
 #include <QGuiApplication>
+#include <QIcon>
 #include <QMessageBox>
-#include <QProcess>
-#include <QProcessEnvironment>
 #include <QSettings>
+#include <QStringList>
 #include <QTimer>
 
 #include "display/window_system.h"
 
 #include "dock_panel.h"
 #include <utils/draw_utils.h>
+#include <utils/launch_metrics.h>
+#include <utils/menu_utils.h>
+#include <utils/process_launcher.h>
+#include <utils/profiler.h>
 
 namespace crystaldock {
 
@@ -41,6 +46,7 @@ Program::Program(DockPanel* parent, MultiDockModel* model, const QString& appId,
                  bool pinned)
     : IconBasedDockItem(parent, model, label, orientation, icon, minSize, maxSize),
       appId_(appId),
+      appIdAtom_(AtomTable::intern(appId)),
       appLabel_(label),
       command_(command),
       isAppMenuEntry_(isAppMenuEntry),
@@ -56,6 +62,7 @@ Program::Program(DockPanel* parent, MultiDockModel* model, const QString& appId,
                  int minSize, int maxSize)
     : IconBasedDockItem(parent, model, label, orientation, icon, minSize, maxSize),
       appId_(appId),
+      appIdAtom_(AtomTable::intern(appId)),
       appLabel_(label),
       command_(""),
       isAppMenuEntry_(false),
@@ -66,39 +73,36 @@ Program::Program(DockPanel* parent, MultiDockModel* model, const QString& appId,
   init();
 }
 
+Program::~Program() {
+  Scheduler::self()->remove(attentionTask_);
+}
+
 void Program::init() {
-  createMenu();
-  animationTimer_.setInterval(500);
-  connect(&animationTimer_, &QTimer::timeout, this, [this]() {
-    attentionStrong_ = !attentionStrong_;
-    parent_->update();
-  });
-  bounceTimer_.setInterval(kBounceIntervalMs);
-  connect(&bounceTimer_, &QTimer::timeout, this, &Program::updateBounceAnimation);
+  launcherEntry_ = LauncherEntryWatcher::self()->entry(appId_);
   connect(&menu_, &QMenu::aboutToHide, this,
           [this]() {
             parent_->setShowingPopup(false);
           });
+  connect(&windowList_, &QMenu::aboutToShow, this, &Program::buildWindowList);
+  connect(&windowList_, &QMenu::aboutToHide, this,
+          [this]() {
+            parent_->setWindowListProgram(nullptr);
+            parent_->setShowingPopup(false);
+          });
 }
 
-void Program::draw(QPainter *painter) const {
-  painter->save();
-  painter->setRenderHint(QPainter::Antialiasing);
+void Program::draw(QPainter* painter, const DrawContext& context) const {
+  PROFILE_SCOPE("Program::draw");
   auto taskCount = static_cast<int>(tasks_.size());
   // For launching feedback if bouncing launcher icon is not enabled.
-  if (taskCount == 0 && launching_&& !model_->bouncingLauncherIcon()) { taskCount = 1; }
-  if (parent_->showTaskManager() && taskCount > 0) {  // Show task count indicator.
+  if (taskCount == 0 && launching_&& !context.bouncingLauncherIcon) { taskCount = 1; }
+  if (context.showTaskManager && taskCount > 0) {  // Show task count indicator.
     static constexpr int kMaxVisibleTaskCount = 4;
     if (taskCount > kMaxVisibleTaskCount) { taskCount = kMaxVisibleTaskCount; }
-    auto activeTask = getActiveTask();
+    auto activeTask = getActiveTask(context.activeWindow);
     if (activeTask > kMaxVisibleTaskCount - 1) { activeTask = kMaxVisibleTaskCount - 1; }
 
-    // Size (width if horizontal, or height if vertical) of the indicator.
-    const int size = parent_->isGlass()
-        ? DockPanel::kIndicatorSizeGlass
-        : parent_->isFlat2D()
-            ? DockPanel::kIndicatorSizeFlat2D
-            : DockPanel::kIndicatorSizeMetal2D;
+    const int size = context.indicatorSize;
     const auto spacing = DockPanel::kIndicatorSpacing;
     const auto totalSize = taskCount * size + (taskCount - 1) * spacing;
     auto x = left_ + (getWidth() - totalSize) / 2 + size / 2;
@@ -107,32 +111,12 @@ void Program::draw(QPainter *painter) const {
       // If bouncing launcher icon is not enabled, we use active color
       // to provide feedback.
       bool useActiveColor = (i == activeTask) || attentionStrong_
-          || (launching_ && !model_->bouncingLauncherIcon());
-      if (parent_->isGlass()) {
-        const auto baseColor = useActiveColor
-            ? model_->activeIndicatorColor() : model_->inactiveIndicatorColor();
-        drawIndicator(orientation_, x, parent_->taskIndicatorPos(),
-                      parent_->taskIndicatorPos(), y,
-                      size, DockPanel::k3DPanelThickness, baseColor, painter);
-      } else if (parent_->isFlat2D()) {
-        const auto baseColor = useActiveColor
-            ? model_->activeIndicatorColor2D() : model_->inactiveIndicatorColor2D();
-        drawIndicatorFlat2D(orientation_, x, parent_->taskIndicatorPos(),
-                            parent_->taskIndicatorPos(), y,
-                            size, baseColor, painter);
-      } else {  // Metal 2D.
-          const auto baseColor = useActiveColor
-              ? model_->activeIndicatorColorMetal2D() : model_->inactiveIndicatorColorMetal2D();
-          drawIndicatorMetal2D(parent_->position(), x, parent_->taskIndicatorPos(),
-                               parent_->taskIndicatorPos(), y,
-                               size, baseColor, painter);
-      }
+          || (launching_ && !context.bouncingLauncherIcon);
+      parent_->drawTaskIndicator(x, y, useActiveColor, context, painter);
       x += (size + spacing);
       y += (size + spacing);
     }
   }
-  painter->setRenderHint(QPainter::Antialiasing, false);
-  painter->restore();
 
   painter->save();
   if (bouncing_) {
@@ -144,9 +128,21 @@ void Program::draw(QPainter *painter) const {
     }
   }
 
-  IconBasedDockItem::draw(painter);
-  if (!model_->groupTasksByApplication() && !tasks_.empty() &&
-      parent_->itemCount(appId_) > 1) {
+  IconBasedDockItem::draw(painter, context);
+  if (launcherEntry_.progressVisible) {
+    // Along the bottom of the icon.
+    const int width = getWidth() * 3 / 4;
+    const int height = std::max(getHeight() / 12, 3);
+    const int x = left_ + (getWidth() - width) / 2;
+    const int y = top_ + getHeight() - height - getHeight() / 16;
+    painter->fillRect(x, y, width, height, QColor(0, 0, 0, 160));
+    painter->fillRect(x, y, std::round(width * launcherEntry_.progress), height, Qt::white);
+  }
+  if (launcherEntry_.countVisible && launcherEntry_.count > 0) {
+    parent_->drawBadge(left_ + getWidth(), top_, launcherEntry_.count, painter);
+  }
+  if (!context.groupTasksByApplication && !tasks_.empty() &&
+      context.appItemCounts.value(appId_) > 1) {
     QString letter;
     for (auto i = 0; i < label_.size(); ++i) {
       if (label_.at(i).isLetter()) {
@@ -205,7 +201,13 @@ void Program::mousePressEvent(QMouseEvent* e) {
         }
       }
     }
+  } else if (e->button() == Qt::MiddleButton) {
+    showWindowList();
   } else if (e->button() == Qt::RightButton) {
+    if (menu_.isEmpty()) {
+      createMenu();
+    }
+    updateMenu();
     showPopupMenu(&menu_);
   }
 }
@@ -222,16 +224,17 @@ bool Program::addTask(const WindowInfo* task) {
     return false;
   }
 
-  auto* app = model_->findApplication(task->appId);
-  if ((app && app->appId == appId_) || task->appId == appId_.toStdString()) {
-    tasks_.push_back(ProgramTask(task->window, QString::fromStdString(task->title),
-                                 task->demandsAttention));
+  if (matchesApp(task)) {
+    tasks_.push_back(ProgramTask(task->window, task->demandsAttention));
     if (task->demandsAttention) {
       setDemandsAttention(true);
     }
+    if (windowList_.isVisible()) {
+      addWindowListRow(task);
+    }
     updateMenu();
     if (!model_->groupTasksByApplication()) {
-      setLabel(QString::fromStdString(task->title));
+      setLabel(task->qTitle);
     }
     return true;
   }
@@ -239,7 +242,7 @@ bool Program::addTask(const WindowInfo* task) {
 }
 
 bool Program::updateTask(const WindowInfo* task) {
-  if (task->appId != appId_.toStdString()) {
+  if (task->appIdAtom != appIdAtom_) {
     return false;
   }
 
@@ -258,6 +261,11 @@ bool Program::removeTask(void* window) {
   for (int i = 0; i < static_cast<int>(tasks_.size()); ++i) {
     if (tasks_[i].window == window) {
       tasks_.erase(tasks_.begin() + i);
+      if (auto it = windowListRows_.find(window); it != windowListRows_.end()) {
+        windowList_.removeAction(it->second);
+        it->second->deleteLater();
+        windowListRows_.erase(it);
+      }
       updateMenu();
       return true;
     }
@@ -291,12 +299,57 @@ bool Program::shouldBeRemoved() {
 
 void Program::launch() {
   launching_ = true;
-  parent_->update();
-  launch(command_);
-  QTimer::singleShot(kLaunchingAcknowledgementDurationMs,
-                     [this] {
-                       launching_ = false; parent_->update();
-                     });
+  parent_->updateItem(this);
+  launch(command_, appId_, parent_);
+  model_->recordLaunch(appId_);
+
+  // Correlates the launch with the application's next window. The compositor doesn't
+  // tell us which window consumed the activation token, so we go by app ID.
+  const int launchId = ++launchId_;
+  launchTimer_.start();
+  if (!trackingLaunch_) {
+    trackingLaunch_ = true;
+    windowAddedConnection_ = connect(WindowSystem::self(), &WindowSystem::windowAdded,
+                                     this, &Program::onLaunchedWindowAdded);
+  }
+  QTimer::singleShot(kLaunchingAcknowledgementDurationMs, this, [this, launchId] {
+    if (launchId == launchId_) {
+      stopLaunchingFeedback();
+    }
+  });
+  QTimer::singleShot(kLaunchTrackingTimeoutMs, this, [this, launchId] {
+    if (launchId == launchId_ && trackingLaunch_) {
+      trackingLaunch_ = false;
+      disconnect(windowAddedConnection_);
+      LaunchMetrics::recordTimeout(appId_);
+    }
+  });
+}
+
+bool Program::matchesApp(const WindowInfo* task) const {
+  if (task->appIdAtom == appIdAtom_) {
+    return true;
+  }
+  auto* app = model_->findApplication(task->appId());
+  return app && app->appId == appId_;
+}
+
+void Program::onLaunchedWindowAdded(const WindowInfo* task) {
+  if (!matchesApp(task)) {
+    return;
+  }
+
+  trackingLaunch_ = false;
+  disconnect(windowAddedConnection_);
+  LaunchMetrics::record(appId_, launchTimer_.elapsed());
+  stopLaunchingFeedback();
+}
+
+void Program::stopLaunchingFeedback() {
+  if (launching_) {
+    launching_ = false;
+    parent_->updateItem(this);
+  }
 }
 
 void Program::pinUnpin() {
@@ -312,24 +365,16 @@ void Program::pinUnpin() {
   parent_->updatePinnedStatus(appId_, pinned_);
 }
 
-void Program::launch(const QString& command) {
-  QStringList list = QProcess::splitCommand(command);
-  QProcess process;
-  process.setProgram(list.at(0));
-  process.setArguments(list.mid(1));
-  auto env = QProcessEnvironment::systemEnvironment();
-  // Unset XDG_ACTIVATION_TOKEN.
-  env.insert("XDG_ACTIVATION_TOKEN", "");
-  // Unset layer-shell env.
-  env.insert("QT_WAYLAND_SHELL_INTEGRATION", "");
-  process.setProcessEnvironment(env);
-  process.setWorkingDirectory(QDir::homePath());
-  if (!process.startDetached()) {
-    QMessageBox warning(QMessageBox::Warning, "Error",
-                        QString("Could not run command: ") + command,
-                        QMessageBox::Ok, nullptr, Qt::Tool);
-    warning.exec();
-  }
+void Program::launch(const QString& command, const QString& appId, QWidget* widget) {
+  WindowSystem::requestActivationToken(appId, widget, [command, appId](const QString& token) {
+    ProcessLauncher::launch(command, appId, [](const QString& error) {
+      // Not modal, so that the dock keeps running.
+      auto* warning = new QMessageBox(QMessageBox::Warning, "Error", error, QMessageBox::Ok,
+                                      nullptr, Qt::Tool);
+      warning->setAttribute(Qt::WA_DeleteOnClose);
+      warning->show();
+    }, token);
+  });
 }
 
 void Program::closeAllWindows() {
@@ -338,6 +383,67 @@ void Program::closeAllWindows() {
   }
 }
 
+void Program::showWindowList() {
+  if (tasks_.empty()) {
+    return;
+  }
+
+  showPopupMenu(&windowList_);
+  windowList_.clear();
+  windowListRows_.clear();
+}
+
+void Program::updateWindowListRow(const WindowInfo* task) {
+  if (auto it = windowListRows_.find(task->window); it != windowListRows_.end()) {
+    it->second->setText(windowListRowText(task));
+  }
+}
+
+void Program::buildWindowList() {
+  windowList_.clear();
+  windowListRows_.clear();
+  windowList_.addSection(QIcon::fromTheme(iconName_), label_);
+  // In mapping order, i.e. the order the windows have been opened in.
+  for (const WindowInfo* task : WindowSystem::windows()) {
+    if (hasTask(task->window)) {
+      addWindowListRow(task);
+    }
+  }
+  parent_->setWindowListProgram(this);
+}
+
+void Program::addWindowListRow(const WindowInfo* task) {
+  void* window = task->window;
+  windowListRows_[window] = windowList_.addAction(
+      windowListRowText(task), this, [window] { WindowSystem::activateWindow(window); });
+}
+
+/* static */ QString Program::windowListRowText(const WindowInfo* task) {
+  QStringList details;
+  if (WindowSystem::numberOfDesktops() > 1) {
+    if (task->onAllDesktops) {
+      details << "All Desktops";
+    } else {
+      for (const auto& desktop : WindowSystem::desktops()) {
+        if (desktop.id == task->desktop) {
+          details << QString::fromStdString(desktop.name);
+          break;
+        }
+      }
+    }
+  }
+  if (task->minimized) {
+    details << "Minimized";
+  }
+
+  // Not a mnemonic.
+  QString text = QString(task->qTitle).replace('&', "&&");
+  if (!details.isEmpty()) {
+    text += " (" + details.join(", ") + ")";
+  }
+  return text;
+}
+
 void Program::createMenu() {
   menu_.addSection(QIcon::fromTheme(iconName_), label_);
 
@@ -356,6 +462,13 @@ void Program::createMenu() {
                     [this] { launch(); });
   }
 
+  windowListAction_ = menu_.addAction(
+      QIcon::fromTheme("window"), QString("&Windows..."), this,
+      [this] {
+        // Once the context menu has closed.
+        QTimer::singleShot(0, this, [this] { showWindowList(); });
+      });
+
   closeAction_ = menu_.addAction(QIcon::fromTheme("window-close"), QString("&Close Window"), this,
                                  [this] { closeAllWindows(); });
 
@@ -363,16 +476,13 @@ void Program::createMenu() {
   menu_.addAction(QIcon::fromTheme("configure"), QString("Edit &Launchers"), parent_,
                   [this] { parent_->showEditLaunchersDialog(); });
 
-  if (model_->showTaskManager(parent_->dockId())) {
-    menu_.addAction(QIcon::fromTheme("configure"),
-                    QString("Task Manager &Settings"),
-                    parent_,
-                    [this] { parent_->showTaskManagerSettingsDialog(); });
-  }
+  // Shown only if the task manager is on, see updateMenu().
+  taskManagerSettingsAction_ = menu_.addAction(
+      QIcon::fromTheme("configure"), QString("Task Manager &Settings"), parent_,
+      [this] { parent_->showTaskManagerSettingsDialog(); });
 
   menu_.addSeparator();
   parent_->addPanelSettings(&menu_);
-  updateMenu();
 }
 
 void Program::setDemandsAttention(bool value) {
@@ -382,15 +492,44 @@ void Program::setDemandsAttention(bool value) {
 
   demandsAttention_ = value;
   if (demandsAttention_) {
-    animationTimer_.start();
-  } else if (animationTimer_.isActive()) {
-    animationTimer_.stop();
+    attentionTask_ = Scheduler::self()->addPeriodic(
+        parent_, kAttentionBlinkIntervalMs, [this]() {
+          attentionStrong_ = !attentionStrong_;
+          parent_->updateItem(this);
+          parent_->requestAnimationFrame();
+        });
+  } else {
+    Scheduler::self()->remove(attentionTask_);
+    attentionTask_ = -1;
     attentionStrong_ = false;
   }
-  parent_->update();
+  parent_->updateItem(this);
+}
+
+void Program::addMemoryUsage(RuntimeMetrics::DockMemory* memory) const {
+  IconBasedDockItem::addMemoryUsage(memory);
+  memory->menuActions += countMenuActions(menu_) + countMenuActions(windowList_);
+}
+
+bool Program::updateLauncherEntry() {
+  const auto& entry = LauncherEntryWatcher::self()->entry(appId_);
+  if (entry == launcherEntry_) {
+    return false;
+  }
+
+  const bool urgentChanged = entry.urgent != launcherEntry_.urgent;
+  launcherEntry_ = entry;
+  if (urgentChanged) {
+    updateDemandsAttention();
+  }
+  return true;
 }
 
 void Program::updateDemandsAttention() {
+  if (launcherEntry_.urgent) {
+    setDemandsAttention(true);
+    return;
+  }
   for (const auto& task : tasks_) {
     if (task.demandsAttention) {
       setDemandsAttention(true);
@@ -401,8 +540,15 @@ void Program::updateDemandsAttention() {
 }
 
 void Program::updateMenu() {
+  // The menu is only created when it is first shown.
+  if (menu_.isEmpty()) {
+    return;
+  }
+
+  windowListAction_->setVisible(tasks_.size() > 1);
   closeAction_->setVisible(!tasks_.empty());
   closeAction_->setText(tasks_.size() > 1 ? "&Close All Windows" : "&Close Window");
+  taskManagerSettingsAction_->setVisible(parent_->showTaskManager());
 }
 
 void Program::startBounceAnimation() {
@@ -414,35 +560,38 @@ void Program::startBounceAnimation() {
     bouncing_ = true;
     bouncingUp_ = true;
     bounceProgress_ = 0.0f;
+    bounceStartMs_ = -1;
     setAnimationStartAsCurrent();
-    bounceTimer_.start();
+    parent_->requestAnimationFrame();
   }
 }
 
-void Program::updateBounceAnimation() {
+bool Program::updateFrameAnimation(qint64 nowMs) {
   if (!bouncing_) {
-    return;
+    return false;
   }
 
-  float bounceStep = 1.0f / kBounceSteps;
-  float nextBounceRatio = bounceProgress_ + bounceStep;
-  if (nextBounceRatio < 1.0f) {
-    bounceProgress_ = nextBounceRatio;
-  } else {
-    if (!bouncingUp_) {
-      // Done and done
-      bounceProgress_ = 1.0f;
-      bouncing_ = false;
-      bounceTimer_.stop();
-      return;
-    }
-
-    // It was bouncing up
+  if (bounceStartMs_ < 0) {
+    bounceStartMs_ = nowMs;
+  }
+  const qint64 elapsed = nowMs - bounceStartMs_;
+  if (elapsed >= 2 * kBouncePhaseDurationMs && launching_) {
+    // Keeps bouncing until the window is mapped.
+    bounceStartMs_ = nowMs;
+    bouncingUp_ = true;
     bounceProgress_ = 0.0f;
-    bouncingUp_ = false;
+    return true;
+  }
+  if (elapsed >= 2 * kBouncePhaseDurationMs) {
+    // Done and done
+    bounceProgress_ = 1.0f;
+    bouncing_ = false;
+    return false;
   }
 
-  parent_->update();
+  bouncingUp_ = elapsed < kBouncePhaseDurationMs;
+  bounceProgress_ = static_cast<float>(elapsed % kBouncePhaseDurationMs) / kBouncePhaseDurationMs;
+  return true;
 }
 
 float Program::getBounceOffset() const {
@@ -19,32 +19,39 @@
 #ifndef CRYSTALDOCK_PROGRAM_H_
 #define CRYSTALDOCK_PROGRAM_H_
 
+#include <unordered_map>
 #include <vector>
 
 #include <QAction>
+#include <QElapsedTimer>
 #include <QMenu>
 #include <QPixmap>
 #include <QTimer>
 
 #include "display/window_system.h"
+#include "model/launcher_entry_watcher.h"
+#include "utils/scheduler.h"
 
 #include "icon_based_dock_item.h"
 
 namespace crystaldock {
 
+// The title is read from the window's WindowInfo by handle, not copied here.
 struct ProgramTask {
   void* window;
-  QString name;  // e.g. home -- Dolphin
   bool demandsAttention;
 
-  ProgramTask(void* window2, QString name2, bool demandsAttention2)
-    : window(window2), name(name2), demandsAttention(demandsAttention2) {}
+  ProgramTask(void* window2, bool demandsAttention2)
+    : window(window2), demandsAttention(demandsAttention2) {}
 };
 
 class Program : public QObject, public IconBasedDockItem {
   Q_OBJECT
 
  public:
+  // How far launcher icons bounce up when launching.
+  static constexpr int kBounceHeight = 32;
+
   Program(DockPanel* parent, MultiDockModel* model, const QString& appId,
           const QString& label, Qt::Orientation orientation, const QPixmap& icon,
           int minSize, int maxSize, const QString& command, bool isAppMenuEntry, bool pinned);
@@ -55,9 +62,9 @@ class Program : public QObject, public IconBasedDockItem {
 
   void init();
 
-  ~Program() override = default;
+  ~Program() override;
 
-  void draw(QPainter* painter) const override;
+  void draw(QPainter* painter, const DrawContext& context) const override;
 
   void mousePressEvent(QMouseEvent* e) override;
 
@@ -69,11 +76,20 @@ class Program : public QObject, public IconBasedDockItem {
 
   void updatePinnedStatus(bool pinned) override {
     pinned_ = pinned;
-    pinAction_->setChecked(pinned_);
+    if (pinAction_ != nullptr) {
+      pinAction_->setChecked(pinned_);
+    }
   }
 
   bool addTask(const WindowInfo* task) override;
 
+  // Removes all tasks, e.g. before the item is reused and its tasks added again.
+  void clearTasks() {
+    tasks_.clear();
+    updateDemandsAttention();
+    updateMenu();
+  }
+
   bool updateTask(const WindowInfo* task) override;
 
   bool removeTask(void* window) override;
@@ -90,44 +106,78 @@ class Program : public QObject, public IconBasedDockItem {
 
   void setDemandsAttention(bool demandsAttention) override;
 
+  bool updateLauncherEntry() override;
+
+  void addMemoryUsage(RuntimeMetrics::DockMemory* memory) const override;
+
+  bool updateFrameAnimation(qint64 nowMs) override;
+
   int taskCount() const { return static_cast<int>(tasks_.size()); }
 
   bool active() const { return getActiveTask() >= 0; }
 
-  int getActiveTask() const {
+  int getActiveTask() const { return getActiveTask(WindowSystem::activeWindow()); }
+
+  int getActiveTask(void* activeWindow) const {
     for (int i = 0; i < static_cast<int>(tasks_.size()); ++i) {
-      if (WindowSystem::activeWindow() == tasks_[i].window) {
+      if (activeWindow == tasks_[i].window) {
         return i;
       }
     }
     return -1;
   }
 
-  bool pinned() { return pinned_; }
+  bool pinned() const { return pinned_; }
+
+  const QString& command() const { return command_; }
   void pinUnpin();
 
   void launch();
-  static void launch(const QString& command);
+  // Launches the command detached, with an xdg-activation token for the last input
+  // event on `widget` if the compositor supports it. appId names its cgroup scope.
+  static void launch(const QString& command, const QString& appId = QString(),
+                     QWidget* widget = nullptr);
 
   void closeAllWindows();
 
+  // Shows the list of the program's windows, to activate one of them.
+  void showWindowList();
+  // Updates the window's row while the window list is shown.
+  void updateWindowListRow(const WindowInfo* task);
+
  private:
-  static constexpr int kLaunchingAcknowledgementDurationMs = 3000;  // 3 seconds.
+  // The launching feedback stops once the application's window is mapped, or after
+  // this if it never is, e.g. for programs without a window.
+  static constexpr int kLaunchingAcknowledgementDurationMs = 5000;  // 5 seconds.
+  // How long we wait for the window for the launch latency metric.
+  static constexpr int kLaunchTrackingTimeoutMs = 30000;  // 30 seconds.
 
   // For bounce animation.
-  static constexpr int kBounceHeight = 32;
-  static constexpr int kBounceSteps = 12;
-  static constexpr int kBounceIntervalMs = 25;
+  // Duration of each of the up and down phases.
+  static constexpr int kBouncePhaseDurationMs = 300;
   static constexpr float kBounceEaseIn = 2.0f;
   static constexpr float kBounceEaseOut = 2.0f;
 
   void createMenu();
 
+  // Adds the rows of the window list, when it's about to be shown.
+  void buildWindowList();
+  void addWindowListRow(const WindowInfo* task);
+  // The window's title, followed by its desktop and whether it's minimized.
+  static QString windowListRowText(const WindowInfo* task);
+
   void updateDemandsAttention();
 
   void updateMenu();
 
+  bool matchesApp(const WindowInfo* task) const;
+
+  void onLaunchedWindowAdded(const WindowInfo* task);
+
+  void stopLaunchingFeedback();
+
   QString appId_;
+  AtomTable::Atom appIdAtom_;
   QString appLabel_;
   QString command_;
   // Is an entry on the App Menu, exluding system commands such as Lock Screen / Shut Down.
@@ -135,26 +185,44 @@ class Program : public QObject, public IconBasedDockItem {
   bool pinned_;
   std::vector<ProgramTask> tasks_;
 
-  // Context (right-click) menu.
+  // Context (right-click) menu, created on first use.
   QMenu menu_;
-  QAction* pinAction_;
-  QAction* closeAction_;
+  QAction* pinAction_ = nullptr;
+  QAction* closeAction_ = nullptr;
+  QAction* windowListAction_ = nullptr;
+  QAction* taskManagerSettingsAction_ = nullptr;
+
+  // The list of the windows (shown on middle click), whose rows only exist while it's
+  // shown, so that window events don't have anything to update otherwise.
+  QMenu windowList_;
+  std::unordered_map<void*, QAction*> windowListRows_;
+
+  // The count badge and progress bar, and whether the application asks for attention.
+  LauncherEntryWatcher::Entry launcherEntry_;
 
   // Demands attention logic.
   bool demandsAttention_;
-  QTimer animationTimer_;
+  static constexpr int kAttentionBlinkIntervalMs = 500;
+  // The blinking task while demanding attention, -1 otherwise.
+  Scheduler::TaskId attentionTask_ = -1;
   bool attentionStrong_;
 
   // For launching acknowledgement.
   bool launching_;
+  // While waiting for the window of the last launch.
+  bool trackingLaunch_ = false;
+  QElapsedTimer launchTimer_;
+  // Identifies the last launch, so that the timeouts of earlier ones are ignored.
+  int launchId_ = 0;
+  QMetaObject::Connection windowAddedConnection_;
 
-  QTimer bounceTimer_;
   bool bouncing_ = false;
   float bounceProgress_ = 0.0f;
   bool bouncingUp_ = true;
+  // On the dock's animation clock, or -1 if the bounce starts on the next frame.
+  qint64 bounceStartMs_ = -1;
 
   void startBounceAnimation();
-  void updateBounceAnimation();
   float getBounceOffset() const;
 
   friend class DockPanel;
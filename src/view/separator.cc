@@ -19,6 +19,7 @@
 #include "separator.h"
 
 #include "dock_panel.h"
+#include <utils/profiler.h>
 
 namespace crystaldock {
 
@@ -32,7 +33,8 @@ Separator::Separator(DockPanel* parent, MultiDockModel* model, Qt::Orientation o
   whRatio_ = 0.5;
 }
 
-void Separator::draw(QPainter* painter) const {
+void Separator::draw(QPainter* painter, const DrawContext& context) const {
+  PROFILE_SCOPE("Separator::draw");
   int x, y, w, h;
   if (orientation_ == Qt::Horizontal) {
     x = left_ + getWidth() / 2;
@@ -32,7 +32,7 @@ class Separator : public QObject, public IconlessDockItem {
         int minSize, int maxSize, bool isLauncherSeparator);
   virtual ~Separator() = default;
 
-  void draw(QPainter* painter) const override;
+  void draw(QPainter* painter, const DrawContext& context) const override;
 
   void mousePressEvent(QMouseEvent* e) override { /* no-op */ }
 
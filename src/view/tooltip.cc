@@ -0,0 +1,54 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "tooltip.h"
+
+#include <QPainter>
+
+#include <utils/draw_utils.h>
+
+namespace crystaldock {
+
+Tooltip::Tooltip(QWidget* parent)
+    : QWidget(parent, Qt::ToolTip | Qt::FramelessWindowHint | Qt::WindowTransparentForInput) {
+  setAttribute(Qt::WA_TranslucentBackground);
+  setAttribute(Qt::WA_ShowWithoutActivating);
+}
+
+void Tooltip::showText(const QString& text, const QRect& rect) {
+  if (text != text_) {
+    text_ = text;
+    update();
+  }
+  if (geometry() != rect) {
+    setGeometry(rect);
+  }
+  if (isHidden()) {
+    show();
+  }
+}
+
+void Tooltip::paintEvent(QPaintEvent* e) {
+  QPainter painter(this);
+  painter.setFont(font());
+  drawBorderedText(kBorderWidth, kBorderWidth + fontMetrics().ascent(), text_, kBorderWidth,
+                   Qt::black, Qt::white, &painter);
+}
+
+}  // namespace crystaldock
@@ -0,0 +1,50 @@
+/*
+ * This file is part of Crystal Dock.
+ * Copyright (C) 2025 Viet Dang (dangvd@gmail.com)
+ *
+ * Crystal Dock is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Crystal Dock is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Crystal Dock.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CRYSTALDOCK_TOOLTIP_H_
+#define CRYSTALDOCK_TOOLTIP_H_
+
+#include <QPaintEvent>
+#include <QRect>
+#include <QString>
+#include <QWidget>
+
+namespace crystaldock {
+
+// The label of the active dock item, in a small popup surface of its own, so that the
+// dock's surface doesn't need to make room for it.
+class Tooltip : public QWidget {
+ public:
+  static constexpr int kBorderWidth = 2;
+
+  explicit Tooltip(QWidget* parent);
+
+  // Shows the text in the rect, in global coordinates.
+  void showText(const QString& text, const QRect& rect);
+
+ protected:
+  void paintEvent(QPaintEvent* e) override;
+
+ private:
+  QString text_;
+};
+
+}  // namespace crystaldock
+
+#endif  // CRYSTALDOCK_TOOLTIP_H_
@@ -18,48 +18,193 @@
 
 #include "trash.h"
 
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
 #include <QApplication>
 #include <QDateTime>
 #include <QDir>
+#include <QDirIterator>
 #include <QFileInfo>
 #include <QMouseEvent>
 #include <QPainter>
 #include <QProcess>
+#include <QPointer>
 #include <QProcessEnvironment>
 #include <QStandardPaths>
-#include <QTextStream>
+#include <QThreadPool>
 
 #include <utils/draw_utils.h>
 #include <utils/font_utils.h>
+#include <utils/profiler.h>
 
 #include "dock_panel.h"
 #include "program.h"
 
 namespace crystaldock {
 
+namespace {
+
+constexpr QDir::Filters kAllEntries =
+    QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System;
+
+constexpr int kMaxNameAttempts = 10000;
+
+// A single worker thread, so that trash operations run in order.
+QThreadPool* workerPool() {
+  static QThreadPool* pool = [] {
+    auto* pool = new QThreadPool();
+    pool->setMaxThreadCount(1);
+    return pool;
+  }();
+  return pool;
+}
+
+// Removes the file or directory tree. Returns false if cancelled or not fully removed.
+bool removeTree(const QString& path, const std::atomic<bool>& cancelled) {
+  const QFileInfo fileInfo(path);
+  if (!fileInfo.isDir() || fileInfo.isSymLink()) {
+    return QFile::remove(path);
+  }
+
+  bool removed = true;
+  QDirIterator it(path, kAllEntries);
+  while (it.hasNext()) {
+    if (cancelled) {
+      return false;
+    }
+    removed = removeTree(it.next(), cancelled) && removed;
+  }
+  return removed && QDir().rmdir(path);
+}
+
+// Copies the file or directory tree, keeping symlinks as they are.
+bool copyTree(const QString& source, const QString& dest) {
+  const QFileInfo fileInfo(source);
+  if (fileInfo.isSymLink()) {
+    return QFile::link(fileInfo.symLinkTarget(), dest);
+  }
+  if (!fileInfo.isDir()) {
+    // Copies in chunks, and keeps the permissions.
+    return QFile::copy(source, dest);
+  }
+
+  if (!QDir().mkdir(dest)) {
+    return false;
+  }
+  QFile::setPermissions(dest, fileInfo.permissions());
+  QDirIterator it(source, kAllEntries);
+  while (it.hasNext()) {
+    it.next();
+    if (!copyTree(it.filePath(), dest + "/" + it.fileName())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Moves the file or directory to the trash, following the FreeDesktop.org trash spec.
+bool trashFile(const QString& filePath, const QString& filesPath, const QString& infoPath) {
+  const QFileInfo fileInfo(filePath);
+  if (!fileInfo.exists() && !fileInfo.isSymLink()) {
+    return false;
+  }
+
+  // Reserves the name by creating its info file exclusively, in case another
+  // application is trashing a file with the same name.
+  QString fileName = fileInfo.fileName();
+  QString destPath = filesPath + "/" + fileName;
+  QFile infoFile(infoPath + "/" + fileName + ".trashinfo");
+  for (int counter = 1;
+       QFileInfo::exists(destPath) || !infoFile.open(QIODevice::WriteOnly | QIODevice::NewOnly);
+       ++counter) {
+    const QString baseName = fileInfo.baseName();
+    const QString suffix = fileInfo.completeSuffix();
+    fileName = suffix.isEmpty() ? QString("%1_%2").arg(baseName).arg(counter)
+                                : QString("%1_%2.%3").arg(baseName).arg(counter).arg(suffix);
+    destPath = filesPath + "/" + fileName;
+    infoFile.setFileName(infoPath + "/" + fileName + ".trashinfo");
+    if (counter > kMaxNameAttempts) {
+      return false;
+    }
+  }
+
+  const QString absolutePath = fileInfo.absoluteFilePath();
+  infoFile.write("[Trash Info]\nPath=" + QUrl::toPercentEncoding(absolutePath, "/") +
+                 "\nDeletionDate=" +
+                 QDateTime::currentDateTime().toString("yyyy-MM-ddThh:mm:ss").toUtf8() + "\n");
+  infoFile.close();
+
+  struct stat sourceStat;
+  struct stat destStat;
+  const bool sameDevice = lstat(QFile::encodeName(absolutePath), &sourceStat) == 0 &&
+      stat(QFile::encodeName(filesPath), &destStat) == 0 &&
+      sourceStat.st_dev == destStat.st_dev;
+  const std::atomic<bool> notCancelled = false;
+  if (sameDevice) {
+    if (std::rename(QFile::encodeName(absolutePath), QFile::encodeName(destPath)) == 0) {
+      return true;
+    }
+  } else if (copyTree(absolutePath, destPath)) {
+    // The trash has the only complete copy now, so it's kept even if the source
+    // can be removed only partly.
+    if (!removeTree(absolutePath, notCancelled)) {
+      std::cerr << "Could not remove all of " << absolutePath.toStdString()
+                << " after copying it to the trash" << std::endl;
+      return false;
+    }
+    return true;
+  } else if (QFileInfo::exists(destPath) || QFileInfo(destPath).isSymLink()) {
+    // The partial copy.
+    removeTree(destPath, notCancelled);
+  }
+  infoFile.remove();
+  return false;
+}
+
+}  // namespace
+
 Trash::Trash(DockPanel* parent, MultiDockModel* model, Qt::Orientation orientation,
              int minSize, int maxSize)
     : IconBasedDockItem(parent, model, "Trash", orientation, kEmptyTrashIconName, 
                         minSize, maxSize),
-      trashWatcher_(nullptr),
+      inotifyFd_(-1),
+      filesWatch_(-1),
+      infoWatch_(-1),
+      trashNotifier_(nullptr),
+      numFiles_(0),
+      numInfoFiles_(0),
       isEmpty_(true),
-      acceptingDrop_(false) {
+      acceptingDrop_(false),
+      emptyTrashProgress_(0) {
   
   trashPath_ = getTrashPath();
   trashInfoPath_ = getTrashInfoPath();
   trashFilesPath_ = getTrashFilesPath();
-  
-  createMenu();
-  setupTrashWatcher();
-  updateTrashState();
+
+  // The trash is shown as empty until the watcher is set up in completeInit().
   connect(&menu_, &QMenu::aboutToHide, this,
           [this]() {
             parent_->setShowingPopup(false);
           });
 }
 
-void Trash::draw(QPainter* painter) const {
-  IconBasedDockItem::draw(painter);
+Trash::~Trash() {
+  delete trashNotifier_;
+  if (inotifyFd_ >= 0) {
+    close(inotifyFd_);
+  }
+}
+
+void Trash::draw(QPainter* painter, const DrawContext& context) const {
+  PROFILE_SCOPE("Trash::draw");
+  IconBasedDockItem::draw(painter, context);
   
   if (acceptingDrop_) {
     painter->save();
@@ -75,39 +220,104 @@ void Trash::mousePressEvent(QMouseEvent* e) {
   if (e->button() == Qt::LeftButton) {
     openTrash();
   } else if (e->button() == Qt::RightButton) {
+    if (menu_.isEmpty()) {
+      createMenu();
+    }
     showPopupMenu(&menu_);
   }
 }
 
 QString Trash::getLabel() const {
+  if (emptyTrashCancelled_) {
+    return QString("Trash (Emptying %1%)").arg(emptyTrashProgress_);
+  }
   return isEmpty_ ? "Trash (Empty)" : "Trash (Full)";
 }
 
+void Trash::completeInit() {
+  if (inotifyFd_ >= 0) {
+    return;
+  }
+  setupTrashWatcher();
+  updateTrashState();
+}
+
 void Trash::updateTrashState() {
   bool wasEmpty = isEmpty_;
-  isEmpty_ = isTrashEmpty();
-  
+  isEmpty_ = numFiles_ == 0 && numInfoFiles_ == 0;
+
   if (isEmpty_ != wasEmpty) {
     updateIcon();
-    parent_->update();
+    parent_->updateItem(this);
   }
 }
 
 void Trash::emptyTrash() {
-  if (isEmpty_) {
+  if (isEmpty_ || emptyTrashCancelled_) {
     return;
   }
-  
-  QDir trashFilesDir(trashFilesPath_);
-  QDir trashInfoDir(trashInfoPath_);
-  
-  trashFilesDir.removeRecursively();
-  trashInfoDir.removeRecursively();
-  
-  QDir().mkpath(trashFilesPath_);
-  QDir().mkpath(trashInfoPath_);
-  
-  updateTrashState();
+
+  emptyTrashCancelled_ = std::make_shared<std::atomic<bool>>(false);
+  emptyTrashProgress_ = 0;
+  updateMenu();
+  parent_->updateItem(this);
+
+  // The counts and the icon follow from the inotify events as the entries are removed.
+  QPointer<Trash> guard(this);
+  workerPool()->start([trashPath = trashPath_, filesPath = trashFilesPath_,
+                       infoPath = trashInfoPath_, cancelled = emptyTrashCancelled_, guard]() {
+    auto post = [](auto callback) {
+      QMetaObject::invokeMethod(QCoreApplication::instance(), callback, Qt::QueuedConnection);
+    };
+
+    const QStringList names = QDir(filesPath).entryList(kAllEntries);
+    int lastPercent = 0;
+    for (int i = 0; i < names.size() && !*cancelled; ++i) {
+      if (removeTree(filesPath + "/" + names[i], *cancelled)) {
+        QFile::remove(infoPath + "/" + names[i] + ".trashinfo");
+      }
+      const int percent = (i + 1) * 100 / names.size();
+      if (percent != lastPercent) {
+        lastPercent = percent;
+        post([guard, percent]() {
+          if (guard) {
+            guard->onEmptyTrashProgress(percent);
+          }
+        });
+      }
+    }
+
+    if (!*cancelled) {
+      // Info files of missing trashed files.
+      for (const auto& name : QDir(infoPath).entryList(kAllEntries)) {
+        QFile::remove(infoPath + "/" + name);
+      }
+      QFile::remove(trashPath + "/directorysizes");
+    }
+
+    post([guard]() {
+      if (guard) {
+        guard->onEmptyTrashFinished();
+      }
+    });
+  });
+}
+
+void Trash::stopEmptyingTrash() {
+  if (emptyTrashCancelled_) {
+    *emptyTrashCancelled_ = true;
+  }
+}
+
+void Trash::onEmptyTrashProgress(int percent) {
+  emptyTrashProgress_ = percent;
+  parent_->updateItem(this);
+}
+
+void Trash::onEmptyTrashFinished() {
+  emptyTrashCancelled_.reset();
+  updateMenu();
+  parent_->updateItem(this);
 }
 
 void Trash::openTrash() {
@@ -116,7 +326,7 @@ void Trash::openTrash() {
 
 void Trash::setAcceptDrops(bool accept) {
   acceptingDrop_ = accept;
-  parent_->update();
+  parent_->updateItem(this);
 }
 
 bool Trash::canAcceptDrop(const QMimeData* mimeData) const {
@@ -153,54 +363,40 @@ void Trash::dropEvent(QDropEvent* event) {
 void Trash::createMenu() {
   emptyTrashAction_ = menu_.addAction(QIcon::fromTheme("trash-empty"), "Empty Trash");
   connect(emptyTrashAction_, &QAction::triggered, this, &Trash::emptyTrash);
+  stopEmptyingTrashAction_ = menu_.addAction(QIcon::fromTheme("process-stop"),
+                                             "Stop Emptying Trash");
+  connect(stopEmptyingTrashAction_, &QAction::triggered, this, &Trash::stopEmptyingTrash);
+  updateMenu();
 
   menu_.addSeparator();
   parent_->addPanelSettings(&menu_);
 }
 
 void Trash::moveToTrash(const QStringList& filePaths) {
-  for (const QString& filePath : filePaths) {
-    QFileInfo fileInfo(filePath);
-    if (!fileInfo.exists()) {
-      continue;
-    }
-    
-    QString fileName = fileInfo.fileName();
-    QString destPath = trashFilesPath_ + "/" + fileName;
-    QString infoPath = trashInfoPath_ + "/" + fileName + ".trashinfo";
-    
-    int counter = 1;
-    while (QFile::exists(destPath)) {
-      QString baseName = fileInfo.baseName();
-      QString suffix = fileInfo.completeSuffix();
-      if (!suffix.isEmpty()) {
-        fileName = QString("%1_%2.%3").arg(baseName).arg(counter).arg(suffix);
-      } else {
-        fileName = QString("%1_%2").arg(baseName).arg(counter);
+  QPointer<Trash> guard(this);
+  workerPool()->start([filePaths, filesPath = trashFilesPath_, infoPath = trashInfoPath_,
+                       guard]() {
+    QStringList failedPaths;
+    for (const QString& filePath : filePaths) {
+      if (!trashFile(filePath, filesPath, infoPath)) {
+        failedPaths << filePath;
       }
-      destPath = trashFilesPath_ + "/" + fileName;
-      infoPath = trashInfoPath_ + "/" + fileName + ".trashinfo";
-      counter++;
     }
-    
-    if (QFile::rename(filePath, destPath)) {
-      QFile infoFile(infoPath);
-      if (infoFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QTextStream stream(&infoFile);
-        stream << "[Trash Info]\n";
-        stream << "Path=" << filePath << "\n";
-        stream << "DeletionDate=" << QDateTime::currentDateTime().toString(Qt::ISODate) << "\n";
-        infoFile.close();
+
+    QMetaObject::invokeMethod(QCoreApplication::instance(), [guard, failedPaths]() {
+      if (guard) {
+        guard->onMovedToTrash(failedPaths);
       }
-    }
-  }
-  
-  updateTrashState();
+    }, Qt::QueuedConnection);
+  });
 }
 
-bool Trash::isTrashEmpty() const {
-  QDir trashDir(trashFilesPath_);
-  return trashDir.isEmpty();
+void Trash::onMovedToTrash(const QStringList& failedPaths) {
+  for (const auto& path : failedPaths) {
+    std::cerr << "Could not move to trash: " << path.toStdString() << std::endl;
+  }
+  // The counts are already updated by the inotify events.
+  updateTrashState();
 }
 
 QString Trash::getTrashPath() const {
@@ -218,21 +414,80 @@ QString Trash::getTrashFilesPath() const {
 
 void Trash::updateIcon() {
   setIconName(isEmpty_ ? kEmptyTrashIconName : kFullTrashIconName);
-  
-  emptyTrashAction_->setEnabled(!isEmpty_);
+  updateMenu();
+}
+
+void Trash::updateMenu() {
+  if (emptyTrashAction_ == nullptr) {
+    return;
+  }
+  emptyTrashAction_->setEnabled(!isEmpty_ && !emptyTrashCancelled_);
+  stopEmptyingTrashAction_->setVisible(emptyTrashCancelled_ != nullptr);
 }
 
 void Trash::setupTrashWatcher() {
-  trashWatcher_ = new QFileSystemWatcher(this);
-  
+  inotifyFd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (inotifyFd_ < 0) {
+    std::cerr << "Could not watch the trash: " << std::strerror(errno) << std::endl;
+  } else {
+    trashNotifier_ = new QSocketNotifier(inotifyFd_, QSocketNotifier::Read, this);
+    connect(trashNotifier_, &QSocketNotifier::activated, this, &Trash::onTrashEvents);
+  }
+  watchTrashDirs();
+}
+
+void Trash::watchTrashDirs() {
   QDir().mkpath(trashFilesPath_);
   QDir().mkpath(trashInfoPath_);
-  
-  trashWatcher_->addPath(trashFilesPath_);
-  trashWatcher_->addPath(trashInfoPath_);
-  
-  connect(trashWatcher_, &QFileSystemWatcher::directoryChanged,
-          this, &Trash::updateTrashState);
+
+  if (inotifyFd_ >= 0) {
+    constexpr uint32_t kMask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                               IN_DELETE_SELF | IN_MOVE_SELF;
+    for (int* watch : {&filesWatch_, &infoWatch_}) {
+      if (*watch >= 0) {
+        inotify_rm_watch(inotifyFd_, *watch);
+      }
+    }
+    filesWatch_ = inotify_add_watch(inotifyFd_, QFile::encodeName(trashFilesPath_), kMask);
+    infoWatch_ = inotify_add_watch(inotifyFd_, QFile::encodeName(trashInfoPath_), kMask);
+  }
+
+  numFiles_ = QDir(trashFilesPath_).entryList(kAllEntries).size();
+  numInfoFiles_ = QDir(trashInfoPath_).entryList(kAllEntries).size();
+}
+
+void Trash::onTrashEvents() {
+  alignas(inotify_event) char buffer[4096];
+  bool rewatch = false;
+  ssize_t length;
+  while ((length = read(inotifyFd_, buffer, sizeof(buffer))) > 0) {
+    for (char* p = buffer; p < buffer + length;) {
+      const auto* event = reinterpret_cast<const inotify_event*>(p);
+      p += sizeof(inotify_event) + event->len;
+      if (event->mask & IN_Q_OVERFLOW) {
+        rewatch = true;
+        continue;
+      }
+      // Also skips the events of removed watches.
+      int* count = (event->wd == filesWatch_) ? &numFiles_
+          : (event->wd == infoWatch_) ? &numInfoFiles_ : nullptr;
+      if (count == nullptr) {
+        continue;
+      }
+      if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+        rewatch = true;
+      } else if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+        ++*count;
+      } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+        --*count;
+      }
+    }
+  }
+
+  if (rewatch) {
+    watchTrashDirs();
+  }
+  updateTrashState();
 }
 
 }  // namespace crystaldock
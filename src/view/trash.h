@@ -19,13 +19,16 @@
 #ifndef CRYSTALDOCK_TRASH_H_
 #define CRYSTALDOCK_TRASH_H_
 
+#include <atomic>
+#include <memory>
+
 #include <QAction>
 #include <QDragEnterEvent>
 #include <QDropEvent>
-#include <QFileSystemWatcher>
 #include <QMenu>
 #include <QMimeData>
 #include <QObject>
+#include <QSocketNotifier>
 #include <QString>
 #include <QTimer>
 #include <QUrl>
@@ -40,10 +43,12 @@ class Trash : public QObject, public IconBasedDockItem {
  public:
   Trash(DockPanel* parent, MultiDockModel* model, Qt::Orientation orientation,
         int minSize, int maxSize);
-  virtual ~Trash() = default;
+  virtual ~Trash();
 
-  void draw(QPainter* painter) const override;
+  void draw(QPainter* painter, const DrawContext& context) const override;
   void mousePressEvent(QMouseEvent* e) override;
+
+  void completeInit() override;
   QString getLabel() const override;
   bool beforeTask(const QString& program) override { return false; }
 
@@ -54,7 +59,9 @@ class Trash : public QObject, public IconBasedDockItem {
 
  public slots:
   void updateTrashState();
+  // Empties the trash in the background.
   void emptyTrash();
+  void stopEmptyingTrash();
   void openTrash();
 
   void dragEnterEvent(QDragEnterEvent* event);
@@ -62,28 +69,50 @@ class Trash : public QObject, public IconBasedDockItem {
 
  private:
   void createMenu();
+  // Moves the files to the trash in the background.
   void moveToTrash(const QStringList& filePaths);
-  bool isTrashEmpty() const;
+  void onMovedToTrash(const QStringList& failedPaths);
   QString getTrashPath() const;
   QString getTrashInfoPath() const;
   QString getTrashFilesPath() const;
   void updateIcon();
+  void updateMenu();
+
+  // Watches the files and info directories with inotify, counting their entries from the
+  // events instead of listing the directories on every change.
   void setupTrashWatcher();
+  // (Re)adds the watches and lists the directories again, e.g. after the event queue
+  // overflowed or a directory was removed.
+  void watchTrashDirs();
+  void onTrashEvents();
+
+  void onEmptyTrashProgress(int percent);
+  void onEmptyTrashFinished();
 
   QString trashPath_;
   QString trashInfoPath_;
   QString trashFilesPath_;
-  
-  QFileSystemWatcher* trashWatcher_;
-  
+
+  int inotifyFd_;
+  int filesWatch_;
+  int infoWatch_;
+  QSocketNotifier* trashNotifier_;
+  int numFiles_;
+  int numInfoFiles_;
+
   QMenu menu_;
-  QAction* emptyTrashAction_;
+  QAction* emptyTrashAction_ = nullptr;
+  QAction* stopEmptyingTrashAction_ = nullptr;
   QAction* openTrashAction_;
   QAction* restoreAction_;
 
   bool isEmpty_;
   bool acceptingDrop_;
 
+  // Set while emptying the trash, to cancel it.
+  std::shared_ptr<std::atomic<bool>> emptyTrashCancelled_;
+  int emptyTrashProgress_;
+
   static constexpr const char* kEmptyTrashIconName = "user-trash";
   static constexpr const char* kFullTrashIconName = "user-trash-full";
 };
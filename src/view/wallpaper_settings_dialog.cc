@@ -38,7 +38,7 @@ WallpaperSettingsDialog::WallpaperSettingsDialog(QWidget* parent,
     : QDialog(parent),
       ui(new Ui::WallpaperSettingsDialog),
       model_(model),
-      desktopEnv_(DesktopEnv::getDesktopEnv()),
+      desktopEnv_(model->desktopEnv()),
       currentDir_(QDir::homePath()),
       multiScreen_(false) {
   ui->setupUi(this);